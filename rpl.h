@@ -0,0 +1,38 @@
+/**
+ * RPL module interface
+ * Based on https://tools.ietf.org/html/rfc6550
+ *
+ * Collects the message definitions and the interfaces of each RPL component,
+ * include this rather than the individual component headers.
+ */
+
+#ifndef RPL_H
+#define RPL_H
+
+#include "rpl_types.h"
+#include "rpl_sequence.h"
+#include "rpl_message.h"
+#include "rpl_option.h"
+#include "rpl_checksum.h"
+#include "rpl_builder.h"
+#include "rpl_security.h"
+#include "rpl_replay.h"
+#include "rpl_pool.h"
+#include "rpl_address.h"
+#include "rpl_instance.h"
+#include "rpl_timer.h"
+#include "rpl_trickle.h"
+#include "rpl_parent.h"
+#include "rpl_of.h"
+#include "rpl_metric.h"
+#include "rpl_route.h"
+#include "rpl_source_route.h"
+#include "rpl_version.h"
+#include "rpl_repair.h"
+#include "rpl_packet_info.h"
+#include "rpl_dao.h"
+#include "rpl_dis.h"
+#include "rpl_prefix.h"
+#include "rpl_sim.h"
+
+#endif
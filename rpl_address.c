@@ -0,0 +1,129 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+static uint32_t RPL_address_hash(rpl_address_handle_t context, const uint8_t key[8]) {
+	uint32_t hash = RPL_read_uint32(key) ^ (RPL_read_uint32(key + 4) * 0x9E3779B1UL) ^ ((uint32_t)context * 0x85EBCA6BUL);
+
+	return hash ^ (hash >> 15);
+}
+
+//Entry of key under context, contexts are keyed by their upper 64 bits under RPL_ADDRESS_NONE
+static rpl_address_handle_t RPL_address_lookup(const struct rpl_address_table_s *table, rpl_address_handle_t context, const uint8_t key[8]) {
+	rpl_address_handle_t handle;
+
+	for (handle = table->index[RPL_address_hash(context, key) & table->index_mask]; handle != RPL_ADDRESS_NONE; handle = table->entries[handle].next) {
+		const struct rpl_address_s *entry = &table->entries[handle];
+
+		if ((entry->context == context) && (memcmp(entry->iid, key, 8) == 0)) {
+			return handle;
+		}
+	}
+	return RPL_ADDRESS_NONE;
+}
+
+//Takes an entry without a reference and links it into its hash chain
+static rpl_address_handle_t RPL_address_add(struct rpl_address_table_s *table, rpl_address_handle_t context, const uint8_t key[8]) {
+	struct rpl_address_s *entry;
+	uint32_t index = RPL_pool_alloc(&table->pool);
+	uint32_t slot;
+
+	if (index == RPL_POOL_NONE) {
+		return RPL_ADDRESS_NONE;
+	}
+
+	entry = &table->entries[index];
+	memcpy(entry->iid, key, 8);
+	entry->context = context;
+	entry->references = 0;
+	slot = RPL_address_hash(context, key) & table->index_mask;
+	entry->next = table->index[slot];
+	table->index[slot] = (rpl_address_handle_t)index;
+	return (rpl_address_handle_t)index;
+}
+
+//Unlinks an entry from its hash chain and frees it
+static void RPL_address_remove(struct rpl_address_table_s *table, rpl_address_handle_t handle) {
+	struct rpl_address_s *entry = &table->entries[handle];
+	rpl_address_handle_t *link = &table->index[RPL_address_hash(entry->context, entry->iid) & table->index_mask];
+
+	while (*link != handle) {
+		link = &table->entries[*link].next;
+	}
+	*link = entry->next;
+	RPL_pool_free(&table->pool, handle);
+}
+
+int RPL_address_table_init(struct rpl_address_table_s *table, struct rpl_address_s *entries, uint32_t capacity, rpl_address_handle_t *index,
+                           uint32_t index_size) {
+	uint32_t i;
+
+	if ((capacity >= RPL_ADDRESS_NONE) || (index_size == 0) || ((index_size & (index_size - 1)) != 0)) {
+		return -1;
+	}
+
+	table->entries = entries;
+	//Free entries are out of every hash chain, their interface identifier holds the free list
+	RPL_pool_init(&table->pool, entries, sizeof(struct rpl_address_s), offsetof(struct rpl_address_s, iid), capacity);
+	table->index = index;
+	table->index_mask = index_size - 1;
+	for (i = 0; i < index_size; i++) {
+		index[i] = RPL_ADDRESS_NONE;
+	}
+	return 0;
+}
+
+rpl_address_handle_t RPL_address_find(const struct rpl_address_table_s *table, const uint8_t address[16]) {
+	rpl_address_handle_t context = RPL_address_lookup(table, RPL_ADDRESS_NONE, address);
+
+	if (context == RPL_ADDRESS_NONE) {
+		return RPL_ADDRESS_NONE;
+	}
+	return RPL_address_lookup(table, context, address + 8);
+}
+
+rpl_address_handle_t RPL_address_intern(struct rpl_address_table_s *table, const uint8_t address[16]) {
+	rpl_address_handle_t context = RPL_address_lookup(table, RPL_ADDRESS_NONE, address);
+	rpl_address_handle_t handle;
+
+	if (context != RPL_ADDRESS_NONE) {
+		handle = RPL_address_lookup(table, context, address + 8);
+		if (handle != RPL_ADDRESS_NONE) {
+			table->entries[handle].references++;
+			return handle;
+		}
+	} else if ((context = RPL_address_add(table, RPL_ADDRESS_NONE, address)) == RPL_ADDRESS_NONE) {
+		return RPL_ADDRESS_NONE;
+	}
+
+	handle = RPL_address_add(table, context, address + 8);
+	if (handle == RPL_ADDRESS_NONE) {
+		//A new context is only kept with its first address
+		if (table->entries[context].references == 0) {
+			RPL_address_remove(table, context);
+		}
+		return RPL_ADDRESS_NONE;
+	}
+	table->entries[context].references++;
+	table->entries[handle].references = 1;
+	return handle;
+}
+
+void RPL_address_release(struct rpl_address_table_s *table, rpl_address_handle_t handle) {
+	rpl_address_handle_t context = table->entries[handle].context;
+
+	if (--table->entries[handle].references != 0) {
+		return;
+	}
+
+	RPL_address_remove(table, handle);
+	if (--table->entries[context].references == 0) {
+		RPL_address_remove(table, context);
+	}
+}
+
+void RPL_address_get(const struct rpl_address_table_s *table, rpl_address_handle_t handle, uint8_t address[16]) {
+	memcpy(address, RPL_address_prefix(table, handle), 8);
+	memcpy(address + 8, RPL_address_iid(table, handle), 8);
+}
@@ -0,0 +1,101 @@
+/**
+ * RPL address interning
+ * Compact handles for the IPv6 addresses and prefixes held in neighbor, parent and route tables
+ *
+ * Each distinct address is stored once and tables hold a handle (rpl_address_handle_t, 16 bits
+ * unless RPL_CONF_ADDRESS_HANDLE_BITS is 32) in place of 16 octets, so equal addresses compare as
+ * equal handles. Addresses of a node share few /64 prefixes (the DODAG prefixes and fe80::/64),
+ * so like 6LoWPAN contexts [RFC6282 Section 3.1.2] the upper 64 bits are interned once as a
+ * context entry and an address entry only keeps its interface identifier and the handle of its
+ * context. Contexts are entries of the same table, a table holding n addresses needs room for n
+ * entries plus one per distinct /64 and there is no other limit on the prefixes. Prefixes are
+ * interned as addresses with the bits past the prefix length cleared.
+ *
+ * Entries are reference counted: RPL_address_intern and RPL_address_retain take a reference,
+ * RPL_address_release drops one and frees the entry (and its context) with the last. Entries
+ * come from a pool over a caller supplied array (see rpl_pool.h) and are found through a caller
+ * supplied power of 2 hash index chained through the entries, so the table never allocates.
+ */
+
+#ifndef RPL_ADDRESS_H
+#define RPL_ADDRESS_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_ADDRESS_NONE            ((rpl_address_handle_t)~(rpl_address_handle_t)0)  //!< Null handle
+
+/**
+ * @brief Interned address or context
+ */
+struct rpl_address_s {
+    uint8_t iid[8];                 //!< Lower 64 bits (interface identifier), upper 64 bits for a context
+    uint32_t references;            //!< Handles held by tables (addresses using it for a context), 0 when free
+    rpl_address_handle_t next;      //!< Next entry of the hash chain
+    rpl_address_handle_t context;   //!< Context holding the upper 64 bits, RPL_ADDRESS_NONE for a context
+};
+
+/**
+ * @brief Address table
+ */
+struct rpl_address_table_s {
+    struct rpl_address_s *entries;  //!< Entry storage
+    struct rpl_pool_s pool;         //!< Entries in use
+    rpl_address_handle_t *index;    //!< Hash chains
+    uint32_t index_mask;            //!< Size of index - 1
+};
+
+/**
+ * @brief Initialise an empty table
+ * @details index_size must be a power of 2, capacity below RPL_ADDRESS_NONE. capacity covers the
+ * addresses and one context per distinct /64 of the addresses.
+ * @return 0 on success, -1 on invalid sizes
+ */
+int RPL_address_table_init(struct rpl_address_table_s *table, struct rpl_address_s *entries, uint32_t capacity, rpl_address_handle_t *index,
+                           uint32_t index_size);
+
+/**
+ * @brief Handle of an address, adding it when not present, with a reference taken
+ * @return handle, RPL_ADDRESS_NONE when the entries are exhausted
+ */
+rpl_address_handle_t RPL_address_intern(struct rpl_address_table_s *table, const uint8_t address[16]);
+
+/**
+ * @brief Handle of an address without taking a reference
+ * @return handle, RPL_ADDRESS_NONE when the address is not interned
+ */
+rpl_address_handle_t RPL_address_find(const struct rpl_address_table_s *table, const uint8_t address[16]);
+
+/**
+ * @brief Drop a reference, the last frees the entry
+ */
+void RPL_address_release(struct rpl_address_table_s *table, rpl_address_handle_t handle);
+
+static inline void RPL_address_retain(struct rpl_address_table_s *table, rpl_address_handle_t handle) {
+    table->entries[handle].references++;
+}
+
+static inline const uint8_t *RPL_address_prefix(const struct rpl_address_table_s *table, rpl_address_handle_t handle) {
+    return table->entries[table->entries[handle].context].iid;
+}
+
+static inline const uint8_t *RPL_address_iid(const struct rpl_address_table_s *table, rpl_address_handle_t handle) {
+    return table->entries[handle].iid;
+}
+
+/**
+ * @brief Copy out the address of a handle
+ */
+void RPL_address_get(const struct rpl_address_table_s *table, rpl_address_handle_t handle, uint8_t address[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#define ADDRESS_TEST_CAPACITY   8
+
+static void test_address(uint8_t address[16], uint8_t prefix, uint8_t iid) {
+	memset(address, 0, 16);
+	address[0] = 0x20;
+	address[1] = 0x01;
+	address[2] = 0x0D;
+	address[3] = 0xB8;
+	address[7] = prefix;
+	address[15] = iid;
+}
+
+TEST_GROUP(address_tests)
+{
+	struct rpl_address_table_s table;
+	struct rpl_address_s entries[ADDRESS_TEST_CAPACITY];
+	rpl_address_handle_t index[4];
+	uint8_t address[16];
+
+	void setup() {
+		CHECK_EQUAL(0, RPL_address_table_init(&table, entries, ADDRESS_TEST_CAPACITY, index, 4));
+	}
+
+	void teardown() {
+
+	}
+};
+
+TEST(address_tests, address_init) {
+	CHECK_EQUAL(-1, RPL_address_table_init(&table, entries, ADDRESS_TEST_CAPACITY, index, 3));
+	CHECK_EQUAL(-1, RPL_address_table_init(&table, entries, ADDRESS_TEST_CAPACITY, index, 0));
+	CHECK_EQUAL(-1, RPL_address_table_init(&table, entries, RPL_ADDRESS_NONE, index, 4));
+
+	//A DODAGID is held as a handle
+	CHECK_EQUAL(sizeof(rpl_address_handle_t), sizeof(rpl_dodag_id_t));
+}
+
+//Equal addresses give equal handles, the last release frees the entry
+TEST(address_tests, address_intern) {
+	uint8_t other[16], copy[16];
+	rpl_address_handle_t handle;
+
+	test_address(address, 1, 1);
+	test_address(other, 1, 2);
+	handle = RPL_address_intern(&table, address);
+	CHECK(handle != RPL_ADDRESS_NONE);
+	CHECK_EQUAL(handle, RPL_address_intern(&table, address));
+	CHECK_EQUAL(handle, RPL_address_find(&table, address));
+	CHECK(RPL_address_intern(&table, other) != handle);
+	CHECK_EQUAL(3, table.pool.count);
+	CHECK_EQUAL(2, table.entries[handle].references);
+
+	RPL_address_get(&table, handle, copy);
+	MEMCMP_EQUAL(address, copy, 16);
+
+	RPL_address_release(&table, handle);
+	CHECK_EQUAL(handle, RPL_address_find(&table, address));
+	RPL_address_release(&table, handle);
+	CHECK_EQUAL(RPL_ADDRESS_NONE, RPL_address_find(&table, address));
+	CHECK_EQUAL(2, table.pool.count);
+
+	//Released entries are reused
+	test_address(address, 1, 3);
+	CHECK_EQUAL(handle, RPL_address_intern(&table, address));
+	CHECK_EQUAL(3, table.pool.used);
+}
+
+//Addresses of a /64 share one context entry, released with its last address
+TEST(address_tests, address_context) {
+	rpl_address_handle_t handles[ADDRESS_TEST_CAPACITY / 2];
+	uint8_t i;
+
+	test_address(address, 1, 1);
+	handles[0] = RPL_address_intern(&table, address);
+	test_address(address, 1, 2);
+	handles[1] = RPL_address_intern(&table, address);
+	CHECK_EQUAL(3, table.pool.count);
+	POINTERS_EQUAL(RPL_address_prefix(&table, handles[0]), RPL_address_prefix(&table, handles[1]));
+	RPL_address_release(&table, handles[0]);
+	RPL_address_release(&table, handles[1]);
+	CHECK_EQUAL(0, table.pool.count);
+
+	//Distinct prefixes are only limited by the entries
+	for (i = 0; i < ADDRESS_TEST_CAPACITY / 2; i++) {
+		test_address(address, i, 1);
+		handles[i] = RPL_address_intern(&table, address);
+		CHECK(handles[i] != RPL_ADDRESS_NONE);
+	}
+	CHECK_EQUAL(ADDRESS_TEST_CAPACITY, table.pool.count);
+
+	//A new context is not kept when its address does not fit
+	test_address(address, ADDRESS_TEST_CAPACITY, 1);
+	CHECK_EQUAL(RPL_ADDRESS_NONE, RPL_address_intern(&table, address));
+	RPL_address_release(&table, handles[3]);
+	CHECK_EQUAL(ADDRESS_TEST_CAPACITY - 2, table.pool.count);
+	CHECK(RPL_address_intern(&table, address) != RPL_ADDRESS_NONE);
+	test_address(address, 3, 1);
+	CHECK_EQUAL(RPL_ADDRESS_NONE, RPL_address_find(&table, address));
+}
+
+//Intern fails once every entry is taken
+TEST(address_tests, address_full) {
+	rpl_address_handle_t first = RPL_ADDRESS_NONE;
+	uint8_t i;
+
+	//One entry holds the context
+	for (i = 0; i < ADDRESS_TEST_CAPACITY - 1; i++) {
+		test_address(address, 1, i);
+		CHECK(RPL_address_intern(&table, address) != RPL_ADDRESS_NONE);
+		if (i == 0) {
+			first = RPL_address_find(&table, address);
+		}
+	}
+	test_address(address, 1, ADDRESS_TEST_CAPACITY);
+	CHECK_EQUAL(RPL_ADDRESS_NONE, RPL_address_intern(&table, address));
+
+	//Chains hold more entries than the index has slots
+	for (i = 0; i < ADDRESS_TEST_CAPACITY - 1; i++) {
+		test_address(address, 1, i);
+		CHECK(RPL_address_find(&table, address) != RPL_ADDRESS_NONE);
+	}
+
+	RPL_address_release(&table, first);
+	test_address(address, 1, ADDRESS_TEST_CAPACITY);
+	CHECK_EQUAL(first, RPL_address_intern(&table, address));
+}
+
+//Route nodes hold handles in place of two addresses
+TEST(address_tests, address_route_size) {
+#if RPL_CONF_STORING
+	CHECK(sizeof(struct rpl_route_s) <= 20 + 2 * sizeof(rpl_address_handle_t));
+#endif
+	CHECK(sizeof(struct rpl_neighbor_s) <= 8 + sizeof(rpl_address_handle_t));
+}
@@ -0,0 +1,118 @@
+/**
+ * Benchmark harness
+ * Shared setup for the Google Benchmark micro-benchmarks (rpl_*_bench.cpp)
+ *
+ * Each benchmark file is a separate program ending in RPL_BENCH_MAIN(). Results are written as
+ * JSON unless another --benchmark_format is given. Benchmarks clear rpl_bench_allocations before
+ * the timed loop and finish with rpl_bench_items, so each result has the time per iteration in
+ * ns, items_per_second (ns/op = 1e9 / items_per_second) and allocs_per_op. Build with eg.
+ *   gcc -O3 -c rpl_*.c && g++ -O3 rpl_route_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#ifndef RPL_BENCH_H
+#define RPL_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+static int64_t rpl_bench_allocations;
+static int64_t rpl_bench_allocated_bytes;
+
+#ifdef __GLIBC__
+//Heap allocations from C code (the library must not make any) are counted by interposing malloc
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+
+extern "C" void *malloc(size_t size) {
+	rpl_bench_allocations++;
+	rpl_bench_allocated_bytes += (int64_t)size;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+	rpl_bench_allocations++;
+	rpl_bench_allocated_bytes += (int64_t)(count * size);
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size) {
+	rpl_bench_allocations++;
+	rpl_bench_allocated_bytes += (int64_t)size;
+	return __libc_realloc(pointer, size);
+}
+#else
+void *operator new(size_t size) {
+	void *pointer = malloc(size ? size : 1);
+
+	rpl_bench_allocations++;
+	rpl_bench_allocated_bytes += (int64_t)size;
+	if (pointer == NULL) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+	free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+	free(pointer);
+}
+#endif
+
+/**
+ * @brief Report per operation rates for a benchmark covering items operations per iteration
+ * @details Sets the items processed and the allocs_per_op counter, heap allocations made since
+ * rpl_bench_allocations was cleared before the timed loop divided by the operations run.
+ */
+static inline void rpl_bench_items(benchmark::State &state, int64_t items) {
+	//Read before the counter map allocates its entry
+	int64_t allocations = rpl_bench_allocations;
+	double operations = (double)state.iterations() * (double)items;
+
+	state.SetItemsProcessed(state.iterations() * items);
+	state.counters["allocs_per_op"] = benchmark::Counter((operations > 0) ? (double)allocations / operations : 0);
+}
+
+//Deterministic test data, rand() differs between C libraries
+static inline uint32_t rpl_bench_random(uint32_t *state) {
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+#define RPL_BENCH_MAIN()                                                        \
+    int main(int argc, char **argv) {                                           \
+        std::vector<char *> args(argv, argv + argc);                            \
+        static char json[] = "--benchmark_format=json";                         \
+        int format_given = 0;                                                   \
+        for (int i = 1; i < argc; i++) {                                        \
+            format_given |= (strncmp(argv[i], "--benchmark_format", 18) == 0);  \
+        }                                                                       \
+        if (!format_given) {                                                    \
+            args.push_back(json);                                               \
+        }                                                                       \
+        int count = (int)args.size();                                           \
+        benchmark::Initialize(&count, args.data());                             \
+        if (benchmark::ReportUnrecognizedArguments(count, args.data())) {       \
+            return 1;                                                           \
+        }                                                                       \
+        benchmark::RunSpecifiedBenchmarks();                                    \
+        benchmark::Shutdown();                                                  \
+        return 0;                                                               \
+    }
+
+#endif
@@ -0,0 +1,512 @@
+#include <string.h>
+
+#include "rpl.h"
+
+//Message encoding, section 6
+
+//Required option alignment xn+y relative to the start of the message, chosen so multi octet fields are naturally aligned
+static const uint8_t rpl_builder_alignment[RPL_OPTION_TYPE_MAX + 1][2] = {
+	{1, 0},     //Pad1
+	{1, 0},     //PadN
+	{1, 0},     //DAG Metric Container
+	{4, 0},     //Route Information, lifetime at 4n
+	{2, 0},     //DODAG Configuration, 16 bit fields at 2n
+	{4, 0},     //RPL Target, prefix at 4n
+	{8, 2},     //Transit Information, parent address at 8n
+	{1, 0},     //Solicited Information
+	{8, 0},     //Prefix Information, lifetimes at 4n and prefix at 8n
+	{4, 2}      //RPL Target Descriptor, descriptor at 4n
+};
+
+#define RPL_BUILDER_BLOCK_ALIGNMENT     8       //!< Blocks are placed at 8n so their internal alignment is preserved
+
+static int RPL_builder_fail(struct rpl_builder_s *builder) {
+	builder->error = 1;
+	return -1;
+}
+
+void RPL_builder_init(struct rpl_builder_s *builder, uint8_t *buffer, uint16_t capacity, struct rpl_iovec_s *iov, uint8_t iov_capacity) {
+	builder->buffer = buffer;
+	builder->capacity = capacity;
+	builder->used = 0;
+	builder->length = 0;
+	builder->segment_start = 0;
+	builder->iov = iov;
+	builder->iov_capacity = iov_capacity;
+	builder->iov_count = 0;
+	builder->code = 0;
+	builder->error = 0;
+	builder->block = 0;
+	builder->allowed = 0;
+	builder->sum = 0;
+}
+
+//A block has no header, its options are aligned as if it started a message
+int RPL_builder_block_begin(struct rpl_builder_s *builder, uint8_t message_code) {
+	if (builder->length != 0) {
+		return RPL_builder_fail(builder);
+	}
+
+	builder->block = 1;
+	builder->code = message_code;
+	builder->allowed = RPL_option_allowed(message_code);
+
+	return 0;
+}
+
+//Space for length octets in the buffer, NULL if there is no room
+static uint8_t *RPL_builder_reserve(struct rpl_builder_s *builder, uint16_t length) {
+	if (builder->error || ((uint32_t)builder->used + length > builder->capacity)) {
+		RPL_builder_fail(builder);
+		return NULL;
+	}
+	return builder->buffer + builder->used;
+}
+
+//Adds the octets written to reserved space to the message and the running checksum
+static void RPL_builder_commit(struct rpl_builder_s *builder, uint16_t length) {
+	uint32_t partial = RPL_checksum_partial(0, builder->buffer + builder->used, length);
+
+	builder->sum = RPL_checksum_combine(builder->sum, partial, builder->length);
+	builder->used += length;
+	builder->length += length;
+}
+
+static int RPL_builder_pad(struct rpl_builder_s *builder, uint8_t alignment, uint8_t offset) {
+	uint8_t gap = (uint8_t)((offset - builder->length) & (alignment - 1));
+	uint8_t *p;
+
+	if (gap == 0) {
+		return 0;
+	}
+	if ((p = RPL_builder_reserve(builder, gap)) == NULL) {
+		return -1;
+	}
+
+	memset(p, 0, gap);
+	if (gap > 1) {
+		p[0] = RPL_OPTION_PADN;
+		p[1] = gap - RPL_OPTION_HEADER_LENGTH;
+	}
+	RPL_builder_commit(builder, gap);
+
+	return 0;
+}
+
+//Writes an aligned option header and returns the space for its data
+static uint8_t *RPL_builder_option_begin(struct rpl_builder_s *builder, uint8_t type, uint8_t length) {
+	uint8_t *p;
+
+	if ((type > RPL_OPTION_TYPE_MAX) || !(builder->allowed & (1UL << type))) {
+		RPL_builder_fail(builder);
+		return NULL;
+	}
+	if (RPL_builder_pad(builder, rpl_builder_alignment[type][0], rpl_builder_alignment[type][1]) < 0) {
+		return NULL;
+	}
+	if ((p = RPL_builder_reserve(builder, RPL_OPTION_HEADER_LENGTH + length)) == NULL) {
+		return NULL;
+	}
+
+	p[0] = type;
+	p[1] = length;
+	return p + RPL_OPTION_HEADER_LENGTH;
+}
+
+static int RPL_builder_option_end(struct rpl_builder_s *builder, uint8_t length) {
+	RPL_builder_commit(builder, RPL_OPTION_HEADER_LENGTH + length);
+	return 0;
+}
+
+static uint16_t RPL_builder_security_length(const struct rpl_security_s *security) {
+#if RPL_CONF_SECURITY
+	if (security == NULL) {
+		return 0;
+	}
+	return RPL_SECURITY_BASE_LENGTH + RPL_security_key_identifier_length(security->kim_and_lvl);
+#else
+	(void)security;
+	return 0;
+#endif
+}
+
+#if RPL_CONF_SECURITY
+//Security section, section 6.1
+static void RPL_builder_write_security(uint8_t *p, const struct rpl_security_s *security) {
+	uint16_t key_identifier = RPL_security_key_identifier_length(security->kim_and_lvl);
+
+	p[0] = security->t & RPL_SECURITY_COUNTER_IS_TIME_FLAG;
+	p[1] = security->algorithm;
+	p[2] = security->kim_and_lvl;
+	p[3] = security->flags;
+	RPL_write_uint32(p + 4, security->counter);
+
+	p += RPL_SECURITY_BASE_LENGTH;
+	if (key_identifier == 1) {
+		p[0] = security->key_identifier_mode0.key_index;
+	} else if (key_identifier > 1) {
+		memcpy(p, security->key_identifier_mode2.key_source, sizeof(security->key_identifier_mode2.key_source));
+		p[sizeof(security->key_identifier_mode2.key_source)] = security->key_identifier_mode2.key_index;
+	}
+}
+#endif
+
+//Writes the ICMPv6 header and security section, returns the space for the message base
+static uint8_t *RPL_builder_begin(struct rpl_builder_s *builder, uint8_t code, const struct rpl_security_s *security, uint16_t base_length) {
+	uint16_t security_length = RPL_builder_security_length(security);
+	uint8_t *p;
+
+	if (builder->length != 0) {
+		RPL_builder_fail(builder);
+		return NULL;
+	}
+#if !RPL_CONF_SECURITY
+	//Secured messages cannot be built when security is compiled out
+	if (security != NULL) {
+		RPL_builder_fail(builder);
+		return NULL;
+	}
+#endif
+	if ((p = RPL_builder_reserve(builder, RPL_ICMPV6_HEADER_LENGTH + security_length + base_length)) == NULL) {
+		return NULL;
+	}
+
+#if RPL_CONF_SECURITY
+	if (security != NULL) {
+		code |= RPL_CONTROL_MESSAGE_SECURE_FLAG;
+		RPL_builder_write_security(p + RPL_ICMPV6_HEADER_LENGTH, security);
+	}
+#endif
+	p[0] = RPL_ICMPV6_INFORMATION_TYPE;
+	p[1] = code;
+	p[2] = 0;
+	p[3] = 0;
+
+	builder->code = code;
+	builder->allowed = RPL_option_allowed(code);
+
+	return p + RPL_ICMPV6_HEADER_LENGTH + security_length;
+}
+
+static int RPL_builder_end_base(struct rpl_builder_s *builder, const struct rpl_security_s *security, uint16_t base_length) {
+	RPL_builder_commit(builder, RPL_ICMPV6_HEADER_LENGTH + RPL_builder_security_length(security) + base_length);
+	return 0;
+}
+
+//6.3.1 DIO Base Object
+int RPL_builder_dio(struct rpl_builder_s *builder, const struct rpl_dio_s *dio, const uint8_t dodag_id[16], const struct rpl_security_s *security) {
+	uint8_t *p = RPL_builder_begin(builder, RPL_DODAG_INFORMATION_OBJECT, security, RPL_DIO_BASE_LENGTH);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = dio->rpl_instance_id;
+	p[1] = dio->rpl_version;
+	RPL_write_uint16(p + 2, dio->rank);
+	p[4] = dio->mode;
+	p[5] = dio->dtsn;
+	p[6] = 0;
+	p[7] = 0;
+	memcpy(p + 8, dodag_id, RPL_DODAG_ID_LENGTH);
+
+	return RPL_builder_end_base(builder, security, RPL_DIO_BASE_LENGTH);
+}
+
+//6.4.1 DAO Base Object
+int RPL_builder_dao(struct rpl_builder_s *builder, const struct rpl_dao_s *dao, const struct rpl_security_s *security) {
+	uint8_t flags = dao->flags & (RPL_DAO_FLAG_K_MASK | RPL_DAO_FLAG_D_MASK);
+	uint16_t length = RPL_DAO_BASE_LENGTH + ((flags & RPL_DAO_FLAG_D_MASK) ? RPL_DODAG_ID_LENGTH : 0);
+	uint8_t *p = RPL_builder_begin(builder, RPL_DESTINATION_ADVERTISEMENt_OBJECT, security, length);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = dao->rpl_instance;
+	p[1] = flags;
+	p[2] = 0;
+	p[3] = dao->dao_sequence;
+	if (flags & RPL_DAO_FLAG_D_MASK) {
+		memcpy(p + RPL_DAO_BASE_LENGTH, dao->dodag_id, RPL_DODAG_ID_LENGTH);
+	}
+
+	return RPL_builder_end_base(builder, security, length);
+}
+
+//6.5.1 DAO-ACK Base Object
+int RPL_builder_dao_ack(struct rpl_builder_s *builder, const struct rpl_dao_ack_s *dao_ack, const struct rpl_security_s *security) {
+	uint8_t flags = dao_ack->flags & RPL_DAO_ACK_FLAG_D_MASK;
+	uint16_t length = RPL_DAO_ACK_BASE_LENGTH + (flags ? RPL_DODAG_ID_LENGTH : 0);
+	uint8_t *p = RPL_builder_begin(builder, RPL_DESTINATION_ADVERTISEMENT_OBJECT_ACK, security, length);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = dao_ack->rpl_instance;
+	p[1] = flags;
+	p[2] = dao_ack->dao_sequence;
+	p[3] = dao_ack->status;
+	if (flags) {
+		memcpy(p + RPL_DAO_ACK_BASE_LENGTH, dao_ack->dodag_id, RPL_DODAG_ID_LENGTH);
+	}
+
+	return RPL_builder_end_base(builder, security, length);
+}
+
+//6.2.1 DIS Base Object
+int RPL_builder_dis(struct rpl_builder_s *builder, const struct rpl_dis_s *dis, const struct rpl_security_s *security) {
+	uint8_t *p = RPL_builder_begin(builder, RPL_DODAG_INFORMATION_SOLICITATION, security, RPL_DIS_BASE_LENGTH);
+
+	(void)dis;
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = 0;
+	p[1] = 0;
+
+	return RPL_builder_end_base(builder, security, RPL_DIS_BASE_LENGTH);
+}
+
+//6.6.1 CC Base Object, CC messages are always secured
+int RPL_builder_cc(struct rpl_builder_s *builder, const struct rpl_cc_s *cc, const struct rpl_security_s *security) {
+	uint8_t *p;
+
+	if (security == NULL) {
+		return RPL_builder_fail(builder);
+	}
+	if ((p = RPL_builder_begin(builder, RPL_CONSISTENCY_CHECK, security, RPL_CC_BASE_LENGTH)) == NULL) {
+		return -1;
+	}
+
+	p[0] = cc->rpl_instance;
+	p[1] = cc->flags & RPL_CC_FLAG_R_MASK;
+	RPL_write_uint16(p + 2, cc->cc_nonce);
+	memcpy(p + 4, cc->dodag_id, RPL_DODAG_ID_LENGTH);
+	RPL_write_uint32(p + 4 + RPL_DODAG_ID_LENGTH, cc->destination_counter);
+
+	return RPL_builder_end_base(builder, security, RPL_CC_BASE_LENGTH);
+}
+
+int RPL_builder_option(struct rpl_builder_s *builder, uint8_t type, const uint8_t *data, uint8_t length) {
+	uint8_t *p;
+
+	if ((type == RPL_OPTION_PAD1) || (type == RPL_OPTION_PADN)) {
+		return RPL_builder_fail(builder);
+	}
+	if ((p = RPL_builder_option_begin(builder, type, length)) == NULL) {
+		return -1;
+	}
+
+	memcpy(p, data, length);
+
+	return RPL_builder_option_end(builder, length);
+}
+
+//6.7.4 DAG Metric Container
+int RPL_builder_dag_metric(struct rpl_builder_s *builder, const uint8_t *metric_data, uint8_t length) {
+	return RPL_builder_option(builder, RPL_OPTION_DAG_METRIC, metric_data, length);
+}
+
+//6.7.5 Route Information
+int RPL_builder_route_info(struct rpl_builder_s *builder, const struct rpl_option_route_info_s *route_info, const uint8_t *prefix) {
+	uint8_t prefix_octets = (uint8_t)((route_info->prefix_length + 7) / 8);
+	uint8_t length = 6 + prefix_octets;
+	uint8_t *p;
+
+	if (route_info->prefix_length > 128) {
+		return RPL_builder_fail(builder);
+	}
+	if ((p = RPL_builder_option_begin(builder, RPL_OPTION_ROUTE_INFO, length)) == NULL) {
+		return -1;
+	}
+
+	p[0] = route_info->prefix_length;
+	p[1] = route_info->flags;
+	RPL_write_uint32(p + 2, route_info->route_lifetime);
+	memcpy(p + 6, prefix, prefix_octets);
+
+	return RPL_builder_option_end(builder, length);
+}
+
+//6.7.6 DODAG Configuration
+int RPL_builder_dodag_config(struct rpl_builder_s *builder, const struct rpl_option_dodag_configuration_s *config) {
+	uint8_t *p = RPL_builder_option_begin(builder, RPL_OPTION_DODAG_CONFIGURATION, RPL_OPTION_DODAG_CONFIGURATION_LENGTH);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = config->flags;
+	p[1] = config->dio_int_double;
+	p[2] = config->dio_int_min;
+	p[3] = config->dio_redun;
+	RPL_write_uint16(p + 4, config->max_rank_increase);
+	RPL_write_uint16(p + 6, config->min_hop_rank_increase);
+	RPL_write_uint16(p + 8, config->objective_code_point);
+	p[10] = 0;
+	p[11] = config->default_lifetime;
+	RPL_write_uint16(p + 12, config->lifetime_unit);
+
+	return RPL_builder_option_end(builder, RPL_OPTION_DODAG_CONFIGURATION_LENGTH);
+}
+
+//6.7.7 RPL Target
+int RPL_builder_target(struct rpl_builder_s *builder, uint8_t prefix_length, const uint8_t *prefix) {
+	uint8_t prefix_octets = (uint8_t)((prefix_length + 7) / 8);
+	uint8_t length = 2 + prefix_octets;
+	uint8_t *p;
+
+	if (prefix_length > 128) {
+		return RPL_builder_fail(builder);
+	}
+	if ((p = RPL_builder_option_begin(builder, RPL_OPTION_RPL_TARGET, length)) == NULL) {
+		return -1;
+	}
+
+	p[0] = 0;
+	p[1] = prefix_length;
+	memcpy(p + 2, prefix, prefix_octets);
+
+	return RPL_builder_option_end(builder, length);
+}
+
+//6.7.8 Transit Information, parent_address only in non-storing mode
+int RPL_builder_transit_info(struct rpl_builder_s *builder, const struct rpl_option_transit_info_s *transit_info, const uint8_t *parent_address) {
+	uint8_t length = RPL_OPTION_TRANSIT_INFO_LENGTH + (parent_address ? RPL_DODAG_ID_LENGTH : 0);
+	uint8_t *p = RPL_builder_option_begin(builder, RPL_OPTION_TRANSIT_INFO, length);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = transit_info->flags & RPL_OPTION_TRANSIT_INFO_EXTERNAL_MASK;
+	p[1] = transit_info->path_control;
+	p[2] = transit_info->path_sequence;
+	p[3] = transit_info->path_lifetime;
+	if (parent_address) {
+		memcpy(p + RPL_OPTION_TRANSIT_INFO_LENGTH, parent_address, RPL_DODAG_ID_LENGTH);
+	}
+
+	return RPL_builder_option_end(builder, length);
+}
+
+//6.7.9 Solicited Information
+int RPL_builder_solicited_info(struct rpl_builder_s *builder, const struct rpl_option_solicited_info_s *solicited_info) {
+	uint8_t *p = RPL_builder_option_begin(builder, RPL_OPTION_SOLICITED_INFO, RPL_OPTION_SOLICITED_INFO_LENGTH);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = solicited_info->rpl_instance_id;
+	p[1] = solicited_info->flags;
+	memcpy(p + 2, solicited_info->dodag_id, RPL_DODAG_ID_LENGTH);
+	p[2 + RPL_DODAG_ID_LENGTH] = solicited_info->version_number;
+
+	return RPL_builder_option_end(builder, RPL_OPTION_SOLICITED_INFO_LENGTH);
+}
+
+//6.7.10 Prefix Information
+int RPL_builder_prefix_info(struct rpl_builder_s *builder, const struct rpl_option_prefix_info_s *prefix_info, const uint8_t prefix[16]) {
+	uint8_t *p = RPL_builder_option_begin(builder, RPL_OPTION_PREFIX_INFO, RPL_OPTION_PREFIX_INFO_LENGTH);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	p[0] = prefix_info->prefix_length;
+	p[1] = prefix_info->flags;
+	RPL_write_uint32(p + 2, prefix_info->valid_lifetime);
+	RPL_write_uint32(p + 6, prefix_info->preferred_lifetime);
+	RPL_write_uint32(p + 10, 0);
+	memcpy(p + 14, prefix, 16);
+
+	return RPL_builder_option_end(builder, RPL_OPTION_PREFIX_INFO_LENGTH);
+}
+
+//6.7.11 RPL Target Descriptor
+int RPL_builder_target_descriptor(struct rpl_builder_s *builder, uint32_t descriptor) {
+	uint8_t *p = RPL_builder_option_begin(builder, RPL_OPTION_TARGET_DESCRIPTOR, RPL_OPTION_TARGET_DESCRIPTOR_LENGTH);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	RPL_write_uint32(p, descriptor);
+
+	return RPL_builder_option_end(builder, RPL_OPTION_TARGET_DESCRIPTOR_LENGTH);
+}
+
+//Moves the octets written since the last block into the output segments
+static int RPL_builder_close_segment(struct rpl_builder_s *builder) {
+	if (builder->used == builder->segment_start) {
+		return 0;
+	}
+	if (builder->iov_count >= builder->iov_capacity) {
+		return RPL_builder_fail(builder);
+	}
+
+	builder->iov[builder->iov_count].base = builder->buffer + builder->segment_start;
+	builder->iov[builder->iov_count].length = builder->used - builder->segment_start;
+	builder->iov_count++;
+	builder->segment_start = builder->used;
+
+	return 0;
+}
+
+int RPL_builder_block(struct rpl_builder_s *builder, const uint8_t *options, uint16_t length) {
+	if ((builder->allowed == 0) || (RPL_builder_pad(builder, RPL_BUILDER_BLOCK_ALIGNMENT, 0) < 0)) {
+		return RPL_builder_fail(builder);
+	}
+	if (builder->iov == NULL) {
+		return RPL_builder_raw(builder, options, length);
+	}
+	if ((RPL_builder_close_segment(builder) < 0) || (builder->iov_count >= builder->iov_capacity)
+	        || ((uint32_t)builder->length + length > 0xFFFF)) {
+		return RPL_builder_fail(builder);
+	}
+
+	builder->iov[builder->iov_count].base = options;
+	builder->iov[builder->iov_count].length = length;
+	builder->iov_count++;
+	builder->sum = RPL_checksum_combine(builder->sum, RPL_checksum_partial(0, options, length), builder->length);
+	builder->length += length;
+
+	return 0;
+}
+
+int RPL_builder_raw(struct rpl_builder_s *builder, const uint8_t *data, uint16_t length) {
+	uint8_t *p = RPL_builder_reserve(builder, length);
+
+	if (p == NULL) {
+		return -1;
+	}
+
+	memcpy(p, data, length);
+	RPL_builder_commit(builder, length);
+
+	return 0;
+}
+
+int RPL_builder_finish(struct rpl_builder_s *builder, const uint8_t source[16], const uint8_t destination[16]) {
+	uint32_t sum;
+	uint16_t checksum;
+
+	if (builder->error || (builder->length == 0)) {
+		return RPL_builder_fail(builder);
+	}
+	if ((builder->iov != NULL) && (RPL_builder_close_segment(builder) < 0)) {
+		return -1;
+	}
+
+	if (!builder->block) {
+		sum = builder->sum + RPL_checksum_pseudo_header(source, destination, builder->length);
+		checksum = RPL_checksum_finish(sum);
+		RPL_write_uint16(builder->buffer + 2, checksum);
+	}
+
+	return builder->length;
+}
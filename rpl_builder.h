@@ -0,0 +1,115 @@
+/**
+ * RPL message builder
+ * Encodes control messages and their options directly into a caller supplied buffer [RFC6550 Section 6]
+ *
+ * The builder never allocates. The checksum is accumulated as each field is written and the
+ * options are aligned with Pad1/PadN as they are added. When an iovec array is supplied,
+ * pre-encoded option blocks (eg. a child's cached Target/Transit options) are referenced by the
+ * output rather than copied into the buffer.
+ *
+ * Usage:
+ *   RPL_builder_init(&b, buffer, sizeof(buffer), NULL, 0);
+ *   RPL_builder_dio(&b, &dio, dodag_id, NULL);
+ *   RPL_builder_dodag_config(&b, &config);
+ *   length = RPL_builder_finish(&b, source, destination);
+ *
+ * Errors are sticky, once a call has failed all further calls (and finish) fail.
+ * Secured messages must be finished after the MAC has been appended.
+ */
+
+#ifndef RPL_BUILDER_H
+#define RPL_BUILDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rpl_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Scatter-gather output segment
+ */
+struct rpl_iovec_s {
+    const uint8_t *base;            //!< Segment data
+    uint16_t length;                //!< Segment length
+};
+
+/**
+ * @brief Message builder state
+ */
+struct rpl_builder_s {
+    uint8_t *buffer;                //!< Storage for the header, base and options written by the builder
+    uint16_t capacity;              //!< Size of buffer
+    uint16_t used;                  //!< Octets of buffer used
+    uint16_t length;                //!< Total message length, including referenced blocks
+    uint16_t segment_start;         //!< Start in buffer of the segment not yet added to iov
+    struct rpl_iovec_s *iov;        //!< Output segments, NULL to build a contiguous message in buffer
+    uint8_t iov_capacity;           //!< Size of iov
+    uint8_t iov_count;              //!< Segments in iov
+    uint8_t code;                   //!< ICMPv6 code of the message being built
+    int8_t error;                   //!< Set once any call has failed
+    uint8_t block;                  //!< Building a pre-encoded option block rather than a message
+    uint32_t allowed;               //!< Option types permitted in the message (see RPL_option_allowed)
+    uint32_t sum;                   //!< Running checksum of the message
+};
+
+void RPL_builder_init(struct rpl_builder_s *builder, uint8_t *buffer, uint16_t capacity, struct rpl_iovec_s *iov, uint8_t iov_capacity);
+
+/**
+ * @brief Start a pre-encoded option block for later use with RPL_builder_block
+ * @details Options permitted in message_code may be added, finish returns the block length.
+ */
+int RPL_builder_block_begin(struct rpl_builder_s *builder, uint8_t message_code);
+
+/**
+ * Start a message, writing the ICMPv6 header, the security section (when security is not NULL)
+ * and the message base. Only one message may be built per init. Secured messages fail to build
+ * when RPL_CONF_SECURITY is 0.
+ */
+int RPL_builder_dio(struct rpl_builder_s *builder, const struct rpl_dio_s *dio, const uint8_t dodag_id[16], const struct rpl_security_s *security);
+int RPL_builder_dao(struct rpl_builder_s *builder, const struct rpl_dao_s *dao, const struct rpl_security_s *security);
+int RPL_builder_dao_ack(struct rpl_builder_s *builder, const struct rpl_dao_ack_s *dao_ack, const struct rpl_security_s *security);
+int RPL_builder_dis(struct rpl_builder_s *builder, const struct rpl_dis_s *dis, const struct rpl_security_s *security);
+int RPL_builder_cc(struct rpl_builder_s *builder, const struct rpl_cc_s *cc, const struct rpl_security_s *security);
+
+/**
+ * Options, aligned with padding as required by the option type
+ */
+int RPL_builder_option(struct rpl_builder_s *builder, uint8_t type, const uint8_t *data, uint8_t length);
+int RPL_builder_dag_metric(struct rpl_builder_s *builder, const uint8_t *metric_data, uint8_t length);
+int RPL_builder_route_info(struct rpl_builder_s *builder, const struct rpl_option_route_info_s *route_info, const uint8_t *prefix);
+int RPL_builder_dodag_config(struct rpl_builder_s *builder, const struct rpl_option_dodag_configuration_s *config);
+int RPL_builder_target(struct rpl_builder_s *builder, uint8_t prefix_length, const uint8_t *prefix);
+int RPL_builder_transit_info(struct rpl_builder_s *builder, const struct rpl_option_transit_info_s *transit_info, const uint8_t *parent_address);
+int RPL_builder_solicited_info(struct rpl_builder_s *builder, const struct rpl_option_solicited_info_s *solicited_info);
+int RPL_builder_prefix_info(struct rpl_builder_s *builder, const struct rpl_option_prefix_info_s *prefix_info, const uint8_t prefix[16]);
+int RPL_builder_target_descriptor(struct rpl_builder_s *builder, uint32_t descriptor);
+
+/**
+ * @brief Add a block of pre-encoded options
+ * @details The block is referenced from the iovec output without copying (copied into the buffer
+ * when building a contiguous message). It must stay valid until the message has been sent.
+ */
+int RPL_builder_block(struct rpl_builder_s *builder, const uint8_t *options, uint16_t length);
+
+/**
+ * @brief Append raw octets (eg. a MAC) without option alignment or validation
+ */
+int RPL_builder_raw(struct rpl_builder_s *builder, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Complete the message, filling in the ICMPv6 checksum
+ * @details The output is builder->buffer (contiguous) or builder->iov[0..iov_count)
+ *
+ * @return message length, or -1 on error
+ */
+int RPL_builder_finish(struct rpl_builder_s *builder, const uint8_t source[16], const uint8_t destination[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
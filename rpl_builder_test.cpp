@@ -0,0 +1,219 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+static const uint8_t destination[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+static const uint8_t dodag_id[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+//Checksum over pseudo header and message folds to 0xFFFF when valid
+static int checksum_valid(const uint8_t *message, uint16_t length) {
+	uint32_t sum = RPL_checksum_pseudo_header(source, destination, length);
+
+	sum = RPL_checksum_partial(sum, message, length);
+	return RPL_checksum_fold(sum) == 0xFFFF;
+}
+
+TEST_GROUP(builder_tests)
+{
+	struct rpl_builder_s builder;
+	uint8_t buffer[256];
+
+	void setup() {
+		memset(buffer, 0xAA, sizeof(buffer));
+	}
+
+	void teardown() {
+
+	}
+};
+
+TEST(builder_tests, dio_build_test) {
+	struct rpl_dio_s dio = {};
+	struct rpl_option_dodag_configuration_s config = {};
+	struct rpl_option_prefix_info_s prefix_info = {};
+	struct rpl_message_view_s message;
+	struct rpl_dio_view_s dio_view;
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option;
+	int length;
+
+	dio.rpl_instance_id = 1;
+	dio.rpl_version = 240;
+	dio.rank = 256;
+	dio.mode = RPL_DIO_MODE_GROUNDED_FLAG | (RPL_DIO_MODE_MOP2 << RPL_DIO_MODE_MODE_OF_OPERATION_SHIFT);
+	dio.dtsn = 241;
+	config.dio_int_double = 20;
+	config.dio_int_min = 3;
+	config.dio_redun = 10;
+	config.min_hop_rank_increase = 256;
+	config.lifetime_unit = 60;
+	prefix_info.prefix_length = 64;
+	prefix_info.flags = RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID;
+	prefix_info.valid_lifetime = 0xFFFFFFFF;
+
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	CHECK_EQUAL(0, RPL_builder_dio(&builder, &dio, dodag_id, NULL));
+	CHECK_EQUAL(0, RPL_builder_dodag_config(&builder, &config));
+	CHECK_EQUAL(0, RPL_builder_prefix_info(&builder, &prefix_info, dodag_id));
+	length = RPL_builder_finish(&builder, source, destination);
+
+	//Header, base, config at 28 needs no padding, PIO padded from 44 to 48
+	CHECK_EQUAL(RPL_ICMPV6_HEADER_LENGTH + RPL_DIO_BASE_LENGTH + 16 + 4 + 32, length);
+	CHECK_EQUAL(RPL_OPTION_PADN, buffer[44]);
+	CHECK_EQUAL(2, buffer[45]);
+	CHECK_EQUAL(RPL_OPTION_PREFIX_INFO, buffer[48]);
+	CHECK(checksum_valid(buffer, (uint16_t)length));
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+	CHECK_EQUAL(0, RPL_dio_view_init(&dio_view, &message));
+	CHECK_EQUAL(256, RPL_dio_view_rank(&dio_view));
+	CHECK_EQUAL(241, RPL_dio_view_dtsn(&dio_view));
+	MEMCMP_EQUAL(dodag_id, RPL_dio_view_dodag_id(&dio_view), 16);
+
+	RPL_option_iter_init(&iter, RPL_DODAG_INFORMATION_OBJECT, RPL_dio_view_options(&dio_view), RPL_dio_view_options_length(&dio_view));
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(60, RPL_option_dodag_config_lifetime_unit(&option));
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(0xFFFFFFFF, RPL_option_prefix_info_valid_lifetime(&option));
+	CHECK_EQUAL(0, RPL_option_iter_next(&iter, &option));
+}
+
+//Pre-encoded Target/Transit blocks are referenced, not copied, and checksum the same as a copy
+TEST(builder_tests, dao_scatter_gather_test) {
+	struct rpl_dao_s dao = {};
+	struct rpl_option_transit_info_s transit_info = {};
+	struct rpl_builder_s block_builder;
+	struct rpl_iovec_s iov[4];
+	uint8_t block[64];
+	uint8_t contiguous[256];
+	uint8_t gathered[256];
+	int block_length, length, contiguous_length, i;
+	uint16_t offset = 0;
+
+	dao.rpl_instance = 1;
+	dao.flags = RPL_DAO_FLAG_K_MASK;
+	dao.dao_sequence = 17;
+	transit_info.path_sequence = 240;
+	transit_info.path_lifetime = 30;
+
+	RPL_builder_init(&block_builder, block, sizeof(block), NULL, 0);
+	CHECK_EQUAL(0, RPL_builder_block_begin(&block_builder, RPL_DESTINATION_ADVERTISEMENt_OBJECT));
+	CHECK_EQUAL(0, RPL_builder_target(&block_builder, 128, dodag_id));
+	CHECK_EQUAL(0, RPL_builder_transit_info(&block_builder, &transit_info, NULL));
+	block_length = RPL_builder_finish(&block_builder, NULL, NULL);
+	CHECK(block_length > 0);
+	CHECK_EQUAL(2, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, block, (uint16_t)block_length));
+
+	RPL_builder_init(&builder, buffer, sizeof(buffer), iov, 4);
+	CHECK_EQUAL(0, RPL_builder_dao(&builder, &dao, NULL));
+	CHECK_EQUAL(0, RPL_builder_block(&builder, block, (uint16_t)block_length));
+	CHECK_EQUAL(0, RPL_builder_target_descriptor(&builder, 7));
+	length = RPL_builder_finish(&builder, source, destination);
+
+	CHECK_EQUAL(3, builder.iov_count);
+	POINTERS_EQUAL(block, iov[1].base);
+	for (i = 0; i < builder.iov_count; i++) {
+		memcpy(gathered + offset, iov[i].base, iov[i].length);
+		offset += iov[i].length;
+	}
+	CHECK_EQUAL(length, offset);
+	CHECK(checksum_valid(gathered, offset));
+	CHECK_EQUAL(3, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, gathered + 8, (uint16_t)(offset - 8)));
+
+	RPL_builder_init(&builder, contiguous, sizeof(contiguous), NULL, 0);
+	CHECK_EQUAL(0, RPL_builder_dao(&builder, &dao, NULL));
+	CHECK_EQUAL(0, RPL_builder_block(&builder, block, (uint16_t)block_length));
+	CHECK_EQUAL(0, RPL_builder_target_descriptor(&builder, 7));
+	contiguous_length = RPL_builder_finish(&builder, source, destination);
+	CHECK_EQUAL(length, contiguous_length);
+	MEMCMP_EQUAL(contiguous, gathered, length);
+}
+
+TEST(builder_tests, dao_ack_build_test) {
+	struct rpl_dao_ack_s dao_ack = {};
+	struct rpl_message_view_s message;
+	struct rpl_dao_ack_view_s view;
+	int length;
+
+	dao_ack.rpl_instance = 0x80;
+	dao_ack.flags = RPL_DAO_ACK_FLAG_D_MASK;
+	dao_ack.dao_sequence = 5;
+	memcpy(dao_ack.dodag_id, dodag_id, 16);
+
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	CHECK_EQUAL(0, RPL_builder_dao_ack(&builder, &dao_ack, NULL));
+	length = RPL_builder_finish(&builder, source, destination);
+	CHECK_EQUAL(RPL_ICMPV6_HEADER_LENGTH + RPL_DAO_ACK_BASE_LENGTH + 16, length);
+	CHECK(checksum_valid(buffer, (uint16_t)length));
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+	CHECK_EQUAL(0, RPL_dao_ack_view_init(&view, &message));
+	CHECK_EQUAL(5, RPL_dao_ack_view_sequence(&view));
+	MEMCMP_EQUAL(dodag_id, RPL_dao_ack_view_dodag_id(&view), 16);
+}
+
+TEST(builder_tests, cc_build_test) {
+	struct rpl_cc_s cc = {};
+	struct rpl_security_s security = {};
+#if RPL_CONF_SECURITY
+	struct rpl_message_view_s message;
+	struct rpl_cc_view_s view;
+	uint8_t mac[4] = { 0 };
+	int length;
+#endif
+
+	cc.cc_nonce = 0x1234;
+	cc.destination_counter = 99;
+	security.kim_and_lvl = (RPL_SEC_KIM_MODE0 << RPL_SEC_KIM_SHIFT);
+	security.key_identifier_mode0.key_index = 3;
+
+	//CC must be secured
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	CHECK_EQUAL(-1, RPL_builder_cc(&builder, &cc, NULL));
+	CHECK_EQUAL(-1, RPL_builder_finish(&builder, source, destination));
+
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+#if !RPL_CONF_SECURITY
+	//and cannot be built without security
+	CHECK_EQUAL(-1, RPL_builder_cc(&builder, &cc, &security));
+#else
+	CHECK_EQUAL(0, RPL_builder_cc(&builder, &cc, &security));
+	CHECK_EQUAL(0, RPL_builder_raw(&builder, mac, sizeof(mac)));
+	length = RPL_builder_finish(&builder, source, destination);
+	CHECK(checksum_valid(buffer, (uint16_t)length));
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+	CHECK_EQUAL(3, RPL_message_view_security(&message)[RPL_SECURITY_BASE_LENGTH]);
+	CHECK_EQUAL(0, RPL_cc_view_init(&view, &message));
+	CHECK_EQUAL(0x1234, RPL_cc_view_nonce(&view));
+	CHECK_EQUAL(99, RPL_cc_view_destination_counter(&view));
+#endif
+}
+
+TEST(builder_tests, builder_error_test) {
+	struct rpl_dis_s dis = {};
+	struct rpl_option_dodag_configuration_s config = {};
+	uint8_t small[8];
+
+	//Option not permitted in a DIS
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	CHECK_EQUAL(0, RPL_builder_dis(&builder, &dis, NULL));
+	CHECK_EQUAL(-1, RPL_builder_dodag_config(&builder, &config));
+	CHECK_EQUAL(-1, RPL_builder_finish(&builder, source, destination));
+
+	//Out of space, and the error is sticky
+	RPL_builder_init(&builder, small, sizeof(small), NULL, 0);
+	CHECK_EQUAL(0, RPL_builder_dis(&builder, &dis, NULL));
+	CHECK_EQUAL(-1, RPL_builder_raw(&builder, small, 3));
+	CHECK_EQUAL(-1, RPL_builder_raw(&builder, small, 1));
+	CHECK_EQUAL(-1, RPL_builder_finish(&builder, source, destination));
+
+	//Options before a message
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	CHECK_EQUAL(-1, RPL_builder_target_descriptor(&builder, 1));
+}
@@ -0,0 +1,123 @@
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "rpl.h"
+
+//ICMPv6 checksum, RFC4443 section 2.3
+
+//The one's complement sum is independent of byte order [RFC1071 Section 2(B)], so words are summed
+//in host order several at a time and the result swapped into network order once at the end
+
+static inline uint16_t RPL_checksum_fold64(uint64_t acc) {
+	acc = (acc & 0xFFFFFFFF) + (acc >> 32);
+	acc = (acc & 0xFFFFFFFF) + (acc >> 32);
+	return RPL_checksum_fold((uint32_t)acc);
+}
+
+static inline uint16_t RPL_checksum_to_network(uint16_t folded) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	return folded;
+#else
+	return (uint16_t)((folded << 8) | (folded >> 8));
+#endif
+}
+
+uint32_t RPL_checksum_partial(uint32_t sum, const uint8_t *data, size_t length) {
+	uint64_t acc = 0;
+	uint64_t word64;
+	uint16_t word16;
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	//16 octets per iteration into four 32 bit lanes, a lane cannot overflow for any IPv6 payload
+	if (length >= 16) {
+		__m128i zero = _mm_setzero_si128();
+		__m128i lanes = _mm_setzero_si128();
+		uint32_t partial[4];
+
+		for (; i + 16 <= length; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+			lanes = _mm_add_epi32(lanes, _mm_unpacklo_epi16(v, zero));
+			lanes = _mm_add_epi32(lanes, _mm_unpackhi_epi16(v, zero));
+		}
+		_mm_storeu_si128((__m128i *)partial, lanes);
+		acc = (uint64_t)partial[0] + partial[1] + partial[2] + partial[3];
+	}
+#endif
+
+	for (; i + 8 <= length; i += 8) {
+		memcpy(&word64, data + i, sizeof(word64));
+		acc += (word64 & 0xFFFFFFFF) + (word64 >> 32);
+	}
+	for (; i + 2 <= length; i += 2) {
+		memcpy(&word16, data + i, sizeof(word16));
+		acc += word16;
+	}
+
+	sum = (sum & 0xFFFF) + (sum >> 16) + RPL_checksum_to_network(RPL_checksum_fold64(acc));
+	if (length & 1) {
+		sum += (uint32_t)data[length - 1] << 8;
+	}
+
+	return sum;
+}
+
+uint32_t RPL_checksum_pseudo_header(const uint8_t source[16], const uint8_t destination[16], uint32_t length) {
+	uint32_t sum = 0;
+
+	sum = RPL_checksum_partial(sum, source, 16);
+	sum = RPL_checksum_partial(sum, destination, 16);
+	sum += length >> 16;
+	sum += length & 0xFFFF;
+	sum += RPL_ICMPV6_NEXT_HEADER;
+
+	return sum;
+}
+
+//RFC1624 equation 3: HC' = ~(~HC + ~m + m')
+uint16_t RPL_checksum_update(uint16_t checksum, const uint8_t *old_data, const uint8_t *new_data, size_t length, size_t offset) {
+	uint32_t sum = (uint16_t)~checksum;
+	uint16_t old_sum = RPL_checksum_fold(RPL_checksum_combine(0, RPL_checksum_partial(0, old_data, length), offset));
+	uint16_t new_sum = RPL_checksum_fold(RPL_checksum_combine(0, RPL_checksum_partial(0, new_data, length), offset));
+
+	sum += (uint16_t)~old_sum;
+	sum += new_sum;
+
+	return RPL_checksum_finish(sum);
+}
+
+void RPL_checksum_patch(uint8_t *message, size_t offset, const uint8_t *data, size_t length) {
+	uint16_t checksum = RPL_read_uint16(message + 2);
+
+	checksum = RPL_checksum_update(checksum, message + offset, data, length, offset);
+	memmove(message + offset, data, length);
+	RPL_write_uint16(message + 2, checksum);
+}
+
+int RPL_checksum_verify(const uint8_t *message, uint16_t length, const uint8_t source[16], const uint8_t destination[16]) {
+	uint32_t sum = RPL_checksum_pseudo_header(source, destination, length);
+
+	sum = RPL_checksum_partial(sum, message, length);
+
+	return RPL_checksum_fold(sum) == 0xFFFF;
+}
+
+unsigned int RPL_checksum_verify_many(const struct rpl_checksum_packet_s *packets, uint8_t *valid, unsigned int count) {
+	unsigned int i;
+	unsigned int total = 0;
+
+	for (i = 0; i < count; i++) {
+#if defined(__GNUC__)
+		if (i + 1 < count) {
+			__builtin_prefetch(packets[i + 1].message);
+		}
+#endif
+		valid[i] = (uint8_t)RPL_checksum_verify(packets[i].message, packets[i].length, packets[i].source, packets[i].destination);
+		total += valid[i];
+	}
+
+	return total;
+}
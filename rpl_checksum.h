@@ -0,0 +1,84 @@
+/**
+ * ICMPv6 checksum
+ * One's complement sum over the IPv6 pseudo header and the ICMPv6 message [RFC4443 Section 2.3]
+ *
+ * Partial sums are kept unfolded in 32 bits so that they can be accumulated across buffers,
+ * a partial sum of data starting at an odd offset in the message must be combined with
+ * RPL_checksum_combine so the octets are swapped into place [RFC1071 Section 2].
+ *
+ * Summing uses SSE2 when available and 64 bit words otherwise. Changes to a few fields of an
+ * already checksummed message (eg. rank or DTSN of a cached DIO) are applied incrementally
+ * [RFC1624] rather than by summing the whole message again.
+ */
+
+#ifndef RPL_CHECKSUM_H
+#define RPL_CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_ICMPV6_NEXT_HEADER      58      //!< IPv6 Next Header value for ICMPv6
+
+/**
+ * @brief Received packet for batch verification
+ */
+struct rpl_checksum_packet_s {
+    const uint8_t *message;         //!< ICMPv6 message
+    const uint8_t *source;          //!< IPv6 source address
+    const uint8_t *destination;     //!< IPv6 destination address
+    uint16_t length;                //!< ICMPv6 message length
+};
+
+uint32_t RPL_checksum_partial(uint32_t sum, const uint8_t *data, size_t length);
+uint32_t RPL_checksum_pseudo_header(const uint8_t source[16], const uint8_t destination[16], uint32_t length);
+
+/**
+ * @brief Incremental checksum update [RFC1624 Section 3]
+ * @details Returns the checksum field value after length octets at offset in the message change
+ * from old_data to new_data.
+ */
+uint16_t RPL_checksum_update(uint16_t checksum, const uint8_t *old_data, const uint8_t *new_data, size_t length, size_t offset);
+
+/**
+ * @brief Overwrite octets of a checksummed message, updating its checksum field incrementally
+ */
+void RPL_checksum_patch(uint8_t *message, size_t offset, const uint8_t *data, size_t length);
+
+/**
+ * @brief Verify received messages
+ * @return 1 (or the number of valid packets, with valid[i] set per packet) when the checksum is correct
+ */
+int RPL_checksum_verify(const uint8_t *message, uint16_t length, const uint8_t source[16], const uint8_t destination[16]);
+unsigned int RPL_checksum_verify_many(const struct rpl_checksum_packet_s *packets, uint8_t *valid, unsigned int count);
+
+//Fold a 32 bit partial sum into 16 bits (not complemented)
+static inline uint16_t RPL_checksum_fold(uint32_t sum) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return (uint16_t)sum;
+}
+
+//Add the partial sum of a block that starts at the given offset of the message
+static inline uint32_t RPL_checksum_combine(uint32_t sum, uint32_t partial, size_t offset) {
+    uint16_t folded = RPL_checksum_fold(partial);
+
+    if (offset & 1) {
+        folded = (uint16_t)((folded << 8) | (folded >> 8));
+    }
+    return sum + folded;
+}
+
+//Final checksum field value from a partial sum
+static inline uint16_t RPL_checksum_finish(uint32_t sum) {
+    return (uint16_t)~RPL_checksum_fold(sum);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+static const uint8_t destination[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+
+//Octet at a time sum as described in RFC1071
+static uint16_t checksum_reference(const uint8_t *data, size_t length) {
+	uint32_t sum = 0;
+	size_t i;
+
+	for (i = 0; i < length; i++) {
+		sum += (i & 1) ? data[i] : (uint32_t)data[i] << 8;
+	}
+	while (sum >> 16) {
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+	return (uint16_t)sum;
+}
+
+TEST_GROUP(checksum_tests)
+{
+	uint8_t buffer[300];
+
+	void setup() {
+		int i;
+
+		srand(4443);
+		for (i = 0; i < (int)sizeof(buffer); i++) {
+			buffer[i] = (uint8_t)rand();
+		}
+	}
+
+	void teardown() {
+
+	}
+};
+
+//Every length and alignment, covering the vector, 64 bit and odd octet paths
+TEST(checksum_tests, checksum_partial_test) {
+	size_t start, length;
+
+	for (start = 0; start < 8; start++) {
+		for (length = 0; length < sizeof(buffer) - 8; length++) {
+			CHECK_EQUAL(checksum_reference(buffer + start, length), RPL_checksum_fold(RPL_checksum_partial(0, buffer + start, length)));
+		}
+	}
+}
+
+//Blocks summed separately and combined at their offsets match a single sum
+TEST(checksum_tests, checksum_combine_test) {
+	uint32_t sum = 0;
+
+	sum = RPL_checksum_combine(sum, RPL_checksum_partial(0, buffer, 33), 0);
+	sum = RPL_checksum_combine(sum, RPL_checksum_partial(0, buffer + 33, 100), 33);
+	sum = RPL_checksum_combine(sum, RPL_checksum_partial(0, buffer + 133, 7), 133);
+
+	CHECK_EQUAL(checksum_reference(buffer, 140), RPL_checksum_fold(sum));
+}
+
+TEST(checksum_tests, checksum_verify_test) {
+	uint16_t length = 64;
+	uint32_t sum;
+
+	buffer[2] = 0;
+	buffer[3] = 0;
+	sum = RPL_checksum_pseudo_header(source, destination, length);
+	sum = RPL_checksum_partial(sum, buffer, length);
+	RPL_write_uint16(buffer + 2, RPL_checksum_finish(sum));
+
+	CHECK_EQUAL(1, RPL_checksum_verify(buffer, length, source, destination));
+	buffer[10] ^= 0x01;
+	CHECK_EQUAL(0, RPL_checksum_verify(buffer, length, source, destination));
+	CHECK_EQUAL(0, RPL_checksum_verify(buffer, length, source, source));
+}
+
+//RFC1624 update of a cached DIO rank and DTSN matches a full recompute
+TEST(checksum_tests, checksum_incremental_test) {
+	uint8_t message[64];
+	uint8_t rank[2] = { 0x02, 0x00 };
+	uint8_t dtsn = 242;
+	uint32_t sum;
+
+	memcpy(message, buffer, sizeof(message));
+	message[2] = 0;
+	message[3] = 0;
+	sum = RPL_checksum_pseudo_header(source, destination, sizeof(message));
+	sum = RPL_checksum_partial(sum, message, sizeof(message));
+	RPL_write_uint16(message + 2, RPL_checksum_finish(sum));
+
+	RPL_checksum_patch(message, RPL_ICMPV6_HEADER_LENGTH + 2, rank, sizeof(rank));
+	CHECK_EQUAL(1, RPL_checksum_verify(message, sizeof(message), source, destination));
+	RPL_checksum_patch(message, RPL_ICMPV6_HEADER_LENGTH + 5, &dtsn, 1);
+	CHECK_EQUAL(1, RPL_checksum_verify(message, sizeof(message), source, destination));
+	CHECK_EQUAL(0x0200, RPL_read_uint16(message + RPL_ICMPV6_HEADER_LENGTH + 2));
+	CHECK_EQUAL(242, message[RPL_ICMPV6_HEADER_LENGTH + 5]);
+}
+
+TEST(checksum_tests, checksum_verify_many_test) {
+	struct rpl_checksum_packet_s packets[8];
+	uint8_t messages[8][32];
+	uint8_t valid[8];
+	uint32_t sum;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		memcpy(messages[i], buffer + i * 32, 32);
+		messages[i][2] = 0;
+		messages[i][3] = 0;
+		sum = RPL_checksum_pseudo_header(source, destination, 32);
+		sum = RPL_checksum_partial(sum, messages[i], 32);
+		RPL_write_uint16(messages[i] + 2, RPL_checksum_finish(sum));
+
+		packets[i].message = messages[i];
+		packets[i].source = source;
+		packets[i].destination = destination;
+		packets[i].length = 32;
+	}
+	messages[5][20] ^= 0xFF;
+
+	CHECK_EQUAL(7, RPL_checksum_verify_many(packets, valid, 8));
+	CHECK_EQUAL(1, valid[4]);
+	CHECK_EQUAL(0, valid[5]);
+}
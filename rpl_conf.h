@@ -0,0 +1,39 @@
+/**
+ * RPL build configuration
+ * Modes of operation, security and type widths selected at compile time
+ *
+ * A deployment sets these on the command line or in a header of its own named by RPL_CONF_FILE
+ * (eg. -DRPL_CONF_FILE=\"leaf_conf.h\"). That header is included before any module, so it may
+ * also set the table sizes of the modules (eg. RPL_NEIGHBOR_TABLE_SIZE, RPL_DAO_QUEUE_SIZE,
+ * RPL_PREFIX_MAX) and replace the types (RPL_OVERRIDE_TYPES).
+ *
+ * A feature set to 0 is compiled out: its modules build to nothing, its state is left out of the
+ * structures of the remaining modules and messages needing it are rejected. For example a leaf
+ * of a non-storing DODAG without link layer keys builds with RPL_CONF_STORING 0 and
+ * RPL_CONF_SECURITY 0, a root of a large storing DODAG with RPL_CONF_ADDRESS_HANDLE_BITS 32.
+ */
+
+#ifndef RPL_CONF_H
+#define RPL_CONF_H
+
+#ifdef RPL_CONF_FILE
+#include RPL_CONF_FILE
+#endif
+
+#ifndef RPL_CONF_STORING
+#define RPL_CONF_STORING                1       //!< Storing mode: routing table (rpl_route), queueing of the targets of children (RPL_dao_pipeline_add_options)
+#endif
+
+#ifndef RPL_CONF_NON_STORING
+#define RPL_CONF_NON_STORING            1       //!< Non-storing mode: Parent Address in DAOs, source routes at the root (rpl_source_route, rpl_sim)
+#endif
+
+#ifndef RPL_CONF_SECURITY
+#define RPL_CONF_SECURITY               1       //!< Secured control messages (rpl_security, rpl_replay)
+#endif
+
+#ifndef RPL_CONF_ADDRESS_HANDLE_BITS
+#define RPL_CONF_ADDRESS_HANDLE_BITS    16      //!< Width of rpl_address_handle_t, 32 for tables of more than 65534 addresses
+#endif
+
+#endif
@@ -0,0 +1,337 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+static void RPL_dao_pipeline_window_expired(struct rpl_timer_s *timer, void *context);
+static void RPL_dao_pipeline_ack_timeout(struct rpl_timer_s *timer, void *context);
+
+void RPL_dao_pipeline_init(struct rpl_dao_pipeline_s *pipeline, struct rpl_timer_wheel_s *wheel, uint8_t *buffer, uint16_t mtu, rpl_instance_t instance,
+                           const uint8_t *dodag_id, rpl_dao_send_t send, rpl_dao_event_t event, void *context) {
+	unsigned int i;
+
+	memset(pipeline, 0, sizeof(*pipeline));
+	pipeline->wheel = wheel;
+	pipeline->buffer = buffer;
+	pipeline->mtu = mtu;
+	pipeline->instance = instance;
+	if (dodag_id != NULL) {
+		memcpy(pipeline->dodag_id, dodag_id, 16);
+		pipeline->use_dodag_id = 1;
+	}
+	pipeline->sequence = (uint8_t)RPL_sequence_init();
+	pipeline->ack_requested = 1;
+	pipeline->max_retransmissions = DEFAULT_DAO_MAX_RETRANSMISSIONS;
+	pipeline->window = DEFAULT_DAO_AGGREGATION_WINDOW;
+	pipeline->ack_timeout = DEFAULT_DAO_ACK_TIMEOUT;
+	pipeline->send = send;
+	pipeline->event = event;
+	pipeline->context = context;
+	//Free targets are never encoded, their prefix holds the free list
+	RPL_pool_init(&pipeline->target_pool, pipeline->targets, sizeof(struct rpl_dao_target_s), offsetof(struct rpl_dao_target_s, prefix),
+	              RPL_DAO_QUEUE_SIZE);
+	RPL_timer_init(&pipeline->window_timer, RPL_dao_pipeline_window_expired, pipeline);
+	for (i = 0; i < RPL_DAO_INFLIGHT_SIZE; i++) {
+		RPL_timer_init(&pipeline->inflight[i].timer, RPL_dao_pipeline_ack_timeout, &pipeline->inflight[i]);
+		pipeline->inflight[i].pipeline = pipeline;
+	}
+}
+
+//Move the targets of a DAO to state, and release its slot (RPL_DAO_INFLIGHT_SIZE when no DAO-ACK was requested)
+static void RPL_dao_pipeline_release(struct rpl_dao_pipeline_s *pipeline, unsigned int slot, uint8_t state) {
+	unsigned int i;
+
+	for (i = 0; i < pipeline->target_pool.used; i++) {
+		if ((pipeline->targets[i].state == RPL_DAO_TARGET_INFLIGHT) && (pipeline->targets[i].slot == slot)) {
+			pipeline->targets[i].state = state;
+			if (state == RPL_DAO_TARGET_FREE) {
+				RPL_pool_free(&pipeline->target_pool, i);
+			}
+		}
+	}
+	if (slot < RPL_DAO_INFLIGHT_SIZE) {
+		RPL_timer_stop(pipeline->wheel, &pipeline->inflight[slot].timer);
+		pipeline->inflight[slot].active = 0;
+	}
+}
+
+static void RPL_dao_pipeline_schedule(struct rpl_dao_pipeline_s *pipeline) {
+	if (!RPL_timer_running(&pipeline->window_timer)) {
+		RPL_timer_start(pipeline->wheel, &pipeline->window_timer, pipeline->wheel->now + pipeline->window);
+	}
+}
+
+void RPL_dao_pipeline_set_destination(struct rpl_dao_pipeline_s *pipeline, const uint8_t source[16], const uint8_t destination[16]) {
+	unsigned int i;
+
+	memcpy(pipeline->source, source, 16);
+	memcpy(pipeline->destination, destination, 16);
+	pipeline->has_destination = 1;
+	for (i = 0; i < RPL_DAO_INFLIGHT_SIZE; i++) {
+		if (pipeline->inflight[i].active) {
+			RPL_dao_pipeline_release(pipeline, i, RPL_DAO_TARGET_QUEUED);
+		}
+	}
+	if (RPL_dao_pipeline_count(pipeline, RPL_DAO_TARGET_QUEUED) > 0) {
+		RPL_dao_pipeline_schedule(pipeline);
+	}
+}
+
+int RPL_dao_pipeline_add(struct rpl_dao_pipeline_s *pipeline, const uint8_t *prefix, uint8_t prefix_length, const struct rpl_option_transit_info_s *transit,
+                         const uint8_t *parent_address) {
+	struct rpl_dao_target_s *target = NULL;
+	unsigned int i;
+
+	if (prefix_length > 128) {
+		return -1;
+	}
+#if !RPL_CONF_NON_STORING
+	if (parent_address != NULL) {
+		return -1;
+	}
+#endif
+	//An update of a queued or in-flight target replaces it, the newer Path Sequence supersedes the DAO in flight
+	for (i = 0; i < pipeline->target_pool.used; i++) {
+		struct rpl_dao_target_s *entry = &pipeline->targets[i];
+
+		if ((entry->state != RPL_DAO_TARGET_FREE) && (entry->prefix_length == prefix_length) && (memcmp(entry->prefix, prefix, (prefix_length + 7) / 8) == 0)) {
+			target = entry;
+			break;
+		}
+	}
+	if (target == NULL) {
+		uint32_t index = RPL_pool_alloc(&pipeline->target_pool);
+
+		if (index == RPL_POOL_NONE) {
+			return -1;
+		}
+		target = &pipeline->targets[index];
+	}
+	memset(target->prefix, 0, 16);
+	memcpy(target->prefix, prefix, (prefix_length + 7) / 8);
+	target->prefix_length = prefix_length;
+	target->flags = transit->flags;
+	target->path_control = transit->path_control;
+	target->path_sequence = transit->path_sequence;
+	target->path_lifetime = transit->path_lifetime;
+#if RPL_CONF_NON_STORING
+	target->has_parent_address = (parent_address != NULL);
+	if (parent_address != NULL) {
+		memcpy(target->parent_address, parent_address, 16);
+	}
+#endif
+	target->state = RPL_DAO_TARGET_QUEUED;
+	RPL_dao_pipeline_schedule(pipeline);
+	return 0;
+}
+
+#if RPL_CONF_STORING
+int RPL_dao_pipeline_add_options(struct rpl_dao_pipeline_s *pipeline, const struct rpl_option_view_s *target, const struct rpl_option_view_s *transit) {
+	struct rpl_option_transit_info_s transit_info;
+
+	transit_info.flags = transit->data[0];
+	transit_info.path_control = RPL_option_transit_info_path_control(transit);
+	transit_info.path_sequence = RPL_option_transit_info_path_sequence(transit);
+	transit_info.path_lifetime = RPL_option_transit_info_path_lifetime(transit);
+	return RPL_dao_pipeline_add(pipeline, RPL_option_target_prefix(target), RPL_option_target_prefix_length(target), &transit_info,
+	                            RPL_option_transit_info_parent_address(transit));
+}
+#endif
+
+/**
+ * Encode a DAO into the pipeline buffer. With select set the queued targets that fit are moved to
+ * the slot, otherwise the targets already in the slot are encoded (retransmission). A queued target
+ * that does not fit even alone is dropped and counted in oversize.
+ * Returns the message length, 0 when there were no targets, -1 when the DAO does not fit the MTU.
+ */
+static int RPL_dao_pipeline_encode(struct rpl_dao_pipeline_s *pipeline, unsigned int slot, uint8_t sequence, int select) {
+	struct rpl_builder_s builder;
+	struct rpl_dao_s dao;
+	unsigned int i, count = 0;
+
+	memset(&dao, 0, sizeof(dao));
+	dao.rpl_instance = pipeline->instance;
+	dao.flags = (pipeline->ack_requested ? RPL_DAO_FLAG_K_MASK : 0) | (pipeline->use_dodag_id ? RPL_DAO_FLAG_D_MASK : 0);
+	dao.dao_sequence = sequence;
+	memcpy(dao.dodag_id, pipeline->dodag_id, 16);
+	RPL_builder_init(&builder, pipeline->buffer, pipeline->mtu, NULL, 0);
+	if (RPL_builder_dao(&builder, &dao, NULL) != 0) {
+		return -1;
+	}
+	for (i = 0; i < pipeline->target_pool.used; i++) {
+		struct rpl_dao_target_s *target = &pipeline->targets[i];
+		struct rpl_option_transit_info_s transit;
+		struct rpl_builder_s saved;
+
+		if (select ? (target->state != RPL_DAO_TARGET_QUEUED) : ((target->state != RPL_DAO_TARGET_INFLIGHT) || (target->slot != slot))) {
+			continue;
+		}
+		transit.flags = target->flags;
+		transit.path_control = target->path_control;
+		transit.path_sequence = target->path_sequence;
+		transit.path_lifetime = target->path_lifetime;
+		saved = builder;
+		RPL_builder_target(&builder, target->prefix_length, target->prefix);
+#if RPL_CONF_NON_STORING
+		RPL_builder_transit_info(&builder, &transit, target->has_parent_address ? target->parent_address : NULL);
+#else
+		RPL_builder_transit_info(&builder, &transit, NULL);
+#endif
+		if (builder.error) {
+			builder = saved;
+			if (!select) {
+				continue;
+			}
+			if (count > 0) {
+				//Does not fit, left for the next DAO
+				break;
+			}
+			//Does not fit in any DAO, dropped so that it does not hold up the targets behind it
+			target->state = RPL_DAO_TARGET_FREE;
+			RPL_pool_free(&pipeline->target_pool, i);
+			pipeline->oversize++;
+			continue;
+		}
+		if (select) {
+			target->state = RPL_DAO_TARGET_INFLIGHT;
+			target->slot = (uint8_t)slot;
+		}
+		count++;
+	}
+	if (count == 0) {
+		return 0;
+	}
+	return RPL_builder_finish(&builder, pipeline->source, pipeline->destination);
+}
+
+void RPL_dao_pipeline_flush(struct rpl_dao_pipeline_s *pipeline) {
+	RPL_timer_stop(pipeline->wheel, &pipeline->window_timer);
+	if (!pipeline->has_destination) {
+		return;
+	}
+	while (RPL_dao_pipeline_count(pipeline, RPL_DAO_TARGET_QUEUED) > 0) {
+		unsigned int slot = RPL_DAO_INFLIGHT_SIZE;
+		uint8_t sequence = (uint8_t)RPL_sequence_increment(pipeline->sequence);
+		int length;
+
+		if (pipeline->ack_requested) {
+			//Sending resumes when a DAO-ACK frees a slot
+			slot = 0;
+			while ((slot < RPL_DAO_INFLIGHT_SIZE) && pipeline->inflight[slot].active) {
+				slot++;
+			}
+			if (slot == RPL_DAO_INFLIGHT_SIZE) {
+				return;
+			}
+		}
+		length = RPL_dao_pipeline_encode(pipeline, slot, sequence, 1);
+		if (length < 0) {
+			return;
+		}
+		if (length == 0) {
+			//Every queued target was oversize, nothing sent and no DAO Sequence used
+			continue;
+		}
+		pipeline->sequence = sequence;
+		pipeline->transmissions++;
+		pipeline->send(pipeline, pipeline->buffer, (uint16_t)length, pipeline->context);
+		if (pipeline->ack_requested) {
+			struct rpl_dao_inflight_s *inflight = &pipeline->inflight[slot];
+
+			inflight->active = 1;
+			inflight->sequence = pipeline->sequence;
+			inflight->retransmissions = 0;
+			inflight->timeout = pipeline->ack_timeout;
+			RPL_timer_start(pipeline->wheel, &inflight->timer, pipeline->wheel->now + inflight->timeout);
+		} else {
+			RPL_dao_pipeline_release(pipeline, slot, RPL_DAO_TARGET_FREE);
+		}
+	}
+}
+
+static void RPL_dao_pipeline_window_expired(struct rpl_timer_s *timer, void *context) {
+	(void)timer;
+
+	RPL_dao_pipeline_flush((struct rpl_dao_pipeline_s *)context);
+}
+
+static void RPL_dao_pipeline_ack_timeout(struct rpl_timer_s *timer, void *context) {
+	struct rpl_dao_inflight_s *inflight = (struct rpl_dao_inflight_s *)context;
+	struct rpl_dao_pipeline_s *pipeline = inflight->pipeline;
+	unsigned int slot = (unsigned int)(inflight - pipeline->inflight);
+	int length;
+
+	(void)timer;
+
+	if (inflight->retransmissions >= pipeline->max_retransmissions) {
+		//Targets stay queued, the caller is expected to select another parent
+		RPL_dao_pipeline_release(pipeline, slot, RPL_DAO_TARGET_QUEUED);
+		if (pipeline->event != NULL) {
+			pipeline->event(pipeline, RPL_DAO_EVENT_TIMEOUT, 0, pipeline->context);
+		}
+		return;
+	}
+	//Same DAO Sequence, without the targets superseded since the first transmission
+	length = RPL_dao_pipeline_encode(pipeline, slot, inflight->sequence, 0);
+	if (length <= 0) {
+		inflight->active = 0;
+		return;
+	}
+	inflight->retransmissions++;
+	inflight->timeout *= 2;
+	pipeline->transmissions++;
+	pipeline->send(pipeline, pipeline->buffer, (uint16_t)length, pipeline->context);
+	RPL_timer_start(pipeline->wheel, &inflight->timer, pipeline->wheel->now + inflight->timeout);
+}
+
+int RPL_dao_pipeline_ack(struct rpl_dao_pipeline_s *pipeline, const struct rpl_dao_ack_view_s *ack) {
+	const uint8_t *dodag_id = RPL_dao_ack_view_dodag_id(ack);
+	uint8_t sequence = RPL_dao_ack_view_sequence(ack);
+	uint8_t status = RPL_dao_ack_view_status(ack);
+	unsigned int slot;
+	int event;
+
+	if (RPL_dao_ack_view_instance_id(ack) != pipeline->instance) {
+		return -1;
+	}
+	if ((dodag_id != NULL) && (!pipeline->use_dodag_id || (memcmp(dodag_id, pipeline->dodag_id, 16) != 0))) {
+		return -1;
+	}
+	for (slot = 0; slot < RPL_DAO_INFLIGHT_SIZE; slot++) {
+		if (pipeline->inflight[slot].active && (pipeline->inflight[slot].sequence == sequence)) {
+			break;
+		}
+	}
+	if (slot == RPL_DAO_INFLIGHT_SIZE) {
+		return -1;
+	}
+	if (!RPL_DAO_ACK_STATUS_ACCEPTED(status) && !RPL_DAO_ACK_STATUS_TENTATIVE(status)) {
+		//Rejected
+		RPL_dao_pipeline_release(pipeline, slot, RPL_DAO_TARGET_QUEUED);
+		event = RPL_DAO_EVENT_REJECTED;
+	} else {
+		RPL_dao_pipeline_release(pipeline, slot, RPL_DAO_TARGET_FREE);
+		event = RPL_DAO_ACK_STATUS_ACCEPTED(status) ? RPL_DAO_EVENT_ACCEPTED : RPL_DAO_EVENT_TENTATIVE;
+		//Targets held back while every slot was in use
+		if (!RPL_timer_running(&pipeline->window_timer) && (RPL_dao_pipeline_count(pipeline, RPL_DAO_TARGET_QUEUED) > 0)) {
+			RPL_dao_pipeline_flush(pipeline);
+		}
+	}
+	if (pipeline->event != NULL) {
+		pipeline->event(pipeline, event, status, pipeline->context);
+	}
+	return 0;
+}
+
+int RPL_dao_pipeline_count(const struct rpl_dao_pipeline_s *pipeline, uint8_t state) {
+	unsigned int i;
+	int count = 0;
+
+	if (state == RPL_DAO_TARGET_FREE) {
+		return (int)(RPL_DAO_QUEUE_SIZE - pipeline->target_pool.count);
+	}
+	for (i = 0; i < pipeline->target_pool.used; i++) {
+		count += (pipeline->targets[i].state == state);
+	}
+	return count;
+}
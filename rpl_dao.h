@@ -0,0 +1,190 @@
+/**
+ * RPL DAO transmission
+ * Aggregation of Target/Transit Information pairs into DAO messages and DAO-ACK handling [RFC6550 Section 9]
+ *
+ * Targets to advertise (this node's own and, in storing mode, those received from children) are
+ * queued and sent together once the aggregation window has elapsed, so a burst of DAOs from
+ * children (eg. after a DTSN increment) produces a few DAOs packed up to the MTU rather than one
+ * DAO per child. A target queued again before it has been sent is updated in place.
+ * The pipeline itself is built in every mode, as it also sends the node's own targets; only
+ * RPL_dao_pipeline_add_options, which queues the targets of a child, needs RPL_CONF_STORING.
+ *
+ * When an acknowledgement is requested each DAO is held in an in-flight slot until the DAO-ACK
+ * with its DAO Sequence arrives, and retransmitted with exponential backoff until then.
+ * One DAO-ACK acknowledges every target of the DAO. Rejection (status 128-255) and exhausted
+ * retransmissions are reported to the caller (eg. to select another parent) and the targets are
+ * kept queued for the next parent.
+ */
+
+#ifndef RPL_DAO_H
+#define RPL_DAO_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_option.h"
+#include "rpl_message.h"
+#include "rpl_timer.h"
+#include "rpl_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RPL_DAO_QUEUE_SIZE
+#define RPL_DAO_QUEUE_SIZE                  32      //!< Targets held for transmission
+#endif
+
+#ifndef RPL_DAO_INFLIGHT_SIZE
+#define RPL_DAO_INFLIGHT_SIZE               4       //!< DAOs awaiting a DAO-ACK
+#endif
+
+#ifndef DEFAULT_DAO_AGGREGATION_WINDOW
+#define DEFAULT_DAO_AGGREGATION_WINDOW      1000    //!< Time (ms) from the first queued target to transmission
+#endif
+
+#ifndef DEFAULT_DAO_ACK_TIMEOUT
+#define DEFAULT_DAO_ACK_TIMEOUT             2000    //!< Time (ms) to wait for the first DAO-ACK, doubled on each retransmission
+#endif
+
+#ifndef DEFAULT_DAO_MAX_RETRANSMISSIONS
+#define DEFAULT_DAO_MAX_RETRANSMISSIONS     3
+#endif
+
+/**
+ * Events reported for acknowledged DAOs
+ */
+enum rpl_dao_event_e {
+    RPL_DAO_EVENT_ACCEPTED = 0,         //!< DAO-ACK status 0
+    RPL_DAO_EVENT_TENTATIVE = 1,        //!< DAO-ACK status 1-127, accepted but the parent is not an outright fit
+    RPL_DAO_EVENT_REJECTED = 2,         //!< DAO-ACK status 128-255, another parent should be selected
+    RPL_DAO_EVENT_TIMEOUT = 3           //!< No DAO-ACK after all retransmissions
+};
+
+enum rpl_dao_target_state_e {
+    RPL_DAO_TARGET_FREE = 0,
+    RPL_DAO_TARGET_QUEUED = 1,          //!< Waiting for transmission
+    RPL_DAO_TARGET_INFLIGHT = 2         //!< Sent, waiting for the DAO-ACK
+};
+
+struct rpl_dao_pipeline_s;
+
+typedef void (*rpl_dao_send_t)(struct rpl_dao_pipeline_s *pipeline, const uint8_t *message, uint16_t length, void *context);
+typedef void (*rpl_dao_event_t)(struct rpl_dao_pipeline_s *pipeline, int event, uint8_t status, void *context);
+
+/**
+ * @brief Queued Target and Transit Information pair
+ */
+struct rpl_dao_target_s {
+    uint8_t prefix[16];             //!< Target prefix
+#if RPL_CONF_NON_STORING
+    uint8_t parent_address[16];     //!< Transit Information Parent Address (non-storing mode)
+#endif
+    uint8_t prefix_length;          //!< Target prefix length
+    uint8_t flags;                  //!< Transit Information flags
+    uint8_t path_control;           //!< Transit Information Path Control
+    uint8_t path_sequence;          //!< Transit Information Path Sequence
+    uint8_t path_lifetime;          //!< Transit Information Path Lifetime
+#if RPL_CONF_NON_STORING
+    uint8_t has_parent_address;     //!< Set when parent_address is sent
+#endif
+    uint8_t state;                  //!< rpl_dao_target_state_e
+    uint8_t slot;                   //!< In-flight slot when sent
+};
+
+/**
+ * @brief DAO awaiting acknowledgement
+ */
+struct rpl_dao_inflight_s {
+    struct rpl_timer_s timer;               //!< Retransmission timer
+    struct rpl_dao_pipeline_s *pipeline;    //!< Owner
+    uint32_t timeout;                       //!< Current retransmission timeout (ms)
+    uint8_t sequence;                       //!< DAO Sequence
+    uint8_t retransmissions;                //!< Retransmissions so far
+    uint8_t active;                         //!< Set while waiting for the DAO-ACK
+};
+
+/**
+ * @brief DAO transmission state for one DODAG
+ * @details window, ack_timeout, max_retransmissions and ack_requested may be changed after init.
+ */
+struct rpl_dao_pipeline_s {
+    struct rpl_timer_wheel_s *wheel;                        //!< Timer wheel (ms)
+    struct rpl_timer_s window_timer;                        //!< Aggregation window
+    struct rpl_dao_target_s targets[RPL_DAO_QUEUE_SIZE];    //!< Queued and in-flight targets
+    struct rpl_pool_s target_pool;                          //!< Targets in use
+    struct rpl_dao_inflight_s inflight[RPL_DAO_INFLIGHT_SIZE];  //!< DAOs awaiting a DAO-ACK
+    uint8_t *buffer;                                        //!< Message buffer
+    uint16_t mtu;                                           //!< Size of buffer, the largest DAO sent
+    uint8_t source[16];                                     //!< Address DAOs are sent from
+    uint8_t destination[16];                                //!< DAO parent (or root in non-storing mode)
+    uint8_t has_destination;                                //!< Set once a destination is known
+    uint8_t dodag_id[16];                                   //!< DODAGID, sent when use_dodag_id is set
+    uint8_t use_dodag_id;                                   //!< Send the DODAGID (D flag), required for local instances
+    rpl_instance_t instance;                                //!< RPLInstanceID
+    uint8_t sequence;                                       //!< Last DAO Sequence used
+    uint8_t ack_requested;                                  //!< Request DAO-ACKs (K flag)
+    uint8_t max_retransmissions;                            //!< Retransmissions before RPL_DAO_EVENT_TIMEOUT
+    uint32_t window;                                        //!< Aggregation window (ms)
+    uint32_t ack_timeout;                                   //!< Initial DAO-ACK timeout (ms)
+    uint32_t transmissions;                                 //!< DAOs sent, including retransmissions
+    uint32_t oversize;                                      //!< Targets dropped as they do not fit in a DAO of mtu octets
+    rpl_dao_send_t send;                                    //!< Transmits a DAO to destination
+    rpl_dao_event_t event;                                  //!< Reports rpl_dao_event_e, may be NULL
+    void *context;                                          //!< Passed to send and event
+};
+
+/**
+ * @param dodag_id DODAGID to send in each DAO, NULL to omit it
+ */
+void RPL_dao_pipeline_init(struct rpl_dao_pipeline_s *pipeline, struct rpl_timer_wheel_s *wheel, uint8_t *buffer, uint16_t mtu, rpl_instance_t instance,
+                           const uint8_t *dodag_id, rpl_dao_send_t send, rpl_dao_event_t event, void *context);
+
+/**
+ * @brief Set the addresses DAOs are sent from and to, eg. on a change of preferred parent
+ * @details DAOs awaiting acknowledgement by a previous destination are abandoned and their
+ * targets queued again for the new destination.
+ */
+void RPL_dao_pipeline_set_destination(struct rpl_dao_pipeline_s *pipeline, const uint8_t source[16], const uint8_t destination[16]);
+
+/**
+ * @brief Queue a target, starting the aggregation window if it is not running
+ *
+ * @param transit Transit Information for the target
+ * @param parent_address Parent Address to include, NULL in storing mode
+ * @return 0 on success, -1 when the queue is full or parent_address is given with
+ * RPL_CONF_NON_STORING 0
+ */
+int RPL_dao_pipeline_add(struct rpl_dao_pipeline_s *pipeline, const uint8_t *prefix, uint8_t prefix_length, const struct rpl_option_transit_info_s *transit,
+                         const uint8_t *parent_address);
+
+#if RPL_CONF_STORING
+/**
+ * @brief Queue a target received from a child in storing mode (validated Target and Transit Information options)
+ */
+int RPL_dao_pipeline_add_options(struct rpl_dao_pipeline_s *pipeline, const struct rpl_option_view_s *target, const struct rpl_option_view_s *transit);
+#endif
+
+/**
+ * @brief Send the queued targets now
+ * @details A target that does not fit in a DAO of mtu octets on its own is dropped and counted in
+ * oversize. The DAO Sequence only advances for DAOs that are sent.
+ */
+void RPL_dao_pipeline_flush(struct rpl_dao_pipeline_s *pipeline);
+
+/**
+ * @brief Process a received DAO-ACK
+ * @return 0 when it acknowledged a DAO awaiting acknowledgement, -1 otherwise (eg. a duplicate)
+ */
+int RPL_dao_pipeline_ack(struct rpl_dao_pipeline_s *pipeline, const struct rpl_dao_ack_view_s *ack);
+
+/**
+ * @brief Number of targets in a state (see rpl_dao_target_state_e)
+ */
+int RPL_dao_pipeline_count(const struct rpl_dao_pipeline_s *pipeline, uint8_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,407 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#define DAO_TEST_MAX_SENT       64
+
+static const uint8_t dao_source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02 };
+static const uint8_t dao_parent[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 };
+static const uint8_t dao_dodag_id[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 };
+
+struct dao_test_sent_s {
+	uint8_t message[1280];
+	uint16_t length;
+	uint32_t time;
+};
+
+static struct dao_test_sent_s dao_sent[DAO_TEST_MAX_SENT];
+static int dao_sent_count;
+static int dao_last_event;
+static int dao_event_count;
+static struct rpl_option_transit_info_s transit;
+
+static void dao_test_send(struct rpl_dao_pipeline_s *pipeline, const uint8_t *message, uint16_t length, void *context) {
+	(void)context;
+
+	if (dao_sent_count < DAO_TEST_MAX_SENT) {
+		memcpy(dao_sent[dao_sent_count].message, message, length);
+		dao_sent[dao_sent_count].length = length;
+		dao_sent[dao_sent_count].time = pipeline->wheel->now;
+	}
+	dao_sent_count++;
+}
+
+static void dao_test_event(struct rpl_dao_pipeline_s *pipeline, int event, uint8_t status, void *context) {
+	(void)pipeline;
+	(void)status;
+	(void)context;
+
+	dao_last_event = event;
+	dao_event_count++;
+}
+
+static void dao_target_address(uint8_t address[16], uint16_t id) {
+	memcpy(address, dao_dodag_id, 16);
+	RPL_write_uint16(address + 14, id);
+}
+
+//Parses a sent DAO, returning the number of targets (or -1) and the DAO Sequence
+static int dao_test_parse(const struct dao_test_sent_s *sent, uint8_t *sequence, uint16_t *first_target) {
+	struct rpl_message_view_s message;
+	struct rpl_dao_view_s view;
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option;
+	int targets = 0, transits = 0;
+
+	if ((RPL_message_view_init(&message, sent->message, sent->length) != 0) || (RPL_dao_view_init(&view, &message) != 0)) {
+		return -1;
+	}
+	*sequence = RPL_dao_view_sequence(&view);
+	RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_dao_view_options(&view), RPL_dao_view_options_length(&view));
+	while (RPL_option_iter_next(&iter, &option) == 1) {
+		if (option.type == RPL_OPTION_RPL_TARGET) {
+			if ((targets == 0) && (first_target != NULL)) {
+				*first_target = RPL_read_uint16(RPL_option_target_prefix(&option) + 14);
+			}
+			targets++;
+		} else if (option.type == RPL_OPTION_TRANSIT_INFO) {
+			transits++;
+		}
+	}
+	return (iter.error || (targets != transits)) ? -1 : targets;
+}
+
+static int dao_test_ack(struct rpl_dao_pipeline_s *pipeline, uint8_t sequence, uint8_t status) {
+	struct rpl_builder_s builder;
+	struct rpl_dao_ack_s dao_ack = {};
+	struct rpl_message_view_s message;
+	struct rpl_dao_ack_view_s view;
+	uint8_t buffer[64];
+	int length;
+
+	dao_ack.rpl_instance = pipeline->instance;
+	dao_ack.flags = RPL_DAO_ACK_FLAG_D_MASK;
+	dao_ack.dao_sequence = sequence;
+	dao_ack.status = status;
+	memcpy(dao_ack.dodag_id, dao_dodag_id, 16);
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dao_ack(&builder, &dao_ack, NULL);
+	length = RPL_builder_finish(&builder, dao_parent, dao_source);
+	CHECK(length > 0);
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+	CHECK_EQUAL(0, RPL_dao_ack_view_init(&view, &message));
+	return RPL_dao_pipeline_ack(pipeline, &view);
+}
+
+TEST_GROUP(dao_tests)
+{
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_dao_pipeline_s pipeline;
+	uint8_t buffer[1280];
+
+	void setup() {
+		dao_sent_count = 0;
+		dao_last_event = -1;
+		dao_event_count = 0;
+		RPL_timer_wheel_init(&wheel, 0, NULL);
+		RPL_dao_pipeline_init(&pipeline, &wheel, buffer, sizeof(buffer), 0x01, dao_dodag_id, dao_test_send, dao_test_event, NULL);
+		RPL_dao_pipeline_set_destination(&pipeline, dao_source, dao_parent);
+		memset(&transit, 0, sizeof(transit));
+		transit.path_lifetime = 30;
+	}
+
+	void teardown() {
+	}
+
+	void add_targets(int first, int count) {
+		uint8_t address[16];
+		int i;
+
+		for (i = first; i < first + count; i++) {
+			dao_target_address(address, (uint16_t)i);
+			CHECK_EQUAL(0, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, NULL));
+		}
+	}
+};
+
+TEST(dao_tests, aggregation_window_test) {
+	uint8_t sequence;
+
+	add_targets(1, 5);
+	RPL_timer_wheel_advance(&wheel, DEFAULT_DAO_AGGREGATION_WINDOW / 2);
+	add_targets(6, 5);
+	CHECK_EQUAL(0, dao_sent_count);
+
+	//One DAO with every target, sent a window after the first was queued
+	RPL_timer_wheel_advance(&wheel, DEFAULT_DAO_AGGREGATION_WINDOW);
+	CHECK_EQUAL(1, dao_sent_count);
+	CHECK_EQUAL(DEFAULT_DAO_AGGREGATION_WINDOW, dao_sent[0].time);
+	CHECK_EQUAL(10, dao_test_parse(&dao_sent[0], &sequence, NULL));
+	CHECK_EQUAL(10, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_INFLIGHT));
+
+	CHECK_EQUAL(0, dao_test_ack(&pipeline, sequence, 0));
+	CHECK_EQUAL(RPL_DAO_EVENT_ACCEPTED, dao_last_event);
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_INFLIGHT));
+
+	//Duplicate DAO-ACK
+	CHECK_EQUAL(-1, dao_test_ack(&pipeline, sequence, 0));
+	CHECK_EQUAL(1, dao_event_count);
+}
+
+TEST(dao_tests, target_update_test) {
+	uint8_t address[16];
+	uint8_t sequence;
+
+	add_targets(1, 3);
+	dao_target_address(address, 2);
+	transit.path_sequence = 7;
+	CHECK_EQUAL(0, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, NULL));
+	CHECK_EQUAL(3, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(3, dao_test_parse(&dao_sent[0], &sequence, NULL));
+}
+
+TEST(dao_tests, mtu_test) {
+	uint8_t sequence[4];
+	uint8_t small[100];
+	int i, total = 0;
+
+	//Each /128 target with its Transit Information takes 28 octets (with padding)
+	RPL_dao_pipeline_init(&pipeline, &wheel, small, sizeof(small), 0x01, dao_dodag_id, dao_test_send, dao_test_event, NULL);
+	RPL_dao_pipeline_set_destination(&pipeline, dao_source, dao_parent);
+	add_targets(1, 8);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(4, dao_sent_count);
+	for (i = 0; i < dao_sent_count; i++) {
+		CHECK(dao_sent[i].length <= sizeof(small));
+		total += dao_test_parse(&dao_sent[i], &sequence[i], NULL);
+	}
+	CHECK_EQUAL(8, total);
+	CHECK(RPL_sequence_is_greater(sequence[1], sequence[0]));
+	CHECK(RPL_sequence_is_greater(sequence[3], sequence[2]));
+}
+
+//A target too large for the MTU is dropped without holding up the others or using a DAO Sequence
+TEST(dao_tests, oversize_test) {
+	uint8_t sequence[2];
+	uint8_t tiny[48];
+	uint8_t address[16];
+	uint8_t initial;
+	int i;
+
+	//The DAO with its DODAGID takes 24 octets, a /32 target 16 and a /128 target 28
+	RPL_dao_pipeline_init(&pipeline, &wheel, tiny, sizeof(tiny), 0x01, dao_dodag_id, dao_test_send, dao_test_event, NULL);
+	RPL_dao_pipeline_set_destination(&pipeline, dao_source, dao_parent);
+	initial = pipeline.sequence;
+	add_targets(1, 1);
+	for (i = 0; i < 2; i++) {
+		dao_target_address(address, 0);
+		address[3] = (uint8_t)i;
+		CHECK_EQUAL(0, RPL_dao_pipeline_add(&pipeline, address, 32, &transit, NULL));
+	}
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(1, pipeline.oversize);
+	CHECK_EQUAL(2, dao_sent_count);
+	for (i = 0; i < dao_sent_count; i++) {
+		CHECK(dao_sent[i].length <= sizeof(tiny));
+		CHECK_EQUAL(1, dao_test_parse(&dao_sent[i], &sequence[i], NULL));
+	}
+	CHECK_EQUAL(RPL_sequence_increment(initial), sequence[0]);
+	CHECK_EQUAL(RPL_sequence_increment(sequence[0]), sequence[1]);
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+
+	//Only oversize targets, nothing is sent
+	add_targets(2, 1);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(2, pipeline.oversize);
+	CHECK_EQUAL(2, dao_sent_count);
+	CHECK_EQUAL(sequence[1], pipeline.sequence);
+}
+
+TEST(dao_tests, inflight_limit_test) {
+	uint8_t small[100];
+	uint8_t sequence;
+
+	RPL_dao_pipeline_init(&pipeline, &wheel, small, sizeof(small), 0x01, dao_dodag_id, dao_test_send, dao_test_event, NULL);
+	RPL_dao_pipeline_set_destination(&pipeline, dao_source, dao_parent);
+	add_targets(1, 2 * (RPL_DAO_INFLIGHT_SIZE + 1));
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(RPL_DAO_INFLIGHT_SIZE, dao_sent_count);
+	CHECK_EQUAL(2, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+
+	//A DAO-ACK frees a slot for the remaining targets
+	CHECK_EQUAL(2, dao_test_parse(&dao_sent[0], &sequence, NULL));
+	CHECK_EQUAL(0, dao_test_ack(&pipeline, sequence, 0));
+	CHECK_EQUAL(RPL_DAO_INFLIGHT_SIZE + 1, dao_sent_count);
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+}
+
+TEST(dao_tests, retransmission_test) {
+	uint8_t sequence, retransmitted;
+	uint32_t timeout = DEFAULT_DAO_ACK_TIMEOUT;
+	uint32_t expected = 0;
+	int i;
+
+	add_targets(1, 3);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(3, dao_test_parse(&dao_sent[0], &sequence, NULL));
+
+	//Backoff doubles, each retransmission keeps the DAO Sequence
+	for (i = 1; i <= DEFAULT_DAO_MAX_RETRANSMISSIONS; i++) {
+		expected += timeout;
+		timeout *= 2;
+		RPL_timer_wheel_advance(&wheel, expected);
+		CHECK_EQUAL(i + 1, dao_sent_count);
+		CHECK_EQUAL(expected, dao_sent[i].time);
+		CHECK_EQUAL(3, dao_test_parse(&dao_sent[i], &retransmitted, NULL));
+		CHECK_EQUAL(sequence, retransmitted);
+	}
+	CHECK_EQUAL(0, dao_event_count);
+	RPL_timer_wheel_advance(&wheel, expected + timeout);
+	CHECK_EQUAL(DEFAULT_DAO_MAX_RETRANSMISSIONS + 1, dao_sent_count);
+	CHECK_EQUAL(RPL_DAO_EVENT_TIMEOUT, dao_last_event);
+	CHECK_EQUAL(3, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+
+	//A late DAO-ACK no longer matches
+	CHECK_EQUAL(-1, dao_test_ack(&pipeline, sequence, 0));
+
+	//A new parent receives the targets
+	RPL_dao_pipeline_set_destination(&pipeline, dao_source, dao_dodag_id);
+	RPL_timer_wheel_advance(&wheel, expected + timeout + DEFAULT_DAO_AGGREGATION_WINDOW);
+	CHECK_EQUAL(DEFAULT_DAO_MAX_RETRANSMISSIONS + 2, dao_sent_count);
+}
+
+TEST(dao_tests, superseded_retransmission_test) {
+	uint8_t sequence, retransmitted;
+	uint16_t first;
+
+	add_targets(1, 3);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(3, dao_test_parse(&dao_sent[0], &sequence, NULL));
+
+	//Target 1 is updated while the DAO is in flight, it is sent in a new DAO and the retransmission omits it
+	transit.path_sequence = 1;
+	add_targets(1, 1);
+	RPL_timer_wheel_advance(&wheel, DEFAULT_DAO_ACK_TIMEOUT);
+	CHECK_EQUAL(3, dao_sent_count);
+	CHECK_EQUAL(1, dao_test_parse(&dao_sent[1], &retransmitted, &first));
+	CHECK_EQUAL(1, first);
+	CHECK(RPL_sequence_is_greater(retransmitted, sequence));
+	CHECK_EQUAL(2, dao_test_parse(&dao_sent[2], &retransmitted, &first));
+	CHECK_EQUAL(sequence, retransmitted);
+	CHECK_EQUAL(2, first);
+}
+
+TEST(dao_tests, ack_status_test) {
+	uint8_t sequence;
+
+	add_targets(1, 2);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(2, dao_test_parse(&dao_sent[0], &sequence, NULL));
+	CHECK_EQUAL(-1, dao_test_ack(&pipeline, (uint8_t)(sequence + 1), 0));
+	CHECK_EQUAL(0, dao_test_ack(&pipeline, sequence, 1));
+	CHECK_EQUAL(RPL_DAO_EVENT_TENTATIVE, dao_last_event);
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_INFLIGHT));
+
+	//Rejected targets stay queued for another parent
+	add_targets(1, 2);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(2, dao_test_parse(&dao_sent[1], &sequence, NULL));
+	CHECK_EQUAL(0, dao_test_ack(&pipeline, sequence, 128));
+	CHECK_EQUAL(RPL_DAO_EVENT_REJECTED, dao_last_event);
+	CHECK_EQUAL(2, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+	RPL_timer_wheel_advance(&wheel, 10 * DEFAULT_DAO_ACK_TIMEOUT);
+	CHECK_EQUAL(2, dao_sent_count);
+}
+
+TEST(dao_tests, no_ack_test) {
+	pipeline.ack_requested = 0;
+	add_targets(1, 4);
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(1, dao_sent_count);
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_INFLIGHT));
+	RPL_timer_wheel_advance(&wheel, 10 * DEFAULT_DAO_ACK_TIMEOUT);
+	CHECK_EQUAL(1, dao_sent_count);
+}
+
+#if RPL_CONF_STORING
+TEST(dao_tests, dtsn_storm_test) {
+	struct rpl_dao_pipeline_s child;
+	uint8_t child_buffer[1280];
+	int i, total = 0;
+
+	//DAOs from many children after a DTSN increment are forwarded in a few aggregated DAOs
+	RPL_dao_pipeline_init(&child, &wheel, child_buffer, sizeof(child_buffer), 0x01, dao_dodag_id, dao_test_send, NULL, NULL);
+	child.ack_requested = 0;
+	for (i = 0; i < RPL_DAO_QUEUE_SIZE; i++) {
+		uint8_t address[16];
+		struct rpl_message_view_s message;
+		struct rpl_dao_view_s view;
+		struct rpl_option_iter_s iter;
+		struct rpl_option_view_s target, transit_option;
+
+		dao_target_address(address, (uint16_t)(100 + i));
+		RPL_dao_pipeline_set_destination(&child, address, dao_source);
+		CHECK_EQUAL(0, RPL_dao_pipeline_add(&child, address, 128, &transit, NULL));
+		RPL_dao_pipeline_flush(&child);
+
+		CHECK_EQUAL(0, RPL_message_view_init(&message, dao_sent[dao_sent_count - 1].message, dao_sent[dao_sent_count - 1].length));
+		CHECK_EQUAL(0, RPL_dao_view_init(&view, &message));
+		RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_dao_view_options(&view), RPL_dao_view_options_length(&view));
+		CHECK_EQUAL(1, RPL_option_iter_next(&iter, &target));
+		CHECK_EQUAL(1, RPL_option_iter_next(&iter, &transit_option));
+		CHECK_EQUAL(0, RPL_dao_pipeline_add_options(&pipeline, &target, &transit_option));
+	}
+	dao_sent_count = 0;
+	RPL_timer_wheel_advance(&wheel, DEFAULT_DAO_AGGREGATION_WINDOW);
+	CHECK_EQUAL(1, dao_sent_count);
+	for (i = 0; i < dao_sent_count; i++) {
+		uint8_t sequence;
+
+		total += dao_test_parse(&dao_sent[i], &sequence, NULL);
+	}
+	CHECK_EQUAL(RPL_DAO_QUEUE_SIZE, total);
+
+}
+#endif
+
+TEST(dao_tests, queue_full_test) {
+	uint8_t address[16];
+
+	add_targets(1, RPL_DAO_QUEUE_SIZE);
+	dao_target_address(address, 0xFFFF);
+	CHECK_EQUAL(-1, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, NULL));
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(-1, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, NULL));
+	CHECK_EQUAL(0, dao_test_ack(&pipeline, pipeline.inflight[0].sequence, 0));
+	CHECK(RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_FREE) > 0);
+	CHECK_EQUAL(0, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, NULL));
+
+	//The queue was full once, and the adds made then failed
+	CHECK_EQUAL(RPL_DAO_QUEUE_SIZE, pipeline.target_pool.high_water);
+	CHECK_EQUAL(2, pipeline.target_pool.failures);
+}
+
+//The Transit Information Parent Address is only sent in non-storing mode
+TEST(dao_tests, parent_address_test) {
+	uint8_t address[16];
+
+	dao_target_address(address, 1);
+#if RPL_CONF_NON_STORING
+	CHECK_EQUAL(0, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, dao_parent));
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(0, dao_test_ack(&pipeline, pipeline.inflight[0].sequence, 0));
+	CHECK_EQUAL(0, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, NULL));
+	RPL_dao_pipeline_flush(&pipeline);
+	CHECK_EQUAL(2, dao_sent_count);
+	CHECK_EQUAL(dao_sent[1].length + 16, dao_sent[0].length);
+#else
+	CHECK_EQUAL(-1, RPL_dao_pipeline_add(&pipeline, address, 128, &transit, dao_parent));
+	CHECK_EQUAL(0, RPL_dao_pipeline_count(&pipeline, RPL_DAO_TARGET_QUEUED));
+#endif
+}
@@ -0,0 +1,221 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+#if RPL_DIS_SLOTS > 32
+#error "RPL_DIS_SLOTS must fit the 32 bit slot masks"
+#endif
+
+#define RPL_DIS_LOCAL_SLOT(index)       (RPL_INSTANCE_GLOBAL_MAX + (index))
+
+static uint8_t RPL_dis_dodag_hash(const uint8_t dodag_id[16]) {
+	uint8_t hash = 0;
+	int i;
+
+	//Interface identifiers differ in their last bytes, prefixes in their first ones
+	for (i = 0; i < RPL_DODAG_ID_LENGTH; i++) {
+		hash ^= dodag_id[i];
+	}
+	return (uint8_t)((hash ^ (hash >> 4)) & (RPL_DIS_DODAG_BUCKETS - 1));
+}
+
+static void RPL_dis_answer(struct rpl_timer_s *timer, void *context);
+
+void RPL_dis_engine_init(struct rpl_dis_engine_s *engine, struct rpl_instance_table_s *instances, struct rpl_timer_wheel_s *wheel, uint32_t holdoff,
+                         uint32_t delay, rpl_dis_reset_t reset, rpl_dis_send_t send, void *context) {
+	engine->instances = instances;
+	engine->wheel = wheel;
+	engine->reset = reset;
+	engine->send = send;
+	engine->context = context;
+	engine->holdoff = holdoff;
+	engine->delay = delay;
+	RPL_timer_init(&engine->timer, RPL_dis_answer, engine);
+	RPL_dis_engine_rebuild(engine);
+}
+
+void RPL_dis_engine_rebuild(struct rpl_dis_engine_s *engine) {
+	const struct rpl_instance_table_s *instances = engine->instances;
+	unsigned int i;
+
+	memset(engine->dodag_index, 0, sizeof(engine->dodag_index));
+	engine->all = 0;
+	for (i = 0; i < instances->global_count; i++) {
+		engine->dodag_index[RPL_dis_dodag_hash(instances->global[i].dodag_id)] |= 1u << i;
+		engine->all |= 1u << i;
+	}
+	for (i = 0; i < instances->local_count; i++) {
+		engine->dodag_index[RPL_dis_dodag_hash(instances->local[i].dodag_id)] |= 1u << RPL_DIS_LOCAL_SLOT(i);
+		engine->all |= 1u << RPL_DIS_LOCAL_SLOT(i);
+	}
+
+	//Slots may now hold other instances
+	RPL_timer_stop(engine->wheel, &engine->timer);
+	engine->pending_count = 0;
+	engine->coalesced = 0;
+	engine->held = 0;
+}
+
+struct rpl_instance_state_s *RPL_dis_slot_instance(const struct rpl_dis_engine_s *engine, unsigned int slot) {
+	if (slot < RPL_INSTANCE_GLOBAL_MAX) {
+		return &engine->instances->global[slot];
+	}
+	return &engine->instances->local[slot - RPL_INSTANCE_GLOBAL_MAX];
+}
+
+//Slots of an instance id, all the DODAGs sharing a local id
+static uint32_t RPL_dis_match_instance(const struct rpl_dis_engine_s *engine, rpl_instance_t instance_id) {
+	const struct rpl_instance_table_s *instances = engine->instances;
+	uint32_t slots = 0;
+	uint8_t index;
+
+	if (!RPL_instance_is_local(instance_id)) {
+		index = instances->global_index[instance_id];
+		return (index == RPL_INSTANCE_NONE) ? 0 : 1u << index;
+	}
+	for (index = instances->local_index[instance_id & RPL_INSTANCE_LOCAL_ID_MASK]; index != RPL_INSTANCE_NONE; index = instances->local[index].next) {
+		slots |= 1u << RPL_DIS_LOCAL_SLOT(index);
+	}
+	return slots;
+}
+
+uint32_t RPL_dis_match(const struct rpl_dis_engine_s *engine, const struct rpl_option_view_s *solicited) {
+	const uint8_t *dodag_id;
+	uint8_t flags;
+	uint32_t slots, candidates;
+	unsigned int slot;
+
+	if (solicited == NULL) {
+		return engine->all;
+	}
+	flags = RPL_option_solicited_info_flags(solicited);
+	dodag_id = RPL_option_solicited_info_dodag_id(solicited);
+
+	//Narrow down with the indexes, then check the candidates left
+	candidates = engine->all;
+	if (flags & RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK) {
+		candidates &= RPL_dis_match_instance(engine, RPL_option_solicited_info_instance_id(solicited));
+	}
+	if (flags & RPL_OPTION_SOLICITED_INFO_DODAGID_MASK) {
+		candidates &= engine->dodag_index[RPL_dis_dodag_hash(dodag_id)];
+	}
+	if (!(flags & (RPL_OPTION_SOLICITED_INFO_DODAGID_MASK | RPL_OPTION_SOLICITED_INFO_VERSION_MASK))) {
+		return candidates;
+	}
+
+	slots = 0;
+	for (slot = 0; candidates != 0; slot++, candidates >>= 1) {
+		const struct rpl_instance_state_s *instance;
+
+		if (!(candidates & 1)) {
+			continue;
+		}
+		instance = RPL_dis_slot_instance(engine, slot);
+		if ((flags & RPL_OPTION_SOLICITED_INFO_DODAGID_MASK) && (memcmp(instance->dodag_id, dodag_id, RPL_DODAG_ID_LENGTH) != 0)) {
+			continue;
+		}
+		if ((flags & RPL_OPTION_SOLICITED_INFO_VERSION_MASK) && (instance->version != RPL_option_solicited_info_version(solicited))) {
+			continue;
+		}
+		slots |= 1u << slot;
+	}
+	return slots;
+}
+
+//Resets the Trickle timers of the slots not reset within the holdoff
+static void RPL_dis_reset(struct rpl_dis_engine_s *engine, uint32_t slots) {
+	uint32_t now = engine->wheel->now;
+	unsigned int slot;
+
+	for (slot = 0; slots != 0; slot++, slots >>= 1) {
+		if (!(slots & 1)) {
+			continue;
+		}
+		if ((engine->held & (1u << slot)) && (now - engine->reset_time[slot] < engine->holdoff)) {
+			continue;
+		}
+		engine->held |= 1u << slot;
+		engine->reset_time[slot] = now;
+		engine->reset(engine, RPL_dis_slot_instance(engine, slot), engine->context);
+	}
+}
+
+static void RPL_dis_answer(struct rpl_timer_s *timer, void *context) {
+	struct rpl_dis_engine_s *engine = (struct rpl_dis_engine_s *)context;
+	unsigned int i, slot;
+	uint32_t slots;
+
+	(void)timer;
+
+	for (i = 0; i < engine->pending_count; i++) {
+		slots = engine->pending[i].slots;
+		for (slot = 0; slots != 0; slot++, slots >>= 1) {
+			if (slots & 1) {
+				engine->send(engine, RPL_dis_slot_instance(engine, slot), engine->pending[i].source, engine->context);
+			}
+		}
+	}
+	engine->pending_count = 0;
+
+	slots = engine->coalesced;
+	engine->coalesced = 0;
+	RPL_dis_reset(engine, slots);
+}
+
+//Queues a unicast solicitation, answering each source once per delay
+static void RPL_dis_queue(struct rpl_dis_engine_s *engine, const uint8_t source[16], uint32_t slots) {
+	unsigned int i;
+
+	for (i = 0; i < engine->pending_count; i++) {
+		if (memcmp(engine->pending[i].source, source, 16) == 0) {
+			engine->pending[i].slots |= slots;
+			return;
+		}
+	}
+	if (engine->pending_count == RPL_DIS_PENDING_MAX) {
+		engine->coalesced |= slots;
+	} else {
+		memcpy(engine->pending[engine->pending_count].source, source, 16);
+		engine->pending[engine->pending_count++].slots = slots;
+	}
+
+	if (!RPL_timer_running(&engine->timer)) {
+		RPL_timer_start(engine->wheel, &engine->timer, engine->wheel->now + engine->delay);
+	}
+}
+
+int RPL_dis_receive(struct rpl_dis_engine_s *engine, const struct rpl_dis_view_s *dis, const uint8_t source[16], uint8_t multicast) {
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option;
+	uint32_t slots = 0;
+	int found = 0, result, count;
+
+	//Several Solicited Information options solicit the instances matching any of them
+	RPL_option_iter_init(&iter, RPL_DODAG_INFORMATION_SOLICITATION, RPL_dis_view_options(dis), RPL_dis_view_options_length(dis));
+	while ((result = RPL_option_iter_next(&iter, &option)) > 0) {
+		if (option.type == RPL_OPTION_SOLICITED_INFO) {
+			slots |= RPL_dis_match(engine, &option);
+			found = 1;
+		}
+	}
+	if (result < 0) {
+		return -1;
+	}
+	if (!found) {
+		slots = engine->all;
+	}
+
+	if (slots != 0) {
+		if (multicast) {
+			RPL_dis_reset(engine, slots);
+		} else {
+			RPL_dis_queue(engine, source, slots);
+		}
+	}
+
+	for (count = 0; slots != 0; slots &= slots - 1) {
+		count++;
+	}
+	return count;
+}
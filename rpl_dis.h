@@ -0,0 +1,115 @@
+/**
+ * RPL DIS processing
+ * Answering DODAG Information Solicitations [RFC6550 Sections 6.2, 6.7.9, 8.3]
+ *
+ * A DIS solicits DIOs from the instances matching its Solicited Information predicates (all
+ * instances without the option). A multicast DIS resets the Trickle timers of the matching
+ * instances, a unicast DIS is answered with a DIO sent to its source.
+ *
+ * Instances are the slots of an instance table (global instances first), sets of instances are
+ * bitmasks of slots. The instance predicate uses the instance table indexes and the DODAGID
+ * predicate an index of DODAGID hashes to slots, built when instances are joined or left, so
+ * only the candidates are compared in full.
+ *
+ * Solicitation storms (eg. a whole network rebooting) are absorbed in two ways: an instance
+ * whose timer was reset ignores multicast DIS for holdoff ticks, and unicast DIS are queued for
+ * delay ticks, answering each source once. When the queue is full the remaining solicitations
+ * are answered by a single Trickle reset of their instances instead.
+ */
+
+#ifndef RPL_DIS_H
+#define RPL_DIS_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_message.h"
+#include "rpl_option.h"
+#include "rpl_instance.h"
+#include "rpl_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RPL_DIS_PENDING_MAX
+#define RPL_DIS_PENDING_MAX         8       //!< Unicast DIOs sent per delay, further solicitations are coalesced
+#endif
+
+#define RPL_DIS_SLOTS               (RPL_INSTANCE_GLOBAL_MAX + RPL_INSTANCE_LOCAL_MAX)
+#define RPL_DIS_DODAG_BUCKETS       16      //!< DODAGID hash buckets
+
+struct rpl_dis_engine_s;
+
+/**
+ * @brief Reset the Trickle timer of an instance (multicast DIS)
+ */
+typedef void (*rpl_dis_reset_t)(struct rpl_dis_engine_s *engine, struct rpl_instance_state_s *instance, void *context);
+
+/**
+ * @brief Send a DIO of an instance to the source of a unicast DIS
+ */
+typedef void (*rpl_dis_send_t)(struct rpl_dis_engine_s *engine, struct rpl_instance_state_s *instance, const uint8_t destination[16], void *context);
+
+/**
+ * @brief Queued unicast solicitation
+ */
+struct rpl_dis_pending_s {
+    uint8_t source[16];             //!< Source of the DIS
+    uint32_t slots;                 //!< Instances solicited
+};
+
+/**
+ * @brief DIS engine
+ */
+struct rpl_dis_engine_s {
+    struct rpl_instance_table_s *instances;
+    struct rpl_timer_wheel_s *wheel;
+    struct rpl_timer_s timer;                               //!< Answers the queued solicitations
+    rpl_dis_reset_t reset;
+    rpl_dis_send_t send;
+    void *context;                                          //!< Passed to reset and send
+    uint32_t holdoff;                                       //!< Ticks an instance ignores multicast DIS after a reset
+    uint32_t delay;                                         //!< Ticks unicast DIS are queued
+    uint32_t all;                                           //!< Slots in use
+    uint32_t dodag_index[RPL_DIS_DODAG_BUCKETS];            //!< Slots by DODAGID hash
+    uint32_t held;                                          //!< Slots reset within the last holdoff
+    uint32_t reset_time[RPL_DIS_SLOTS];                     //!< Time of the last reset of each held slot
+    uint32_t coalesced;                                     //!< Slots to reset when the queue is answered
+    struct rpl_dis_pending_s pending[RPL_DIS_PENDING_MAX];
+    uint8_t pending_count;
+};
+
+void RPL_dis_engine_init(struct rpl_dis_engine_s *engine, struct rpl_instance_table_s *instances, struct rpl_timer_wheel_s *wheel, uint32_t holdoff,
+                         uint32_t delay, rpl_dis_reset_t reset, rpl_dis_send_t send, void *context);
+
+/**
+ * @brief Rebuild the index, whenever instances are joined or left
+ * @details Queued solicitations and held instances are dropped.
+ */
+void RPL_dis_engine_rebuild(struct rpl_dis_engine_s *engine);
+
+/**
+ * @brief Instance state of a slot
+ */
+struct rpl_instance_state_s *RPL_dis_slot_instance(const struct rpl_dis_engine_s *engine, unsigned int slot);
+
+/**
+ * @brief Instances matching the predicates of a Solicited Information option
+ * @param solicited Solicited Information option, NULL to match every instance
+ * @return bitmask of slots
+ */
+uint32_t RPL_dis_match(const struct rpl_dis_engine_s *engine, const struct rpl_option_view_s *solicited);
+
+/**
+ * @brief Process a received DIS
+ * @param multicast set when the DIS was sent to a multicast address
+ * @return number of instances solicited, -1 when the options are malformed
+ */
+int RPL_dis_receive(struct rpl_dis_engine_s *engine, const struct rpl_dis_view_s *dis, const uint8_t source[16], uint8_t multicast);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,238 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t source_a[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 0x0A };
+static const uint8_t source_b[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 0x0B };
+static const uint8_t multicast[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+static const uint8_t dodag_a[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static const uint8_t dodag_b[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+
+static int reset_count[RPL_DIS_SLOTS];
+static int send_count[RPL_DIS_SLOTS];
+static uint8_t send_destination[16];
+
+static void dis_reset(struct rpl_dis_engine_s *engine, struct rpl_instance_state_s *instance, void *context) {
+	(void)engine;
+	(void)context;
+
+	reset_count[*(int *)instance->context]++;
+}
+
+static void dis_send(struct rpl_dis_engine_s *engine, struct rpl_instance_state_s *instance, const uint8_t destination[16], void *context) {
+	(void)engine;
+	(void)context;
+
+	send_count[*(int *)instance->context]++;
+	memcpy(send_destination, destination, 16);
+}
+
+TEST_GROUP(dis_tests)
+{
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_instance_table_s instances;
+	struct rpl_dis_engine_s engine;
+	int slots[RPL_DIS_SLOTS];
+	uint8_t buffer[128];
+
+	void setup() {
+		int i;
+
+		memset(reset_count, 0, sizeof(reset_count));
+		memset(send_count, 0, sizeof(send_count));
+		for (i = 0; i < RPL_DIS_SLOTS; i++) {
+			slots[i] = i;
+		}
+		RPL_timer_wheel_init(&wheel, 0, NULL);
+		RPL_instance_table_init(&instances);
+
+		//Global instances 1 and 2 in DODAG A and B, local instance 1 in both DODAGs
+		join(1, dodag_a, 10, 0);
+		join(2, dodag_b, 20, 1);
+		join(RPL_INSTANCE_FLAG_LOCAL | 1, dodag_a, 0, RPL_INSTANCE_GLOBAL_MAX);
+		join(RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b, 0, RPL_INSTANCE_GLOBAL_MAX + 1);
+		RPL_dis_engine_init(&engine, &instances, &wheel, 100, 10, dis_reset, dis_send, NULL);
+	}
+
+	void teardown() {
+
+	}
+
+	void join(rpl_instance_t instance_id, const uint8_t *dodag_id, rpl_dodag_version_t version, int slot) {
+		struct rpl_instance_state_s *instance = RPL_instance_join(&instances, instance_id, dodag_id);
+
+		instance->version = version;
+		instance->context = &slots[slot];
+	}
+
+	uint32_t match(uint8_t flags, rpl_instance_t instance_id, const uint8_t *dodag_id, rpl_dodag_version_t version) {
+		uint8_t data[RPL_OPTION_SOLICITED_INFO_LENGTH];
+		struct rpl_option_view_s option = { RPL_OPTION_SOLICITED_INFO, RPL_OPTION_SOLICITED_INFO_LENGTH, data };
+
+		data[0] = instance_id;
+		data[1] = flags;
+		memcpy(data + 2, dodag_id, 16);
+		data[18] = version;
+		return RPL_dis_match(&engine, &option);
+	}
+
+	int receive(const struct rpl_option_solicited_info_s *solicited, const uint8_t *source, uint8_t is_multicast) {
+		struct rpl_builder_s builder;
+		struct rpl_dis_s dis;
+		struct rpl_message_view_s message;
+		struct rpl_dis_view_s view;
+		int length;
+
+		memset(&dis, 0, sizeof(dis));
+		RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+		RPL_builder_dis(&builder, &dis, NULL);
+		if (solicited != NULL) {
+			RPL_builder_solicited_info(&builder, solicited);
+		}
+		length = RPL_builder_finish(&builder, source, is_multicast ? multicast : source_a);
+		CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+		CHECK_EQUAL(0, RPL_dis_view_init(&view, &message));
+		return RPL_dis_receive(&engine, &view, source, is_multicast);
+	}
+};
+
+TEST(dis_tests, match_test) {
+	//No predicate, every instance
+	CHECK_EQUAL((3u << RPL_INSTANCE_GLOBAL_MAX) | 3u, engine.all);
+	CHECK_EQUAL(engine.all, RPL_dis_match(&engine, NULL));
+	CHECK_EQUAL(engine.all, match(0, 9, dodag_b, 99));
+
+	//Instance predicate, a local id matches all its DODAGs
+	CHECK_EQUAL(1u << 1, match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK, 2, dodag_a, 0));
+	CHECK_EQUAL(0, match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK, 3, dodag_a, 0));
+	CHECK_EQUAL(3u << RPL_INSTANCE_GLOBAL_MAX, match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_a, 0));
+
+	//DODAGID predicate
+	CHECK_EQUAL((1u << 0) | (1u << RPL_INSTANCE_GLOBAL_MAX), match(RPL_OPTION_SOLICITED_INFO_DODAGID_MASK, 0, dodag_a, 0));
+	CHECK_EQUAL(0, match(RPL_OPTION_SOLICITED_INFO_DODAGID_MASK, 0, multicast, 0));
+
+	//Version predicate
+	CHECK_EQUAL(1u << 1, match(RPL_OPTION_SOLICITED_INFO_VERSION_MASK, 0, dodag_a, 20));
+	CHECK_EQUAL(3u << RPL_INSTANCE_GLOBAL_MAX, match(RPL_OPTION_SOLICITED_INFO_VERSION_MASK, 0, dodag_a, 0));
+
+	//All predicates must hold
+	CHECK_EQUAL(1u << (RPL_INSTANCE_GLOBAL_MAX + 1), match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK | RPL_OPTION_SOLICITED_INFO_DODAGID_MASK,
+	                                                         RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b, 0));
+	CHECK_EQUAL(1u << 0, match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK | RPL_OPTION_SOLICITED_INFO_DODAGID_MASK | RPL_OPTION_SOLICITED_INFO_VERSION_MASK,
+	                           1, dodag_a, 10));
+	CHECK_EQUAL(0, match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK | RPL_OPTION_SOLICITED_INFO_VERSION_MASK, 1, dodag_a, 11));
+}
+
+TEST(dis_tests, rebuild_test) {
+	RPL_instance_leave(&instances, RPL_instance_find(&instances, 1, NULL));
+	RPL_dis_engine_rebuild(&engine);
+
+	//Global instance 2 moved to slot 0
+	CHECK_EQUAL(1u << 0, match(RPL_OPTION_SOLICITED_INFO_DODAGID_MASK, 0, dodag_b, 0) & 0xF);
+	CHECK_EQUAL(0, match(RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK, 1, dodag_a, 0));
+	CHECK_EQUAL(3, receive(NULL, source_a, 1));
+	CHECK_EQUAL(1, reset_count[1]);
+	CHECK_EQUAL(0, reset_count[0]);
+}
+
+TEST(dis_tests, multicast_test) {
+	struct rpl_option_solicited_info_s solicited;
+
+	memset(&solicited, 0, sizeof(solicited));
+	solicited.rpl_instance_id = 2;
+	solicited.flags = RPL_OPTION_SOLICITED_INFO_INSTANCE_VALID;
+
+	CHECK_EQUAL(1, receive(&solicited, source_a, 1));
+	CHECK_EQUAL(1, reset_count[1]);
+	CHECK_EQUAL(0, reset_count[0]);
+
+	//Within the holdoff the flood is absorbed, other instances are still reset
+	CHECK_EQUAL(1, receive(&solicited, source_b, 1));
+	CHECK_EQUAL(4, receive(NULL, source_b, 1));
+	CHECK_EQUAL(1, reset_count[1]);
+	CHECK_EQUAL(1, reset_count[0]);
+	CHECK_EQUAL(1, reset_count[RPL_INSTANCE_GLOBAL_MAX + 1]);
+
+	RPL_timer_wheel_advance(&wheel, 100);
+	CHECK_EQUAL(1, receive(&solicited, source_a, 1));
+	CHECK_EQUAL(2, reset_count[1]);
+
+	//Nothing matching
+	solicited.rpl_instance_id = 3;
+	CHECK_EQUAL(0, receive(&solicited, source_a, 1));
+	CHECK_EQUAL(0, send_count[0] + send_count[1]);
+}
+
+TEST(dis_tests, unicast_test) {
+	struct rpl_option_solicited_info_s solicited;
+
+	memset(&solicited, 0, sizeof(solicited));
+	solicited.flags = RPL_OPTION_SOLICITED_INFO_DODAGID_VALID;
+	memcpy(solicited.dodag_id, dodag_a, 16);
+
+	//Answered once per source after the delay
+	CHECK_EQUAL(2, receive(&solicited, source_b, 0));
+	CHECK_EQUAL(2, receive(&solicited, source_b, 0));
+	CHECK_EQUAL(0, send_count[0]);
+	RPL_timer_wheel_advance(&wheel, 9);
+	CHECK_EQUAL(0, send_count[0]);
+	RPL_timer_wheel_advance(&wheel, 10);
+	CHECK_EQUAL(1, send_count[0]);
+	CHECK_EQUAL(1, send_count[RPL_INSTANCE_GLOBAL_MAX]);
+	CHECK_EQUAL(0, send_count[1]);
+	MEMCMP_EQUAL(source_b, send_destination, 16);
+	CHECK_EQUAL(0, reset_count[0]);
+
+	//Solicitations from the same source are merged
+	receive(&solicited, source_a, 0);
+	receive(NULL, source_a, 0);
+	RPL_timer_wheel_advance(&wheel, 20);
+	CHECK_EQUAL(2, send_count[0]);
+	CHECK_EQUAL(1, send_count[1]);
+}
+
+TEST(dis_tests, coalesce_test) {
+	uint8_t source[16];
+	int i;
+
+	memcpy(source, source_a, 16);
+	for (i = 0; i < RPL_DIS_PENDING_MAX + 4; i++) {
+		source[15] = (uint8_t)(0x20 + i);
+		CHECK_EQUAL(4, receive(NULL, source, 0));
+	}
+	CHECK_EQUAL(RPL_DIS_PENDING_MAX, engine.pending_count);
+
+	//The overflow is answered by a single Trickle reset
+	RPL_timer_wheel_advance(&wheel, 10);
+	CHECK_EQUAL(RPL_DIS_PENDING_MAX, send_count[0]);
+	CHECK_EQUAL(RPL_DIS_PENDING_MAX, send_count[RPL_INSTANCE_GLOBAL_MAX + 1]);
+	CHECK_EQUAL(1, reset_count[0]);
+	CHECK_EQUAL(1, reset_count[RPL_INSTANCE_GLOBAL_MAX + 1]);
+	CHECK_EQUAL(0, engine.pending_count);
+	CHECK_EQUAL(0, engine.coalesced);
+}
+
+TEST(dis_tests, malformed_test) {
+	struct rpl_message_view_s message;
+	struct rpl_dis_view_s view;
+	struct rpl_builder_s builder;
+	struct rpl_dis_s dis;
+	int length;
+
+	memset(&dis, 0, sizeof(dis));
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dis(&builder, &dis, NULL);
+	length = RPL_builder_finish(&builder, source_a, multicast);
+
+	//Truncated option after the DIS base
+	buffer[length] = RPL_OPTION_SOLICITED_INFO;
+	buffer[length + 1] = RPL_OPTION_SOLICITED_INFO_LENGTH;
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)(length + 4)));
+	CHECK_EQUAL(0, RPL_dis_view_init(&view, &message));
+	CHECK_EQUAL(-1, RPL_dis_receive(&engine, &view, source_a, 1));
+	CHECK_EQUAL(0, reset_count[0]);
+}
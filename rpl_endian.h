@@ -0,0 +1,53 @@
+/**
+ * Network byte order helpers
+ * Read and write big endian fields directly in message buffers, byte at a time so no
+ * alignment is required (compilers fuse these into single loads/stores where possible).
+ * Also the address hash and probe step shared by the open addressing tables keyed by address.
+ */
+
+#ifndef RPL_ENDIAN_H
+#define RPL_ENDIAN_H
+
+#include <stdint.h>
+
+static inline uint16_t RPL_read_uint16(const uint8_t *p) {
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static inline uint32_t RPL_read_uint32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void RPL_write_uint16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void RPL_write_uint32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/**
+ * @brief Hash of an IPv6 address for open addressing tables
+ * @details The first 4 octets (usually the same prefix throughout a DODAG) are left out.
+ */
+static inline uint32_t RPL_address_hash16(const uint8_t address[16]) {
+    uint32_t hash = RPL_read_uint32(address + 4) ^ RPL_read_uint32(address + 8) ^ (RPL_read_uint32(address + 12) * 0x9E3779B1UL);
+
+    return hash ^ (hash >> 15);
+}
+
+/**
+ * @brief Linear probing deletion step
+ * @details While removing the entry at hole, the entry found at next (whose hash gives home) is
+ * moved back into hole when hole lies on its probe path, as it would no longer be reachable.
+ * mask is the table size - 1.
+ */
+static inline int RPL_probe_moves_back(uint32_t hole, uint32_t next, uint32_t home, uint32_t mask) {
+    return ((next - home) & mask) >= ((next - hole) & mask);
+}
+
+#endif
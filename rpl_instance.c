@@ -0,0 +1,139 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+void RPL_instance_table_init(struct rpl_instance_table_s *table) {
+	table->global_count = 0;
+	table->local_count = 0;
+	memset(table->global_index, RPL_INSTANCE_NONE, sizeof(table->global_index));
+	memset(table->local_index, RPL_INSTANCE_NONE, sizeof(table->local_index));
+}
+
+struct rpl_instance_state_s *RPL_instance_find(struct rpl_instance_table_s *table, rpl_instance_t instance_id, const uint8_t *dodag_id) {
+	uint8_t index;
+
+	if (!RPL_instance_is_local(instance_id)) {
+		//Single instance nodes never reach the index
+		if ((table->global_count != 0) && (table->global[0].instance_id == instance_id)) {
+			return &table->global[0];
+		}
+		index = table->global_index[instance_id & RPL_MAX_INSTANCE_ID];
+		return (index == RPL_INSTANCE_NONE) ? NULL : &table->global[index];
+	}
+
+	if (dodag_id == NULL) {
+		return NULL;
+	}
+	for (index = table->local_index[instance_id & RPL_INSTANCE_LOCAL_ID_MASK]; index != RPL_INSTANCE_NONE; index = table->local[index].next) {
+		if (memcmp(table->local[index].dodag_id, dodag_id, RPL_DODAG_ID_LENGTH) == 0) {
+			return &table->local[index];
+		}
+	}
+	return NULL;
+}
+
+struct rpl_instance_state_s *RPL_instance_join(struct rpl_instance_table_s *table, rpl_instance_t instance_id, const uint8_t dodag_id[16]) {
+	struct rpl_instance_state_s *instance;
+	uint8_t local_id = instance_id & RPL_INSTANCE_LOCAL_ID_MASK;
+
+	if (RPL_instance_is_local(instance_id)) {
+		instance_id = RPL_INSTANCE_FLAG_LOCAL | local_id;
+	}
+	if ((instance = RPL_instance_find(table, instance_id, dodag_id)) != NULL) {
+		return instance;
+	}
+
+	if (!RPL_instance_is_local(instance_id)) {
+		if (table->global_count == RPL_INSTANCE_GLOBAL_MAX) {
+			return NULL;
+		}
+		table->global_index[instance_id] = table->global_count;
+		instance = &table->global[table->global_count++];
+		instance->next = RPL_INSTANCE_NONE;
+	} else {
+		if (table->local_count == RPL_INSTANCE_LOCAL_MAX) {
+			return NULL;
+		}
+		instance = &table->local[table->local_count];
+		instance->next = table->local_index[local_id];
+		table->local_index[local_id] = table->local_count++;
+	}
+
+	memcpy(instance->dodag_id, dodag_id, RPL_DODAG_ID_LENGTH);
+	instance->instance_id = instance_id;
+	instance->version = 0;
+	instance->rank = 0;
+	instance->mode_of_operation = 0;
+	instance->context = NULL;
+	return instance;
+}
+
+//Replaces the reference to local entry from with to (in the index or the chain holding it)
+static void RPL_instance_local_relink(struct rpl_instance_table_s *table, uint8_t from, uint8_t to) {
+	uint8_t *link = &table->local_index[table->local[from].instance_id & RPL_INSTANCE_LOCAL_ID_MASK];
+
+	while (*link != from) {
+		link = &table->local[*link].next;
+	}
+	*link = to;
+}
+
+void RPL_instance_leave(struct rpl_instance_table_s *table, struct rpl_instance_state_s *instance) {
+	uint8_t index, last;
+
+	if (!RPL_instance_is_local(instance->instance_id)) {
+		index = (uint8_t)(instance - table->global);
+		last = (uint8_t)(table->global_count - 1);
+		table->global_index[instance->instance_id] = RPL_INSTANCE_NONE;
+		if (index != last) {
+			table->global[index] = table->global[last];
+			table->global_index[table->global[index].instance_id] = index;
+		}
+		table->global_count = last;
+		return;
+	}
+
+	index = (uint8_t)(instance - table->local);
+	last = (uint8_t)(table->local_count - 1);
+	RPL_instance_local_relink(table, index, instance->next);
+	if (index != last) {
+		RPL_instance_local_relink(table, last, index);
+		table->local[index] = table->local[last];
+	}
+	table->local_count = last;
+}
+
+struct rpl_instance_state_s *RPL_instance_dispatch(struct rpl_instance_table_s *table, const struct rpl_message_view_s *message) {
+	union {
+		struct rpl_dio_view_s dio;
+		struct rpl_dao_view_s dao;
+		struct rpl_dao_ack_view_s dao_ack;
+		struct rpl_cc_view_s cc;
+	} view;
+
+	switch (RPL_message_view_code(message) & ~RPL_CONTROL_MESSAGE_SECURE_FLAG) {
+	case RPL_DODAG_INFORMATION_OBJECT:
+		if (RPL_dio_view_init(&view.dio, message) < 0) {
+			return NULL;
+		}
+		return RPL_instance_find(table, RPL_dio_view_instance_id(&view.dio), RPL_dio_view_dodag_id(&view.dio));
+	case RPL_DESTINATION_ADVERTISEMENt_OBJECT:
+		if (RPL_dao_view_init(&view.dao, message) < 0) {
+			return NULL;
+		}
+		return RPL_instance_find(table, RPL_dao_view_instance_id(&view.dao), RPL_dao_view_dodag_id(&view.dao));
+	case RPL_DESTINATION_ADVERTISEMENT_OBJECT_ACK:
+		if (RPL_dao_ack_view_init(&view.dao_ack, message) < 0) {
+			return NULL;
+		}
+		return RPL_instance_find(table, RPL_dao_ack_view_instance_id(&view.dao_ack), RPL_dao_ack_view_dodag_id(&view.dao_ack));
+	case RPL_CONSISTENCY_CHECK & ~RPL_CONTROL_MESSAGE_SECURE_FLAG:
+		if (RPL_cc_view_init(&view.cc, message) < 0) {
+			return NULL;
+		}
+		return RPL_instance_find(table, RPL_cc_view_instance_id(&view.cc), RPL_cc_view_dodag_id(&view.cc));
+	default:
+		return NULL;
+	}
+}
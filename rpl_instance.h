@@ -0,0 +1,107 @@
+/**
+ * RPL instances
+ * State of the RPL Instances and DODAGs a node participates in [RFC6550 Sections 3.1, 5.1]
+ *
+ * A node belongs to at most one DODAG per RPL Instance. Global instances (RPLInstanceID 0 to
+ * 127) are found by instance id alone through a direct index, local instances are only unique
+ * together with their DODAGID, so the local index gives the first instance with a local id and
+ * instances sharing it are chained. Global and local states are held in separate compact
+ * arrays, the first global instance sitting in the same cache line as the table header so the
+ * usual single instance node finds its state without touching the indexes.
+ *
+ * Received control messages are dispatched to their instance with RPL_instance_dispatch, the
+ * per instance protocol state (parents, Trickle timer, DAO pipeline...) hangs off context.
+ */
+
+#ifndef RPL_INSTANCE_H
+#define RPL_INSTANCE_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_message.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RPL_INSTANCE_GLOBAL_MAX
+#define RPL_INSTANCE_GLOBAL_MAX         4       //!< Global instances a node can join
+#endif
+
+#ifndef RPL_INSTANCE_LOCAL_MAX
+#define RPL_INSTANCE_LOCAL_MAX          4       //!< Local instances a node can join
+#endif
+
+#define RPL_INSTANCE_LOCAL_ID_MASK      0x3F    //!< Local RPLInstanceID without the local and direction flags
+#define RPL_INSTANCE_NONE               0xFF    //!< Null instance index
+
+/**
+ * @brief Instance state, two per cache line
+ */
+struct rpl_instance_state_s {
+    uint8_t dodag_id[16];           //!< DODAGID of the DODAG joined
+    rpl_instance_t instance_id;     //!< RPLInstanceID, with the direction flag cleared for local instances
+    rpl_dodag_version_t version;    //!< DODAG Version Number
+    rpl_dodag_rank_t rank;          //!< Rank of this node
+    uint8_t mode_of_operation;      //!< MOP (see rpl_dio_mode_of_operation_e)
+    uint8_t next;                   //!< Next local instance with the same local id, RPL_INSTANCE_NONE at the end
+    void *context;                  //!< Per instance protocol state of the caller
+};
+
+/**
+ * @brief Instance table
+ */
+struct rpl_instance_table_s {
+    uint8_t global_count;                                       //!< Global instances, in global[0..global_count)
+    uint8_t local_count;                                        //!< Local instances, in local[0..local_count)
+    struct rpl_instance_state_s global[RPL_INSTANCE_GLOBAL_MAX];
+    struct rpl_instance_state_s local[RPL_INSTANCE_LOCAL_MAX];
+    uint8_t global_index[RPL_MAX_INSTANCE_ID + 1];              //!< Global instance id to global entry
+    uint8_t local_index[RPL_INSTANCE_LOCAL_ID_MASK + 1];        //!< Local instance id to first local entry
+};
+
+static inline int RPL_instance_is_local(rpl_instance_t instance_id) {
+    return (instance_id & RPL_INSTANCE_FLAG_LOCAL) != 0;
+}
+
+void RPL_instance_table_init(struct rpl_instance_table_s *table);
+
+/**
+ * @brief Find an instance
+ * @param dodag_id DODAGID, required for local instances and ignored for global ones
+ * @return instance state, or NULL when the node has not joined the instance
+ */
+struct rpl_instance_state_s *RPL_instance_find(struct rpl_instance_table_s *table, rpl_instance_t instance_id, const uint8_t *dodag_id);
+
+/**
+ * @brief Join an instance (or return it when already joined)
+ * @details A new instance has a zero version, rank and MOP and a NULL context. For a global
+ * instance already joined through another DODAG the state is returned unchanged, moving to the
+ * new DODAG is up to the caller.
+ *
+ * @return instance state, or NULL when the table is full
+ */
+struct rpl_instance_state_s *RPL_instance_join(struct rpl_instance_table_s *table, rpl_instance_t instance_id, const uint8_t dodag_id[16]);
+
+/**
+ * @brief Leave an instance
+ * @details Instance states are kept compact, so pointers to other states of the same kind
+ * (global or local) may change.
+ */
+void RPL_instance_leave(struct rpl_instance_table_s *table, struct rpl_instance_state_s *instance);
+
+/**
+ * @brief Instance a received control message belongs to
+ * @details Uses the RPLInstanceID and DODAGID of DIO, DAO, DAO-ACK and CC messages. DIS carry no
+ * instance, local DAO and DAO-ACK must carry the DODAGID ('D' flag).
+ *
+ * @return instance state, or NULL when the message is for an instance not joined
+ */
+struct rpl_instance_state_s *RPL_instance_dispatch(struct rpl_instance_table_s *table, const struct rpl_message_view_s *message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
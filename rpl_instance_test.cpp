@@ -0,0 +1,151 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+static const uint8_t destination[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+static const uint8_t dodag_a[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static const uint8_t dodag_b[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+
+TEST_GROUP(instance_tests)
+{
+	struct rpl_instance_table_s table;
+	uint8_t buffer[128];
+
+	void setup() {
+		RPL_instance_table_init(&table);
+	}
+
+	void teardown() {
+
+	}
+
+	struct rpl_instance_state_s *dispatch(int length) {
+		struct rpl_message_view_s message;
+
+		CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+		return RPL_instance_dispatch(&table, &message);
+	}
+};
+
+TEST(instance_tests, layout_test) {
+	//The first global instance shares the first cache line with the table header
+	CHECK(offsetof(struct rpl_instance_table_s, global) + sizeof(struct rpl_instance_state_s) <= 64);
+}
+
+TEST(instance_tests, global_test) {
+	struct rpl_instance_state_s *first, *second;
+
+	POINTERS_EQUAL(NULL, RPL_instance_find(&table, 1, NULL));
+	first = RPL_instance_join(&table, 1, dodag_a);
+	second = RPL_instance_join(&table, 30, dodag_b);
+	CHECK(first != NULL);
+	CHECK(second != NULL);
+	POINTERS_EQUAL(first, RPL_instance_join(&table, 1, dodag_b));
+	MEMCMP_EQUAL(dodag_a, first->dodag_id, 16);
+	CHECK_EQUAL(2, table.global_count);
+
+	//Global instances are found by id alone
+	POINTERS_EQUAL(first, RPL_instance_find(&table, 1, NULL));
+	POINTERS_EQUAL(second, RPL_instance_find(&table, 30, dodag_a));
+	POINTERS_EQUAL(NULL, RPL_instance_find(&table, 2, NULL));
+
+	RPL_instance_leave(&table, first);
+	CHECK_EQUAL(1, table.global_count);
+	POINTERS_EQUAL(NULL, RPL_instance_find(&table, 1, NULL));
+	CHECK_EQUAL(30, RPL_instance_find(&table, 30, NULL)->instance_id);
+	POINTERS_EQUAL(&table.global[0], RPL_instance_find(&table, 30, NULL));
+}
+
+TEST(instance_tests, full_test) {
+	int i;
+
+	for (i = 0; i < RPL_INSTANCE_GLOBAL_MAX; i++) {
+		CHECK(RPL_instance_join(&table, (rpl_instance_t)i, dodag_a) != NULL);
+	}
+	POINTERS_EQUAL(NULL, RPL_instance_join(&table, 100, dodag_a));
+	for (i = 0; i < RPL_INSTANCE_LOCAL_MAX; i++) {
+		CHECK(RPL_instance_join(&table, (rpl_instance_t)(RPL_INSTANCE_FLAG_LOCAL | i), dodag_a) != NULL);
+	}
+	POINTERS_EQUAL(NULL, RPL_instance_join(&table, RPL_INSTANCE_FLAG_LOCAL | 50, dodag_a));
+}
+
+TEST(instance_tests, local_test) {
+	struct rpl_instance_state_s *a1, *b1, *a2;
+
+	//Local instance ids are unique per DODAGID
+	a1 = RPL_instance_join(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_a);
+	b1 = RPL_instance_join(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b);
+	a2 = RPL_instance_join(&table, RPL_INSTANCE_FLAG_LOCAL | RPL_INSTANCE_FLAG_LOCAL_DIRECTION | 2, dodag_a);
+	CHECK(a1 != b1);
+	CHECK_EQUAL(3, table.local_count);
+	CHECK_EQUAL(0, table.global_count);
+	CHECK_EQUAL(RPL_INSTANCE_FLAG_LOCAL | 2, a2->instance_id);
+
+	POINTERS_EQUAL(a1, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_a));
+	POINTERS_EQUAL(b1, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b));
+	POINTERS_EQUAL(a2, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | RPL_INSTANCE_FLAG_LOCAL_DIRECTION | 2, dodag_a));
+	POINTERS_EQUAL(NULL, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 2, dodag_b));
+	POINTERS_EQUAL(NULL, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 1, NULL));
+
+	//Leaving moves the last state into the gap, chains follow it
+	a2->context = &table;
+	RPL_instance_leave(&table, a1);
+	CHECK_EQUAL(2, table.local_count);
+	POINTERS_EQUAL(NULL, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_a));
+	POINTERS_EQUAL(&table, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 2, dodag_a)->context);
+	MEMCMP_EQUAL(dodag_b, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b)->dodag_id, 16);
+
+	RPL_instance_leave(&table, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b));
+	RPL_instance_leave(&table, RPL_instance_find(&table, RPL_INSTANCE_FLAG_LOCAL | 2, dodag_a));
+	CHECK_EQUAL(0, table.local_count);
+	CHECK(RPL_instance_join(&table, RPL_INSTANCE_FLAG_LOCAL | 1, dodag_b) != NULL);
+}
+
+TEST(instance_tests, dispatch_test) {
+	struct rpl_builder_s builder;
+	struct rpl_dio_s dio = {};
+	struct rpl_dao_s dao = {};
+	struct rpl_dis_s dis = {};
+	struct rpl_instance_state_s *global, *local;
+	int length;
+
+	global = RPL_instance_join(&table, 5, dodag_a);
+	local = RPL_instance_join(&table, RPL_INSTANCE_FLAG_LOCAL | 5, dodag_b);
+
+	dio.rpl_instance_id = 5;
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dio(&builder, &dio, dodag_b, NULL);
+	length = RPL_builder_finish(&builder, source, destination);
+	POINTERS_EQUAL(global, dispatch(length));
+
+	dio.rpl_instance_id = RPL_INSTANCE_FLAG_LOCAL | 5;
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dio(&builder, &dio, dodag_b, NULL);
+	length = RPL_builder_finish(&builder, source, destination);
+	POINTERS_EQUAL(local, dispatch(length));
+
+	//Local DAOs must carry the DODAGID
+	dao.rpl_instance = RPL_INSTANCE_FLAG_LOCAL | 5;
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dao(&builder, &dao, NULL);
+	length = RPL_builder_finish(&builder, source, destination);
+	POINTERS_EQUAL(NULL, dispatch(length));
+
+	dao.flags = RPL_DAO_FLAG_D_MASK;
+	memcpy(dao.dodag_id, dodag_b, 16);
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dao(&builder, &dao, NULL);
+	length = RPL_builder_finish(&builder, source, destination);
+	POINTERS_EQUAL(local, dispatch(length));
+
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dis(&builder, &dis, NULL);
+	length = RPL_builder_finish(&builder, source, destination);
+	POINTERS_EQUAL(NULL, dispatch(length));
+}
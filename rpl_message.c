@@ -0,0 +1,150 @@
+#include "rpl.h"
+
+//Message views, section 6
+//Each init checks the bounds of the fixed fields once so the accessors can read without checks
+
+uint16_t RPL_security_key_identifier_length(uint8_t kim_and_lvl) {
+	uint8_t kim = (kim_and_lvl & RPL_SEC_KIM_MASK) >> RPL_SEC_KIM_SHIFT;
+	uint8_t lvl = (kim_and_lvl & RPL_SEC_LVL_MASK) >> RPL_SEC_LVL_SHIFT;
+
+	switch (kim) {
+	case RPL_SEC_KIM_MODE0:
+		return 1;	//Key index
+	case RPL_SEC_KIM_MODE1:
+		return 0;
+	case RPL_SEC_KIM_MODE2:
+		return 9;	//Key source and key index
+	default:
+		return (lvl & 0x01) ? 9 : 0;	//Signature key, group key source and index only when encrypted
+	}
+}
+
+uint16_t RPL_security_mac_length(uint8_t kim_and_lvl) {
+	uint8_t kim = (kim_and_lvl & RPL_SEC_KIM_MASK) >> RPL_SEC_KIM_SHIFT;
+	uint8_t lvl = (kim_and_lvl & RPL_SEC_LVL_MASK) >> RPL_SEC_LVL_SHIFT;
+
+	if (kim == RPL_SEC_KIM_MODE3) {
+		return (lvl < 2) ? 384 : 256;
+	}
+	return (lvl < 2) ? 4 : 8;
+}
+
+int RPL_message_view_init(struct rpl_message_view_s *view, const uint8_t *data, uint16_t length) {
+	uint16_t offset = RPL_ICMPV6_HEADER_LENGTH;
+	uint16_t mac = 0;
+
+	if ((data == NULL) || (length < RPL_ICMPV6_HEADER_LENGTH) || (data[0] != RPL_ICMPV6_INFORMATION_TYPE)) {
+		return -1;
+	}
+
+	if (data[1] & RPL_CONTROL_MESSAGE_SECURE_FLAG) {
+#if !RPL_CONF_SECURITY
+		//Secured messages are dropped when security is compiled out
+		return -1;
+#else
+		if (length < RPL_ICMPV6_HEADER_LENGTH + RPL_SECURITY_BASE_LENGTH) {
+			return -1;
+		}
+		offset += RPL_SECURITY_BASE_LENGTH + RPL_security_key_identifier_length(data[offset + 2]);
+		mac = RPL_security_mac_length(data[RPL_ICMPV6_HEADER_LENGTH + 2]);
+		if ((uint32_t)offset + mac > length) {
+			return -1;
+		}
+#endif
+	}
+
+	view->data = data;
+	view->length = length;
+	view->base_offset = offset;
+	view->base_end = (uint16_t)(length - mac);
+
+	return 0;
+}
+
+//Checks the message code (ignoring the secure flag) and the minimum base length
+static int RPL_message_view_base_check(const struct rpl_message_view_s *message, uint8_t code, uint16_t min_length) {
+	if ((message->data[1] & ~RPL_CONTROL_MESSAGE_SECURE_FLAG) != (code & ~RPL_CONTROL_MESSAGE_SECURE_FLAG)) {
+		return -1;
+	}
+	if (RPL_message_view_base_length(message) < min_length) {
+		return -1;
+	}
+	return 0;
+}
+
+int RPL_dio_view_init(struct rpl_dio_view_s *view, const struct rpl_message_view_s *message) {
+	if (RPL_message_view_base_check(message, RPL_DODAG_INFORMATION_OBJECT, RPL_DIO_BASE_LENGTH) < 0) {
+		return -1;
+	}
+
+	view->data = RPL_message_view_base(message);
+	view->length = RPL_message_view_base_length(message);
+
+	return 0;
+}
+
+int RPL_dao_view_init(struct rpl_dao_view_s *view, const struct rpl_message_view_s *message) {
+	const uint8_t *base = RPL_message_view_base(message);
+	uint16_t offset = RPL_DAO_BASE_LENGTH;
+
+	if (RPL_message_view_base_check(message, RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_DAO_BASE_LENGTH) < 0) {
+		return -1;
+	}
+	if (base[1] & RPL_DAO_FLAG_D_MASK) {
+		offset += RPL_DODAG_ID_LENGTH;
+		if (RPL_message_view_base_length(message) < offset) {
+			return -1;
+		}
+	}
+
+	view->data = base;
+	view->length = RPL_message_view_base_length(message);
+	view->options_offset = offset;
+
+	return 0;
+}
+
+int RPL_dao_ack_view_init(struct rpl_dao_ack_view_s *view, const struct rpl_message_view_s *message) {
+	const uint8_t *base = RPL_message_view_base(message);
+	uint16_t offset = RPL_DAO_ACK_BASE_LENGTH;
+
+	if (RPL_message_view_base_check(message, RPL_DESTINATION_ADVERTISEMENT_OBJECT_ACK, RPL_DAO_ACK_BASE_LENGTH) < 0) {
+		return -1;
+	}
+	if (base[1] & RPL_DAO_ACK_FLAG_D_MASK) {
+		offset += RPL_DODAG_ID_LENGTH;
+		if (RPL_message_view_base_length(message) < offset) {
+			return -1;
+		}
+	}
+
+	view->data = base;
+	view->length = RPL_message_view_base_length(message);
+	view->options_offset = offset;
+
+	return 0;
+}
+
+int RPL_dis_view_init(struct rpl_dis_view_s *view, const struct rpl_message_view_s *message) {
+	if (RPL_message_view_base_check(message, RPL_DODAG_INFORMATION_SOLICITATION, RPL_DIS_BASE_LENGTH) < 0) {
+		return -1;
+	}
+
+	view->data = RPL_message_view_base(message);
+	view->length = RPL_message_view_base_length(message);
+
+	return 0;
+}
+
+//CC messages are always secured
+int RPL_cc_view_init(struct rpl_cc_view_s *view, const struct rpl_message_view_s *message) {
+	if ((message->data[1] != RPL_CONSISTENCY_CHECK)
+	        || (RPL_message_view_base_length(message) < RPL_CC_BASE_LENGTH)) {
+		return -1;
+	}
+
+	view->data = RPL_message_view_base(message);
+	view->length = RPL_message_view_base_length(message);
+
+	return 0;
+}
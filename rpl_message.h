@@ -0,0 +1,259 @@
+/**
+ * RPL message views
+ * Read only views over received RPL control messages [RFC6550 Section 6]
+ *
+ * The message structures in rpl_types.h describe the fields but cannot be overlaid on a
+ * received buffer (host byte order, padding, optional fields). Views instead keep a pointer
+ * into the receive buffer, check the bounds once at init, and then decode each field in
+ * network byte order on access. Nothing is allocated or copied, so the receive buffer must
+ * outlive the view.
+ *
+ * For secured messages with an encrypting security level the view must be initialized over
+ * the unprotected buffer.
+ */
+
+#ifndef RPL_MESSAGE_H
+#define RPL_MESSAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_endian.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief ICMPv6 RPL control message view
+ * @details Covers the ICMPv6 header, the security section for secured messages and the
+ * message base with options. Base views (DIO, DAO...) are initialized from this.
+ */
+struct rpl_message_view_s {
+    const uint8_t *data;            //!< Start of the ICMPv6 message (type field)
+    uint16_t length;                //!< Length of the ICMPv6 message
+    uint16_t base_offset;           //!< Offset of the message base (after the security section when secured)
+    uint16_t base_end;              //!< End of the message base and options (start of the MAC or signature when secured)
+};
+
+int RPL_message_view_init(struct rpl_message_view_s *view, const uint8_t *data, uint16_t length);
+
+static inline uint8_t RPL_message_view_code(const struct rpl_message_view_s *view) {
+    return view->data[1];
+}
+
+static inline uint16_t RPL_message_view_checksum(const struct rpl_message_view_s *view) {
+    return RPL_read_uint16(view->data + 2);
+}
+
+static inline int RPL_message_view_is_secure(const struct rpl_message_view_s *view) {
+    return (view->data[1] & RPL_CONTROL_MESSAGE_SECURE_FLAG) != 0;
+}
+
+//Returns the security section of secured messages, NULL otherwise
+static inline const uint8_t *RPL_message_view_security(const struct rpl_message_view_s *view) {
+    return RPL_message_view_is_secure(view) ? view->data + RPL_ICMPV6_HEADER_LENGTH : NULL;
+}
+
+static inline const uint8_t *RPL_message_view_base(const struct rpl_message_view_s *view) {
+    return view->data + view->base_offset;
+}
+
+static inline uint16_t RPL_message_view_base_length(const struct rpl_message_view_s *view) {
+    return (uint16_t)(view->base_end - view->base_offset);
+}
+
+/**
+ * Security section sizes, determined by the KIM and LVL fields [RFC6550 Section 6.1]
+ */
+uint16_t RPL_security_key_identifier_length(uint8_t kim_and_lvl);
+uint16_t RPL_security_mac_length(uint8_t kim_and_lvl);
+
+/**
+ * @brief DODAG Information Object view [RFC6550 Section 6.3.1]
+ */
+struct rpl_dio_view_s {
+    const uint8_t *data;            //!< Start of the DIO base
+    uint16_t length;                //!< Length of the DIO base and options
+};
+
+int RPL_dio_view_init(struct rpl_dio_view_s *view, const struct rpl_message_view_s *message);
+
+static inline rpl_instance_t RPL_dio_view_instance_id(const struct rpl_dio_view_s *view) {
+    return view->data[0];
+}
+
+static inline rpl_dodag_version_t RPL_dio_view_version(const struct rpl_dio_view_s *view) {
+    return view->data[1];
+}
+
+static inline rpl_dodag_rank_t RPL_dio_view_rank(const struct rpl_dio_view_s *view) {
+    return RPL_read_uint16(view->data + 2);
+}
+
+static inline uint8_t RPL_dio_view_mode(const struct rpl_dio_view_s *view) {
+    return view->data[4];
+}
+
+static inline int RPL_dio_view_grounded(const struct rpl_dio_view_s *view) {
+    return (view->data[4] & RPL_DIO_MODE_GROUNDED_FLAG) != 0;
+}
+
+static inline uint8_t RPL_dio_view_mode_of_operation(const struct rpl_dio_view_s *view) {
+    return (view->data[4] & RPL_DIO_MODE_MODE_OF_OPERATION_MASK) >> RPL_DIO_MODE_MODE_OF_OPERATION_SHIFT;
+}
+
+static inline uint8_t RPL_dio_view_preference(const struct rpl_dio_view_s *view) {
+    return (view->data[4] & RPL_DIO_MODE_PREFERENCE_MASK) >> RPL_DIO_MODE_PREFERENCE_SHIFT;
+}
+
+static inline uint8_t RPL_dio_view_dtsn(const struct rpl_dio_view_s *view) {
+    return view->data[5];
+}
+
+static inline const uint8_t *RPL_dio_view_dodag_id(const struct rpl_dio_view_s *view) {
+    return view->data + 8;
+}
+
+static inline const uint8_t *RPL_dio_view_options(const struct rpl_dio_view_s *view) {
+    return view->data + RPL_DIO_BASE_LENGTH;
+}
+
+static inline uint16_t RPL_dio_view_options_length(const struct rpl_dio_view_s *view) {
+    return (uint16_t)(view->length - RPL_DIO_BASE_LENGTH);
+}
+
+/**
+ * @brief Destination Advertisement Object view [RFC6550 Section 6.4.1]
+ */
+struct rpl_dao_view_s {
+    const uint8_t *data;            //!< Start of the DAO base
+    uint16_t length;                //!< Length of the DAO base and options
+    uint16_t options_offset;        //!< Offset of the options, depends on the 'D' flag
+};
+
+int RPL_dao_view_init(struct rpl_dao_view_s *view, const struct rpl_message_view_s *message);
+
+static inline rpl_instance_t RPL_dao_view_instance_id(const struct rpl_dao_view_s *view) {
+    return view->data[0];
+}
+
+static inline int RPL_dao_view_ack_requested(const struct rpl_dao_view_s *view) {
+    return (view->data[1] & RPL_DAO_FLAG_K_MASK) != 0;
+}
+
+static inline uint8_t RPL_dao_view_sequence(const struct rpl_dao_view_s *view) {
+    return view->data[3];
+}
+
+//Returns the DODAGID when the 'D' flag is set, NULL otherwise
+static inline const uint8_t *RPL_dao_view_dodag_id(const struct rpl_dao_view_s *view) {
+    return (view->data[1] & RPL_DAO_FLAG_D_MASK) ? view->data + RPL_DAO_BASE_LENGTH : NULL;
+}
+
+static inline const uint8_t *RPL_dao_view_options(const struct rpl_dao_view_s *view) {
+    return view->data + view->options_offset;
+}
+
+static inline uint16_t RPL_dao_view_options_length(const struct rpl_dao_view_s *view) {
+    return (uint16_t)(view->length - view->options_offset);
+}
+
+/**
+ * @brief Destination Advertisement Object Acknowledgement view [RFC6550 Section 6.5.1]
+ */
+struct rpl_dao_ack_view_s {
+    const uint8_t *data;            //!< Start of the DAO-ACK base
+    uint16_t length;                //!< Length of the DAO-ACK base and options
+    uint16_t options_offset;        //!< Offset of the options, depends on the 'D' flag
+};
+
+int RPL_dao_ack_view_init(struct rpl_dao_ack_view_s *view, const struct rpl_message_view_s *message);
+
+static inline rpl_instance_t RPL_dao_ack_view_instance_id(const struct rpl_dao_ack_view_s *view) {
+    return view->data[0];
+}
+
+static inline uint8_t RPL_dao_ack_view_sequence(const struct rpl_dao_ack_view_s *view) {
+    return view->data[2];
+}
+
+static inline uint8_t RPL_dao_ack_view_status(const struct rpl_dao_ack_view_s *view) {
+    return view->data[3];
+}
+
+//Returns the DODAGID when the 'D' flag is set, NULL otherwise
+static inline const uint8_t *RPL_dao_ack_view_dodag_id(const struct rpl_dao_ack_view_s *view) {
+    return (view->data[1] & RPL_DAO_ACK_FLAG_D_MASK) ? view->data + RPL_DAO_ACK_BASE_LENGTH : NULL;
+}
+
+static inline const uint8_t *RPL_dao_ack_view_options(const struct rpl_dao_ack_view_s *view) {
+    return view->data + view->options_offset;
+}
+
+static inline uint16_t RPL_dao_ack_view_options_length(const struct rpl_dao_ack_view_s *view) {
+    return (uint16_t)(view->length - view->options_offset);
+}
+
+/**
+ * @brief DODAG Information Solicitation view [RFC6550 Section 6.2.1]
+ */
+struct rpl_dis_view_s {
+    const uint8_t *data;            //!< Start of the DIS base
+    uint16_t length;                //!< Length of the DIS base and options
+};
+
+int RPL_dis_view_init(struct rpl_dis_view_s *view, const struct rpl_message_view_s *message);
+
+static inline const uint8_t *RPL_dis_view_options(const struct rpl_dis_view_s *view) {
+    return view->data + RPL_DIS_BASE_LENGTH;
+}
+
+static inline uint16_t RPL_dis_view_options_length(const struct rpl_dis_view_s *view) {
+    return (uint16_t)(view->length - RPL_DIS_BASE_LENGTH);
+}
+
+/**
+ * @brief Consistency Check view [RFC6550 Section 6.6.1]
+ */
+struct rpl_cc_view_s {
+    const uint8_t *data;            //!< Start of the CC base
+    uint16_t length;                //!< Length of the CC base and options
+};
+
+int RPL_cc_view_init(struct rpl_cc_view_s *view, const struct rpl_message_view_s *message);
+
+static inline rpl_instance_t RPL_cc_view_instance_id(const struct rpl_cc_view_s *view) {
+    return view->data[0];
+}
+
+static inline int RPL_cc_view_is_response(const struct rpl_cc_view_s *view) {
+    return (view->data[1] & RPL_CC_FLAG_R_MASK) != 0;
+}
+
+static inline uint16_t RPL_cc_view_nonce(const struct rpl_cc_view_s *view) {
+    return RPL_read_uint16(view->data + 2);
+}
+
+static inline const uint8_t *RPL_cc_view_dodag_id(const struct rpl_cc_view_s *view) {
+    return view->data + 4;
+}
+
+static inline uint32_t RPL_cc_view_destination_counter(const struct rpl_cc_view_s *view) {
+    return RPL_read_uint32(view->data + 4 + RPL_DODAG_ID_LENGTH);
+}
+
+static inline const uint8_t *RPL_cc_view_options(const struct rpl_cc_view_s *view) {
+    return view->data + RPL_CC_BASE_LENGTH;
+}
+
+static inline uint16_t RPL_cc_view_options_length(const struct rpl_cc_view_s *view) {
+    return (uint16_t)(view->length - RPL_CC_BASE_LENGTH);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * Control message micro-benchmark
+ * DIO and DAO encoding (rpl_builder) and decoding (views and the option iterator).
+ * Uses Google Benchmark (see rpl_bench.h), build with eg.
+ *   gcc -O3 -c rpl_*.c && g++ -O3 rpl_message_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+#define BENCH_DAO_TARGETS   8
+
+static const uint8_t bench_source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02 };
+static const uint8_t bench_destination[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+static const uint8_t bench_dodag_id[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 };
+
+static int bench_dio_encode(uint8_t *buffer, uint16_t capacity) {
+	struct rpl_builder_s builder;
+	struct rpl_dio_s dio = {};
+	struct rpl_option_dodag_configuration_s config = {};
+	struct rpl_option_prefix_info_s prefix_info = {};
+
+	dio.rpl_instance_id = 1;
+	dio.rpl_version = 240;
+	dio.rank = 512;
+	dio.mode = RPL_DIO_MODE_GROUNDED_FLAG | (RPL_DIO_MODE_MOP2 << RPL_DIO_MODE_MODE_OF_OPERATION_SHIFT);
+	config.dio_int_double = DEFAULT_DIO_INTERVAL_DOUBLINGS;
+	config.dio_int_min = DEFAULT_DIO_INTERVAL_MIN;
+	config.dio_redun = DEFAULT_DIO_REDUNDANCY_CONSTANT;
+	config.min_hop_rank_increase = DEFAULT_MIN_HOP_RANK_INCREASE;
+	config.default_lifetime = 0xFF;
+	config.lifetime_unit = 60;
+	prefix_info.prefix_length = 64;
+	prefix_info.valid_lifetime = 0xFFFFFFFF;
+	prefix_info.preferred_lifetime = 0xFFFFFFFF;
+
+	RPL_builder_init(&builder, buffer, capacity, NULL, 0);
+	RPL_builder_dio(&builder, &dio, bench_dodag_id, NULL);
+	RPL_builder_dodag_config(&builder, &config);
+	RPL_builder_prefix_info(&builder, &prefix_info, bench_dodag_id);
+	return RPL_builder_finish(&builder, bench_source, bench_destination);
+}
+
+static int bench_dao_encode(uint8_t *buffer, uint16_t capacity) {
+	struct rpl_builder_s builder;
+	struct rpl_dao_s dao = {};
+	struct rpl_option_transit_info_s transit = {};
+	uint8_t target[16];
+	int i;
+
+	dao.rpl_instance = 1;
+	dao.flags = RPL_DAO_FLAG_K_MASK | RPL_DAO_FLAG_D_MASK;
+	dao.dao_sequence = 17;
+	memcpy(dao.dodag_id, bench_dodag_id, 16);
+	transit.path_sequence = 3;
+	transit.path_lifetime = 30;
+	memcpy(target, bench_dodag_id, 16);
+
+	RPL_builder_init(&builder, buffer, capacity, NULL, 0);
+	RPL_builder_dao(&builder, &dao, NULL);
+	for (i = 0; i < BENCH_DAO_TARGETS; i++) {
+		target[15] = (uint8_t)(0x10 + i);
+		RPL_builder_target(&builder, 128, target);
+		RPL_builder_transit_info(&builder, &transit, bench_dodag_id);
+	}
+	return RPL_builder_finish(&builder, bench_source, bench_dodag_id);
+}
+
+static void BM_dio_encode(benchmark::State &state) {
+	uint8_t buffer[256];
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(bench_dio_encode(buffer, sizeof(buffer)));
+		benchmark::ClobberMemory();
+	}
+	rpl_bench_items(state, 1);
+}
+BENCHMARK(BM_dio_encode);
+
+static void BM_dio_decode(benchmark::State &state) {
+	uint8_t buffer[256];
+	uint16_t length = (uint16_t)bench_dio_encode(buffer, sizeof(buffer));
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		struct rpl_message_view_s message;
+		struct rpl_dio_view_s dio;
+		struct rpl_option_iter_s iter;
+		struct rpl_option_view_s option;
+		uint32_t sum = 0;
+
+		RPL_message_view_init(&message, buffer, length);
+		RPL_dio_view_init(&dio, &message);
+		sum += RPL_dio_view_rank(&dio) + RPL_dio_view_version(&dio);
+		RPL_option_iter_init(&iter, RPL_DODAG_INFORMATION_OBJECT, RPL_dio_view_options(&dio), RPL_dio_view_options_length(&dio));
+		while (RPL_option_iter_next(&iter, &option) == 1) {
+			sum += option.type;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	rpl_bench_items(state, 1);
+}
+BENCHMARK(BM_dio_decode);
+
+static void BM_dao_encode(benchmark::State &state) {
+	uint8_t buffer[512];
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(bench_dao_encode(buffer, sizeof(buffer)));
+		benchmark::ClobberMemory();
+	}
+	rpl_bench_items(state, BENCH_DAO_TARGETS);
+}
+BENCHMARK(BM_dao_encode);
+
+static void BM_dao_decode(benchmark::State &state) {
+	uint8_t buffer[512];
+	uint16_t length = (uint16_t)bench_dao_encode(buffer, sizeof(buffer));
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		struct rpl_message_view_s message;
+		struct rpl_dao_view_s dao;
+		struct rpl_option_iter_s iter;
+		struct rpl_option_view_s option;
+		uint32_t sum = 0;
+
+		RPL_message_view_init(&message, buffer, length);
+		RPL_dao_view_init(&dao, &message);
+		RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_dao_view_options(&dao), RPL_dao_view_options_length(&dao));
+		while (RPL_option_iter_next(&iter, &option) == 1) {
+			if (option.type == RPL_OPTION_RPL_TARGET) {
+				sum += RPL_option_target_prefix(&option)[15];
+			} else {
+				sum += RPL_option_transit_info_path_sequence(&option);
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	rpl_bench_items(state, BENCH_DAO_TARGETS);
+}
+BENCHMARK(BM_dao_decode);
+
+//Option walk alone, over the options of the DAO (with padding)
+static void BM_option_walk(benchmark::State &state) {
+	uint8_t buffer[512];
+	uint16_t length = (uint16_t)bench_dao_encode(buffer, sizeof(buffer));
+	struct rpl_message_view_s message;
+	struct rpl_dao_view_s dao;
+
+	RPL_message_view_init(&message, buffer, length);
+	RPL_dao_view_init(&dao, &message);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_dao_view_options(&dao), RPL_dao_view_options_length(&dao)));
+	}
+	rpl_bench_items(state, 2 * BENCH_DAO_TARGETS);
+}
+BENCHMARK(BM_option_walk);
+
+RPL_BENCH_MAIN()
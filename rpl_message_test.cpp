@@ -0,0 +1,201 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+TEST_GROUP(message_tests)
+{
+	uint8_t buffer[128];
+
+	void setup() {
+		memset(buffer, 0, sizeof(buffer));
+		buffer[0] = RPL_ICMPV6_INFORMATION_TYPE;
+	}
+
+	void teardown() {
+
+	}
+};
+
+//6.3.1 DIO Base Object
+TEST(message_tests, dio_view_test) {
+	struct rpl_message_view_s message;
+	struct rpl_dio_view_s dio;
+	uint8_t *base = buffer + RPL_ICMPV6_HEADER_LENGTH;
+	int i;
+
+	buffer[1] = RPL_DODAG_INFORMATION_OBJECT;
+	buffer[2] = 0xAB;
+	buffer[3] = 0xCD;
+	base[0] = 7;                //Instance
+	base[1] = 241;              //Version
+	base[2] = 0x01;             //Rank 0x0180
+	base[3] = 0x80;
+	base[4] = RPL_DIO_MODE_GROUNDED_FLAG | (RPL_DIO_MODE_MOP2 << RPL_DIO_MODE_MODE_OF_OPERATION_SHIFT) | 5;
+	base[5] = 12;               //DTSN
+	for (i = 0; i < RPL_DODAG_ID_LENGTH; i++) {
+		base[8 + i] = (uint8_t)(0xF0 + i);
+	}
+	base[RPL_DIO_BASE_LENGTH] = RPL_OPTION_PAD1;
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH + RPL_DIO_BASE_LENGTH + 1));
+	CHECK_EQUAL(0xABCD, RPL_message_view_checksum(&message));
+	CHECK_EQUAL(0, RPL_message_view_is_secure(&message));
+	POINTERS_EQUAL(NULL, RPL_message_view_security(&message));
+
+	CHECK_EQUAL(0, RPL_dio_view_init(&dio, &message));
+	CHECK_EQUAL(7, RPL_dio_view_instance_id(&dio));
+	CHECK_EQUAL(241, RPL_dio_view_version(&dio));
+	CHECK_EQUAL(0x0180, RPL_dio_view_rank(&dio));
+	CHECK_EQUAL(1, RPL_dio_view_grounded(&dio));
+	CHECK_EQUAL(RPL_DIO_MODE_MOP2, RPL_dio_view_mode_of_operation(&dio));
+	CHECK_EQUAL(5, RPL_dio_view_preference(&dio));
+	CHECK_EQUAL(12, RPL_dio_view_dtsn(&dio));
+	POINTERS_EQUAL(base + 8, RPL_dio_view_dodag_id(&dio));
+	POINTERS_EQUAL(base + RPL_DIO_BASE_LENGTH, RPL_dio_view_options(&dio));
+	CHECK_EQUAL(1, RPL_dio_view_options_length(&dio));
+
+	//Truncated base must be rejected
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH + RPL_DIO_BASE_LENGTH - 1));
+	CHECK_EQUAL(-1, RPL_dio_view_init(&dio, &message));
+
+	//Not a DIO
+	buffer[1] = RPL_DODAG_INFORMATION_SOLICITATION;
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, sizeof(buffer)));
+	CHECK_EQUAL(-1, RPL_dio_view_init(&dio, &message));
+}
+
+TEST(message_tests, message_view_header_test) {
+	struct rpl_message_view_s message;
+
+	CHECK_EQUAL(-1, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH - 1));
+
+	buffer[0] = 134;
+	CHECK_EQUAL(-1, RPL_message_view_init(&message, buffer, sizeof(buffer)));
+
+	//Secured message with no room for the security section
+	buffer[0] = RPL_ICMPV6_INFORMATION_TYPE;
+	buffer[1] = RPL_SECURE_DODAG_INFORMATION_OBJECT;
+	CHECK_EQUAL(-1, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH + 4));
+}
+
+#if RPL_CONF_SECURITY
+//6.4.1 DAO Base Object, with the optional DODAGID, carried in a secured message
+TEST(message_tests, dao_view_test) {
+	struct rpl_message_view_s message;
+	struct rpl_dao_view_s dao;
+	uint8_t *security = buffer + RPL_ICMPV6_HEADER_LENGTH;
+	uint8_t *base;
+
+	buffer[1] = RPL_SECURE_DESTINATION_ADVERTISEMENt_OBJECT;
+	security[2] = (RPL_SEC_KIM_MODE2 << RPL_SEC_KIM_SHIFT) | 2;   //9 octet key identifier, MAC-64
+	base = security + RPL_SECURITY_BASE_LENGTH + 9;
+	base[0] = 3;
+	base[1] = RPL_DAO_FLAG_K_MASK | RPL_DAO_FLAG_D_MASK;
+	base[3] = 99;
+	base[4] = 0xFE;
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, sizeof(buffer)));
+	CHECK_EQUAL(1, RPL_message_view_is_secure(&message));
+	POINTERS_EQUAL(security, RPL_message_view_security(&message));
+	POINTERS_EQUAL(base, RPL_message_view_base(&message));
+	CHECK_EQUAL(sizeof(buffer) - (base - buffer) - 8, RPL_message_view_base_length(&message));
+
+	CHECK_EQUAL(0, RPL_dao_view_init(&dao, &message));
+	CHECK_EQUAL(3, RPL_dao_view_instance_id(&dao));
+	CHECK_EQUAL(1, RPL_dao_view_ack_requested(&dao));
+	CHECK_EQUAL(99, RPL_dao_view_sequence(&dao));
+	POINTERS_EQUAL(base + RPL_DAO_BASE_LENGTH, RPL_dao_view_dodag_id(&dao));
+	POINTERS_EQUAL(base + RPL_DAO_BASE_LENGTH + RPL_DODAG_ID_LENGTH, RPL_dao_view_options(&dao));
+
+	//Without the 'D' flag the options follow the base directly
+	base[1] = 0;
+	CHECK_EQUAL(0, RPL_dao_view_init(&dao, &message));
+	POINTERS_EQUAL(NULL, RPL_dao_view_dodag_id(&dao));
+	POINTERS_EQUAL(base + RPL_DAO_BASE_LENGTH, RPL_dao_view_options(&dao));
+
+	//'D' flag set but the DODAGID is truncated
+	base[1] = RPL_DAO_FLAG_D_MASK;
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)(base - buffer) + RPL_DAO_BASE_LENGTH + 8 + 8));
+	CHECK_EQUAL(-1, RPL_dao_view_init(&dao, &message));
+}
+#else
+//Secured messages are dropped when security is compiled out
+TEST(message_tests, secure_view_test) {
+	struct rpl_message_view_s message;
+
+	buffer[1] = RPL_SECURE_DESTINATION_ADVERTISEMENt_OBJECT;
+	CHECK_EQUAL(-1, RPL_message_view_init(&message, buffer, sizeof(buffer)));
+	buffer[1] = RPL_DESTINATION_ADVERTISEMENt_OBJECT;
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, sizeof(buffer)));
+}
+#endif
+
+//6.5.1 DAO-ACK Base Object
+TEST(message_tests, dao_ack_view_test) {
+	struct rpl_message_view_s message;
+	struct rpl_dao_ack_view_s dao_ack;
+	uint8_t *base = buffer + RPL_ICMPV6_HEADER_LENGTH;
+
+	buffer[1] = RPL_DESTINATION_ADVERTISEMENT_OBJECT_ACK;
+	base[0] = 1;
+	base[2] = 42;
+	base[3] = 130;
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH + RPL_DAO_ACK_BASE_LENGTH));
+	CHECK_EQUAL(0, RPL_dao_ack_view_init(&dao_ack, &message));
+	CHECK_EQUAL(42, RPL_dao_ack_view_sequence(&dao_ack));
+	CHECK_EQUAL(1, RPL_DAO_ACK_STATUS_REJECTED(RPL_dao_ack_view_status(&dao_ack)));
+	POINTERS_EQUAL(NULL, RPL_dao_ack_view_dodag_id(&dao_ack));
+	CHECK_EQUAL(0, RPL_dao_ack_view_options_length(&dao_ack));
+}
+
+//6.2.1 DIS Base Object
+TEST(message_tests, dis_view_test) {
+	struct rpl_message_view_s message;
+	struct rpl_dis_view_s dis;
+
+	buffer[1] = RPL_DODAG_INFORMATION_SOLICITATION;
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH + 1));
+	CHECK_EQUAL(-1, RPL_dis_view_init(&dis, &message));
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, RPL_ICMPV6_HEADER_LENGTH + RPL_DIS_BASE_LENGTH + 3));
+	CHECK_EQUAL(0, RPL_dis_view_init(&dis, &message));
+	CHECK_EQUAL(3, RPL_dis_view_options_length(&dis));
+}
+
+#if RPL_CONF_SECURITY
+//6.6.1 CC Base Object
+TEST(message_tests, cc_view_test) {
+	struct rpl_message_view_s message;
+	struct rpl_cc_view_s cc;
+	uint8_t *security = buffer + RPL_ICMPV6_HEADER_LENGTH;
+	uint8_t *base;
+
+	buffer[1] = RPL_CONSISTENCY_CHECK;
+	security[2] = (RPL_SEC_KIM_MODE0 << RPL_SEC_KIM_SHIFT) | 0;   //Key index, MAC-32
+	base = security + RPL_SECURITY_BASE_LENGTH + 1;
+	base[0] = 9;
+	base[1] = RPL_CC_FLAG_R_MASK;
+	base[2] = 0x12;
+	base[3] = 0x34;
+	base[20] = 0x01;
+	base[23] = 0x02;
+
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)(base - buffer) + RPL_CC_BASE_LENGTH + 4));
+	CHECK_EQUAL(0, RPL_cc_view_init(&cc, &message));
+	CHECK_EQUAL(9, RPL_cc_view_instance_id(&cc));
+	CHECK_EQUAL(1, RPL_cc_view_is_response(&cc));
+	CHECK_EQUAL(0x1234, RPL_cc_view_nonce(&cc));
+	CHECK_EQUAL(0x01000002, RPL_cc_view_destination_counter(&cc));
+	CHECK_EQUAL(0, RPL_cc_view_options_length(&cc));
+
+	//MAC overlapping the base
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)(base - buffer) + RPL_CC_BASE_LENGTH + 3));
+	CHECK_EQUAL(-1, RPL_cc_view_init(&cc, &message));
+}
+#endif
@@ -0,0 +1,250 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+//Object body layout per type: octets before the values and octets per value (0 for types without values)
+struct rpl_metric_layout_s {
+	uint8_t prefix;
+	uint8_t element;
+};
+
+static const struct rpl_metric_layout_s RPL_metric_layouts[] = {
+	{ 0, 0 },   //Unassigned
+	{ 0, 0 },   //Node State and Attribute
+	{ 0, 2 },   //Node Energy
+	{ 1, 1 },   //Hop Count
+	{ 0, 4 },   //Link Throughput
+	{ 0, 4 },   //Link Latency
+	{ 1, 1 },   //Link Quality Level
+	{ 0, 2 },   //ETX
+	{ 0, 0 }    //Link Color
+};
+
+static struct rpl_metric_layout_s RPL_metric_layout(uint8_t type) {
+	static const struct rpl_metric_layout_s unknown = { 0, 0 };
+
+	return (type < sizeof(RPL_metric_layouts) / sizeof(RPL_metric_layouts[0])) ? RPL_metric_layouts[type] : unknown;
+}
+
+void RPL_metric_iter_init(struct rpl_metric_iter_s *iter, const uint8_t *data, uint8_t length) {
+	iter->position = data;
+	iter->end = data + length;
+	iter->error = 0;
+}
+
+int RPL_metric_iter_next(struct rpl_metric_iter_s *iter, struct rpl_metric_view_s *metric) {
+	struct rpl_metric_layout_s layout;
+	const uint8_t *p = iter->position;
+	uint8_t length;
+
+	if (iter->error) {
+		return -1;
+	}
+	if (p == iter->end) {
+		return 0;
+	}
+	if ((iter->end - p) < RPL_METRIC_HEADER_LENGTH) {
+		iter->error = 1;
+		return -1;
+	}
+
+	length = p[3];
+	if ((iter->end - p - RPL_METRIC_HEADER_LENGTH) < length) {
+		iter->error = 1;
+		return -1;
+	}
+
+	metric->header.type = p[0];
+	metric->header.flags = p[1] & (RPL_METRIC_FLAG_PARTIAL | RPL_METRIC_FLAG_CONSTRAINT | RPL_METRIC_FLAG_OPTIONAL);
+	metric->header.recorded = (p[2] & RPL_METRIC_RECORDED_MASK) != 0;
+	metric->header.aggregation = (p[2] & RPL_METRIC_AGGREGATION_MASK) >> RPL_METRIC_AGGREGATION_SHIFT;
+	metric->header.precedence = p[2] & RPL_METRIC_PRECEDENCE_MASK;
+	metric->length = length;
+	metric->data = p + RPL_METRIC_HEADER_LENGTH;
+
+	//Objects with values hold one (aggregated) or more (recorded, or levels of a LQL) whole values
+	layout = RPL_metric_layout(metric->header.type);
+	if (layout.element != 0) {
+		int values = (length - layout.prefix) / layout.element;
+
+		if ((length < layout.prefix + layout.element) || (((length - layout.prefix) % layout.element) != 0) ||
+		    ((values != 1) && !metric->header.recorded && (metric->header.type != RPL_METRIC_LINK_QUALITY_LEVEL))) {
+			iter->error = 1;
+			return -1;
+		}
+	}
+
+	iter->position = p + RPL_METRIC_HEADER_LENGTH + length;
+	return 1;
+}
+
+int RPL_metric_find(const uint8_t *data, uint8_t length, uint8_t type, struct rpl_metric_view_s *metric) {
+	struct rpl_metric_iter_s iter;
+	int result;
+
+	RPL_metric_iter_init(&iter, data, length);
+	while ((result = RPL_metric_iter_next(&iter, metric)) > 0) {
+		if (metric->header.type == type) {
+			return 1;
+		}
+	}
+	return result;
+}
+
+int RPL_metric_count(const struct rpl_metric_view_s *metric) {
+	struct rpl_metric_layout_s layout = RPL_metric_layout(metric->header.type);
+
+	if (layout.element == 0) {
+		return 0;
+	}
+	return (metric->length - layout.prefix) / layout.element;
+}
+
+static uint32_t RPL_metric_read(const uint8_t *data, uint8_t element) {
+	switch (element) {
+	case 1:
+		return data[0];
+	case 2:
+		return RPL_read_uint16(data);
+	default:
+		return RPL_read_uint32(data);
+	}
+}
+
+static void RPL_metric_write(uint8_t *data, uint8_t element, uint32_t value) {
+	switch (element) {
+	case 1:
+		data[0] = (uint8_t)value;
+		break;
+	case 2:
+		RPL_write_uint16(data, (uint16_t)value);
+		break;
+	default:
+		RPL_write_uint32(data, value);
+		break;
+	}
+}
+
+uint32_t RPL_metric_value(const struct rpl_metric_view_s *metric, int index) {
+	struct rpl_metric_layout_s layout = RPL_metric_layout(metric->header.type);
+
+	return RPL_metric_read(metric->data + layout.prefix + index * layout.element, layout.element);
+}
+
+static void RPL_metric_write_header(uint8_t *buffer, const struct rpl_metric_s *header, uint8_t length) {
+	buffer[0] = header->type;
+	buffer[1] = header->flags & (RPL_METRIC_FLAG_PARTIAL | RPL_METRIC_FLAG_CONSTRAINT | RPL_METRIC_FLAG_OPTIONAL);
+	buffer[2] = (uint8_t)((header->recorded ? RPL_METRIC_RECORDED_MASK : 0) | ((header->aggregation << RPL_METRIC_AGGREGATION_SHIFT) & RPL_METRIC_AGGREGATION_MASK) |
+	                      (header->precedence & RPL_METRIC_PRECEDENCE_MASK));
+	buffer[3] = length;
+}
+
+int RPL_metric_encode(uint8_t *buffer, uint16_t capacity, const struct rpl_metric_s *header, const uint32_t *values, uint8_t count) {
+	struct rpl_metric_layout_s layout = RPL_metric_layout(header->type);
+	unsigned length = layout.prefix + (unsigned)count * layout.element;
+	unsigned i;
+
+	if ((layout.element == 0) || (count == 0) || ((count > 1) && !header->recorded && (header->type != RPL_METRIC_LINK_QUALITY_LEVEL)) ||
+	    (length > 0xFF) || (RPL_METRIC_HEADER_LENGTH + length > capacity)) {
+		return -1;
+	}
+
+	RPL_metric_write_header(buffer, header, (uint8_t)length);
+	memset(buffer + RPL_METRIC_HEADER_LENGTH, 0, layout.prefix);
+	for (i = 0; i < count; i++) {
+		RPL_metric_write(buffer + RPL_METRIC_HEADER_LENGTH + layout.prefix + i * layout.element, layout.element, values[i]);
+	}
+	return (int)(RPL_METRIC_HEADER_LENGTH + length);
+}
+
+int RPL_metric_record(uint8_t *buffer, uint16_t capacity, const struct rpl_metric_view_s *metric, uint32_t value) {
+	struct rpl_metric_layout_s layout = RPL_metric_layout(metric->header.type);
+	unsigned length = (unsigned)metric->length + layout.element;
+
+	if ((layout.element == 0) || !metric->header.recorded || (length > 0xFF) || (RPL_METRIC_HEADER_LENGTH + length > capacity)) {
+		return -1;
+	}
+
+	RPL_metric_write_header(buffer, &metric->header, (uint8_t)length);
+	memcpy(buffer + RPL_METRIC_HEADER_LENGTH, metric->data, metric->length);
+	RPL_metric_write(buffer + RPL_METRIC_HEADER_LENGTH + metric->length, layout.element, value);
+	return (int)(RPL_METRIC_HEADER_LENGTH + length);
+}
+
+//The kernels are branch free so that they vectorize
+
+void RPL_metric_aggregate_additive(const uint32_t *restrict path, const uint32_t *restrict link, uint32_t *restrict cost, unsigned count) {
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		uint32_t sum = path[i] + link[i];
+
+		cost[i] = sum | (uint32_t)-(uint32_t)(sum < path[i]);
+	}
+}
+
+void RPL_metric_aggregate_maximum(const uint32_t *restrict path, const uint32_t *restrict link, uint32_t *restrict cost, unsigned count) {
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		cost[i] = (path[i] > link[i]) ? path[i] : link[i];
+	}
+}
+
+void RPL_metric_aggregate_minimum(const uint32_t *restrict path, const uint32_t *restrict link, uint32_t *restrict cost, unsigned count) {
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		cost[i] = (path[i] < link[i]) ? path[i] : link[i];
+	}
+}
+
+void RPL_metric_aggregate_multiplicative(const uint32_t *restrict path, const uint32_t *restrict link, uint32_t *restrict cost, unsigned count) {
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		uint64_t product = ((uint64_t)path[i] * link[i]) >> 16;
+
+		cost[i] = (product > UINT32_MAX) ? UINT32_MAX : (uint32_t)product;
+	}
+}
+
+int RPL_metric_candidates_aggregate(struct rpl_metric_candidates_s *candidates, uint8_t aggregation) {
+	switch (aggregation) {
+	case RPL_METRIC_AGGREGATION_ADDITIVE:
+		RPL_metric_aggregate_additive(candidates->path, candidates->link, candidates->cost, candidates->count);
+		return 0;
+	case RPL_METRIC_AGGREGATION_MAXIMUM:
+		RPL_metric_aggregate_maximum(candidates->path, candidates->link, candidates->cost, candidates->count);
+		return 0;
+	case RPL_METRIC_AGGREGATION_MINIMUM:
+		RPL_metric_aggregate_minimum(candidates->path, candidates->link, candidates->cost, candidates->count);
+		return 0;
+	case RPL_METRIC_AGGREGATION_MULTIPLICATIVE:
+		RPL_metric_aggregate_multiplicative(candidates->path, candidates->link, candidates->cost, candidates->count);
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+int RPL_metric_candidates_best(const struct rpl_metric_candidates_s *candidates) {
+	uint32_t best = UINT32_MAX;
+	int i;
+
+	if (candidates->count == 0) {
+		return -1;
+	}
+
+	//Minimum first (a vectorizable reduction), then its first position
+	for (i = 0; i < candidates->count; i++) {
+		best = (candidates->cost[i] < best) ? candidates->cost[i] : best;
+	}
+	for (i = 0; i < candidates->count; i++) {
+		if (candidates->cost[i] == best) {
+			break;
+		}
+	}
+	return i;
+}
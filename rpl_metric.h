@@ -0,0 +1,176 @@
+/**
+ * RPL DAG metrics
+ * Routing metric/constraint objects carried in the DAG Metric Container [RFC6551]
+ *
+ * Objects are decoded in place with an iterator over the container data (as for options), and
+ * encoded into a caller supplied buffer which is then added to a message with
+ * RPL_builder_dag_metric. Values are exchanged as uint32_t:
+ *  - Node Energy: the 16 bit object (flags, I, T, E, E_E), see RPL_METRIC_ENERGY_ESTIMATE
+ *  - Hop Count: hops
+ *  - Link Throughput: kbit/s
+ *  - Link Latency: microseconds
+ *  - Link Quality Level: the 8 bit Val/Counter octet, see RPL_METRIC_LQL_VALUE
+ *  - ETX: ETX * 128
+ *
+ * The aggregation kernels work on structure of arrays candidate sets (one entry per parent
+ * candidate) so that a path metric can be recomputed for every candidate in one vectorized pass.
+ */
+
+#ifndef RPL_METRIC_H
+#define RPL_METRIC_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_endian.h"
+#include "rpl_parent.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Routing metric/constraint types [RFC6551 Section 6.1]
+ */
+enum rpl_metric_type_e {
+    RPL_METRIC_NODE_STATE = 1,              //!< Node State and Attribute
+    RPL_METRIC_NODE_ENERGY = 2,             //!< Node Energy
+    RPL_METRIC_HOP_COUNT = 3,               //!< Hop Count
+    RPL_METRIC_LINK_THROUGHPUT = 4,         //!< Link Throughput
+    RPL_METRIC_LINK_LATENCY = 5,            //!< Link Latency
+    RPL_METRIC_LINK_QUALITY_LEVEL = 6,      //!< Link Quality Level
+    RPL_METRIC_ETX = 7,                     //!< Link ETX
+    RPL_METRIC_LINK_COLOR = 8               //!< Link Color
+};
+
+/**
+ * Aggregation (A field) [RFC6551 Section 2.1]
+ */
+enum rpl_metric_aggregation_e {
+    RPL_METRIC_AGGREGATION_ADDITIVE = 0,
+    RPL_METRIC_AGGREGATION_MAXIMUM = 1,
+    RPL_METRIC_AGGREGATION_MINIMUM = 2,
+    RPL_METRIC_AGGREGATION_MULTIPLICATIVE = 3
+};
+
+#define RPL_METRIC_HEADER_LENGTH            4       //!< Type, flags, A, Prec and Length
+
+#define RPL_METRIC_FLAG_PARTIAL             0x04    //!< P: not all nodes on the path recorded the metric (in flags octet)
+#define RPL_METRIC_FLAG_CONSTRAINT          0x02    //!< C: object is a constraint rather than a metric
+#define RPL_METRIC_FLAG_OPTIONAL            0x01    //!< O: constraint is optional
+#define RPL_METRIC_RECORDED_MASK            0x80    //!< R: values recorded along the path rather than aggregated (in A/Prec octet)
+#define RPL_METRIC_AGGREGATION_MASK         0x70
+#define RPL_METRIC_AGGREGATION_SHIFT        4
+#define RPL_METRIC_PRECEDENCE_MASK          0x0F
+
+#define RPL_METRIC_ENERGY_ESTIMATE(value)   ((value) & 0xFF)        //!< E_E, estimated percentage of remaining energy
+#define RPL_METRIC_LQL_VALUE(value)         (((value) >> 5) & 0x07) //!< Link quality level 0..7
+#define RPL_METRIC_LQL_COUNTER(value)       ((value) & 0x1F)        //!< Number of links with this level
+#define RPL_METRIC_LQL(level, counter)      ((uint32_t)(((level) & 0x07) << 5 | ((counter) & 0x1F)))
+
+#define RPL_METRIC_MULTIPLICATIVE_ONE       65536   //!< 1.0 for multiplicative aggregation (16.16 fixed point)
+
+/**
+ * @brief Metric object header
+ */
+struct rpl_metric_s {
+    uint8_t type;                   //!< Routing-MC-Type (see rpl_metric_type_e)
+    uint8_t flags;                  //!< P, C and O flags
+    uint8_t recorded;               //!< R flag
+    uint8_t aggregation;            //!< A field (see rpl_metric_aggregation_e)
+    uint8_t precedence;             //!< Prec field
+};
+
+/**
+ * @brief Metric object view
+ * @details data points at the object body in the container
+ */
+struct rpl_metric_view_s {
+    struct rpl_metric_s header;     //!< Decoded header
+    uint8_t length;                 //!< Body length
+    const uint8_t *data;            //!< Object body
+};
+
+/**
+ * @brief Metric container iterator, errors are sticky
+ */
+struct rpl_metric_iter_s {
+    const uint8_t *position;        //!< Next object
+    const uint8_t *end;             //!< End of the container data
+    int error;                      //!< Set when a malformed object was found
+};
+
+/**
+ * @brief Parent candidate set in structure of arrays layout
+ * @details Index i corresponds to neighbor i of a parent table.
+ */
+struct rpl_metric_candidates_s {
+    uint32_t path[RPL_NEIGHBOR_TABLE_SIZE];     //!< Path metric advertised by each candidate
+    uint32_t link[RPL_NEIGHBOR_TABLE_SIZE];     //!< Metric of the link to each candidate
+    uint32_t cost[RPL_NEIGHBOR_TABLE_SIZE];     //!< Aggregated path metric through each candidate
+    uint16_t count;                             //!< Number of candidates
+};
+
+void RPL_metric_iter_init(struct rpl_metric_iter_s *iter, const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Advance to the next metric object
+ * @return 1 when an object was found, 0 at the end of the container, -1 on a malformed object
+ */
+int RPL_metric_iter_next(struct rpl_metric_iter_s *iter, struct rpl_metric_view_s *metric);
+
+/**
+ * @brief Find the first object of a type in a container
+ * @return 1 when found, 0 when not present, -1 when the container is malformed
+ */
+int RPL_metric_find(const uint8_t *data, uint8_t length, uint8_t type, struct rpl_metric_view_s *metric);
+
+/**
+ * @brief Number of values in an object, 1 unless recorded (0 for types without values)
+ */
+int RPL_metric_count(const struct rpl_metric_view_s *metric);
+
+/**
+ * @brief Decode value index of an object
+ */
+uint32_t RPL_metric_value(const struct rpl_metric_view_s *metric, int index);
+
+/**
+ * @brief Encode a metric object with count values
+ * @details Aggregated objects have a single value, recorded objects one per hop.
+ * @return encoded length, or -1 when the buffer is too small or the object is invalid
+ */
+int RPL_metric_encode(uint8_t *buffer, uint16_t capacity, const struct rpl_metric_s *header, const uint32_t *values, uint8_t count);
+
+/**
+ * @brief Encode a copy of a received recorded object with a value for this hop appended
+ * @return encoded length, or -1 when the buffer is too small or the object would exceed 255 octets
+ */
+int RPL_metric_record(uint8_t *buffer, uint16_t capacity, const struct rpl_metric_view_s *metric, uint32_t value);
+
+/**
+ * @brief Aggregation kernels, cost[i] = path[i] (op) link[i] for i in [0..count)
+ * @details Additive and multiplicative results saturate at UINT32_MAX, multiplicative values
+ * are 16.16 fixed point (RPL_METRIC_MULTIPLICATIVE_ONE).
+ */
+void RPL_metric_aggregate_additive(const uint32_t *path, const uint32_t *link, uint32_t *cost, unsigned count);
+void RPL_metric_aggregate_maximum(const uint32_t *path, const uint32_t *link, uint32_t *cost, unsigned count);
+void RPL_metric_aggregate_minimum(const uint32_t *path, const uint32_t *link, uint32_t *cost, unsigned count);
+void RPL_metric_aggregate_multiplicative(const uint32_t *path, const uint32_t *link, uint32_t *cost, unsigned count);
+
+/**
+ * @brief Aggregate a whole candidate set with the given rpl_metric_aggregation_e
+ * @return 0 on success, -1 on an unknown aggregation
+ */
+int RPL_metric_candidates_aggregate(struct rpl_metric_candidates_s *candidates, uint8_t aggregation);
+
+/**
+ * @brief Index of the candidate with the lowest cost (first on ties), -1 when empty
+ */
+int RPL_metric_candidates_best(const struct rpl_metric_candidates_s *candidates);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,213 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+TEST_GROUP(metric_tests)
+{
+	uint8_t buffer[256];
+	struct rpl_metric_s header;
+
+	void setup() {
+		memset(buffer, 0, sizeof(buffer));
+		memset(&header, 0, sizeof(header));
+	}
+
+	void teardown() {
+	}
+};
+
+TEST(metric_tests, metric_encode_etx) {
+	static const uint8_t expected[] = { RPL_METRIC_ETX, 0x00, 0x05, 0x02, 0x01, 0x80 };
+	uint32_t etx = 384;
+	struct rpl_metric_view_s metric;
+
+	header.type = RPL_METRIC_ETX;
+	header.aggregation = RPL_METRIC_AGGREGATION_ADDITIVE;
+	header.precedence = 5;
+	etx = 384;
+	CHECK_EQUAL(sizeof(expected), RPL_metric_encode(buffer, sizeof(buffer), &header, &etx, 1));
+	MEMCMP_EQUAL(expected, buffer, sizeof(expected));
+
+	CHECK_EQUAL(1, RPL_metric_find(buffer, sizeof(expected), RPL_METRIC_ETX, &metric));
+	CHECK_EQUAL(RPL_METRIC_ETX, metric.header.type);
+	CHECK_EQUAL(5, metric.header.precedence);
+	CHECK_EQUAL(0, metric.header.recorded);
+	CHECK_EQUAL(1, RPL_metric_count(&metric));
+	CHECK_EQUAL(384, RPL_metric_value(&metric, 0));
+}
+
+TEST(metric_tests, metric_header_flags) {
+	static const uint8_t expected[] = { RPL_METRIC_LINK_LATENCY, 0x07, 0xA3, 0x04, 0x00, 0x01, 0x86, 0xA0 };
+	uint32_t latency = 100000;
+	struct rpl_metric_view_s metric;
+
+	header.type = RPL_METRIC_LINK_LATENCY;
+	header.flags = RPL_METRIC_FLAG_PARTIAL | RPL_METRIC_FLAG_CONSTRAINT | RPL_METRIC_FLAG_OPTIONAL;
+	header.recorded = 1;
+	header.aggregation = RPL_METRIC_AGGREGATION_MINIMUM;
+	header.precedence = 3;
+	CHECK_EQUAL(sizeof(expected), RPL_metric_encode(buffer, sizeof(buffer), &header, &latency, 1));
+	MEMCMP_EQUAL(expected, buffer, sizeof(expected));
+
+	CHECK_EQUAL(1, RPL_metric_find(buffer, sizeof(expected), RPL_METRIC_LINK_LATENCY, &metric));
+	CHECK_EQUAL(RPL_METRIC_FLAG_PARTIAL | RPL_METRIC_FLAG_CONSTRAINT | RPL_METRIC_FLAG_OPTIONAL, metric.header.flags);
+	CHECK_EQUAL(1, metric.header.recorded);
+	CHECK_EQUAL(RPL_METRIC_AGGREGATION_MINIMUM, metric.header.aggregation);
+	CHECK_EQUAL(100000, RPL_metric_value(&metric, 0));
+}
+
+//Several objects in one container
+TEST(metric_tests, metric_container) {
+	uint32_t hops = 4;
+	uint32_t energy = 0x0850;
+	uint32_t throughput = 250;
+	uint32_t lql[2] = { RPL_METRIC_LQL(1, 3), RPL_METRIC_LQL(4, 1) };
+	struct rpl_metric_view_s metric;
+	struct rpl_metric_iter_s iter;
+	int length = 0;
+
+	header.type = RPL_METRIC_HOP_COUNT;
+	length += RPL_metric_encode(buffer + length, (uint16_t)(sizeof(buffer) - length), &header, &hops, 1);
+	header.type = RPL_METRIC_NODE_ENERGY;
+	length += RPL_metric_encode(buffer + length, (uint16_t)(sizeof(buffer) - length), &header, &energy, 1);
+	header.type = RPL_METRIC_LINK_THROUGHPUT;
+	length += RPL_metric_encode(buffer + length, (uint16_t)(sizeof(buffer) - length), &header, &throughput, 1);
+	header.type = RPL_METRIC_LINK_QUALITY_LEVEL;
+	length += RPL_metric_encode(buffer + length, (uint16_t)(sizeof(buffer) - length), &header, lql, 2);
+	CHECK_EQUAL(6 + 6 + 8 + 7, length);
+
+	RPL_metric_iter_init(&iter, buffer, (uint8_t)length);
+	CHECK_EQUAL(1, RPL_metric_iter_next(&iter, &metric));
+	CHECK_EQUAL(RPL_METRIC_HOP_COUNT, metric.header.type);
+	CHECK_EQUAL(4, RPL_metric_value(&metric, 0));
+	CHECK_EQUAL(1, RPL_metric_iter_next(&iter, &metric));
+	CHECK_EQUAL(0x50, RPL_METRIC_ENERGY_ESTIMATE(RPL_metric_value(&metric, 0)));
+	CHECK_EQUAL(1, RPL_metric_iter_next(&iter, &metric));
+	CHECK_EQUAL(250, RPL_metric_value(&metric, 0));
+	CHECK_EQUAL(1, RPL_metric_iter_next(&iter, &metric));
+	CHECK_EQUAL(2, RPL_metric_count(&metric));
+	CHECK_EQUAL(4, RPL_METRIC_LQL_VALUE(RPL_metric_value(&metric, 1)));
+	CHECK_EQUAL(1, RPL_METRIC_LQL_COUNTER(RPL_metric_value(&metric, 1)));
+	CHECK_EQUAL(0, RPL_metric_iter_next(&iter, &metric));
+
+	CHECK_EQUAL(0, RPL_metric_find(buffer, (uint8_t)length, RPL_METRIC_ETX, &metric));
+
+	//Types without values are skipped over
+	buffer[0] = RPL_METRIC_LINK_COLOR;
+	CHECK_EQUAL(1, RPL_metric_find(buffer, (uint8_t)length, RPL_METRIC_LINK_COLOR, &metric));
+	CHECK_EQUAL(0, RPL_metric_count(&metric));
+}
+
+TEST(metric_tests, metric_malformed) {
+	uint32_t values[2] = { 128, 256 };
+	struct rpl_metric_view_s metric;
+	struct rpl_metric_iter_s iter;
+
+	//Truncated header and body
+	header.type = RPL_METRIC_ETX;
+	CHECK_EQUAL(6, RPL_metric_encode(buffer, sizeof(buffer), &header, values, 1));
+	CHECK_EQUAL(-1, RPL_metric_find(buffer, 3, RPL_METRIC_ETX, &metric));
+	CHECK_EQUAL(-1, RPL_metric_find(buffer, 5, RPL_METRIC_ETX, &metric));
+
+	//Partial value
+	buffer[3] = 1;
+	CHECK_EQUAL(-1, RPL_metric_find(buffer, 5, RPL_METRIC_ETX, &metric));
+
+	//Several values in an aggregated object
+	buffer[3] = 4;
+	CHECK_EQUAL(-1, RPL_metric_find(buffer, 8, RPL_METRIC_ETX, &metric));
+	CHECK_EQUAL(-1, RPL_metric_encode(buffer, sizeof(buffer), &header, values, 2));
+
+	//Errors are sticky
+	RPL_metric_iter_init(&iter, buffer, 3);
+	CHECK_EQUAL(-1, RPL_metric_iter_next(&iter, &metric));
+	iter.end = buffer + 6;
+	CHECK_EQUAL(-1, RPL_metric_iter_next(&iter, &metric));
+
+	//Out of space and unknown types
+	CHECK_EQUAL(-1, RPL_metric_encode(buffer, 5, &header, values, 1));
+	header.type = RPL_METRIC_NODE_STATE;
+	CHECK_EQUAL(-1, RPL_metric_encode(buffer, sizeof(buffer), &header, values, 1));
+}
+
+//Each hop appends its link value to a recorded object
+TEST(metric_tests, metric_record) {
+	uint8_t next[64];
+	uint32_t etx = 128;
+	struct rpl_metric_view_s metric;
+	int length;
+	int hop;
+
+	header.type = RPL_METRIC_ETX;
+	header.recorded = 1;
+	length = RPL_metric_encode(buffer, sizeof(buffer), &header, &etx, 1);
+	for (hop = 1; hop < 4; hop++) {
+		CHECK_EQUAL(1, RPL_metric_find(buffer, (uint8_t)length, RPL_METRIC_ETX, &metric));
+		length = RPL_metric_record(next, sizeof(next), &metric, (uint32_t)(128 + hop));
+		CHECK_EQUAL(RPL_METRIC_HEADER_LENGTH + 2 * (hop + 1), length);
+		memcpy(buffer, next, (size_t)length);
+	}
+	CHECK_EQUAL(1, RPL_metric_find(buffer, (uint8_t)length, RPL_METRIC_ETX, &metric));
+	CHECK_EQUAL(4, RPL_metric_count(&metric));
+	CHECK_EQUAL(128, RPL_metric_value(&metric, 0));
+	CHECK_EQUAL(131, RPL_metric_value(&metric, 3));
+
+	//Aggregated objects are not recorded
+	header.recorded = 0;
+	length = RPL_metric_encode(buffer, sizeof(buffer), &header, &etx, 1);
+	RPL_metric_find(buffer, (uint8_t)length, RPL_METRIC_ETX, &metric);
+	CHECK_EQUAL(-1, RPL_metric_record(next, sizeof(next), &metric, 128));
+}
+
+TEST(metric_tests, metric_aggregate) {
+	uint32_t path[5] = { 100, 0xFFFFFFF0, 300, RPL_METRIC_MULTIPLICATIVE_ONE / 2, 7 };
+	uint32_t link[5] = { 50, 0x20000, 300, RPL_METRIC_MULTIPLICATIVE_ONE / 2, 9 };
+	uint32_t cost[5];
+
+	RPL_metric_aggregate_additive(path, link, cost, 5);
+	CHECK_EQUAL(150, cost[0]);
+	CHECK_EQUAL(UINT32_MAX, cost[1]);
+	CHECK_EQUAL(600, cost[2]);
+
+	RPL_metric_aggregate_maximum(path, link, cost, 5);
+	CHECK_EQUAL(100, cost[0]);
+	CHECK_EQUAL(9, cost[4]);
+
+	RPL_metric_aggregate_minimum(path, link, cost, 5);
+	CHECK_EQUAL(50, cost[0]);
+	CHECK_EQUAL(7, cost[4]);
+
+	RPL_metric_aggregate_multiplicative(path, link, cost, 5);
+	CHECK_EQUAL(RPL_METRIC_MULTIPLICATIVE_ONE / 4, cost[3]);
+	CHECK_EQUAL(UINT32_MAX, cost[1]);
+}
+
+TEST(metric_tests, metric_candidates) {
+	struct rpl_metric_candidates_s candidates;
+	int i;
+
+	candidates.count = 0;
+	CHECK_EQUAL(-1, RPL_metric_candidates_best(&candidates));
+
+	srand(6551);
+	candidates.count = RPL_NEIGHBOR_TABLE_SIZE;
+	for (i = 0; i < RPL_NEIGHBOR_TABLE_SIZE; i++) {
+		candidates.path[i] = 1000 + (uint32_t)(rand() % 1000);
+		candidates.link[i] = 128 + (uint32_t)(rand() % 384);
+	}
+	candidates.path[5] = 200;
+	candidates.link[5] = 128;
+	candidates.path[9] = 100;
+	candidates.link[9] = 228;
+	CHECK_EQUAL(0, RPL_metric_candidates_aggregate(&candidates, RPL_METRIC_AGGREGATION_ADDITIVE));
+	for (i = 0; i < RPL_NEIGHBOR_TABLE_SIZE; i++) {
+		CHECK_EQUAL(candidates.path[i] + candidates.link[i], candidates.cost[i]);
+	}
+	CHECK_EQUAL(5, RPL_metric_candidates_best(&candidates));
+	CHECK_EQUAL(-1, RPL_metric_candidates_aggregate(&candidates, 4));
+}
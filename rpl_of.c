@@ -0,0 +1,89 @@
+#include <stddef.h>
+
+#include "rpl.h"
+
+static uint16_t RPL_of0_rank_increase_call(rpl_dodag_rank_t parent_rank, uint16_t link_metric, uint16_t min_hop_rank_increase) {
+	return RPL_of0_rank_increase(parent_rank, link_metric, min_hop_rank_increase);
+}
+
+static uint32_t RPL_of0_path_metric_call(uint32_t parent_metric, uint16_t link_metric) {
+	return RPL_of0_path_metric(parent_metric, link_metric);
+}
+
+static uint16_t RPL_mrhof_rank_increase_call(rpl_dodag_rank_t parent_rank, uint16_t link_metric, uint16_t min_hop_rank_increase) {
+	return RPL_mrhof_rank_increase(parent_rank, link_metric, min_hop_rank_increase);
+}
+
+static uint32_t RPL_mrhof_path_metric_call(uint32_t parent_metric, uint16_t link_metric) {
+	return RPL_mrhof_path_metric(parent_metric, link_metric);
+}
+
+const struct rpl_objective_function_s RPL_of0 = {
+	RPL_OCP_OF0, 0, RPL_of0_rank_increase_call, RPL_of0_path_metric_call
+};
+
+const struct rpl_objective_function_s RPL_mrhof = {
+	RPL_OCP_MRHOF, RPL_MRHOF_PARENT_SWITCH_THRESHOLD, RPL_mrhof_rank_increase_call, RPL_mrhof_path_metric_call
+};
+
+static const struct rpl_objective_function_s *RPL_of_registry[RPL_OF_REGISTRY_SIZE];
+
+int RPL_of_register(const struct rpl_objective_function_s *of) {
+	int free_slot = -1;
+	int i;
+
+	for (i = 0; i < RPL_OF_REGISTRY_SIZE; i++) {
+		if (RPL_of_registry[i] == NULL) {
+			if (free_slot < 0) {
+				free_slot = i;
+			}
+		} else if (RPL_of_registry[i]->ocp == of->ocp) {
+			return -1;
+		}
+	}
+	if (free_slot < 0) {
+		return -1;
+	}
+	RPL_of_registry[free_slot] = of;
+	return 0;
+}
+
+int RPL_of_unregister(uint16_t ocp) {
+	int i;
+
+	for (i = 0; i < RPL_OF_REGISTRY_SIZE; i++) {
+		if ((RPL_of_registry[i] != NULL) && (RPL_of_registry[i]->ocp == ocp)) {
+			RPL_of_registry[i] = NULL;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+const struct rpl_objective_function_s *RPL_of_find(uint16_t ocp) {
+	int i;
+
+	for (i = 0; i < RPL_OF_REGISTRY_SIZE; i++) {
+		if ((RPL_of_registry[i] != NULL) && (RPL_of_registry[i]->ocp == ocp)) {
+			return RPL_of_registry[i];
+		}
+	}
+
+	switch (ocp) {
+	case RPL_OCP_OF0:
+		return &RPL_of0;
+	case RPL_OCP_MRHOF:
+		return &RPL_mrhof;
+	default:
+		return NULL;
+	}
+}
+
+void RPL_of_attach(const struct rpl_objective_function_s *of, struct rpl_parent_table_s *table) {
+	RPL_parent_table_set_threshold(table, of->switch_threshold);
+}
+
+int RPL_of_parent_update(const struct rpl_objective_function_s *of, struct rpl_parent_table_s *table, const uint8_t address[16], rpl_dodag_rank_t rank,
+                         uint16_t link_metric) {
+	return RPL_parent_table_update(table, address, rank, of->rank_increase(rank, link_metric, table->min_hop_rank_increase));
+}
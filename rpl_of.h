@@ -0,0 +1,153 @@
+/**
+ * RPL Objective Functions
+ * Rank computation and parent selection policies identified by the Objective Code Point [RFC6550 Section 14]
+ *
+ * Each Objective Function is provided as static inline functions so that a build using a single OF
+ * can call it directly (see RPL_OF_PARENT_UPDATE), and as a rpl_objective_function_s for the
+ * runtime registry used when the OCP is only known from the DODAG Configuration option.
+ *
+ * Implemented:
+ *  - OF0, Objective Function Zero [RFC6552]: rank increase from a step of rank per link
+ *  - MRHOF, Minimum Rank with Hysteresis [RFC6719]: rank from additive ETX path cost
+ *
+ * The link metric passed to an OF is the step of rank (1..9, 0 for the default) for OF0 and the
+ * link ETX in units of 1/128 [RFC6551 Section 4.3.2] for MRHOF.
+ */
+
+#ifndef RPL_OF_H
+#define RPL_OF_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_parent.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_OCP_OF0                         0       //!< Objective Function Zero [RFC6552]
+#define RPL_OCP_MRHOF                       1       //!< Minimum Rank with Hysteresis Objective Function [RFC6719]
+
+#ifndef RPL_OF_REGISTRY_SIZE
+#define RPL_OF_REGISTRY_SIZE                4       //!< Objective Functions that may be registered in addition to the built in ones
+#endif
+
+/*** OF0 [RFC6552 Section 6.3] ***/
+
+#define RPL_OF0_DEFAULT_STEP_OF_RANK        3
+#define RPL_OF0_MINIMUM_STEP_OF_RANK        1
+#define RPL_OF0_MAXIMUM_STEP_OF_RANK        9
+#define RPL_OF0_DEFAULT_RANK_STRETCH        0
+#define RPL_OF0_MAXIMUM_RANK_STRETCH        5
+#define RPL_OF0_DEFAULT_RANK_FACTOR         1
+#define RPL_OF0_MINIMUM_RANK_FACTOR         1
+#define RPL_OF0_MAXIMUM_RANK_FACTOR         4
+
+/*** MRHOF [RFC6719 Section 5] ***/
+
+#define RPL_MRHOF_ETX_DIVISOR               128     //!< ETX of 1.0 [RFC6551 Section 4.3.2]
+#define RPL_MRHOF_MAX_LINK_METRIC           512     //!< Links with a higher ETX are not used
+#define RPL_MRHOF_MAX_PATH_COST             32768   //!< Paths with a higher cost are not used
+#define RPL_MRHOF_PARENT_SWITCH_THRESHOLD   192     //!< Path cost improvement needed to change preferred parent
+
+/**
+ * @brief Objective Function interface
+ */
+struct rpl_objective_function_s {
+    uint16_t ocp;                   //!< Objective Code Point
+    uint16_t switch_threshold;      //!< Hysteresis for the parent table (see RPL_parent_table_set_threshold)
+
+    /**
+     * @brief Rank increase over a link to a neighbor advertising parent_rank
+     * @return increase, or RPL_INFINITE_RANK when the neighbor may not be used as a parent
+     */
+    uint16_t (*rank_increase)(rpl_dodag_rank_t parent_rank, uint16_t link_metric, uint16_t min_hop_rank_increase);
+
+    /**
+     * @brief Path metric through a link from the metric advertised by the parent
+     */
+    uint32_t (*path_metric)(uint32_t parent_metric, uint16_t link_metric);
+};
+
+static inline uint16_t RPL_of0_rank_increase(rpl_dodag_rank_t parent_rank, uint16_t link_metric, uint16_t min_hop_rank_increase) {
+    uint32_t step = (link_metric == 0) ? RPL_OF0_DEFAULT_STEP_OF_RANK : link_metric;
+    uint32_t increase;
+
+    (void)parent_rank;
+    if (step < RPL_OF0_MINIMUM_STEP_OF_RANK) {
+        step = RPL_OF0_MINIMUM_STEP_OF_RANK;
+    } else if (step > RPL_OF0_MAXIMUM_STEP_OF_RANK) {
+        step = RPL_OF0_MAXIMUM_STEP_OF_RANK;
+    }
+
+    //R(N) = R(P) + rank_increase, rank_increase = (Rf * Sp + Sr) * MinHopRankIncrease [RFC6552 Section 4.1]
+    increase = (RPL_OF0_DEFAULT_RANK_FACTOR * step + RPL_OF0_DEFAULT_RANK_STRETCH) * (uint32_t)min_hop_rank_increase;
+    return (increase > RPL_INFINITE_RANK) ? RPL_INFINITE_RANK : (uint16_t)increase;
+}
+
+//OF0 does not use metrics, the path metric is the hop count
+static inline uint32_t RPL_of0_path_metric(uint32_t parent_metric, uint16_t link_metric) {
+    (void)link_metric;
+    return parent_metric + 1;
+}
+
+static inline uint16_t RPL_mrhof_rank_increase(rpl_dodag_rank_t parent_rank, uint16_t link_metric, uint16_t min_hop_rank_increase) {
+    (void)min_hop_rank_increase;
+
+    //Links and paths above the maximum cost are excluded from the parent set [RFC6719 Section 3.2.2]
+    if ((link_metric > RPL_MRHOF_MAX_LINK_METRIC) || ((uint32_t)parent_rank + link_metric > RPL_MRHOF_MAX_PATH_COST)) {
+        return RPL_INFINITE_RANK;
+    }
+    return (link_metric == 0) ? RPL_MRHOF_ETX_DIVISOR : link_metric;
+}
+
+//ETX is additive along the path [RFC6719 Section 3.1]
+static inline uint32_t RPL_mrhof_path_metric(uint32_t parent_metric, uint16_t link_metric) {
+    return parent_metric + link_metric;
+}
+
+/**
+ * @brief Update a neighbor from a DIO using an Objective Function known at compile time
+ * @details of is the OF name used in the inline functions (of0, mrhof).
+ * eg. RPL_OF_PARENT_UPDATE(mrhof, &table, address, rank, etx)
+ */
+#define RPL_OF_PARENT_UPDATE(of, table, address, rank, link_metric) \
+    RPL_parent_table_update((table), (address), (rank), RPL_##of##_rank_increase((rank), (link_metric), (table)->min_hop_rank_increase))
+
+extern const struct rpl_objective_function_s RPL_of0;
+extern const struct rpl_objective_function_s RPL_mrhof;
+
+/**
+ * @brief Add an Objective Function to the runtime registry
+ * @details Registered functions take precedence over the built in ones with the same OCP.
+ * The registry is global, register functions before processing messages.
+ *
+ * @return 0 on success, -1 when the OCP is already registered or the registry is full
+ */
+int RPL_of_register(const struct rpl_objective_function_s *of);
+int RPL_of_unregister(uint16_t ocp);
+
+/**
+ * @brief Find the Objective Function for an OCP
+ * @return the Objective Function, NULL when the OCP is not supported
+ */
+const struct rpl_objective_function_s *RPL_of_find(uint16_t ocp);
+
+/**
+ * @brief Use an Objective Function for a parent table (sets the parent switch hysteresis)
+ */
+void RPL_of_attach(const struct rpl_objective_function_s *of, struct rpl_parent_table_s *table);
+
+/**
+ * @brief Update a neighbor from a DIO using an Objective Function found at runtime
+ * @return neighbor index, or -1 when the table is full
+ */
+int RPL_of_parent_update(const struct rpl_objective_function_s *of, struct rpl_parent_table_s *table, const uint8_t address[16], rpl_dodag_rank_t rank,
+                         uint16_t link_metric);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static uint16_t hop_rank_increase(rpl_dodag_rank_t parent_rank, uint16_t link_metric, uint16_t min_hop_rank_increase) {
+	(void)parent_rank;
+	(void)link_metric;
+	return min_hop_rank_increase;
+}
+
+static uint32_t hop_path_metric(uint32_t parent_metric, uint16_t link_metric) {
+	(void)link_metric;
+	return parent_metric + 1;
+}
+
+static const struct rpl_objective_function_s test_of = { 0x8000, 0, hop_rank_increase, hop_path_metric };
+static const struct rpl_objective_function_s test_of0 = { RPL_OCP_OF0, 0, hop_rank_increase, hop_path_metric };
+
+TEST_GROUP(of_tests)
+{
+	struct rpl_parent_table_s table;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[8];
+	rpl_address_handle_t index[8];
+	uint8_t address[4][16];
+
+	void setup() {
+		int i;
+
+		memset(address, 0, sizeof(address));
+		for (i = 0; i < 4; i++) {
+			address[i][0] = 0xFE;
+			address[i][1] = 0x80;
+			address[i][15] = (uint8_t)(i + 1);
+		}
+		RPL_address_table_init(&addresses, entries, 8, index, 8);
+		RPL_parent_table_init(&table, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	}
+
+	void teardown() {
+		RPL_of_unregister(test_of.ocp);
+		RPL_of_unregister(test_of0.ocp);
+	}
+};
+
+//rank_increase = (Rf * Sp + Sr) * MinHopRankIncrease [RFC6552 Section 4.1]
+TEST(of_tests, of0_rank_increase) {
+	CHECK_EQUAL(3 * 256, RPL_of0_rank_increase(256, 0, 256));
+	CHECK_EQUAL(256, RPL_of0_rank_increase(256, 1, 256));
+	CHECK_EQUAL(9 * 128, RPL_of0_rank_increase(256, 20, 128));
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_of0_rank_increase(256, 9, 0x4000));
+	CHECK_EQUAL(4, RPL_of0_path_metric(3, 7));
+}
+
+TEST(of_tests, mrhof_rank_increase) {
+	CHECK_EQUAL(RPL_MRHOF_ETX_DIVISOR, RPL_mrhof_rank_increase(256, 0, 256));
+	CHECK_EQUAL(300, RPL_mrhof_rank_increase(256, 300, 256));
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_mrhof_rank_increase(256, RPL_MRHOF_MAX_LINK_METRIC + 1, 256));
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_mrhof_rank_increase(RPL_MRHOF_MAX_PATH_COST, 128, 256));
+	CHECK_EQUAL(500, RPL_mrhof_path_metric(300, 200));
+}
+
+TEST(of_tests, of_find) {
+	POINTERS_EQUAL(&RPL_of0, RPL_of_find(RPL_OCP_OF0));
+	POINTERS_EQUAL(&RPL_mrhof, RPL_of_find(RPL_OCP_MRHOF));
+	POINTERS_EQUAL(NULL, RPL_of_find(test_of.ocp));
+
+	CHECK_EQUAL(0, RPL_of_register(&test_of));
+	CHECK_EQUAL(-1, RPL_of_register(&test_of));
+	POINTERS_EQUAL(&test_of, RPL_of_find(test_of.ocp));
+
+	//Registered functions replace the built in ones
+	CHECK_EQUAL(0, RPL_of_register(&test_of0));
+	POINTERS_EQUAL(&test_of0, RPL_of_find(RPL_OCP_OF0));
+	CHECK_EQUAL(0, RPL_of_unregister(RPL_OCP_OF0));
+	POINTERS_EQUAL(&RPL_of0, RPL_of_find(RPL_OCP_OF0));
+
+	CHECK_EQUAL(0, RPL_of_unregister(test_of.ocp));
+	CHECK_EQUAL(-1, RPL_of_unregister(test_of.ocp));
+}
+
+TEST(of_tests, of_registry_full) {
+	struct rpl_objective_function_s of[RPL_OF_REGISTRY_SIZE + 1];
+	int i;
+
+	for (i = 0; i <= RPL_OF_REGISTRY_SIZE; i++) {
+		of[i] = test_of;
+		of[i].ocp = (uint16_t)(0x100 + i);
+		CHECK_EQUAL((i < RPL_OF_REGISTRY_SIZE) ? 0 : -1, RPL_of_register(&of[i]));
+	}
+	for (i = 0; i < RPL_OF_REGISTRY_SIZE; i++) {
+		CHECK_EQUAL(0, RPL_of_unregister(of[i].ocp));
+	}
+}
+
+//The compile time and runtime paths give the same table
+TEST(of_tests, of_parent_update) {
+	struct rpl_parent_table_s runtime;
+	const struct rpl_objective_function_s *of = RPL_of_find(RPL_OCP_OF0);
+
+	RPL_parent_table_init(&runtime, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	RPL_OF_PARENT_UPDATE(of0, &table, address[0], 256, 0);
+	RPL_OF_PARENT_UPDATE(of0, &table, address[1], 512, 1);
+	RPL_of_parent_update(of, &runtime, address[0], 256, 0);
+	RPL_of_parent_update(of, &runtime, address[1], 512, 1);
+	CHECK_EQUAL(768, RPL_parent_table_rank(&table));
+	CHECK_EQUAL(1, table.preferred);
+	CHECK_EQUAL(RPL_parent_table_rank(&table), RPL_parent_table_rank(&runtime));
+	CHECK_EQUAL(table.preferred, runtime.preferred);
+}
+
+//MRHOF only changes preferred parent when the path cost improves by more than PARENT_SWITCH_THRESHOLD
+TEST(of_tests, mrhof_hysteresis) {
+	RPL_parent_table_init(&table, &addresses, RPL_MRHOF_ETX_DIVISOR, 0);
+	RPL_of_attach(&RPL_mrhof, &table);
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[0], 1000, 256);
+	CHECK_EQUAL(0, table.preferred);
+	CHECK_EQUAL(1256, RPL_parent_table_rank(&table));
+
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[1], 1000, 128);
+	CHECK_EQUAL(0, table.preferred);
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[2], 900, 200);
+	CHECK_EQUAL(0, table.preferred);
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[3], 800, 128);
+	CHECK_EQUAL(3, table.preferred);
+	CHECK_EQUAL(928, RPL_parent_table_rank(&table));
+
+	//A preferred parent that gets worse is kept while within the threshold
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[3], 900, 128);
+	CHECK_EQUAL(3, table.preferred);
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[3], 1100, 128);
+	CHECK_EQUAL(3, table.preferred);
+	CHECK_EQUAL(1228, RPL_parent_table_rank(&table));
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[3], 1400, 128);
+	CHECK_EQUAL(2, table.preferred);
+	CHECK_EQUAL(1100, RPL_parent_table_rank(&table));
+
+	//Links above MAX_LINK_METRIC are not used
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[2], 900, 600);
+	CHECK_EQUAL(RPL_INFINITE_RANK, table.neighbors[2].path_rank);
+	CHECK_EQUAL(1, table.preferred);
+}
+
+//With the default MinHopRankIncrease links of ETX below 2 are still told apart, only the rank is
+//raised to the integral rank above the parent [RFC6719 Section 3.3]
+TEST(of_tests, mrhof_min_hop_rank_increase) {
+	RPL_of_attach(&RPL_mrhof, &table);
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[0], 256, 448);
+	CHECK_EQUAL(704, RPL_parent_table_rank(&table));
+
+	RPL_OF_PARENT_UPDATE(mrhof, &table, address[1], 256, RPL_MRHOF_ETX_DIVISOR);
+	CHECK_EQUAL(384, table.neighbors[1].path_rank);
+	CHECK_EQUAL(1, table.preferred);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+	CHECK(RPL_parent_table_is_parent(&table, 1));
+}
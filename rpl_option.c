@@ -0,0 +1,155 @@
+#include "rpl.h"
+
+//Option handling, section 6.7
+
+#define RPL_OPTION_BIT(type)       (1UL << (type))
+
+#define RPL_DIO_OPTIONS_ALLOWED     (RPL_OPTION_BIT(RPL_DIO_OPTION_PAD1) | RPL_OPTION_BIT(RPL_DIO_OPTION_PADN) \
+                                    | RPL_OPTION_BIT(RPL_DIO_OPTION_DAG_METRIC_CONTAINER) | RPL_OPTION_BIT(RPL_DIO_OPTION_ROUTING_INFO) \
+                                    | RPL_OPTION_BIT(RPL_DIO_OPTION_DODAG_CONFIG) | RPL_OPTION_BIT(RPL_DIO_OPTION_PREFIX_INFO))
+#define RPL_DAO_OPTIONS_ALLOWED     (RPL_OPTION_BIT(RPL_DAO_OPTION_PAD1) | RPL_OPTION_BIT(RPL_DAO_OPTION_PADN) \
+                                    | RPL_OPTION_BIT(RPL_DAO_OPTION_RPL_TARGET) | RPL_OPTION_BIT(RPL_DAO_OPTION_TRANSIT_INFORMATION) \
+                                    | RPL_OPTION_BIT(RPL_DAO_OPTION_RPL_TARGET_DESCRIPTOR))
+#define RPL_DIS_OPTIONS_ALLOWED     (RPL_OPTION_BIT(RPL_DIS_OPTION_PAD1) | RPL_OPTION_BIT(RPL_DIS_OPTION_PADN) \
+                                    | RPL_OPTION_BIT(RPL_DIS_OPTION_SOLICITED))
+#define RPL_CC_OPTIONS_ALLOWED      (RPL_OPTION_BIT(RPL_CC_OPTION_PAD1) | RPL_OPTION_BIT(RPL_CC_OPTION_PADN))
+#define RPL_DAO_ACK_OPTIONS_ALLOWED (RPL_OPTION_BIT(RPL_OPTION_PAD1) | RPL_OPTION_BIT(RPL_OPTION_PADN))
+
+//Valid option data lengths by option type, variable length options are checked further below
+static const uint8_t rpl_option_min_length[RPL_OPTION_TYPE_MAX + 1] = {
+	0,                                          //Pad1 (no length field)
+	0,                                          //PadN
+	0,                                          //DAG Metric Container
+	6,                                          //Route Information
+	RPL_OPTION_DODAG_CONFIGURATION_LENGTH,      //DODAG Configuration
+	2,                                          //RPL Target
+	RPL_OPTION_TRANSIT_INFO_LENGTH,             //Transit Information
+	RPL_OPTION_SOLICITED_INFO_LENGTH,           //Solicited Information
+	RPL_OPTION_PREFIX_INFO_LENGTH,              //Prefix Information
+	RPL_OPTION_TARGET_DESCRIPTOR_LENGTH         //RPL Target Descriptor
+};
+
+static const uint8_t rpl_option_max_length[RPL_OPTION_TYPE_MAX + 1] = {
+	0,
+	RPL_OPTION_PADN_MAX_LENGTH,
+	255,
+	6 + RPL_DODAG_ID_LENGTH,
+	RPL_OPTION_DODAG_CONFIGURATION_LENGTH,
+	2 + RPL_DODAG_ID_LENGTH,
+	RPL_OPTION_TRANSIT_INFO_LENGTH + RPL_DODAG_ID_LENGTH,
+	RPL_OPTION_SOLICITED_INFO_LENGTH,
+	RPL_OPTION_PREFIX_INFO_LENGTH,
+	RPL_OPTION_TARGET_DESCRIPTOR_LENGTH
+};
+
+uint32_t RPL_option_allowed(uint8_t message_code) {
+	switch (message_code) {
+	case RPL_DODAG_INFORMATION_OBJECT:
+	case RPL_SECURE_DODAG_INFORMATION_OBJECT:
+		return RPL_DIO_OPTIONS_ALLOWED;
+	case RPL_DESTINATION_ADVERTISEMENt_OBJECT:
+	case RPL_SECURE_DESTINATION_ADVERTISEMENt_OBJECT:
+		return RPL_DAO_OPTIONS_ALLOWED;
+	case RPL_DESTINATION_ADVERTISEMENT_OBJECT_ACK:
+	case RPL_SECURE_DESTINATION_ADVERTISEMENT_OBJECT_ACK:
+		return RPL_DAO_ACK_OPTIONS_ALLOWED;
+	case RPL_DODAG_INFORMATION_SOLICITATION:
+	case RPL_SECURE_DODAG_INFORMATION_SOLICITATION:
+		return RPL_DIS_OPTIONS_ALLOWED;
+	case RPL_CONSISTENCY_CHECK:
+		return RPL_CC_OPTIONS_ALLOWED;
+	default:
+		return 0;
+	}
+}
+
+void RPL_option_iter_init(struct rpl_option_iter_s *iter, uint8_t message_code, const uint8_t *options, uint16_t length) {
+	iter->position = options;
+	iter->end = options + length;
+	iter->allowed = RPL_option_allowed(message_code);
+	iter->error = 0;
+}
+
+//Checks the prefix of Route Information and RPL Target options fits in the prefix field
+static int RPL_option_prefix_valid(uint8_t prefix_length, uint8_t field_length) {
+	return (prefix_length <= 128) && (prefix_length <= field_length * 8);
+}
+
+static int RPL_option_length_valid(uint8_t type, uint8_t length, const uint8_t *data) {
+	if ((length < rpl_option_min_length[type]) || (length > rpl_option_max_length[type])) {
+		return 0;
+	}
+
+	switch (type) {
+	case RPL_OPTION_ROUTE_INFO:
+		return RPL_option_prefix_valid(data[0], length - 6);
+	case RPL_OPTION_RPL_TARGET:
+		return RPL_option_prefix_valid(data[1], length - 2);
+	case RPL_OPTION_TRANSIT_INFO:
+		//Parent Address is either absent or a complete IPv6 address
+		return (length == RPL_OPTION_TRANSIT_INFO_LENGTH) || (length == RPL_OPTION_TRANSIT_INFO_LENGTH + RPL_DODAG_ID_LENGTH);
+	default:
+		return 1;
+	}
+}
+
+static int RPL_option_iter_fail(struct rpl_option_iter_s *iter) {
+	iter->error = 1;
+	iter->position = iter->end;
+	return -1;
+}
+
+int RPL_option_iter_next(struct rpl_option_iter_s *iter, struct rpl_option_view_s *option) {
+	while (iter->position < iter->end) {
+		const uint8_t *position = iter->position;
+		uint8_t type = position[0];
+		uint8_t length;
+
+		if ((type > RPL_OPTION_TYPE_MAX) || !(iter->allowed & RPL_OPTION_BIT(type))) {
+			return RPL_option_iter_fail(iter);
+		}
+
+		//Pad1 is a single octet with no length or data
+		if (type == RPL_OPTION_PAD1) {
+			iter->position++;
+			continue;
+		}
+
+		if (iter->end - position < RPL_OPTION_HEADER_LENGTH) {
+			return RPL_option_iter_fail(iter);
+		}
+		length = position[1];
+		if (iter->end - position - RPL_OPTION_HEADER_LENGTH < length) {
+			return RPL_option_iter_fail(iter);
+		}
+		if (!RPL_option_length_valid(type, length, position + RPL_OPTION_HEADER_LENGTH)) {
+			return RPL_option_iter_fail(iter);
+		}
+
+		iter->position = position + RPL_OPTION_HEADER_LENGTH + length;
+		if (type == RPL_OPTION_PADN) {
+			continue;
+		}
+
+		option->type = type;
+		option->length = length;
+		option->data = position + RPL_OPTION_HEADER_LENGTH;
+		return 1;
+	}
+
+	return iter->error ? -1 : 0;
+}
+
+int RPL_option_validate(uint8_t message_code, const uint8_t *options, uint16_t length) {
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option;
+	int count = 0;
+	int res;
+
+	RPL_option_iter_init(&iter, message_code, options, length);
+	while ((res = RPL_option_iter_next(&iter, &option)) > 0) {
+		count++;
+	}
+
+	return (res < 0) ? -1 : count;
+}
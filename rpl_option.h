@@ -0,0 +1,213 @@
+/**
+ * RPL control message options
+ * Single pass iterator over the option area of a control message [RFC6550 Section 6.7]
+ *
+ * The iterator validates each option as it is reached: the option must be permitted in the
+ * message type (see rpl_dio_options_s, rpl_dao_options_e, rpl_dis_option_e, rpl_cc_option_e),
+ * must fit in the option area and must have a valid length for its type. Pad1 and PadN
+ * options are validated and skipped. Option views point into the message buffer, fields are
+ * decoded on access in network byte order.
+ */
+
+#ifndef RPL_OPTION_H
+#define RPL_OPTION_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_endian.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_OPTION_HEADER_LENGTH                2       //!< Option type and length (all options except Pad1)
+#define RPL_OPTION_TYPE_MAX                     RPL_OPTION_TARGET_DESCRIPTOR
+
+#define RPL_OPTION_DODAG_CONFIGURATION_LENGTH   14      //!< [RFC6550 Section 6.7.6]
+#define RPL_OPTION_SOLICITED_INFO_LENGTH        19      //!< [RFC6550 Section 6.7.9]
+#define RPL_OPTION_PREFIX_INFO_LENGTH           30      //!< [RFC6550 Section 6.7.10]
+#define RPL_OPTION_TARGET_DESCRIPTOR_LENGTH     4       //!< [RFC6550 Section 6.7.11]
+#define RPL_OPTION_TRANSIT_INFO_LENGTH          4       //!< [RFC6550 Section 6.7.8] without the Parent Address
+#define RPL_OPTION_PADN_MAX_LENGTH              5       //!< 7 octets of padding
+
+/**
+ * @brief Option view
+ * @details type and length as on the wire, data points at the option data in the message buffer
+ */
+struct rpl_option_view_s {
+    uint8_t type;                   //!< Option type (see rpl_option_type_e)
+    uint8_t length;                 //!< Option data length
+    const uint8_t *data;            //!< Option data
+};
+
+/**
+ * @brief Option iterator
+ * @details Once an error has been found the iterator stays in the error state.
+ */
+struct rpl_option_iter_s {
+    const uint8_t *position;        //!< Next option
+    const uint8_t *end;             //!< End of the option area
+    uint32_t allowed;               //!< Bit per option type permitted in this message type
+    int error;                      //!< Set when a malformed option was found
+};
+
+uint32_t RPL_option_allowed(uint8_t message_code);
+
+void RPL_option_iter_init(struct rpl_option_iter_s *iter, uint8_t message_code, const uint8_t *options, uint16_t length);
+
+/**
+ * @brief Advance to the next (non padding) option
+ *
+ * @param iter iterator
+ * @param option filled with the next option
+ * @return 1 when an option was found, 0 at the end of the options, -1 on a malformed option
+ */
+int RPL_option_iter_next(struct rpl_option_iter_s *iter, struct rpl_option_view_s *option);
+
+/**
+ * @brief Validate a whole option area
+ * @return number of (non padding) options, or -1 if any option is malformed
+ */
+int RPL_option_validate(uint8_t message_code, const uint8_t *options, uint16_t length);
+
+/*** Route Information [RFC6550 Section 6.7.5] ***/
+
+static inline uint8_t RPL_option_route_info_prefix_length(const struct rpl_option_view_s *option) {
+    return option->data[0];
+}
+
+static inline uint8_t RPL_option_route_info_preference(const struct rpl_option_view_s *option) {
+    return (option->data[1] >> RPL_OPTION_ROUTE_INGO_PRF_SHIFT) & 0x03;
+}
+
+static inline uint32_t RPL_option_route_info_lifetime(const struct rpl_option_view_s *option) {
+    return RPL_read_uint32(option->data + 2);
+}
+
+static inline const uint8_t *RPL_option_route_info_prefix(const struct rpl_option_view_s *option) {
+    return option->data + 6;
+}
+
+/*** DODAG Configuration [RFC6550 Section 6.7.6] ***/
+
+static inline uint8_t RPL_option_dodag_config_flags(const struct rpl_option_view_s *option) {
+    return option->data[0];
+}
+
+static inline uint8_t RPL_option_dodag_config_dio_int_double(const struct rpl_option_view_s *option) {
+    return option->data[1];
+}
+
+static inline uint8_t RPL_option_dodag_config_dio_int_min(const struct rpl_option_view_s *option) {
+    return option->data[2];
+}
+
+static inline uint8_t RPL_option_dodag_config_dio_redun(const struct rpl_option_view_s *option) {
+    return option->data[3];
+}
+
+static inline uint16_t RPL_option_dodag_config_max_rank_increase(const struct rpl_option_view_s *option) {
+    return RPL_read_uint16(option->data + 4);
+}
+
+static inline uint16_t RPL_option_dodag_config_min_hop_rank_increase(const struct rpl_option_view_s *option) {
+    return RPL_read_uint16(option->data + 6);
+}
+
+static inline uint16_t RPL_option_dodag_config_objective_code_point(const struct rpl_option_view_s *option) {
+    return RPL_read_uint16(option->data + 8);
+}
+
+static inline uint8_t RPL_option_dodag_config_default_lifetime(const struct rpl_option_view_s *option) {
+    return option->data[11];
+}
+
+static inline uint16_t RPL_option_dodag_config_lifetime_unit(const struct rpl_option_view_s *option) {
+    return RPL_read_uint16(option->data + 12);
+}
+
+/*** RPL Target [RFC6550 Section 6.7.7] ***/
+
+static inline uint8_t RPL_option_target_prefix_length(const struct rpl_option_view_s *option) {
+    return option->data[1];
+}
+
+static inline const uint8_t *RPL_option_target_prefix(const struct rpl_option_view_s *option) {
+    return option->data + 2;
+}
+
+/*** Transit Information [RFC6550 Section 6.7.8] ***/
+
+static inline int RPL_option_transit_info_external(const struct rpl_option_view_s *option) {
+    return (option->data[0] & RPL_OPTION_TRANSIT_INFO_EXTERNAL_MASK) != 0;
+}
+
+static inline uint8_t RPL_option_transit_info_path_control(const struct rpl_option_view_s *option) {
+    return option->data[1];
+}
+
+static inline uint8_t RPL_option_transit_info_path_sequence(const struct rpl_option_view_s *option) {
+    return option->data[2];
+}
+
+static inline uint8_t RPL_option_transit_info_path_lifetime(const struct rpl_option_view_s *option) {
+    return option->data[3];
+}
+
+//Returns the Parent Address when present (non-storing mode), NULL otherwise
+static inline const uint8_t *RPL_option_transit_info_parent_address(const struct rpl_option_view_s *option) {
+    return (option->length > RPL_OPTION_TRANSIT_INFO_LENGTH) ? option->data + RPL_OPTION_TRANSIT_INFO_LENGTH : NULL;
+}
+
+/*** Solicited Information [RFC6550 Section 6.7.9] ***/
+
+static inline rpl_instance_t RPL_option_solicited_info_instance_id(const struct rpl_option_view_s *option) {
+    return option->data[0];
+}
+
+static inline uint8_t RPL_option_solicited_info_flags(const struct rpl_option_view_s *option) {
+    return option->data[1];
+}
+
+static inline const uint8_t *RPL_option_solicited_info_dodag_id(const struct rpl_option_view_s *option) {
+    return option->data + 2;
+}
+
+static inline rpl_dodag_version_t RPL_option_solicited_info_version(const struct rpl_option_view_s *option) {
+    return option->data[2 + RPL_DODAG_ID_LENGTH];
+}
+
+/*** Prefix Information [RFC6550 Section 6.7.10] ***/
+
+static inline uint8_t RPL_option_prefix_info_prefix_length(const struct rpl_option_view_s *option) {
+    return option->data[0];
+}
+
+static inline uint8_t RPL_option_prefix_info_flags(const struct rpl_option_view_s *option) {
+    return option->data[1];
+}
+
+static inline uint32_t RPL_option_prefix_info_valid_lifetime(const struct rpl_option_view_s *option) {
+    return RPL_read_uint32(option->data + 2);
+}
+
+static inline uint32_t RPL_option_prefix_info_preferred_lifetime(const struct rpl_option_view_s *option) {
+    return RPL_read_uint32(option->data + 6);
+}
+
+static inline const uint8_t *RPL_option_prefix_info_prefix(const struct rpl_option_view_s *option) {
+    return option->data + 14;
+}
+
+/*** RPL Target Descriptor [RFC6550 Section 6.7.11] ***/
+
+static inline uint32_t RPL_option_target_descriptor(const struct rpl_option_view_s *option) {
+    return RPL_read_uint32(option->data);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+TEST_GROUP(option_tests)
+{
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option;
+
+	void setup() {
+		CHECK_EQUAL(0, 0);
+	}
+
+	void teardown() {
+
+	}
+};
+
+//6.7 DIO options, with padding between them
+TEST(option_tests, dio_option_walk_test) {
+	uint8_t options[] = {
+		RPL_OPTION_PAD1,
+		RPL_OPTION_PADN, 1, 0,
+		RPL_OPTION_DODAG_CONFIGURATION, RPL_OPTION_DODAG_CONFIGURATION_LENGTH,
+			0x08, 20, 3, 10, 0x07, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x1E, 0x00, 0x3C,
+		RPL_OPTION_PREFIX_INFO, RPL_OPTION_PREFIX_INFO_LENGTH,
+			64, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, 0x00, 0x00, 0x0E, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0,
+			0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		RPL_OPTION_PAD1
+	};
+
+	RPL_option_iter_init(&iter, RPL_DODAG_INFORMATION_OBJECT, options, sizeof(options));
+
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(RPL_OPTION_DODAG_CONFIGURATION, option.type);
+	POINTERS_EQUAL(options + 6, option.data);
+	CHECK_EQUAL(20, RPL_option_dodag_config_dio_int_double(&option));
+	CHECK_EQUAL(3, RPL_option_dodag_config_dio_int_min(&option));
+	CHECK_EQUAL(10, RPL_option_dodag_config_dio_redun(&option));
+	CHECK_EQUAL(0x0700, RPL_option_dodag_config_max_rank_increase(&option));
+	CHECK_EQUAL(0x0100, RPL_option_dodag_config_min_hop_rank_increase(&option));
+	CHECK_EQUAL(1, RPL_option_dodag_config_objective_code_point(&option));
+	CHECK_EQUAL(0x1E, RPL_option_dodag_config_default_lifetime(&option));
+	CHECK_EQUAL(0x3C, RPL_option_dodag_config_lifetime_unit(&option));
+
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(RPL_OPTION_PREFIX_INFO, option.type);
+	CHECK_EQUAL(64, RPL_option_prefix_info_prefix_length(&option));
+	CHECK_EQUAL(3600, RPL_option_prefix_info_valid_lifetime(&option));
+	CHECK_EQUAL(0xFFFFFFFF, RPL_option_prefix_info_preferred_lifetime(&option));
+	CHECK_EQUAL(0x20, RPL_option_prefix_info_prefix(&option)[0]);
+
+	CHECK_EQUAL(0, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(0, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(2, RPL_option_validate(RPL_DODAG_INFORMATION_OBJECT, options, sizeof(options)));
+}
+
+//6.7.7 and 6.7.8 Targets followed by Transit Information
+TEST(option_tests, dao_option_walk_test) {
+	uint8_t options[] = {
+		RPL_OPTION_RPL_TARGET, 10, 0, 64, 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 1,
+		RPL_OPTION_TARGET_DESCRIPTOR, RPL_OPTION_TARGET_DESCRIPTOR_LENGTH, 0xDE, 0xAD, 0xBE, 0xEF,
+		RPL_OPTION_TRANSIT_INFO, RPL_OPTION_TRANSIT_INFO_LENGTH, RPL_OPTION_TRANSIT_INFO_EXTERNAL_ON, 0, 241, 0xFF
+	};
+
+	RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, options, sizeof(options));
+
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(RPL_OPTION_RPL_TARGET, option.type);
+	CHECK_EQUAL(64, RPL_option_target_prefix_length(&option));
+	POINTERS_EQUAL(options + 4, RPL_option_target_prefix(&option));
+
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(0xDEADBEEF, RPL_option_target_descriptor(&option));
+
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(1, RPL_option_transit_info_external(&option));
+	CHECK_EQUAL(241, RPL_option_transit_info_path_sequence(&option));
+	CHECK_EQUAL(0xFF, RPL_option_transit_info_path_lifetime(&option));
+	POINTERS_EQUAL(NULL, RPL_option_transit_info_parent_address(&option));
+
+	CHECK_EQUAL(0, RPL_option_iter_next(&iter, &option));
+}
+
+//Options must be permitted in the message type
+TEST(option_tests, option_allow_list_test) {
+	uint8_t config[2 + RPL_OPTION_DODAG_CONFIGURATION_LENGTH] = { RPL_OPTION_DODAG_CONFIGURATION, RPL_OPTION_DODAG_CONFIGURATION_LENGTH };
+	uint8_t unknown[] = { 0x20, 0 };
+	uint8_t padding[] = { RPL_OPTION_PAD1, RPL_OPTION_PADN, 0, 0 };
+
+	CHECK_EQUAL(1, RPL_option_validate(RPL_DODAG_INFORMATION_OBJECT, config, sizeof(config)));
+	CHECK_EQUAL(1, RPL_option_validate(RPL_SECURE_DODAG_INFORMATION_OBJECT, config, sizeof(config)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, config, sizeof(config)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DODAG_INFORMATION_SOLICITATION, config, sizeof(config)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_CONSISTENCY_CHECK, config, sizeof(config)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DODAG_INFORMATION_OBJECT, unknown, sizeof(unknown)));
+
+	//Padding is allowed everywhere
+	CHECK_EQUAL(0, RPL_option_validate(RPL_CONSISTENCY_CHECK, padding, sizeof(padding)));
+	CHECK_EQUAL(0, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENT_OBJECT_ACK, padding, sizeof(padding)));
+}
+
+//Options with the wrong length, or running past the end of the message
+TEST(option_tests, option_malformed_test) {
+	uint8_t solicited[2 + RPL_OPTION_SOLICITED_INFO_LENGTH] = { RPL_OPTION_SOLICITED_INFO, RPL_OPTION_SOLICITED_INFO_LENGTH };
+	uint8_t padn_long[] = { RPL_OPTION_PADN, 6, 0, 0, 0, 0, 0, 0 };
+	uint8_t transit_short_parent[] = { RPL_OPTION_TRANSIT_INFO, 8, 0, 0, 0, 0, 0, 0, 0, 0 };
+	uint8_t target_long_prefix[] = { RPL_OPTION_RPL_TARGET, 4, 0, 17, 0, 0 };
+	uint8_t truncated_header[] = { RPL_OPTION_PAD1, RPL_OPTION_RPL_TARGET };
+
+	CHECK_EQUAL(1, RPL_option_validate(RPL_DODAG_INFORMATION_SOLICITATION, solicited, sizeof(solicited)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DODAG_INFORMATION_SOLICITATION, solicited, sizeof(solicited) - 1));
+	solicited[1] = RPL_OPTION_SOLICITED_INFO_LENGTH - 1;
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DODAG_INFORMATION_SOLICITATION, solicited, sizeof(solicited) - 1));
+
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DODAG_INFORMATION_OBJECT, padn_long, sizeof(padn_long)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, transit_short_parent, sizeof(transit_short_parent)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, target_long_prefix, sizeof(target_long_prefix)));
+	CHECK_EQUAL(-1, RPL_option_validate(RPL_DESTINATION_ADVERTISEMENt_OBJECT, truncated_header, sizeof(truncated_header)));
+
+	//Errors are sticky
+	RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, truncated_header, sizeof(truncated_header));
+	CHECK_EQUAL(-1, RPL_option_iter_next(&iter, &option));
+	CHECK_EQUAL(-1, RPL_option_iter_next(&iter, &option));
+}
+
+//Random option areas must terminate with every option inside the buffer
+TEST(option_tests, option_random_input_test) {
+	uint8_t options[64];
+	int round, i, res;
+
+	srand(6550);
+	for (round = 0; round < 2000; round++) {
+		for (i = 0; i < (int)sizeof(options); i++) {
+			options[i] = (uint8_t)(rand() % 12);
+		}
+
+		RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, options, sizeof(options));
+		while ((res = RPL_option_iter_next(&iter, &option)) > 0) {
+			CHECK(option.data >= options);
+			CHECK(option.data + option.length <= options + sizeof(options));
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#include <stddef.h>
+
+#include "rpl.h"
+
+#define RPL_PACKET_INFO_PAD1    0       //!< Pad1 Hop-by-Hop option [RFC8200 Section 4.2]
+
+void RPL_packet_info_node_set(struct rpl_packet_info_node_s *node, rpl_instance_t instance, rpl_dodag_rank_t rank, uint16_t min_hop_rank_increase) {
+	if (min_hop_rank_increase == 0) {
+		min_hop_rank_increase = DEFAULT_MIN_HOP_RANK_INCREASE;
+	}
+	node->rank = rank;
+	node->instance = instance;
+	node->rank_floor = (uint32_t)RPL_DAG_RANK(rank, min_hop_rank_increase) * min_hop_rank_increase;
+	node->rank_ceiling = node->rank_floor + min_hop_rank_increase;
+}
+
+int RPL_packet_info_header(uint8_t *buffer, uint16_t size, uint8_t next_header, const struct rpl_packet_info_s *info) {
+	if (size < RPL_PACKET_INFO_HEADER_LENGTH) {
+		return -1;
+	}
+	buffer[0] = next_header;
+	buffer[1] = 0;
+	buffer[2] = RPL_PACKET_INFO_OPTION_TYPE;
+	buffer[3] = RPL_PACKET_INFO_DATA_LENGTH;
+	buffer[4] = info->flags;
+	buffer[5] = info->instance;
+	RPL_write_uint16(buffer + 6, info->sender_rank);
+	return RPL_PACKET_INFO_HEADER_LENGTH;
+}
+
+int RPL_packet_info_find(const uint8_t *header, uint16_t length) {
+	uint16_t end, position;
+
+	if (length < 2) {
+		return -1;
+	}
+	end = (uint16_t)((header[1] + 1) * 8);
+	if (end > length) {
+		return -1;
+	}
+
+	for (position = 2; position < end;) {
+		if (header[position] == RPL_PACKET_INFO_PAD1) {
+			position++;
+			continue;
+		}
+		if ((position + 2 > end) || (position + 2 + header[position + 1] > end)) {
+			return -1;
+		}
+		if (header[position] == RPL_PACKET_INFO_OPTION_TYPE) {
+			return (header[position + 1] >= RPL_PACKET_INFO_DATA_LENGTH) ? position : -1;
+		}
+		position = (uint16_t)(position + 2 + header[position + 1]);
+	}
+	return -1;
+}
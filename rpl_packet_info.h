@@ -0,0 +1,125 @@
+/**
+ * RPL Packet Information
+ * RPL Option carried in the Hop-by-Hop header of data packets [RFC6553, RFC6550 Section 11.2]
+ *
+ * The option records the direction (O), the RPLInstanceID and the Rank of the last router that
+ * forwarded the packet. A router checks the SenderRank against its own Rank: a packet going Up
+ * must not come from a lower DAGRank, a packet going Down not from a higher one. The first
+ * inconsistency sets the Rank-Error flag (R) and the packet is still forwarded, a second one
+ * shows a loop and the packet is dropped. A child with no route for a packet going Down sends it back with the
+ * Forwarding-Error flag (F).
+ *
+ * The check runs on every forwarded packet, so the DAGRank bounds of the router are computed when
+ * its rank changes (RPL_packet_info_node_set) and RPL_packet_info_forward only compares and
+ * rewrites the option in place.
+ */
+
+#ifndef RPL_PACKET_INFO_H
+#define RPL_PACKET_INFO_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_endian.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_PACKET_INFO_OPTION_TYPE     0x63    //!< Hop-by-Hop Option Type, discard if unrecognized and may change en route [RFC6553 Section 6]
+#define RPL_PACKET_INFO_DATA_LENGTH     4       //!< Opt Data Len without sub-TLVs
+#define RPL_PACKET_INFO_LENGTH          6       //!< Option Type, Opt Data Len and data
+#define RPL_PACKET_INFO_HEADER_LENGTH   8       //!< Hop-by-Hop header holding only the RPL Option
+
+#define RPL_PACKET_INFO_FLAG_O          0x80    //!< Down, the packet is expected to progress away from the root
+#define RPL_PACKET_INFO_FLAG_R          0x40    //!< Rank-Error, a rank inconsistency was found on the path
+#define RPL_PACKET_INFO_FLAG_F          0x20    //!< Forwarding-Error, a child had no route for the destination
+
+/**
+ * Results of RPL_packet_info_forward
+ */
+enum rpl_packet_info_result_e {
+    RPL_PACKET_INFO_INVALID = -1,           //!< Malformed option or another RPL Instance, drop the packet
+    RPL_PACKET_INFO_FORWARD = 0,            //!< Consistent, forward the packet
+    RPL_PACKET_INFO_RANK_ERROR = 1,         //!< First inconsistency, R set and the packet forwarded, reset the Trickle timer
+    RPL_PACKET_INFO_LOOP = 2,               //!< Second inconsistency, drop the packet and reset the Trickle timer
+    RPL_PACKET_INFO_FORWARDING_ERROR = 3    //!< F set, the sender has no route for the destination, remove the route through it
+};
+
+/**
+ * @brief Option fields
+ */
+struct rpl_packet_info_s {
+    uint8_t flags;                  //!< RPL_PACKET_INFO_FLAG_*
+    rpl_instance_t instance;        //!< RPLInstanceID
+    rpl_dodag_rank_t sender_rank;   //!< Rank of the router that forwarded the packet
+};
+
+/**
+ * @brief Router state used by the data path
+ */
+struct rpl_packet_info_node_s {
+    uint32_t rank_floor;            //!< Lowest rank with the router's DAGRank
+    uint32_t rank_ceiling;          //!< Lowest rank with a higher DAGRank
+    rpl_dodag_rank_t rank;          //!< Rank of the router, written as SenderRank
+    rpl_instance_t instance;        //!< RPLInstanceID of the router
+};
+
+/**
+ * @brief Prepare the router state, whenever its rank changes
+ */
+void RPL_packet_info_node_set(struct rpl_packet_info_node_s *node, rpl_instance_t instance, rpl_dodag_rank_t rank, uint16_t min_hop_rank_increase);
+
+/**
+ * @brief Write a Hop-by-Hop header holding only the RPL Option, for packets originated or
+ * entering the RPL domain
+ * @return RPL_PACKET_INFO_HEADER_LENGTH, or -1 when size is too small
+ */
+int RPL_packet_info_header(uint8_t *buffer, uint16_t size, uint8_t next_header, const struct rpl_packet_info_s *info);
+
+/**
+ * @brief Find the RPL Option in a Hop-by-Hop header
+ * @param length octets available from header
+ * @return offset of the option from header, -1 when the header is malformed or holds no RPL Option
+ */
+int RPL_packet_info_find(const uint8_t *header, uint16_t length);
+
+/**
+ * @brief Check and update the RPL Option of a packet forwarded by this router
+ * @details The SenderRank is checked against the direction given by the received O flag, then the
+ * option is rewritten for the next hop with this router's rank and the direction it forwards in.
+ * The option is left unchanged for results other than RPL_PACKET_INFO_FORWARD and RPL_PACKET_INFO_RANK_ERROR.
+ *
+ * @param option RPL Option as found by RPL_packet_info_find
+ * @param down set when the packet is forwarded Down (to a child)
+ * @return rpl_packet_info_result_e
+ */
+static inline int RPL_packet_info_forward(const struct rpl_packet_info_node_s *node, uint8_t *option, uint8_t down) {
+    uint8_t flags = option[2];
+    uint32_t sender_rank = RPL_read_uint16(option + 4);
+    int inconsistent;
+
+    if ((option[1] < RPL_PACKET_INFO_DATA_LENGTH) || (option[3] != node->instance)) {
+        return RPL_PACKET_INFO_INVALID;
+    }
+    if (flags & RPL_PACKET_INFO_FLAG_F) {
+        return RPL_PACKET_INFO_FORWARDING_ERROR;
+    }
+
+    inconsistent = (flags & RPL_PACKET_INFO_FLAG_O) ? (sender_rank >= node->rank_ceiling) : (sender_rank < node->rank_floor);
+    if (inconsistent) {
+        if (flags & RPL_PACKET_INFO_FLAG_R) {
+            return RPL_PACKET_INFO_LOOP;
+        }
+        flags |= RPL_PACKET_INFO_FLAG_R;
+    }
+    option[2] = (uint8_t)((flags & ~RPL_PACKET_INFO_FLAG_O) | (down ? RPL_PACKET_INFO_FLAG_O : 0));
+    RPL_write_uint16(option + 4, node->rank);
+    return inconsistent ? RPL_PACKET_INFO_RANK_ERROR : RPL_PACKET_INFO_FORWARD;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * Data path micro-benchmark
+ * RPL Option check and rewrite (rpl_packet_info) of forwarded packets, alone and with the
+ * Hop-by-Hop header walk.
+ * Uses Google Benchmark (see rpl_bench.h), build with eg.
+ *   gcc -O3 -c rpl_*.c && g++ -O3 rpl_packet_info_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+#define BENCH_PACKETS       1024
+
+static uint8_t headers[BENCH_PACKETS][RPL_PACKET_INFO_HEADER_LENGTH];
+
+//Packets going up from children with ranks around the router's, a few with R set
+static void bench_headers(void) {
+	struct rpl_packet_info_s info;
+	uint32_t random = 0x6553;
+	int i;
+
+	for (i = 0; i < BENCH_PACKETS; i++) {
+		info.flags = ((rpl_bench_random(&random) & 31) == 0) ? RPL_PACKET_INFO_FLAG_R : 0;
+		info.instance = 1;
+		info.sender_rank = (rpl_dodag_rank_t)(512 + rpl_bench_random(&random) % 1024);
+		RPL_packet_info_header(headers[i], RPL_PACKET_INFO_HEADER_LENGTH, 17, &info);
+	}
+}
+
+static void BM_packet_info_forward(benchmark::State &state) {
+	struct rpl_packet_info_node_s node;
+
+	bench_headers();
+	RPL_packet_info_node_set(&node, 1, 768, DEFAULT_MIN_HOP_RANK_INCREASE);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		int forwarded = 0;
+
+		for (int i = 0; i < BENCH_PACKETS; i++) {
+			forwarded += (RPL_packet_info_forward(&node, headers[i] + 2, 0) >= 0);
+		}
+		benchmark::DoNotOptimize(forwarded);
+	}
+	rpl_bench_items(state, BENCH_PACKETS);
+}
+BENCHMARK(BM_packet_info_forward);
+
+static void BM_packet_info_find_forward(benchmark::State &state) {
+	struct rpl_packet_info_node_s node;
+
+	bench_headers();
+	RPL_packet_info_node_set(&node, 1, 768, DEFAULT_MIN_HOP_RANK_INCREASE);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		int forwarded = 0;
+
+		for (int i = 0; i < BENCH_PACKETS; i++) {
+			int offset = RPL_packet_info_find(headers[i], RPL_PACKET_INFO_HEADER_LENGTH);
+
+			forwarded += (offset >= 0) && (RPL_packet_info_forward(&node, headers[i] + offset, 0) >= 0);
+		}
+		benchmark::DoNotOptimize(forwarded);
+	}
+	rpl_bench_items(state, BENCH_PACKETS);
+}
+BENCHMARK(BM_packet_info_find_forward);
+
+RPL_BENCH_MAIN()
@@ -0,0 +1,122 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+TEST_GROUP(packet_info_tests)
+{
+	struct rpl_packet_info_node_s node;
+	struct rpl_packet_info_s info;
+	uint8_t header[16];
+
+	void setup() {
+		//Rank 600 has DAGRank 2 (ranks 512 to 767)
+		RPL_packet_info_node_set(&node, 1, 600, DEFAULT_MIN_HOP_RANK_INCREASE);
+		memset(&info, 0, sizeof(info));
+		info.instance = 1;
+	}
+
+	void teardown() {
+
+	}
+
+	uint8_t *option(uint8_t flags, rpl_dodag_rank_t sender_rank) {
+		info.flags = flags;
+		info.sender_rank = sender_rank;
+		CHECK_EQUAL(RPL_PACKET_INFO_HEADER_LENGTH, RPL_packet_info_header(header, sizeof(header), 17, &info));
+		return header + RPL_packet_info_find(header, sizeof(header));
+	}
+};
+
+TEST(packet_info_tests, header_test) {
+	const uint8_t expected[8] = { 17, 0, 0x63, 4, RPL_PACKET_INFO_FLAG_O, 1, 0x02, 0x58 };
+	const uint8_t padded[16] = { 17, 1, 0, 1, 2, 0, 0, 0x63, 4, 0, 1, 0x01, 0x00, 0, 0, 0 };
+
+	info.flags = RPL_PACKET_INFO_FLAG_O;
+	info.sender_rank = 600;
+	CHECK_EQUAL(-1, RPL_packet_info_header(header, 7, 17, &info));
+	CHECK_EQUAL(8, RPL_packet_info_header(header, sizeof(header), 17, &info));
+	MEMCMP_EQUAL(expected, header, 8);
+	CHECK_EQUAL(2, RPL_packet_info_find(header, 8));
+
+	//Options before the RPL Option are skipped
+	CHECK_EQUAL(7, RPL_packet_info_find(padded, sizeof(padded)));
+
+	//Truncated headers and options
+	CHECK_EQUAL(-1, RPL_packet_info_find(padded, 15));
+	CHECK_EQUAL(-1, RPL_packet_info_find(header, 7));
+	header[3] = 6;
+	CHECK_EQUAL(-1, RPL_packet_info_find(header, 8));
+	header[2] = 0x1E;
+	header[3] = 4;
+	CHECK_EQUAL(-1, RPL_packet_info_find(header, 8));
+}
+
+TEST(packet_info_tests, forward_test) {
+	uint8_t *rpl_option;
+
+	//Up from a child, forwarded up with this router's rank
+	rpl_option = option(0, 900);
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, rpl_option, 0));
+	CHECK_EQUAL(0, rpl_option[2]);
+	CHECK_EQUAL(600, RPL_read_uint16(rpl_option + 4));
+
+	//Same DAGRank is not an inconsistency
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, option(0, 512), 0));
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, option(RPL_PACKET_INFO_FLAG_O, 767), 1));
+
+	//Down from the parent, forwarded down
+	rpl_option = option(RPL_PACKET_INFO_FLAG_O, 256);
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, rpl_option, 1));
+	CHECK_EQUAL(RPL_PACKET_INFO_FLAG_O, rpl_option[2]);
+
+	//Down from the parent but routed back up
+	rpl_option = option(RPL_PACKET_INFO_FLAG_O, 256);
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, rpl_option, 0));
+	CHECK_EQUAL(0, rpl_option[2]);
+}
+
+TEST(packet_info_tests, rank_error_test) {
+	uint8_t *rpl_option;
+
+	//Going up from a lower DAGRank
+	rpl_option = option(0, 511);
+	CHECK_EQUAL(RPL_PACKET_INFO_RANK_ERROR, RPL_packet_info_forward(&node, rpl_option, 0));
+	CHECK_EQUAL(RPL_PACKET_INFO_FLAG_R, rpl_option[2]);
+	CHECK_EQUAL(600, RPL_read_uint16(rpl_option + 4));
+
+	//Going down from a higher DAGRank
+	rpl_option = option(RPL_PACKET_INFO_FLAG_O, 768);
+	CHECK_EQUAL(RPL_PACKET_INFO_RANK_ERROR, RPL_packet_info_forward(&node, rpl_option, 1));
+	CHECK_EQUAL(RPL_PACKET_INFO_FLAG_O | RPL_PACKET_INFO_FLAG_R, rpl_option[2]);
+
+	//A second inconsistency is a loop, the option is left as received
+	rpl_option = option(RPL_PACKET_INFO_FLAG_R, 256);
+	CHECK_EQUAL(RPL_PACKET_INFO_LOOP, RPL_packet_info_forward(&node, rpl_option, 0));
+	CHECK_EQUAL(256, RPL_read_uint16(rpl_option + 4));
+
+	//R stays set along a consistent path
+	rpl_option = option(RPL_PACKET_INFO_FLAG_R, 1024);
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, rpl_option, 0));
+	CHECK_EQUAL(RPL_PACKET_INFO_FLAG_R, rpl_option[2]);
+}
+
+TEST(packet_info_tests, error_test) {
+	uint8_t *rpl_option;
+
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARDING_ERROR, RPL_packet_info_forward(&node, option(RPL_PACKET_INFO_FLAG_O | RPL_PACKET_INFO_FLAG_F, 900), 0));
+
+	//Packets of another instance are not forwarded in this one
+	info.instance = 2;
+	rpl_option = option(0, 900);
+	CHECK_EQUAL(RPL_PACKET_INFO_INVALID, RPL_packet_info_forward(&node, rpl_option, 0));
+	CHECK_EQUAL(900, RPL_read_uint16(rpl_option + 4));
+
+	//The root forwards down only, ranks above its DAGRank going down are inconsistent
+	RPL_packet_info_node_set(&node, 2, RPL_ROOT_RANK(DEFAULT_MIN_HOP_RANK_INCREASE), 0);
+	CHECK_EQUAL(RPL_PACKET_INFO_FORWARD, RPL_packet_info_forward(&node, option(0, 512), 1));
+	CHECK_EQUAL(RPL_PACKET_INFO_RANK_ERROR, RPL_packet_info_forward(&node, option(RPL_PACKET_INFO_FLAG_O, 512), 1));
+}
@@ -0,0 +1,221 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+//Rank through a neighbor, saturating at INFINITE_RANK
+static rpl_dodag_rank_t RPL_parent_path_rank(rpl_dodag_rank_t rank, uint16_t rank_increase) {
+	uint32_t path_rank = (uint32_t)rank + rank_increase;
+
+	if ((rank == RPL_INFINITE_RANK) || (path_rank > RPL_INFINITE_RANK)) {
+		return RPL_INFINITE_RANK;
+	}
+	return (rpl_dodag_rank_t)path_rank;
+}
+
+//An increase of 0 (no Objective Function metric) is taken as MinHopRankIncrease
+static uint16_t RPL_parent_rank_increase(const struct rpl_parent_table_s *table, uint16_t rank_increase) {
+	return (rank_increase == 0) ? table->min_hop_rank_increase : rank_increase;
+}
+
+//Rank of this node with the neighbor as preferred parent: the path rank, raised to the first integral
+//rank above the neighbor so that it stays a member of the parent set [RFC6719 Section 3.3]
+static rpl_dodag_rank_t RPL_parent_node_rank(const struct rpl_parent_table_s *table, const struct rpl_neighbor_s *neighbor) {
+	uint32_t floor = ((uint32_t)RPL_DAG_RANK(neighbor->rank, table->min_hop_rank_increase) + 1) * table->min_hop_rank_increase;
+
+	if (neighbor->path_rank >= floor) {
+		return neighbor->path_rank;
+	}
+	return (floor > RPL_INFINITE_RANK) ? RPL_INFINITE_RANK : (rpl_dodag_rank_t)floor;
+}
+
+static void RPL_parent_table_detach(struct rpl_parent_table_s *table) {
+	table->preferred = RPL_PARENT_NONE;
+	table->rank = table->is_root ? RPL_ROOT_RANK(table->min_hop_rank_increase) : RPL_INFINITE_RANK;
+}
+
+//Full selection, only needed when the preferred parent got worse or went away
+//The current preferred parent is kept while it is within switch_threshold of the best neighbor
+static void RPL_parent_table_select(struct rpl_parent_table_s *table) {
+	int best = RPL_PARENT_NONE;
+	rpl_dodag_rank_t best_rank = RPL_INFINITE_RANK;
+	int current = table->preferred;
+	int i;
+
+	if (table->is_root) {
+		RPL_parent_table_detach(table);
+		return;
+	}
+
+	for (i = 0; i < table->count; i++) {
+		if ((table->neighbors[i].path_rank < best_rank) && (table->neighbors[i].epoch == table->epoch) &&
+		    (RPL_parent_node_rank(table, &table->neighbors[i]) <= table->max_rank)) {
+			best = i;
+			best_rank = table->neighbors[i].path_rank;
+		}
+	}
+	if ((current != RPL_PARENT_NONE) && (table->neighbors[current].path_rank != RPL_INFINITE_RANK) &&
+	    (RPL_parent_node_rank(table, &table->neighbors[current]) <= table->max_rank) &&
+	    ((uint32_t)table->neighbors[current].path_rank <= (uint32_t)best_rank + table->switch_threshold)) {
+		best = current;
+	}
+	table->preferred = (int16_t)best;
+	table->rank = (best == RPL_PARENT_NONE) ? RPL_INFINITE_RANK : RPL_parent_node_rank(table, &table->neighbors[best]);
+}
+
+void RPL_parent_table_init(struct rpl_parent_table_s *table, struct rpl_address_table_s *addresses, uint16_t min_hop_rank_increase, uint8_t is_root) {
+	table->addresses = addresses;
+	table->count = 0;
+	table->min_hop_rank_increase = (min_hop_rank_increase == 0) ? DEFAULT_MIN_HOP_RANK_INCREASE : min_hop_rank_increase;
+	table->switch_threshold = 0;
+	table->is_root = is_root;
+	table->epoch = 0;
+	table->max_rank = RPL_INFINITE_RANK;
+	RPL_parent_table_detach(table);
+}
+
+void RPL_parent_table_configure(struct rpl_parent_table_s *table, const struct rpl_option_dodag_configuration_s *config) {
+	uint16_t min_hop_rank_increase = (config->min_hop_rank_increase == 0) ? DEFAULT_MIN_HOP_RANK_INCREASE : config->min_hop_rank_increase;
+	int i;
+
+	if (min_hop_rank_increase == table->min_hop_rank_increase) {
+		return;
+	}
+
+	table->min_hop_rank_increase = min_hop_rank_increase;
+	for (i = 0; i < table->count; i++) {
+		struct rpl_neighbor_s *neighbor = &table->neighbors[i];
+
+		neighbor->path_rank = RPL_parent_path_rank(neighbor->rank, RPL_parent_rank_increase(table, neighbor->rank_increase));
+	}
+	RPL_parent_table_select(table);
+}
+
+void RPL_parent_table_set_max_rank(struct rpl_parent_table_s *table, rpl_dodag_rank_t max_rank) {
+	table->max_rank = max_rank;
+	if ((table->rank > max_rank) || (table->preferred == RPL_PARENT_NONE)) {
+		RPL_parent_table_select(table);
+	}
+}
+
+int RPL_parent_table_find(const struct rpl_parent_table_s *table, const uint8_t address[16]) {
+	rpl_address_handle_t handle = RPL_address_find(table->addresses, address);
+	int i;
+
+	if (handle == RPL_ADDRESS_NONE) {
+		return -1;
+	}
+	for (i = 0; i < table->count; i++) {
+		if (table->neighbors[i].address == handle) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int RPL_parent_table_update(struct rpl_parent_table_s *table, const uint8_t address[16], rpl_dodag_rank_t rank, uint16_t rank_increase) {
+	struct rpl_neighbor_s *neighbor;
+	rpl_dodag_rank_t path_rank, preferred_rank, node_rank;
+	int index = RPL_parent_table_find(table, address);
+
+	if (index < 0) {
+		rpl_address_handle_t handle;
+
+		if (table->count >= RPL_NEIGHBOR_TABLE_SIZE) {
+			//Only a full table pays for finding a neighbor of a previous version
+			for (index = 0; (index < table->count) && (table->neighbors[index].epoch == table->epoch); index++) {
+			}
+			if (index == table->count) {
+				return -1;
+			}
+			if ((handle = RPL_address_intern(table->addresses, address)) == RPL_ADDRESS_NONE) {
+				return -1;
+			}
+			RPL_address_release(table->addresses, table->neighbors[index].address);
+		} else {
+			if ((handle = RPL_address_intern(table->addresses, address)) == RPL_ADDRESS_NONE) {
+				return -1;
+			}
+			index = table->count++;
+		}
+		table->neighbors[index].address = handle;
+	}
+
+	//Neighbors are compared by path rank, the current one before this update when it is the preferred parent
+	preferred_rank = (table->preferred == RPL_PARENT_NONE) ? RPL_INFINITE_RANK : table->neighbors[table->preferred].path_rank;
+	path_rank = RPL_parent_path_rank(rank, RPL_parent_rank_increase(table, rank_increase));
+	neighbor = &table->neighbors[index];
+	neighbor->rank = rank;
+	neighbor->rank_increase = rank_increase;
+	neighbor->path_rank = path_rank;
+	neighbor->epoch = table->epoch;
+
+	if (table->is_root) {
+		return index;
+	}
+
+	if (index == table->preferred) {
+		node_rank = RPL_parent_node_rank(table, neighbor);
+		if ((path_rank <= preferred_rank) && (node_rank <= table->rank)) {
+			table->rank = node_rank;
+		} else {
+			RPL_parent_table_select(table);
+		}
+	} else if ((uint32_t)path_rank + table->switch_threshold < preferred_rank) {
+		node_rank = RPL_parent_node_rank(table, neighbor);
+		if (node_rank <= table->max_rank) {
+			table->preferred = (int16_t)index;
+			table->rank = node_rank;
+		}
+	}
+	return index;
+}
+
+int RPL_parent_table_remove(struct rpl_parent_table_s *table, const uint8_t address[16]) {
+	int index = RPL_parent_table_find(table, address);
+	int removed_preferred;
+	int last;
+
+	if (index < 0) {
+		return -1;
+	}
+
+	RPL_address_release(table->addresses, table->neighbors[index].address);
+
+	//Keep the array dense by moving the last entry into the hole
+	removed_preferred = (table->preferred == index);
+	last = --table->count;
+	if (index != last) {
+		table->neighbors[index] = table->neighbors[last];
+		if (table->preferred == last) {
+			table->preferred = (int16_t)index;
+		}
+	}
+
+	if (removed_preferred) {
+		table->preferred = RPL_PARENT_NONE;
+		RPL_parent_table_select(table);
+	}
+	return 0;
+}
+
+void RPL_parent_table_new_version(struct rpl_parent_table_s *table) {
+	//Entries are only compared for equality, so they are dropped before an epoch can come round again
+	if (++table->epoch == 0) {
+		while (table->count != 0) {
+			RPL_address_release(table->addresses, table->neighbors[--table->count].address);
+		}
+	}
+	table->max_rank = RPL_INFINITE_RANK;
+	RPL_parent_table_detach(table);
+}
+
+int RPL_parent_table_parent_count(const struct rpl_parent_table_s *table) {
+	int count = 0;
+	int i;
+
+	for (i = 0; i < table->count; i++) {
+		count += RPL_parent_table_is_parent(table, i);
+	}
+	return count;
+}
@@ -0,0 +1,160 @@
+/**
+ * RPL neighbor and parent table
+ * Candidate neighbor set, parent set and preferred parent within a DODAG Version [RFC6550 Section 8.2.1]
+ *
+ * Neighbors are keyed by their interned link-local address (see rpl_address.h), so finding a
+ * neighbor compares 16 or 32 bit handles, and held in a dense fixed size array. Each received DIO
+ * updates one entry and the preferred parent and rank are adjusted from that entry alone, the
+ * table is only rescanned when the preferred parent gets worse or is removed.
+ *
+ * The parent set is not stored: a neighbor is a parent when its DAGRank is less than the DAGRank
+ * of this node, so parent set membership always follows the current rank. The path rank through
+ * a neighbor is its advertised rank plus a rank increase supplied by the Objective Function, and
+ * neighbors are compared by it. The rank taken through the preferred parent is its path rank raised
+ * to at least the first integral rank above the parent [RFC6719 Section 3.3], which keeps the
+ * preferred parent a member of the parent set while increases below MinHopRankIncrease (eg. MRHOF
+ * ETX) still tell links apart.
+ *
+ * Neighbors are stamped with the epoch of the table when updated. A new DODAG Version bumps the
+ * epoch, so the neighbors heard in previous versions stop being parents without touching them
+ * and their entries are reused as they are heard again in the new version.
+ *
+ * The rank a node may take is bounded by max_rank (see rpl_repair.h for DAGMaxRankIncrease), when
+ * no neighbor gives a rank within the bound the node detaches.
+ */
+
+#ifndef RPL_PARENT_H
+#define RPL_PARENT_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_address.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RPL_NEIGHBOR_TABLE_SIZE
+#define RPL_NEIGHBOR_TABLE_SIZE     16      //!< Maximum number of neighbors in a parent table
+#endif
+
+#define RPL_PARENT_NONE             -1      //!< No preferred parent selected
+
+/**
+ * @brief Neighbor entry
+ */
+struct rpl_neighbor_s {
+    rpl_address_handle_t address;   //!< Interned link-local address of the neighbor
+    rpl_dodag_rank_t rank;          //!< Rank advertised in the neighbor's last DIO
+    uint16_t rank_increase;         //!< Rank increase for the link given by the Objective Function
+    rpl_dodag_rank_t path_rank;     //!< Rank plus rank increase, compared when selecting the preferred parent
+    uint8_t epoch;                  //!< Table epoch of the last update, other epochs are previous DODAG Versions
+};
+
+/**
+ * @brief Neighbor and parent table for one DODAG
+ */
+struct rpl_parent_table_s {
+    struct rpl_neighbor_s neighbors[RPL_NEIGHBOR_TABLE_SIZE];  //!< Neighbors [0..count)
+    struct rpl_address_table_s *addresses;  //!< Neighbor addresses
+    uint16_t count;                         //!< Number of neighbors
+    uint16_t min_hop_rank_increase;         //!< MinHopRankIncrease of the DODAG
+    rpl_dodag_rank_t rank;                  //!< Rank of this node
+    rpl_dodag_rank_t max_rank;              //!< Highest rank this node may take, RPL_INFINITE_RANK when unbounded
+    int16_t preferred;                      //!< Index of the preferred parent, RPL_PARENT_NONE if detached (or root)
+    uint16_t switch_threshold;              //!< Rank improvement needed to change preferred parent (Objective Function hysteresis)
+    uint8_t is_root;                        //!< Set when this node is the DODAG root
+    uint8_t epoch;                          //!< Current epoch, bumped for each DODAG Version
+};
+
+/**
+ * @brief Initialise an empty table
+ * @details A root has rank ROOT_RANK and an empty parent set, other nodes start detached
+ * with rank INFINITE_RANK. addresses interns the neighbor addresses and needs room for one more
+ * address than the neighbors held, as a neighbor of a previous version is only released after
+ * its replacement was interned, and for the context of their /64 (RPL_NEIGHBOR_TABLE_SIZE + 2
+ * entries for link-local neighbors).
+ */
+void RPL_parent_table_init(struct rpl_parent_table_s *table, struct rpl_address_table_s *addresses, uint16_t min_hop_rank_increase, uint8_t is_root);
+
+/**
+ * @brief Apply a (new) DODAG Configuration, recomputing the rank through every neighbor
+ */
+void RPL_parent_table_configure(struct rpl_parent_table_s *table, const struct rpl_option_dodag_configuration_s *config);
+
+/**
+ * @brief Set the hysteresis used when changing preferred parent
+ * @details A neighbor replaces the preferred parent only when the path rank through it is more than
+ * threshold lower (eg. PARENT_SWITCH_THRESHOLD for MRHOF [RFC6719 Section 3.2.2]).
+ */
+static inline void RPL_parent_table_set_threshold(struct rpl_parent_table_s *table, uint16_t threshold) {
+    table->switch_threshold = threshold;
+}
+
+/**
+ * @brief Bound the rank of this node, reselecting the preferred parent when needed
+ * @details A max_rank of 0 keeps the node detached.
+ */
+void RPL_parent_table_set_max_rank(struct rpl_parent_table_s *table, rpl_dodag_rank_t max_rank);
+
+/**
+ * @brief Find a neighbor by link-local address
+ * @return neighbor index, or -1 when not in the table
+ */
+int RPL_parent_table_find(const struct rpl_parent_table_s *table, const uint8_t address[16]);
+
+/**
+ * @brief Record the rank advertised in a DIO from a neighbor
+ * @details The neighbor is added when not already present. rank_increase is the increase computed
+ * by the Objective Function for the link, 0 is taken as MinHopRankIncrease.
+ *
+ * @return neighbor index, or -1 when the table (or the address table) is full
+ */
+int RPL_parent_table_update(struct rpl_parent_table_s *table, const uint8_t address[16], rpl_dodag_rank_t rank, uint16_t rank_increase);
+
+/**
+ * @brief Remove a neighbor, eg. after Neighbor Unreachability Detection has failed [RFC4861]
+ * @details Indexes of other neighbors may change.
+ * @return 0 on success, -1 when the neighbor was not in the table
+ */
+int RPL_parent_table_remove(struct rpl_parent_table_s *table, const uint8_t address[16]);
+
+/**
+ * @brief Move to a new DODAG Version
+ * @details Neighbors heard in the previous versions are no longer parents and a node detaches
+ * until it hears DIOs of the new version, a root keeps its rank. The rank is no longer bounded.
+ */
+void RPL_parent_table_new_version(struct rpl_parent_table_s *table);
+
+/**
+ * @brief Number of neighbors in the parent set
+ */
+int RPL_parent_table_parent_count(const struct rpl_parent_table_s *table);
+
+static inline rpl_dodag_rank_t RPL_parent_table_rank(const struct rpl_parent_table_s *table) {
+    return table->rank;
+}
+
+static inline void RPL_parent_table_address(const struct rpl_parent_table_s *table, const struct rpl_neighbor_s *neighbor, uint8_t address[16]) {
+    RPL_address_get(table->addresses, neighbor->address, address);
+}
+
+//Returns the preferred parent, NULL when detached or root
+static inline const struct rpl_neighbor_s *RPL_parent_table_preferred(const struct rpl_parent_table_s *table) {
+    return (table->preferred == RPL_PARENT_NONE) ? 0 : &table->neighbors[table->preferred];
+}
+
+//A neighbor is a parent when this node is attached and the neighbor's DAGRank is below its own [RFC6550 Section 8.2.1]
+static inline int RPL_parent_table_is_parent(const struct rpl_parent_table_s *table, int index) {
+    rpl_dodag_rank_t rank = table->neighbors[index].rank;
+
+    return (table->preferred != RPL_PARENT_NONE) && (rank != RPL_INFINITE_RANK) && (table->neighbors[index].epoch == table->epoch) &&
+           (RPL_DAG_RANK(rank, table->min_hop_rank_increase) < RPL_DAG_RANK(table->rank, table->min_hop_rank_increase));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
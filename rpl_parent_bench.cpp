@@ -0,0 +1,112 @@
+/**
+ * Rank computation micro-benchmark
+ * Objective Function rank increases and parent table updates from a stream of DIOs.
+ * Uses Google Benchmark (see rpl_bench.h), build with eg.
+ *   gcc -O3 -c rpl_*.c && g++ -O3 rpl_parent_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+#define BENCH_DIOS          4096
+
+struct parent_bench_data {
+	uint8_t neighbor[BENCH_DIOS];           //!< Sender of each DIO, of RPL_NEIGHBOR_TABLE_SIZE neighbors
+	rpl_dodag_rank_t rank[BENCH_DIOS];
+	uint16_t etx[BENCH_DIOS];
+	uint8_t addresses[RPL_NEIGHBOR_TABLE_SIZE][16];
+
+	parent_bench_data() {
+		uint32_t random = 0x6550;
+
+		for (int i = 0; i < RPL_NEIGHBOR_TABLE_SIZE; i++) {
+			memset(addresses[i], 0, 16);
+			addresses[i][0] = 0xFE;
+			addresses[i][1] = 0x80;
+			addresses[i][15] = (uint8_t)(i + 1);
+		}
+		for (int i = 0; i < BENCH_DIOS; i++) {
+			neighbor[i] = (uint8_t)(rpl_bench_random(&random) % RPL_NEIGHBOR_TABLE_SIZE);
+			rank[i] = (rpl_dodag_rank_t)(256 + rpl_bench_random(&random) % 2048);
+			etx[i] = (uint16_t)(128 + rpl_bench_random(&random) % 256);
+		}
+	}
+};
+
+static parent_bench_data data;
+
+static void BM_of0_rank_increase(benchmark::State &state) {
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		uint32_t sum = 0;
+
+		for (int i = 0; i < BENCH_DIOS; i++) {
+			sum += RPL_of0_rank_increase(data.rank[i], (uint16_t)(data.etx[i] >> 6), DEFAULT_MIN_HOP_RANK_INCREASE);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	rpl_bench_items(state, BENCH_DIOS);
+}
+BENCHMARK(BM_of0_rank_increase);
+
+static void BM_mrhof_rank_increase(benchmark::State &state) {
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		uint32_t sum = 0;
+
+		for (int i = 0; i < BENCH_DIOS; i++) {
+			sum += RPL_mrhof_rank_increase(data.rank[i], data.etx[i], DEFAULT_MIN_HOP_RANK_INCREASE);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	rpl_bench_items(state, BENCH_DIOS);
+}
+BENCHMARK(BM_mrhof_rank_increase);
+
+//Parent selection with the Objective Function inlined (RPL_OF_PARENT_UPDATE) and through the descriptor
+static void BM_parent_update_mrhof_inline(benchmark::State &state) {
+	struct rpl_parent_table_s table;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[RPL_NEIGHBOR_TABLE_SIZE + 2];
+	rpl_address_handle_t index[32];
+
+	RPL_address_table_init(&addresses, entries, RPL_NEIGHBOR_TABLE_SIZE + 2, index, 32);
+	RPL_parent_table_init(&table, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	RPL_of_attach(&RPL_mrhof, &table);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_DIOS; i++) {
+			RPL_OF_PARENT_UPDATE(mrhof, &table, data.addresses[data.neighbor[i]], data.rank[i], data.etx[i]);
+		}
+		benchmark::DoNotOptimize(RPL_parent_table_rank(&table));
+	}
+	rpl_bench_items(state, BENCH_DIOS);
+}
+BENCHMARK(BM_parent_update_mrhof_inline);
+
+static void BM_parent_update_of(benchmark::State &state) {
+	const struct rpl_objective_function_s *of = (state.range(0) == RPL_OCP_OF0) ? &RPL_of0 : &RPL_mrhof;
+	struct rpl_parent_table_s table;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[RPL_NEIGHBOR_TABLE_SIZE + 2];
+	rpl_address_handle_t index[32];
+
+	RPL_address_table_init(&addresses, entries, RPL_NEIGHBOR_TABLE_SIZE + 2, index, 32);
+	RPL_parent_table_init(&table, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	RPL_of_attach(of, &table);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_DIOS; i++) {
+			RPL_of_parent_update(of, &table, data.addresses[data.neighbor[i]], data.rank[i], data.etx[i]);
+		}
+		benchmark::DoNotOptimize(RPL_parent_table_rank(&table));
+	}
+	rpl_bench_items(state, BENCH_DIOS);
+}
+BENCHMARK(BM_parent_update_of)->Arg(RPL_OCP_OF0)->Arg(RPL_OCP_MRHOF);
+
+RPL_BENCH_MAIN()
@@ -0,0 +1,257 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static void neighbor_address(uint8_t address[16], uint16_t id) {
+	memset(address, 0, 16);
+	address[0] = 0xFE;
+	address[1] = 0x80;
+	address[14] = (uint8_t)(id >> 8);
+	address[15] = (uint8_t)id;
+}
+
+TEST_GROUP(parent_tests)
+{
+	struct rpl_parent_table_s table;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[RPL_NEIGHBOR_TABLE_SIZE + 2];
+	rpl_address_handle_t index[32];
+	uint8_t address[RPL_NEIGHBOR_TABLE_SIZE + 2][16];
+
+	void setup() {
+		int i;
+
+		for (i = 0; i <= RPL_NEIGHBOR_TABLE_SIZE; i++) {
+			neighbor_address(address[i], (uint16_t)(i + 1));
+		}
+		RPL_address_table_init(&addresses, entries, RPL_NEIGHBOR_TABLE_SIZE + 2, index, 32);
+		RPL_parent_table_init(&table, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	}
+
+	void teardown() {
+	}
+};
+
+TEST(parent_tests, parent_init) {
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&table));
+	POINTERS_EQUAL(NULL, RPL_parent_table_preferred(&table));
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&table));
+
+	RPL_parent_table_init(&table, &addresses, 128, 1);
+	CHECK_EQUAL(RPL_ROOT_RANK(128), RPL_parent_table_rank(&table));
+
+	//0 is not a valid MinHopRankIncrease
+	RPL_parent_table_init(&table, &addresses, 0, 0);
+	CHECK_EQUAL(DEFAULT_MIN_HOP_RANK_INCREASE, table.min_hop_rank_increase);
+}
+
+TEST(parent_tests, parent_select) {
+	CHECK_EQUAL(0, RPL_parent_table_update(&table, address[0], 512, 0));
+	CHECK_EQUAL(768, RPL_parent_table_rank(&table));
+	POINTERS_EQUAL(&table.neighbors[0], RPL_parent_table_preferred(&table));
+
+	//A better neighbor is taken directly
+	CHECK_EQUAL(1, RPL_parent_table_update(&table, address[1], 256, 0));
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+	CHECK_EQUAL(1, table.preferred);
+
+	//Rank increases below MinHopRankIncrease still order the neighbors, only the rank taken is
+	//raised to the integral rank above the parent
+	CHECK_EQUAL(2, RPL_parent_table_update(&table, address[2], 256, 200));
+	CHECK_EQUAL(2, table.preferred);
+	CHECK_EQUAL(456, table.neighbors[2].path_rank);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+	CHECK(RPL_parent_table_is_parent(&table, 2));
+	CHECK_EQUAL(2, RPL_parent_table_update(&table, address[2], 256, 300));
+	CHECK_EQUAL(556, table.neighbors[2].path_rank);
+	CHECK_EQUAL(1, table.preferred);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+
+	//Repeated DIOs update the same entry
+	CHECK_EQUAL(1, RPL_parent_table_update(&table, address[1], 256, 0));
+	CHECK_EQUAL(3, table.count);
+	CHECK_EQUAL(2, RPL_parent_table_find(&table, address[2]));
+	CHECK_EQUAL(-1, RPL_parent_table_find(&table, address[3]));
+}
+
+//When the preferred parent gets worse the best remaining neighbor is selected
+TEST(parent_tests, parent_worse) {
+	RPL_parent_table_update(&table, address[0], 256, 0);
+	RPL_parent_table_update(&table, address[1], 512, 0);
+	RPL_parent_table_update(&table, address[2], 768, 0);
+	CHECK_EQUAL(0, table.preferred);
+
+	RPL_parent_table_update(&table, address[0], 1024, 0);
+	CHECK_EQUAL(1, table.preferred);
+	CHECK_EQUAL(768, RPL_parent_table_rank(&table));
+
+	//A preferred parent that improves stays preferred
+	RPL_parent_table_update(&table, address[1], 256, 0);
+	CHECK_EQUAL(1, table.preferred);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+
+	//Poisoned
+	RPL_parent_table_update(&table, address[0], RPL_INFINITE_RANK, 0);
+	RPL_parent_table_update(&table, address[1], RPL_INFINITE_RANK, 0);
+	RPL_parent_table_update(&table, address[2], RPL_INFINITE_RANK, 0);
+	POINTERS_EQUAL(NULL, RPL_parent_table_preferred(&table));
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&table));
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&table));
+}
+
+TEST(parent_tests, parent_remove) {
+	uint8_t neighbor[16];
+
+	RPL_parent_table_update(&table, address[0], 256, 0);
+	RPL_parent_table_update(&table, address[1], 512, 0);
+	RPL_parent_table_update(&table, address[2], 1024, 0);
+	RPL_parent_table_update(&table, address[3], 768, 0);
+
+	//Removing the preferred parent moves the last entry into its place
+	CHECK_EQUAL(0, RPL_parent_table_remove(&table, address[0]));
+	CHECK_EQUAL(3, table.count);
+	CHECK_EQUAL(0, RPL_parent_table_find(&table, address[3]));
+	CHECK_EQUAL(1, table.preferred);
+	CHECK_EQUAL(768, RPL_parent_table_rank(&table));
+
+	//The preferred parent index follows a moved entry
+	RPL_parent_table_update(&table, address[3], 256, 0);
+	CHECK_EQUAL(0, table.preferred);
+	CHECK_EQUAL(0, RPL_parent_table_remove(&table, address[1]));
+	CHECK_EQUAL(0, table.preferred);
+	RPL_parent_table_address(&table, RPL_parent_table_preferred(&table), neighbor);
+	MEMCMP_EQUAL(address[3], neighbor, 16);
+	CHECK_EQUAL((uint32_t)table.count + 1, addresses.pool.count);
+
+	CHECK_EQUAL(-1, RPL_parent_table_remove(&table, address[1]));
+	CHECK_EQUAL(0, RPL_parent_table_remove(&table, address[3]));
+	CHECK_EQUAL(0, RPL_parent_table_remove(&table, address[2]));
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&table));
+}
+
+TEST(parent_tests, parent_full) {
+	int i;
+
+	for (i = 0; i < RPL_NEIGHBOR_TABLE_SIZE; i++) {
+		CHECK_EQUAL(i, RPL_parent_table_update(&table, address[i], (rpl_dodag_rank_t)(256 * (i + 1)), 0));
+	}
+	CHECK_EQUAL(-1, RPL_parent_table_update(&table, address[RPL_NEIGHBOR_TABLE_SIZE], 256, 0));
+	CHECK_EQUAL(0, table.preferred);
+}
+
+//Only neighbors with a lower DAGRank are parents
+TEST(parent_tests, parent_set) {
+	RPL_parent_table_update(&table, address[0], 300, 0);
+	RPL_parent_table_update(&table, address[1], 400, 0);
+	RPL_parent_table_update(&table, address[2], 512, 0);
+	CHECK_EQUAL(556, RPL_parent_table_rank(&table));
+	CHECK(RPL_parent_table_is_parent(&table, 0));
+	CHECK(RPL_parent_table_is_parent(&table, 1));
+	CHECK(!RPL_parent_table_is_parent(&table, 2));
+	CHECK_EQUAL(2, RPL_parent_table_parent_count(&table));
+
+	//Neighbors never become parents of the root
+	RPL_address_table_init(&addresses, entries, RPL_NEIGHBOR_TABLE_SIZE + 2, index, 32);
+	RPL_parent_table_init(&table, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 1);
+	RPL_parent_table_update(&table, address[0], 256, 0);
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&table));
+	CHECK_EQUAL(RPL_ROOT_RANK(DEFAULT_MIN_HOP_RANK_INCREASE), RPL_parent_table_rank(&table));
+}
+
+//Neighbors of previous DODAG Versions are no longer parents, their entries are reused
+TEST(parent_tests, parent_new_version) {
+	int i;
+
+	for (i = 0; i < RPL_NEIGHBOR_TABLE_SIZE; i++) {
+		RPL_parent_table_update(&table, address[i], (rpl_dodag_rank_t)(256 * (i + 1)), 0);
+	}
+	RPL_parent_table_new_version(&table);
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&table));
+	POINTERS_EQUAL(NULL, RPL_parent_table_preferred(&table));
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&table));
+
+	//A worse neighbor of the new version wins over the better ones of the old version
+	CHECK_EQUAL(3, RPL_parent_table_update(&table, address[3], 1024, 0));
+	CHECK_EQUAL(1280, RPL_parent_table_rank(&table));
+	CHECK_EQUAL(1, RPL_parent_table_parent_count(&table));
+
+	//A full table makes room from the old version
+	CHECK_EQUAL(0, RPL_parent_table_update(&table, address[RPL_NEIGHBOR_TABLE_SIZE], 256, 0));
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+	CHECK_EQUAL(RPL_NEIGHBOR_TABLE_SIZE, table.count);
+	CHECK_EQUAL(-1, RPL_parent_table_find(&table, address[0]));
+	CHECK_EQUAL(RPL_NEIGHBOR_TABLE_SIZE + 1, addresses.pool.count);
+
+	//Old entries never come back when the epoch wraps
+	RPL_parent_table_update(&table, address[0], 256, 0);
+	for (i = 0; i < 256; i++) {
+		RPL_parent_table_new_version(&table);
+	}
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&table));
+	CHECK_EQUAL(0, addresses.pool.count);
+	RPL_parent_table_update(&table, address[1], 768, 0);
+	CHECK_EQUAL(1024, RPL_parent_table_rank(&table));
+
+	//The root keeps its rank
+	RPL_address_table_init(&addresses, entries, RPL_NEIGHBOR_TABLE_SIZE + 2, index, 32);
+	RPL_parent_table_init(&table, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 1);
+	RPL_parent_table_new_version(&table);
+	CHECK_EQUAL(RPL_ROOT_RANK(DEFAULT_MIN_HOP_RANK_INCREASE), RPL_parent_table_rank(&table));
+}
+
+TEST(parent_tests, parent_configure) {
+	struct rpl_option_dodag_configuration_s config;
+
+	memset(&config, 0, sizeof(config));
+	RPL_parent_table_update(&table, address[0], 256, 200);
+	RPL_parent_table_update(&table, address[1], 384, 0);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&table));
+
+	config.min_hop_rank_increase = 128;
+	RPL_parent_table_configure(&table, &config);
+	CHECK_EQUAL(456, RPL_parent_table_rank(&table));
+	CHECK_EQUAL(0, table.preferred);
+	CHECK_EQUAL(512, table.neighbors[1].path_rank);
+}
+
+//Random DIO sequences give the same result as a full rescan
+TEST(parent_tests, parent_incremental) {
+	int step, i, best;
+
+	srand(6550);
+	for (step = 0; step < 20000; step++) {
+		i = rand() % RPL_NEIGHBOR_TABLE_SIZE;
+		if ((rand() % 8) == 0) {
+			RPL_parent_table_remove(&table, address[i]);
+		} else {
+			RPL_parent_table_update(&table, address[i], (rand() % 16) ? (rpl_dodag_rank_t)(256 + rand() % 4096) : RPL_INFINITE_RANK,
+			                        (uint16_t)(rand() % 1024));
+		}
+
+		best = RPL_PARENT_NONE;
+		for (i = 0; i < table.count; i++) {
+			if ((table.neighbors[i].path_rank != RPL_INFINITE_RANK) && ((best == RPL_PARENT_NONE) || (table.neighbors[i].path_rank < table.neighbors[best].path_rank))) {
+				best = i;
+			}
+		}
+		if (best == RPL_PARENT_NONE) {
+			CHECK_EQUAL(RPL_PARENT_NONE, table.preferred);
+			CHECK_EQUAL(RPL_INFINITE_RANK, table.rank);
+		} else {
+			const struct rpl_neighbor_s *preferred;
+			uint32_t floor;
+
+			CHECK(table.preferred != RPL_PARENT_NONE);
+			preferred = &table.neighbors[table.preferred];
+			floor = (preferred->rank / DEFAULT_MIN_HOP_RANK_INCREASE + 1) * DEFAULT_MIN_HOP_RANK_INCREASE;
+			CHECK_EQUAL(table.neighbors[best].path_rank, preferred->path_rank);
+			CHECK_EQUAL((preferred->path_rank >= floor) ? preferred->path_rank : ((floor > RPL_INFINITE_RANK) ? RPL_INFINITE_RANK : floor), table.rank);
+			CHECK(RPL_parent_table_is_parent(&table, table.preferred));
+		}
+	}
+}
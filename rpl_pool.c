@@ -0,0 +1,45 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+void RPL_pool_init(struct rpl_pool_s *pool, void *storage, uint32_t size, uint32_t link, uint32_t capacity) {
+	pool->storage = (uint8_t *)storage;
+	pool->size = size;
+	pool->link = link;
+	pool->capacity = capacity;
+	pool->high_water = 0;
+	pool->failures = 0;
+	RPL_pool_reset(pool);
+}
+
+uint32_t RPL_pool_alloc(struct rpl_pool_s *pool) {
+	uint32_t index;
+
+	if (pool->free != RPL_POOL_NONE) {
+		index = pool->free;
+		//The link may be any field of the owner's entry, so it is copied rather than cast
+		memcpy(&pool->free, (uint8_t *)RPL_pool_entry(pool, index) + pool->link, sizeof(uint32_t));
+	} else if (pool->used < pool->capacity) {
+		index = pool->used++;
+	} else {
+		pool->failures++;
+		return RPL_POOL_NONE;
+	}
+	if (++pool->count > pool->high_water) {
+		pool->high_water = pool->count;
+	}
+	return index;
+}
+
+void RPL_pool_free(struct rpl_pool_s *pool, uint32_t index) {
+	memcpy((uint8_t *)RPL_pool_entry(pool, index) + pool->link, &pool->free, sizeof(uint32_t));
+	pool->free = index;
+	pool->count--;
+}
+
+void RPL_pool_reset(struct rpl_pool_s *pool) {
+	pool->used = 0;
+	pool->free = RPL_POOL_NONE;
+	pool->count = 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * RPL fixed capacity pools
+ * Allocation of the fixed size entries of the runtime tables from caller supplied storage
+ *
+ * Route and source route nodes, interned addresses, queued DAO targets and simulated packets are
+ * taken from pools over arrays sized at compile time (eg. RPL_DAO_QUEUE_SIZE) or at init, so the
+ * stack runs without a heap and tables of a node never contend on a shared allocator. Released
+ * entries are kept on a free list and taken before storage not yet used, so allocation and release
+ * are O(1) and, entries of a pool being all of one size, storage does not fragment.
+ *
+ * A free entry holds the free list link in a uint32_t at a caller given offset, a field its owner
+ * does not read while the entry is free. Each pool counts the entries in use, the most in use at
+ * once (high-water mark) and the allocations that failed, for sizing the tables of a deployment.
+ */
+
+#ifndef RPL_POOL_H
+#define RPL_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_POOL_NONE           0xFFFFFFFFUL    //!< Null entry index
+
+/**
+ * @brief Pool of fixed size entries
+ */
+struct rpl_pool_s {
+    uint8_t *storage;               //!< Entry storage
+    uint32_t size;                  //!< Size of an entry in octets
+    uint32_t link;                  //!< Offset of the free list link within an entry
+    uint32_t capacity;              //!< Number of entries
+    uint32_t used;                  //!< Entries taken from storage at least once
+    uint32_t free;                  //!< Free list of released entries
+    uint32_t count;                 //!< Entries in use
+    uint32_t high_water;            //!< Most entries in use at once
+    uint32_t failures;              //!< Allocations made with every entry in use
+};
+
+/**
+ * @brief Initialise an empty pool over storage of capacity entries of size octets
+ * @details link is the offset of a uint32_t within an entry (eg. offsetof the owner's next field)
+ * overwritten while the entry is free.
+ */
+void RPL_pool_init(struct rpl_pool_s *pool, void *storage, uint32_t size, uint32_t link, uint32_t capacity);
+
+/**
+ * @return index of an entry, RPL_POOL_NONE when every entry is in use
+ */
+uint32_t RPL_pool_alloc(struct rpl_pool_s *pool);
+
+/**
+ * @brief Release an entry
+ */
+void RPL_pool_free(struct rpl_pool_s *pool, uint32_t index);
+
+/**
+ * @brief Release every entry at once, the high-water mark and failures are kept
+ */
+void RPL_pool_reset(struct rpl_pool_s *pool);
+
+static inline void *RPL_pool_entry(const struct rpl_pool_s *pool, uint32_t index) {
+    return pool->storage + (size_t)index * pool->size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
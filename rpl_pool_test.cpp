@@ -0,0 +1,81 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#define POOL_TEST_CAPACITY      4
+
+struct pool_test_entry_s {
+	uint8_t data[6];
+	uint32_t next;
+	uint8_t flags;
+};
+
+TEST_GROUP(pool_tests)
+{
+	struct rpl_pool_s pool;
+	struct pool_test_entry_s entries[POOL_TEST_CAPACITY];
+
+	void setup() {
+		memset(entries, 0, sizeof(entries));
+		RPL_pool_init(&pool, entries, sizeof(struct pool_test_entry_s), offsetof(struct pool_test_entry_s, next), POOL_TEST_CAPACITY);
+	}
+
+	void teardown() {
+
+	}
+};
+
+TEST(pool_tests, pool_alloc) {
+	uint32_t i;
+
+	for (i = 0; i < POOL_TEST_CAPACITY; i++) {
+		CHECK_EQUAL(i, RPL_pool_alloc(&pool));
+	}
+	CHECK_EQUAL(RPL_POOL_NONE, RPL_pool_alloc(&pool));
+	CHECK_EQUAL(1, pool.failures);
+	CHECK_EQUAL(POOL_TEST_CAPACITY, pool.count);
+	POINTERS_EQUAL(&entries[2], RPL_pool_entry(&pool, 2));
+
+	//Released entries are taken again, last released first
+	RPL_pool_free(&pool, 1);
+	RPL_pool_free(&pool, 3);
+	CHECK_EQUAL(2, pool.count);
+	CHECK_EQUAL(3, RPL_pool_alloc(&pool));
+	CHECK_EQUAL(1, RPL_pool_alloc(&pool));
+	CHECK_EQUAL(RPL_POOL_NONE, RPL_pool_alloc(&pool));
+}
+
+//Only the link of a free entry is written
+TEST(pool_tests, pool_link) {
+	uint32_t index = RPL_pool_alloc(&pool);
+
+	memset(entries[index].data, 0xAA, sizeof(entries[index].data));
+	entries[index].flags = 0x80;
+	RPL_pool_free(&pool, index);
+	CHECK_EQUAL(RPL_POOL_NONE, entries[index].next);
+	CHECK_EQUAL(0xAA, entries[index].data[5]);
+	CHECK_EQUAL(0x80, entries[index].flags);
+}
+
+//The high-water mark outlives the entries and a reset
+TEST(pool_tests, pool_high_water) {
+	RPL_pool_alloc(&pool);
+	RPL_pool_alloc(&pool);
+	RPL_pool_alloc(&pool);
+	RPL_pool_free(&pool, 0);
+	RPL_pool_free(&pool, 1);
+	RPL_pool_alloc(&pool);
+	CHECK_EQUAL(2, pool.count);
+	CHECK_EQUAL(3, pool.high_water);
+
+	RPL_pool_reset(&pool);
+	CHECK_EQUAL(0, pool.count);
+	CHECK_EQUAL(0, pool.used);
+	CHECK_EQUAL(3, pool.high_water);
+	CHECK_EQUAL(0, RPL_pool_alloc(&pool));
+}
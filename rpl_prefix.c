@@ -0,0 +1,228 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+#define RPL_PREFIX_SLAAC_LENGTH     64      //!< Prefix length of SLAAC over 802.15.4 [RFC4944 Section 6]
+
+//FNV-1a over the option type and data
+static uint32_t RPL_prefix_hash(const struct rpl_option_view_s *option) {
+	uint32_t hash = (2166136261UL ^ option->type) * 16777619UL;
+	int i;
+
+	for (i = 0; i < option->length; i++) {
+		hash = (hash ^ option->data[i]) * 16777619UL;
+	}
+	return hash;
+}
+
+static void RPL_prefix_mask(uint8_t out[16], const uint8_t *prefix, uint8_t prefix_length) {
+	uint8_t octets = (uint8_t)(prefix_length / 8);
+
+	memset(out, 0, 16);
+	memcpy(out, prefix, octets);
+	if (prefix_length % 8) {
+		out[octets] = (uint8_t)(prefix[octets] & (0xFF << (8 - prefix_length % 8)));
+	}
+}
+
+#define RPL_PREFIX_PREFERENCE_RESERVED  0x02    //!< Reserved Route Preference, the option is ignored [RFC4191 Section 2.3]
+
+//Restarts the lifetimes from the option data of the entry
+static void RPL_prefix_restart(struct rpl_prefix_s *entry, uint32_t now) {
+	uint32_t valid, preferred;
+
+	if (entry->type == RPL_OPTION_PREFIX_INFO) {
+		valid = RPL_read_uint32(entry->data + 2);
+		preferred = RPL_read_uint32(entry->data + 6);
+	} else {
+		valid = RPL_read_uint32(entry->data + 2);
+		preferred = RPL_PREFIX_LIFETIME_INFINITE;
+	}
+
+	entry->flags &= (uint8_t)~(RPL_PREFIX_FLAG_VALID_INFINITE | RPL_PREFIX_FLAG_PREFERRED_INFINITE);
+	if (valid == RPL_PREFIX_LIFETIME_INFINITE) {
+		entry->flags |= RPL_PREFIX_FLAG_VALID_INFINITE;
+	}
+	if (preferred == RPL_PREFIX_LIFETIME_INFINITE) {
+		entry->flags |= RPL_PREFIX_FLAG_PREFERRED_INFINITE;
+	}
+	//Longer finite lifetimes would wrap past now and count as expired
+	entry->valid_expires = now + ((valid > RPL_PREFIX_LIFETIME_MAX) ? RPL_PREFIX_LIFETIME_MAX : valid);
+	entry->preferred_expires = now + ((preferred > RPL_PREFIX_LIFETIME_MAX) ? RPL_PREFIX_LIFETIME_MAX : preferred);
+}
+
+void RPL_prefix_table_init(struct rpl_prefix_table_s *table, const uint8_t interface_id[8]) {
+	memset(table->prefixes, 0, sizeof(table->prefixes));
+	memcpy(table->interface_id, interface_id, 8);
+}
+
+static struct rpl_prefix_s *RPL_prefix_lookup(struct rpl_prefix_table_s *table, uint8_t type, const uint8_t prefix[16], uint8_t prefix_length) {
+	int i;
+
+	for (i = 0; i < RPL_PREFIX_MAX; i++) {
+		struct rpl_prefix_s *entry = &table->prefixes[i];
+
+		if ((entry->type == type) && (entry->prefix_length == prefix_length) && (memcmp(entry->prefix, prefix, 16) == 0)) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+//Free entry, or an expired one
+static struct rpl_prefix_s *RPL_prefix_alloc(struct rpl_prefix_table_s *table, uint32_t now) {
+	struct rpl_prefix_s *expired = NULL;
+	int i;
+
+	for (i = 0; i < RPL_PREFIX_MAX; i++) {
+		if (table->prefixes[i].type == 0) {
+			return &table->prefixes[i];
+		}
+		if ((expired == NULL) && RPL_prefix_expired(&table->prefixes[i], now)) {
+			expired = &table->prefixes[i];
+		}
+	}
+	return expired;
+}
+
+int RPL_prefix_table_option(struct rpl_prefix_table_s *table, const struct rpl_option_view_s *option, uint32_t now) {
+	struct rpl_prefix_s *entry;
+	uint8_t prefix[16];
+	uint8_t prefix_length;
+	uint32_t hash, valid;
+	int i, result;
+
+	if ((option->length > RPL_PREFIX_DATA_MAX) || ((option->type != RPL_OPTION_PREFIX_INFO) && (option->type != RPL_OPTION_ROUTE_INFO))) {
+		return RPL_PREFIX_INVALID;
+	}
+
+	//The same option as last time, nothing to parse
+	hash = RPL_prefix_hash(option);
+	for (i = 0; i < RPL_PREFIX_MAX; i++) {
+		entry = &table->prefixes[i];
+		if ((entry->hash == hash) && (entry->type == option->type) && (entry->length == option->length)
+		    && (memcmp(entry->data, option->data, option->length) == 0)) {
+			RPL_prefix_restart(entry, now);
+			return RPL_PREFIX_UNCHANGED;
+		}
+	}
+
+	if (option->type == RPL_OPTION_PREFIX_INFO) {
+		prefix_length = RPL_option_prefix_info_prefix_length(option);
+		valid = RPL_option_prefix_info_valid_lifetime(option);
+		//Preferred beyond valid is ignored [RFC4862 Section 5.5.3 c]
+		if ((prefix_length > 128) || (RPL_option_prefix_info_preferred_lifetime(option) > valid)) {
+			return RPL_PREFIX_INVALID;
+		}
+		RPL_prefix_mask(prefix, RPL_option_prefix_info_prefix(option), prefix_length);
+	} else {
+		prefix_length = RPL_option_route_info_prefix_length(option);
+		valid = RPL_option_route_info_lifetime(option);
+		if ((prefix_length > 128) || (6 + (prefix_length + 7) / 8 > option->length)
+		    || (RPL_option_route_info_preference(option) == RPL_PREFIX_PREFERENCE_RESERVED)) {
+			return RPL_PREFIX_INVALID;
+		}
+		RPL_prefix_mask(prefix, RPL_option_route_info_prefix(option), prefix_length);
+	}
+
+	entry = RPL_prefix_lookup(table, option->type, prefix, prefix_length);
+	if (valid == 0) {
+		if (entry == NULL) {
+			return RPL_PREFIX_UNCHANGED;
+		}
+		entry->type = 0;
+		entry->hash = 0;
+		return RPL_PREFIX_REMOVED;
+	}
+
+	if (entry == NULL) {
+		if ((entry = RPL_prefix_alloc(table, now)) == NULL) {
+			return RPL_PREFIX_FULL;
+		}
+		memcpy(entry->prefix, prefix, 16);
+		entry->prefix_length = prefix_length;
+		entry->type = option->type;
+		entry->flags = 0;
+		result = RPL_PREFIX_ADDED;
+	} else {
+		result = RPL_PREFIX_UPDATED;
+	}
+
+	memcpy(entry->data, option->data, option->length);
+	entry->length = option->length;
+	entry->hash = hash;
+	if (option->type == RPL_OPTION_PREFIX_INFO) {
+		entry->option_flags = RPL_option_prefix_info_flags(option);
+		if ((entry->option_flags & RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_MASK) && (prefix_length == RPL_PREFIX_SLAAC_LENGTH)
+		    && !(entry->flags & RPL_PREFIX_FLAG_ADDRESS)) {
+			memcpy(entry->address, prefix, 8);
+			memcpy(entry->address + 8, table->interface_id, 8);
+			entry->flags |= RPL_PREFIX_FLAG_ADDRESS;
+		}
+	} else {
+		entry->option_flags = RPL_option_route_info_preference(option);
+	}
+	RPL_prefix_restart(entry, now);
+	return result;
+}
+
+int RPL_prefix_table_dio(struct rpl_prefix_table_s *table, const struct rpl_dio_view_s *dio, uint32_t now) {
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option;
+	int result, changed = 0;
+
+	RPL_option_iter_init(&iter, RPL_DODAG_INFORMATION_OBJECT, RPL_dio_view_options(dio), RPL_dio_view_options_length(dio));
+	while ((result = RPL_option_iter_next(&iter, &option)) > 0) {
+		if ((option.type == RPL_OPTION_PREFIX_INFO) || (option.type == RPL_OPTION_ROUTE_INFO)) {
+			changed += (RPL_prefix_table_option(table, &option, now) > RPL_PREFIX_UNCHANGED);
+		}
+	}
+	return (result < 0) ? -1 : changed;
+}
+
+const struct rpl_prefix_s *RPL_prefix_table_find(const struct rpl_prefix_table_s *table, uint8_t type, const uint8_t *prefix, uint8_t prefix_length) {
+	uint8_t masked[16];
+
+	if (prefix_length > 128) {
+		return NULL;
+	}
+	RPL_prefix_mask(masked, prefix, prefix_length);
+	return RPL_prefix_lookup((struct rpl_prefix_table_s *)table, type, masked, prefix_length);
+}
+
+const struct rpl_prefix_s *RPL_prefix_table_route(const struct rpl_prefix_table_s *table, const uint8_t address[16], uint32_t now) {
+	const struct rpl_prefix_s *best = NULL;
+	uint8_t masked[16];
+	int i;
+
+	for (i = 0; i < RPL_PREFIX_MAX; i++) {
+		const struct rpl_prefix_s *entry = &table->prefixes[i];
+
+		if ((entry->type != RPL_OPTION_ROUTE_INFO) || RPL_prefix_expired(entry, now)) {
+			continue;
+		}
+		if ((best != NULL) && (entry->prefix_length <= best->prefix_length)) {
+			continue;
+		}
+		RPL_prefix_mask(masked, address, entry->prefix_length);
+		if (memcmp(masked, entry->prefix, 16) == 0) {
+			best = entry;
+		}
+	}
+	return best;
+}
+
+uint32_t RPL_prefix_table_purge(struct rpl_prefix_table_s *table, uint32_t now) {
+	uint32_t removed = 0;
+	int i;
+
+	for (i = 0; i < RPL_PREFIX_MAX; i++) {
+		if ((table->prefixes[i].type != 0) && RPL_prefix_expired(&table->prefixes[i], now)) {
+			table->prefixes[i].type = 0;
+			table->prefixes[i].hash = 0;
+			removed++;
+		}
+	}
+	return removed;
+}
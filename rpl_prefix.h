@@ -0,0 +1,126 @@
+/**
+ * RPL prefixes
+ * Prefix Information and Route Information carried by DIOs [RFC6550 Sections 6.7.5, 6.7.10]
+ *
+ * The table keeps one entry per advertised prefix (PIO and RIO apart) with its lifetimes, as
+ * expiry times in seconds of a caller supplied clock. Lifetimes of 0xFFFFFFFF never expire, a
+ * valid (route) lifetime of 0 withdraws the prefix. For PIOs with the Autonomous flag and a /64
+ * prefix the SLAAC address [RFC4862 Section 5.5.3] is derived from the table interface identifier
+ * once, when the prefix is first seen.
+ *
+ * Each entry keeps the option data it was built from and its hash. DIOs are sent again and again
+ * by Trickle with the same options, so a received option is first hashed and compared with the
+ * entries: an identical option only restarts the lifetimes, it is parsed and checked only when
+ * its bytes differ.
+ */
+
+#ifndef RPL_PREFIX_H
+#define RPL_PREFIX_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_option.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RPL_PREFIX_MAX
+#define RPL_PREFIX_MAX                  4           //!< Prefixes and routes held
+#endif
+
+#define RPL_PREFIX_LIFETIME_INFINITE    0xFFFFFFFFUL    //!< Lifetime that never expires
+#define RPL_PREFIX_LIFETIME_MAX         0x7FFFFFFFUL    //!< Longest finite lifetime kept, expiry times are compared modulo 2^32
+#define RPL_PREFIX_DATA_MAX             RPL_OPTION_PREFIX_INFO_LENGTH
+
+#define RPL_PREFIX_FLAG_VALID_INFINITE      0x01    //!< Valid (route) lifetime does not expire
+#define RPL_PREFIX_FLAG_PREFERRED_INFINITE  0x02    //!< Preferred lifetime does not expire
+#define RPL_PREFIX_FLAG_ADDRESS             0x04    //!< address holds a SLAAC address
+
+/**
+ * Results of RPL_prefix_table_option
+ */
+enum rpl_prefix_result_e {
+    RPL_PREFIX_INVALID = -2,        //!< Prefix length beyond the prefix carried, inconsistent lifetimes or reserved preference
+    RPL_PREFIX_FULL = -1,           //!< No entry left
+    RPL_PREFIX_UNCHANGED = 0,       //!< Same option as before, lifetimes restarted
+    RPL_PREFIX_ADDED = 1,           //!< New prefix stored
+    RPL_PREFIX_UPDATED = 2,         //!< Flags, preference or lifetimes of a prefix changed
+    RPL_PREFIX_REMOVED = 3          //!< Prefix withdrawn (zero lifetime)
+};
+
+/**
+ * @brief Prefix or route entry
+ */
+struct rpl_prefix_s {
+    uint8_t prefix[16];             //!< Prefix, bits past prefix_length are zero
+    uint8_t address[16];            //!< SLAAC address (see RPL_PREFIX_FLAG_ADDRESS)
+    uint32_t valid_expires;         //!< Expiry time in seconds of the prefix (route)
+    uint32_t preferred_expires;     //!< Expiry time in seconds of the preferred lifetime (PIO only)
+    uint32_t hash;                  //!< Hash of data
+    uint8_t data[RPL_PREFIX_DATA_MAX];  //!< Option data the entry was built from
+    uint8_t length;                 //!< Option data length
+    uint8_t type;                   //!< RPL_OPTION_PREFIX_INFO or RPL_OPTION_ROUTE_INFO, 0 when free
+    uint8_t prefix_length;          //!< Prefix length in bits
+    uint8_t flags;                  //!< RPL_PREFIX_FLAG_*
+    uint8_t option_flags;           //!< PIO L/A/R flags, RIO Route Preference
+};
+
+/**
+ * @brief Prefix table
+ */
+struct rpl_prefix_table_s {
+    struct rpl_prefix_s prefixes[RPL_PREFIX_MAX];
+    uint8_t interface_id[8];        //!< Interface identifier of SLAAC addresses
+};
+
+void RPL_prefix_table_init(struct rpl_prefix_table_s *table, const uint8_t interface_id[8]);
+
+/**
+ * @brief Process a received (validated) Prefix or Route Information option
+ * @param now current time in seconds
+ * @return rpl_prefix_result_e
+ */
+int RPL_prefix_table_option(struct rpl_prefix_table_s *table, const struct rpl_option_view_s *option, uint32_t now);
+
+/**
+ * @brief Process the Prefix and Route Information options of a DIO
+ * @return number of options that added, updated or removed a prefix, -1 when the options are malformed
+ */
+int RPL_prefix_table_dio(struct rpl_prefix_table_s *table, const struct rpl_dio_view_s *dio, uint32_t now);
+
+/**
+ * @brief Exact match, including expired prefixes
+ * @param type RPL_OPTION_PREFIX_INFO or RPL_OPTION_ROUTE_INFO
+ */
+const struct rpl_prefix_s *RPL_prefix_table_find(const struct rpl_prefix_table_s *table, uint8_t type, const uint8_t *prefix, uint8_t prefix_length);
+
+/**
+ * @brief Longest unexpired Route Information covering an address
+ * @return the route, NULL when none covers the address
+ */
+const struct rpl_prefix_s *RPL_prefix_table_route(const struct rpl_prefix_table_s *table, const uint8_t address[16], uint32_t now);
+
+/**
+ * @brief Remove expired prefixes
+ * @return number of prefixes removed
+ */
+uint32_t RPL_prefix_table_purge(struct rpl_prefix_table_s *table, uint32_t now);
+
+static inline int RPL_prefix_expired(const struct rpl_prefix_s *prefix, uint32_t now) {
+    return !(prefix->flags & RPL_PREFIX_FLAG_VALID_INFINITE) && ((int32_t)(now - prefix->valid_expires) >= 0);
+}
+
+/**
+ * @brief Whether the SLAAC address of a prefix is still preferred (otherwise deprecated)
+ */
+static inline int RPL_prefix_preferred(const struct rpl_prefix_s *prefix, uint32_t now) {
+    return (prefix->flags & RPL_PREFIX_FLAG_PREFERRED_INFINITE) || ((int32_t)(now - prefix->preferred_expires) < 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
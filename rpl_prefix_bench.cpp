@@ -0,0 +1,93 @@
+/**
+ * Prefix table micro-benchmark
+ * Prefix and Route Information of repeated DIOs (rpl_prefix), the common case where Trickle
+ * sends the same options again, against options that change every time.
+ * Uses Google Benchmark (see rpl_bench.h), build with eg.
+ *   gcc -O3 -c rpl_*.c && g++ -O3 rpl_prefix_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+static const uint8_t interface_id[8] = { 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+
+//A PIO and two RIOs, as a border router would advertise
+static void bench_options(uint8_t pio[RPL_OPTION_PREFIX_INFO_LENGTH], uint8_t rio[2][14], struct rpl_option_view_s options[3]) {
+	static const uint8_t prefix[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0x0A, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	int i;
+
+	memset(pio, 0, RPL_OPTION_PREFIX_INFO_LENGTH);
+	pio[0] = 64;
+	pio[1] = RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID;
+	RPL_write_uint32(pio + 2, 86400);
+	RPL_write_uint32(pio + 6, 14400);
+	memcpy(pio + 14, prefix, 16);
+	options[0].type = RPL_OPTION_PREFIX_INFO;
+	options[0].length = RPL_OPTION_PREFIX_INFO_LENGTH;
+	options[0].data = pio;
+
+	for (i = 0; i < 2; i++) {
+		rio[i][0] = 64;
+		rio[i][1] = 0;
+		RPL_write_uint32(rio[i] + 2, 3600);
+		memcpy(rio[i] + 6, prefix, 8);
+		rio[i][13] = (uint8_t)(0x10 + i);
+		options[1 + i].type = RPL_OPTION_ROUTE_INFO;
+		options[1 + i].length = 14;
+		options[1 + i].data = rio[i];
+	}
+}
+
+static void BM_prefix_unchanged(benchmark::State &state) {
+	struct rpl_prefix_table_s table;
+	struct rpl_option_view_s options[3];
+	uint8_t pio[RPL_OPTION_PREFIX_INFO_LENGTH], rio[2][14];
+	uint32_t now = 0;
+
+	RPL_prefix_table_init(&table, interface_id);
+	bench_options(pio, rio, options);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		int changed = 0;
+
+		now++;
+		for (int i = 0; i < 3; i++) {
+			changed += RPL_prefix_table_option(&table, &options[i], now);
+		}
+		benchmark::DoNotOptimize(changed);
+	}
+	rpl_bench_items(state, 3);
+}
+BENCHMARK(BM_prefix_unchanged);
+
+//Lifetimes counting down, as some roots advertise them, so every option is parsed again
+static void BM_prefix_changed(benchmark::State &state) {
+	struct rpl_prefix_table_s table;
+	struct rpl_option_view_s options[3];
+	uint8_t pio[RPL_OPTION_PREFIX_INFO_LENGTH], rio[2][14];
+	uint32_t now = 0;
+
+	RPL_prefix_table_init(&table, interface_id);
+	bench_options(pio, rio, options);
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		int changed = 0;
+
+		now++;
+		RPL_write_uint32(pio + 2, 86400 - (now & 0xFFFF));
+		RPL_write_uint32(rio[0] + 2, 3600 - (now & 0x7FF));
+		RPL_write_uint32(rio[1] + 2, 3600 - (now & 0x7FF));
+		for (int i = 0; i < 3; i++) {
+			changed += RPL_prefix_table_option(&table, &options[i], now);
+		}
+		benchmark::DoNotOptimize(changed);
+	}
+	rpl_bench_items(state, 3);
+}
+BENCHMARK(BM_prefix_changed);
+
+RPL_BENCH_MAIN()
@@ -0,0 +1,210 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+static const uint8_t destination[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+static const uint8_t interface_id[8] = { 0x02, 0x12, 0x4B, 0, 0, 0, 0, 0x2A };
+static const uint8_t prefix_a[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0x0A, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static const uint8_t prefix_b[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0x0B, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+TEST_GROUP(prefix_tests)
+{
+	struct rpl_prefix_table_s table;
+	uint8_t data[RPL_OPTION_PREFIX_INFO_LENGTH];
+	struct rpl_option_view_s option;
+
+	void setup() {
+		RPL_prefix_table_init(&table, interface_id);
+	}
+
+	void teardown() {
+
+	}
+
+	int pio(const uint8_t *prefix, uint8_t prefix_length, uint8_t flags, uint32_t valid, uint32_t preferred, uint32_t now) {
+		memset(data, 0, sizeof(data));
+		data[0] = prefix_length;
+		data[1] = flags;
+		RPL_write_uint32(data + 2, valid);
+		RPL_write_uint32(data + 6, preferred);
+		memcpy(data + 14, prefix, 16);
+		option.type = RPL_OPTION_PREFIX_INFO;
+		option.length = RPL_OPTION_PREFIX_INFO_LENGTH;
+		option.data = data;
+		return RPL_prefix_table_option(&table, &option, now);
+	}
+
+	int rio(const uint8_t *prefix, uint8_t prefix_length, uint8_t preference, uint32_t lifetime, uint32_t now) {
+		uint8_t octets = (uint8_t)((prefix_length + 7) / 8);
+
+		memset(data, 0, sizeof(data));
+		data[0] = prefix_length;
+		data[1] = (uint8_t)(preference << RPL_OPTION_ROUTE_INGO_PRF_SHIFT);
+		RPL_write_uint32(data + 2, lifetime);
+		memcpy(data + 6, prefix, octets);
+		option.type = RPL_OPTION_ROUTE_INFO;
+		option.length = (uint8_t)(6 + octets);
+		option.data = data;
+		return RPL_prefix_table_option(&table, &option, now);
+	}
+};
+
+TEST(prefix_tests, pio_test) {
+	const struct rpl_prefix_s *entry;
+	uint8_t address[16];
+
+	CHECK_EQUAL(RPL_PREFIX_ADDED, pio(prefix_a, 64, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, 3600, 1800, 0));
+	entry = RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_a, 64);
+	CHECK(entry != NULL);
+	POINTERS_EQUAL(NULL, RPL_prefix_table_find(&table, RPL_OPTION_ROUTE_INFO, prefix_a, 64));
+
+	//SLAAC address from the prefix and interface identifier, bits past the prefix ignored
+	memcpy(address, prefix_a, 8);
+	memcpy(address + 8, interface_id, 8);
+	CHECK(entry->flags & RPL_PREFIX_FLAG_ADDRESS);
+	MEMCMP_EQUAL(address, entry->address, 16);
+	CHECK_EQUAL(0, entry->prefix[15]);
+	CHECK_EQUAL(3600, entry->valid_expires);
+	CHECK_EQUAL(1800, entry->preferred_expires);
+
+	//The same option only restarts the lifetimes
+	CHECK_EQUAL(RPL_PREFIX_UNCHANGED, pio(prefix_a, 64, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, 3600, 1800, 100));
+	CHECK_EQUAL(3700, entry->valid_expires);
+	CHECK_EQUAL(1900, entry->preferred_expires);
+
+	//Other lifetimes or flags update the prefix, the address is kept
+	CHECK_EQUAL(RPL_PREFIX_UPDATED, pio(prefix_a, 64, RPL_OPTION_PREFIX_INFO_ON_LINK_VALID, 7200, 7200, 200));
+	CHECK_EQUAL(7400, entry->valid_expires);
+	CHECK_EQUAL(RPL_OPTION_PREFIX_INFO_ON_LINK_VALID, entry->option_flags);
+	MEMCMP_EQUAL(address, entry->address, 16);
+
+	//No address for other prefix lengths or without the A flag
+	CHECK_EQUAL(RPL_PREFIX_ADDED, pio(prefix_b, 48, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, 3600, 1800, 0));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, pio(prefix_b, 64, 0, 3600, 1800, 0));
+	CHECK(!(RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_b, 48)->flags & RPL_PREFIX_FLAG_ADDRESS));
+	CHECK(!(RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_b, 64)->flags & RPL_PREFIX_FLAG_ADDRESS));
+
+	//Withdrawn with a zero valid lifetime
+	CHECK_EQUAL(RPL_PREFIX_REMOVED, pio(prefix_a, 64, 0, 0, 0, 300));
+	POINTERS_EQUAL(NULL, RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_a, 64));
+	CHECK_EQUAL(RPL_PREFIX_UNCHANGED, pio(prefix_a, 64, 0, 0, 0, 300));
+
+	//Preferred beyond valid
+	CHECK_EQUAL(RPL_PREFIX_INVALID, pio(prefix_a, 64, 0, 100, 200, 300));
+	CHECK_EQUAL(RPL_PREFIX_INVALID, pio(prefix_a, 129, 0, 100, 100, 300));
+}
+
+TEST(prefix_tests, rio_test) {
+	uint8_t address[16];
+
+	memcpy(address, prefix_a, 16);
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 32, 0, 600, 0));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 48, 3, 600, 0));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_b, 48, 1, 600, 0));
+	CHECK_EQUAL(RPL_PREFIX_UNCHANGED, rio(prefix_b, 48, 1, 600, 0));
+	CHECK_EQUAL(RPL_PREFIX_INVALID, rio(prefix_b, 64, 2, 600, 0));
+	option.length = 6;
+	CHECK_EQUAL(RPL_PREFIX_INVALID, RPL_prefix_table_option(&table, &option, 0));
+
+	//Longest match
+	CHECK_EQUAL(48, RPL_prefix_table_route(&table, address, 0)->prefix_length);
+	address[5] = 0x0C;
+	CHECK_EQUAL(32, RPL_prefix_table_route(&table, address, 0)->prefix_length);
+	address[0] = 0x30;
+	POINTERS_EQUAL(NULL, RPL_prefix_table_route(&table, address, 0));
+
+	//Preference changes update the route
+	CHECK_EQUAL(RPL_PREFIX_UPDATED, rio(prefix_a, 32, 3, 600, 0));
+	CHECK_EQUAL(3, RPL_prefix_table_find(&table, RPL_OPTION_ROUTE_INFO, prefix_a, 32)->option_flags);
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 33, 1, 600, 0));
+	CHECK_EQUAL(RPL_PREFIX_FULL, rio(destination, 16, 1, 600, 0));
+	memcpy(address, prefix_a, 16);
+	address[4] = 0x80;
+	CHECK_EQUAL(32, RPL_prefix_table_route(&table, address, 0)->prefix_length);
+
+	//Expired routes are ignored
+	CHECK_EQUAL(RPL_PREFIX_UPDATED, rio(prefix_a, 32, 3, 100, 0));
+	POINTERS_EQUAL(NULL, RPL_prefix_table_route(&table, address, 100));
+}
+
+TEST(prefix_tests, lifetime_test) {
+	const struct rpl_prefix_s *entry;
+
+	CHECK_EQUAL(RPL_PREFIX_ADDED, pio(prefix_a, 64, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, 200, 100, 1000));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, pio(prefix_b, 64, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, RPL_PREFIX_LIFETIME_INFINITE,
+	                                  RPL_PREFIX_LIFETIME_INFINITE, 1000));
+	entry = RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_a, 64);
+
+	CHECK(RPL_prefix_preferred(entry, 1099));
+	CHECK(!RPL_prefix_preferred(entry, 1100));
+	CHECK(!RPL_prefix_expired(entry, 1199));
+	CHECK_EQUAL(0, RPL_prefix_table_purge(&table, 1199));
+	CHECK(RPL_prefix_expired(entry, 1200));
+	CHECK_EQUAL(1, RPL_prefix_table_purge(&table, 1200));
+	POINTERS_EQUAL(NULL, RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_a, 64));
+
+	entry = RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_b, 64);
+	CHECK(RPL_prefix_preferred(entry, 0x7FFFFFFFUL));
+	CHECK(!RPL_prefix_expired(entry, 0x7FFFFFFFUL));
+
+	//A full table reuses expired entries
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 16, 0, 10, 0));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 24, 0, 10, 0));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 32, 0, 10, 0));
+	CHECK_EQUAL(RPL_PREFIX_FULL, rio(prefix_a, 40, 0, 10, 5));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_a, 40, 0, 10, 10));
+	POINTERS_EQUAL(NULL, RPL_prefix_table_find(&table, RPL_OPTION_ROUTE_INFO, prefix_a, 16));
+}
+
+//Finite lifetimes of 2^31 seconds or more are clamped, not wrapped into the past
+TEST(prefix_tests, long_lifetime_test) {
+	const struct rpl_prefix_s *entry;
+
+	CHECK_EQUAL(RPL_PREFIX_ADDED, pio(prefix_a, 64, RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID, 0xFFFFFFFEUL, 0x80000000UL, 1000));
+	CHECK_EQUAL(RPL_PREFIX_ADDED, rio(prefix_b, 48, 0, 0xFFFFFFFEUL, 1000));
+	entry = RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_a, 64);
+	CHECK(RPL_prefix_preferred(entry, 1000));
+	CHECK(!RPL_prefix_expired(entry, 1000));
+	CHECK(!RPL_prefix_expired(entry, 1000 + RPL_PREFIX_LIFETIME_MAX - 1));
+	CHECK(RPL_prefix_expired(entry, 1000 + RPL_PREFIX_LIFETIME_MAX));
+	CHECK(!RPL_prefix_expired(RPL_prefix_table_find(&table, RPL_OPTION_ROUTE_INFO, prefix_b, 48), 1000));
+	CHECK_EQUAL(0, RPL_prefix_table_purge(&table, 1000));
+}
+
+TEST(prefix_tests, dio_test) {
+	struct rpl_builder_s builder;
+	struct rpl_message_view_s message;
+	struct rpl_dio_view_s view;
+	struct rpl_dio_s dio;
+	struct rpl_option_prefix_info_s prefix_info = {};
+	struct rpl_option_route_info_s route_info = {};
+	uint8_t buffer[128];
+	int length;
+
+	memset(&dio, 0, sizeof(dio));
+	prefix_info.prefix_length = 64;
+	prefix_info.flags = RPL_OPTION_PREFIX_INFO_AUTO_ADDRESS_VALID;
+	prefix_info.valid_lifetime = RPL_PREFIX_LIFETIME_INFINITE;
+	prefix_info.preferred_lifetime = RPL_PREFIX_LIFETIME_INFINITE;
+	route_info.prefix_length = 48;
+	route_info.route_lifetime = 600;
+
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dio(&builder, &dio, prefix_a, NULL);
+	RPL_builder_prefix_info(&builder, &prefix_info, prefix_a);
+	RPL_builder_route_info(&builder, &route_info, prefix_b);
+	length = RPL_builder_finish(&builder, source, destination);
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+	CHECK_EQUAL(0, RPL_dio_view_init(&view, &message));
+
+	//Trickle sends the same DIO again and again
+	CHECK_EQUAL(2, RPL_prefix_table_dio(&table, &view, 0));
+	CHECK_EQUAL(0, RPL_prefix_table_dio(&table, &view, 60));
+	CHECK_EQUAL(660, RPL_prefix_table_find(&table, RPL_OPTION_ROUTE_INFO, prefix_b, 48)->valid_expires);
+	CHECK(RPL_prefix_table_find(&table, RPL_OPTION_PREFIX_INFO, prefix_a, 64)->flags & RPL_PREFIX_FLAG_ADDRESS);
+}
@@ -0,0 +1,90 @@
+#include <stddef.h>
+
+#include "rpl.h"
+
+//L + DAGMaxRankIncrease, saturating at INFINITE_RANK
+static rpl_dodag_rank_t RPL_repair_max_rank(const struct rpl_repair_s *repair) {
+	uint32_t max_rank = (uint32_t)repair->lowest_rank + repair->max_rank_increase;
+
+	if ((repair->max_rank_increase == 0) || (max_rank > RPL_INFINITE_RANK)) {
+		return RPL_INFINITE_RANK;
+	}
+	return (rpl_dodag_rank_t)max_rank;
+}
+
+//Detach and advertise INFINITE_RANK, no parent is taken until the poisoning ends
+static void RPL_repair_poison(struct rpl_repair_s *repair) {
+	repair->attached = 0;
+	RPL_parent_table_set_max_rank(repair->parents, 0);
+	RPL_timer_start(repair->wheel, &repair->poison, repair->wheel->now + repair->poison_time);
+	if (repair->callback != NULL) {
+		repair->callback(repair, repair->context);
+	}
+}
+
+static void RPL_repair_poison_expired(struct rpl_timer_s *timer, void *context) {
+	struct rpl_repair_s *repair = (struct rpl_repair_s *)context;
+
+	(void)timer;
+
+	RPL_parent_table_set_max_rank(repair->parents, RPL_repair_max_rank(repair));
+	RPL_repair_update(repair);
+	if (repair->callback != NULL) {
+		repair->callback(repair, repair->context);
+	}
+}
+
+void RPL_repair_init(struct rpl_repair_s *repair, struct rpl_parent_table_s *parents, struct rpl_timer_wheel_s *wheel, uint32_t poison_time,
+                     rpl_repair_callback_t callback, void *context) {
+	repair->parents = parents;
+	repair->wheel = wheel;
+	repair->poison_time = poison_time;
+	repair->callback = callback;
+	repair->context = context;
+	repair->lowest_rank = RPL_INFINITE_RANK;
+	repair->max_rank_increase = 0;
+	repair->epoch = parents->epoch;
+	repair->attached = (RPL_parent_table_preferred(parents) != NULL);
+	RPL_timer_init(&repair->poison, RPL_repair_poison_expired, repair);
+}
+
+void RPL_repair_configure(struct rpl_repair_s *repair, const struct rpl_option_dodag_configuration_s *config) {
+	repair->max_rank_increase = config->max_rank_increase;
+	if (!RPL_timer_running(&repair->poison)) {
+		RPL_parent_table_set_max_rank(repair->parents, RPL_repair_max_rank(repair));
+		RPL_repair_update(repair);
+	}
+}
+
+void RPL_repair_update(struct rpl_repair_s *repair) {
+	struct rpl_parent_table_s *parents = repair->parents;
+
+	if (parents->epoch != repair->epoch) {
+		//New DODAG Version, L restarts from the first rank taken in it
+		repair->epoch = parents->epoch;
+		repair->lowest_rank = RPL_INFINITE_RANK;
+		repair->attached = 0;
+		RPL_timer_stop(repair->wheel, &repair->poison);
+	}
+	if (RPL_timer_running(&repair->poison)) {
+		return;
+	}
+
+	if (RPL_parent_table_preferred(parents) != NULL) {
+		repair->attached = 1;
+		if (parents->rank < repair->lowest_rank) {
+			//The bound follows L down, the new rank is L so it stays within it
+			repair->lowest_rank = parents->rank;
+			parents->max_rank = RPL_repair_max_rank(repair);
+		}
+	} else if (repair->attached) {
+		RPL_repair_poison(repair);
+	}
+}
+
+void RPL_repair_detach(struct rpl_repair_s *repair) {
+	RPL_repair_update(repair);
+	if (repair->attached) {
+		RPL_repair_poison(repair);
+	}
+}
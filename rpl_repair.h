@@ -0,0 +1,76 @@
+/**
+ * RPL local repair
+ * Rank bound, detaching and poisoning within a DODAG Version [RFC6550 Sections 8.2.2.4, 8.2.2.5]
+ *
+ * Within a DODAG Version a node may not take a rank above L + DAGMaxRankIncrease, L being the
+ * lowest rank it has had in the version, so it cannot follow its own sub-DODAG down into a loop.
+ * The bound is applied by the parent table (max_rank), and is lifted by a new version (detected
+ * through the parent table epoch).
+ *
+ * When the node has no parent within the bound it detaches and poisons its sub-DODAG: for
+ * poison_time ticks it advertises INFINITE_RANK and takes no parent, so its former children drop
+ * it as a parent before it reattaches (within the bound again) through another neighbor.
+ */
+
+#ifndef RPL_REPAIR_H
+#define RPL_REPAIR_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_parent.h"
+#include "rpl_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rpl_repair_s;
+
+typedef void (*rpl_repair_callback_t)(struct rpl_repair_s *repair, void *context);
+
+/**
+ * @brief Local repair state of a node
+ */
+struct rpl_repair_s {
+    struct rpl_parent_table_s *parents;
+    struct rpl_timer_wheel_s *wheel;
+    struct rpl_timer_s poison;              //!< Runs while the node poisons before reattaching
+    uint32_t poison_time;                   //!< Ticks spent advertising INFINITE_RANK after detaching
+    rpl_repair_callback_t callback;         //!< Called when the node detaches and when the poisoning ends, may be NULL
+    void *context;                          //!< Passed to callback
+    rpl_dodag_rank_t lowest_rank;           //!< L, lowest rank of the node in the DODAG Version
+    uint16_t max_rank_increase;             //!< DAGMaxRankIncrease, 0 when the rank is not bounded
+    uint8_t epoch;                          //!< Parent table epoch lowest_rank belongs to
+    uint8_t attached;                       //!< Set while the node has a preferred parent
+};
+
+void RPL_repair_init(struct rpl_repair_s *repair, struct rpl_parent_table_s *parents, struct rpl_timer_wheel_s *wheel, uint32_t poison_time,
+                     rpl_repair_callback_t callback, void *context);
+
+/**
+ * @brief Apply the DAGMaxRankIncrease of a (new) DODAG Configuration
+ */
+void RPL_repair_configure(struct rpl_repair_s *repair, const struct rpl_option_dodag_configuration_s *config);
+
+/**
+ * @brief Follow the parent table, to be called after it changed
+ * @details Lowers L as the rank improves and starts the poisoning when the node has lost its
+ * preferred parent (the callback is then to advertise INFINITE_RANK, eg. by resetting Trickle).
+ */
+void RPL_repair_update(struct rpl_repair_s *repair);
+
+/**
+ * @brief Detach from the DODAG, eg. after a loop was detected on the data path
+ */
+void RPL_repair_detach(struct rpl_repair_s *repair);
+
+static inline int RPL_repair_is_poisoning(const struct rpl_repair_s *repair) {
+    return RPL_timer_running(&repair->poison);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
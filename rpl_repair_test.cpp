@@ -0,0 +1,123 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t parent_a[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0A };
+static const uint8_t parent_b[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0B };
+static const uint8_t child[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0C };
+
+static int callback_count;
+
+static void repair_callback(struct rpl_repair_s *repair, void *context) {
+	(void)repair;
+	(void)context;
+
+	callback_count++;
+}
+
+TEST_GROUP(repair_tests)
+{
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_parent_table_s parents;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[8];
+	rpl_address_handle_t index[8];
+	struct rpl_repair_s repair;
+	struct rpl_option_dodag_configuration_s config;
+
+	void setup() {
+		callback_count = 0;
+		RPL_timer_wheel_init(&wheel, 0, NULL);
+		RPL_address_table_init(&addresses, entries, 8, index, 8);
+		RPL_parent_table_init(&parents, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+		RPL_repair_init(&repair, &parents, &wheel, 1000, repair_callback, NULL);
+		memset(&config, 0, sizeof(config));
+		config.max_rank_increase = 512;
+		RPL_repair_configure(&repair, &config);
+	}
+
+	void teardown() {
+
+	}
+
+	void update(const uint8_t *address, rpl_dodag_rank_t rank) {
+		RPL_parent_table_update(&parents, address, rank, 0);
+		RPL_repair_update(&repair);
+	}
+};
+
+//The rank may not rise more than DAGMaxRankIncrease above the lowest rank in the version
+TEST(repair_tests, max_rank_test) {
+	update(parent_a, 256);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&parents));
+	CHECK_EQUAL(512, repair.lowest_rank);
+	CHECK_EQUAL(1024, parents.max_rank);
+
+	//Within the bound the rank follows the parent
+	update(parent_a, 768);
+	CHECK_EQUAL(1024, RPL_parent_table_rank(&parents));
+	CHECK(!RPL_repair_is_poisoning(&repair));
+
+	//Beyond it the node detaches rather than following its sub-DODAG down
+	update(child, 1024);
+	update(parent_a, 1024);
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&parents));
+	POINTERS_EQUAL(NULL, RPL_parent_table_preferred(&parents));
+	CHECK(RPL_repair_is_poisoning(&repair));
+	CHECK_EQUAL(1, callback_count);
+}
+
+TEST(repair_tests, poison_test) {
+	update(parent_a, 256);
+	RPL_repair_detach(&repair);
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&parents));
+	CHECK(RPL_repair_is_poisoning(&repair));
+	CHECK_EQUAL(1, callback_count);
+
+	//No parent is taken while poisoning, even a good one
+	update(parent_b, 256);
+	POINTERS_EQUAL(NULL, RPL_parent_table_preferred(&parents));
+	RPL_repair_detach(&repair);
+	CHECK_EQUAL(1, callback_count);
+
+	//Then the node reattaches within the bound
+	update(child, 1024);
+	RPL_timer_wheel_advance(&wheel, 1000);
+	CHECK(!RPL_repair_is_poisoning(&repair));
+	CHECK_EQUAL(2, callback_count);
+	CHECK_EQUAL(512, RPL_parent_table_rank(&parents));
+	CHECK(repair.attached);
+	CHECK_EQUAL(1024, parents.max_rank);
+}
+
+//A new DODAG Version lifts the bound and ends the poisoning
+TEST(repair_tests, new_version_test) {
+	update(parent_a, 256);
+	RPL_repair_detach(&repair);
+	RPL_parent_table_new_version(&parents);
+	update(child, 2048);
+	CHECK(!RPL_repair_is_poisoning(&repair));
+	CHECK_EQUAL(2304, RPL_parent_table_rank(&parents));
+	CHECK_EQUAL(2304, repair.lowest_rank);
+	CHECK_EQUAL(2816, parents.max_rank);
+
+	//Losing the parent in the new version poisons again
+	RPL_parent_table_remove(&parents, child);
+	RPL_repair_update(&repair);
+	CHECK(RPL_repair_is_poisoning(&repair));
+}
+
+//DAGMaxRankIncrease of 0 leaves the rank unbounded
+TEST(repair_tests, unbounded_test) {
+	config.max_rank_increase = 0;
+	RPL_repair_configure(&repair, &config);
+	update(parent_a, 256);
+	update(parent_a, 8192);
+	CHECK_EQUAL(8448, RPL_parent_table_rank(&parents));
+	CHECK_EQUAL(RPL_INFINITE_RANK, parents.max_rank);
+	CHECK(!RPL_repair_is_poisoning(&repair));
+}
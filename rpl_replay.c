@@ -0,0 +1,224 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+#if RPL_CONF_SECURITY
+
+#define RPL_REPLAY_NONE         0xFFFFFFFFUL    //!< No slot
+
+static uint32_t RPL_replay_probe_limit(const struct rpl_replay_table_s *table) {
+	return (table->mask < RPL_REPLAY_MAX_PROBE) ? table->mask + 1 : RPL_REPLAY_MAX_PROBE;
+}
+
+//Slot holding address, or RPL_REPLAY_NONE
+static uint32_t RPL_replay_slot(const struct rpl_replay_table_s *table, const uint8_t address[16]) {
+	uint32_t slot = RPL_address_hash16(address) & table->mask;
+	uint32_t limit = RPL_replay_probe_limit(table);
+	uint32_t i;
+
+	for (i = 0; i < limit; i++) {
+		const struct rpl_replay_entry_s *entry = &table->entries[slot];
+
+		if (!(entry->flags & RPL_REPLAY_FLAG_VALID)) {
+			break;
+		}
+		if (memcmp(entry->address, address, 16) == 0) {
+			return slot;
+		}
+		slot = (slot + 1) & table->mask;
+	}
+	return RPL_REPLAY_NONE;
+}
+
+//Entry for address, added (evicting the least recently heard peer in reach when needed) if not found
+static struct rpl_replay_entry_s *RPL_replay_entry(struct rpl_replay_table_s *table, const uint8_t address[16], uint32_t now) {
+	uint32_t slot = RPL_address_hash16(address) & table->mask;
+	uint32_t limit = RPL_replay_probe_limit(table);
+	uint32_t oldest = slot;
+	struct rpl_replay_entry_s *entry;
+	uint32_t i;
+
+	for (i = 0; i < limit; i++) {
+		entry = &table->entries[slot];
+		if (!(entry->flags & RPL_REPLAY_FLAG_VALID)) {
+			table->count++;
+			break;
+		}
+		if (memcmp(entry->address, address, 16) == 0) {
+			return entry;
+		}
+		if ((int32_t)(entry->last_heard - table->entries[oldest].last_heard) < 0) {
+			oldest = slot;
+		}
+		slot = (slot + 1) & table->mask;
+	}
+	if (i == limit) {
+		slot = oldest;
+	}
+
+	entry = &table->entries[slot];
+	memset(entry, 0, sizeof(*entry));
+	memcpy(entry->address, address, 16);
+	entry->flags = RPL_REPLAY_FLAG_VALID;
+	entry->last_heard = now;
+	return entry;
+}
+
+int RPL_replay_init(struct rpl_replay_table_s *table, struct rpl_replay_entry_s *entries, uint32_t capacity, uint32_t timestamp_window, uint8_t strict, uint32_t seed) {
+	if ((capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+		return -1;
+	}
+
+	memset(entries, 0, capacity * sizeof(*entries));
+	table->entries = entries;
+	table->mask = capacity - 1;
+	table->count = 0;
+	table->counter = 0;
+	table->timestamp_window = timestamp_window;
+	table->random = (seed == 0) ? 0x6550 : seed;
+	table->strict = strict;
+	return 0;
+}
+
+const struct rpl_replay_entry_s *RPL_replay_find(const struct rpl_replay_table_s *table, const uint8_t address[16]) {
+	uint32_t slot = RPL_replay_slot(table, address);
+
+	return (slot == RPL_REPLAY_NONE) ? NULL : &table->entries[slot];
+}
+
+//Removes the entry for address (see RPL_probe_moves_back)
+void RPL_replay_remove(struct rpl_replay_table_s *table, const uint8_t address[16]) {
+	uint32_t slot = RPL_replay_slot(table, address);
+	uint32_t next = slot;
+
+	if (slot == RPL_REPLAY_NONE) {
+		return;
+	}
+
+	for (;;) {
+		uint32_t home;
+
+		next = (next + 1) & table->mask;
+		if ((next == slot) || !(table->entries[next].flags & RPL_REPLAY_FLAG_VALID)) {
+			break;
+		}
+		home = RPL_address_hash16(table->entries[next].address) & table->mask;
+		if (RPL_probe_moves_back(slot, next, home, table->mask)) {
+			table->entries[slot] = table->entries[next];
+			slot = next;
+		}
+	}
+	memset(&table->entries[slot], 0, sizeof(table->entries[slot]));
+	table->count--;
+}
+
+static int RPL_replay_compare(const struct rpl_replay_table_s *table, const struct rpl_replay_entry_s *entry, const uint8_t *security, uint32_t now) {
+	uint32_t counter = RPL_read_uint32(security + 4);
+	uint8_t timestamp = (security[0] & RPL_SECURITY_COUNTER_IS_TIME_FLAG) ? RPL_REPLAY_FLAG_TIMESTAMP : 0;
+	uint32_t distance;
+
+	if (timestamp) {
+		distance = counter - now;
+		distance = ((int32_t)distance < 0) ? 0U - distance : distance;
+		if (distance > table->timestamp_window) {
+			return RPL_REPLAY_STALE;
+		}
+	}
+	if ((entry == NULL) || !(entry->flags & RPL_REPLAY_FLAG_SYNCHRONIZED) || ((entry->flags & RPL_REPLAY_FLAG_TIMESTAMP) != timestamp)) {
+		return RPL_REPLAY_UNKNOWN;
+	}
+	return (counter > entry->counter) ? RPL_REPLAY_FRESH : RPL_REPLAY_REPLAYED;
+}
+
+int RPL_replay_check(const struct rpl_replay_table_s *table, const uint8_t source[16], const uint8_t *security, uint32_t now) {
+	int result = RPL_replay_compare(table, RPL_replay_find(table, source), security, now);
+
+	//Trust on first use
+	if ((result == RPL_REPLAY_UNKNOWN) && !table->strict) {
+		return RPL_REPLAY_FRESH;
+	}
+	return result;
+}
+
+static void RPL_replay_synchronize(struct rpl_replay_entry_s *entry, const uint8_t *security, uint32_t now) {
+	entry->counter = RPL_read_uint32(security + 4);
+	entry->last_heard = now;
+	entry->flags = (uint8_t)((entry->flags & ~RPL_REPLAY_FLAG_TIMESTAMP) | RPL_REPLAY_FLAG_SYNCHRONIZED);
+	if (security[0] & RPL_SECURITY_COUNTER_IS_TIME_FLAG) {
+		entry->flags |= RPL_REPLAY_FLAG_TIMESTAMP;
+	}
+}
+
+int RPL_replay_accept(struct rpl_replay_table_s *table, const uint8_t source[16], const uint8_t *security, uint32_t now) {
+	struct rpl_replay_entry_s *entry;
+
+	if (RPL_replay_check(table, source, security, now) != RPL_REPLAY_FRESH) {
+		return -1;
+	}
+	entry = RPL_replay_entry(table, source, now);
+	RPL_replay_synchronize(entry, security, now);
+	return 0;
+}
+
+int RPL_replay_cc_request(struct rpl_replay_table_s *table, const uint8_t destination[16], struct rpl_cc_s *cc, uint32_t now) {
+	struct rpl_replay_entry_s *entry = RPL_replay_entry(table, destination, now);
+	uint32_t x;
+
+	if (!(entry->flags & RPL_REPLAY_FLAG_CC_PENDING)) {
+		//xorshift32, nonces only need to be unpredictable enough that old responses do not match
+		x = table->random;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		table->random = x;
+		entry->cc_nonce = (uint16_t)(x ^ (x >> 16));
+		entry->flags |= RPL_REPLAY_FLAG_CC_PENDING;
+	}
+
+	cc->flags = 0;
+	cc->cc_nonce = entry->cc_nonce;
+	cc->destination_counter = (entry->flags & RPL_REPLAY_FLAG_SYNCHRONIZED) ? entry->counter : 0;
+	return 0;
+}
+
+int RPL_replay_cc_response(const struct rpl_replay_table_s *table, const uint8_t source[16], const struct rpl_cc_view_s *request, struct rpl_cc_s *response) {
+	const struct rpl_replay_entry_s *entry = RPL_replay_find(table, source);
+
+	if (RPL_cc_view_is_response(request)) {
+		return -1;
+	}
+
+	response->rpl_instance = RPL_cc_view_instance_id(request);
+	response->flags = RPL_CC_FLAG_R_MASK;
+	response->cc_nonce = RPL_cc_view_nonce(request);
+	memcpy(response->dodag_id, RPL_cc_view_dodag_id(request), RPL_DODAG_ID_LENGTH);
+	response->destination_counter = ((entry != NULL) && (entry->flags & RPL_REPLAY_FLAG_SYNCHRONIZED)) ? entry->counter : 0;
+	return 0;
+}
+
+int RPL_replay_cc_receive(struct rpl_replay_table_s *table, const uint8_t source[16], const struct rpl_cc_view_s *response, const uint8_t *security, uint32_t now) {
+	uint32_t slot = RPL_replay_slot(table, source);
+	struct rpl_replay_entry_s *entry;
+	uint32_t destination_counter;
+
+	if ((slot == RPL_REPLAY_NONE) || !RPL_cc_view_is_response(response)) {
+		return -1;
+	}
+	entry = &table->entries[slot];
+	if (!(entry->flags & RPL_REPLAY_FLAG_CC_PENDING) || (entry->cc_nonce != RPL_cc_view_nonce(response))) {
+		return -1;
+	}
+
+	entry->flags &= (uint8_t)~RPL_REPLAY_FLAG_CC_PENDING;
+	RPL_replay_synchronize(entry, security, now);
+
+	//The peer has heard higher counters from us than we remember sending (eg. after a reboot)
+	destination_counter = RPL_cc_view_destination_counter(response);
+	if (destination_counter > table->counter) {
+		table->counter = destination_counter;
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * RPL replay protection
+ * Per peer security counter state and Consistency Checks [RFC6550 Sections 6.6, 10.7.1]
+ *
+ * Peers are found through an open addressing hash on their source address, with entries held
+ * in a caller supplied power of 2 array so memory is bounded. Each address is stored within
+ * RPL_REPLAY_MAX_PROBE slots of its home slot, when those are all taken the least recently
+ * heard peer is evicted, so a check touches at most a few consecutive cache lines.
+ *
+ * A secured message is checked with RPL_replay_check before its MAC is verified and recorded
+ * with RPL_replay_accept afterwards, so forged messages cannot advance the counters. Counters
+ * must increase; timestamps (RPL_SECURITY_COUNTER_IS_TIME_FLAG) must also be within
+ * timestamp_window of the local clock. Peers without state (eg. after a reboot) are either
+ * trusted on first use or, for a strict table, resynchronized with a Consistency Check whose
+ * response is matched by nonce. The response also carries the peer's estimate of our own
+ * counter, which moves the local counter forward after a reboot. Only built with RPL_CONF_SECURITY.
+ */
+
+#ifndef RPL_REPLAY_H
+#define RPL_REPLAY_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_message.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if RPL_CONF_SECURITY
+
+#define RPL_REPLAY_MAX_PROBE            8       //!< Slots searched from the home slot of an address
+
+#define RPL_REPLAY_FLAG_VALID           0x01    //!< Entry in use
+#define RPL_REPLAY_FLAG_SYNCHRONIZED    0x02    //!< counter holds the peer's last accepted counter
+#define RPL_REPLAY_FLAG_TIMESTAMP       0x04    //!< Peer's counter is a timestamp
+#define RPL_REPLAY_FLAG_CC_PENDING      0x08    //!< Consistency Check request outstanding
+
+/**
+ * Results of RPL_replay_check
+ */
+enum rpl_replay_result_e {
+    RPL_REPLAY_FRESH = 0,           //!< Counter is newer than any accepted from the peer
+    RPL_REPLAY_REPLAYED = 1,        //!< Counter not above the last accepted one
+    RPL_REPLAY_STALE = 2,           //!< Timestamp outside the accepted window
+    RPL_REPLAY_UNKNOWN = 3          //!< No counter for the peer (or its counter mode changed), send a Consistency Check
+};
+
+/**
+ * @brief Peer counter state, two per cache line
+ */
+struct rpl_replay_entry_s {
+    uint8_t address[16];            //!< Peer source address
+    uint32_t counter;               //!< Last accepted counter or timestamp
+    uint32_t last_heard;            //!< Time of the last accepted message, for eviction
+    uint16_t cc_nonce;              //!< Nonce of the outstanding Consistency Check request
+    uint8_t flags;                  //!< RPL_REPLAY_FLAG_*
+    uint8_t reserved[5];
+};
+
+/**
+ * @brief Replay table
+ */
+struct rpl_replay_table_s {
+    struct rpl_replay_entry_s *entries;
+    uint32_t mask;                  //!< Number of entries - 1
+    uint32_t count;                 //!< Entries in use
+    uint32_t counter;               //!< Local counter, last value sent
+    uint32_t timestamp_window;      //!< Accepted distance between a peer timestamp and the local clock
+    uint32_t random;                //!< Nonce generator state
+    uint8_t strict;                 //!< Peers without state are rejected until a Consistency Check succeeds
+};
+
+/**
+ * @brief Initialise an empty table
+ * @details capacity must be a power of 2. now passed to the other calls is both the eviction
+ * clock and, for timestamp counters, the clock the peers' timestamps are compared to.
+ *
+ * @return 0, or -1 when capacity is not a power of 2
+ */
+int RPL_replay_init(struct rpl_replay_table_s *table, struct rpl_replay_entry_s *entries, uint32_t capacity, uint32_t timestamp_window, uint8_t strict, uint32_t seed);
+
+const struct rpl_replay_entry_s *RPL_replay_find(const struct rpl_replay_table_s *table, const uint8_t address[16]);
+void RPL_replay_remove(struct rpl_replay_table_s *table, const uint8_t address[16]);
+
+/**
+ * @brief Check the counter of a received secured message (before the MAC is verified)
+ * @param security security section of the message
+ * @return rpl_replay_result_e
+ */
+int RPL_replay_check(const struct rpl_replay_table_s *table, const uint8_t source[16], const uint8_t *security, uint32_t now);
+
+/**
+ * @brief Record the counter of a message whose MAC has been verified
+ * @return 0, or -1 when the counter is not fresh
+ */
+int RPL_replay_accept(struct rpl_replay_table_s *table, const uint8_t source[16], const uint8_t *security, uint32_t now);
+
+/**
+ * @brief Counter for the next secured message sent
+ */
+static inline uint32_t RPL_replay_next_counter(struct rpl_replay_table_s *table) {
+    return ++table->counter;
+}
+
+/**
+ * @brief Start a Consistency Check with a peer
+ * @details Sets the flags, nonce and Destination Counter of cc (the caller sets the instance
+ * and DODAGID). While a request is outstanding the same nonce is reused, so retransmissions
+ * can be answered by any response.
+ *
+ * @return 0
+ */
+int RPL_replay_cc_request(struct rpl_replay_table_s *table, const uint8_t destination[16], struct rpl_cc_s *cc, uint32_t now);
+
+/**
+ * @brief Fill in the response to a received (and verified) Consistency Check request
+ * @details The response echoes the instance, nonce and DODAGID, and carries our estimate of the
+ * requester's counter. It must be sent secured with the next local counter.
+ *
+ * @return 0, or -1 when the message is not a request
+ */
+int RPL_replay_cc_response(const struct rpl_replay_table_s *table, const uint8_t source[16], const struct rpl_cc_view_s *request, struct rpl_cc_s *response);
+
+/**
+ * @brief Process a received (and verified) Consistency Check response
+ * @details A response matching the outstanding nonce resynchronizes the peer's counter to the
+ * counter of the response's security section, regardless of the state held.
+ *
+ * @return 0 when the response matched a request, -1 otherwise
+ */
+int RPL_replay_cc_receive(struct rpl_replay_table_s *table, const uint8_t source[16], const struct rpl_cc_view_s *response, const uint8_t *security, uint32_t now);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#if RPL_CONF_SECURITY
+
+static const uint8_t node_a[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+static const uint8_t node_b[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 2 };
+static const uint8_t dodag_id[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+//Security section with the given counter
+static const uint8_t *security_section(uint8_t *security, uint32_t counter, int timestamp) {
+	memset(security, 0, RPL_SECURITY_BASE_LENGTH + 1);
+	security[0] = timestamp ? RPL_SECURITY_COUNTER_IS_TIME_FLAG : 0;
+	RPL_write_uint32(security + 4, counter);
+	return security;
+}
+
+//Builds a CC message and returns a view of it
+static void cc_message(uint8_t *buffer, const struct rpl_cc_s *cc, uint32_t counter, struct rpl_cc_view_s *view) {
+	struct rpl_builder_s builder;
+	struct rpl_security_s security = {};
+	struct rpl_message_view_s message;
+	uint8_t mac[4] = { 0 };
+	int length;
+
+	security.counter = counter;
+	RPL_builder_init(&builder, buffer, 128, NULL, 0);
+	RPL_builder_cc(&builder, cc, &security);
+	RPL_builder_raw(&builder, mac, sizeof(mac));
+	length = RPL_builder_finish(&builder, node_a, node_b);
+	CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, (uint16_t)length));
+	CHECK_EQUAL(0, RPL_cc_view_init(view, &message));
+}
+
+TEST_GROUP(replay_tests)
+{
+	struct rpl_replay_table_s table;
+	struct rpl_replay_entry_s entries[64];
+	uint8_t security[RPL_SECURITY_BASE_LENGTH + 1];
+
+	void setup() {
+		CHECK_EQUAL(0, RPL_replay_init(&table, entries, 64, 30, 0, 1));
+	}
+
+	void teardown() {
+
+	}
+};
+
+TEST(replay_tests, init_test) {
+	CHECK_EQUAL(32, sizeof(struct rpl_replay_entry_s));
+	CHECK_EQUAL(-1, RPL_replay_init(&table, entries, 48, 30, 0, 1));
+	CHECK_EQUAL(-1, RPL_replay_init(&table, entries, 0, 30, 0, 1));
+	CHECK_EQUAL(1, RPL_replay_next_counter(&table));
+	CHECK_EQUAL(2, RPL_replay_next_counter(&table));
+}
+
+TEST(replay_tests, counter_test) {
+	//First message is trusted
+	CHECK_EQUAL(RPL_REPLAY_FRESH, RPL_replay_check(&table, node_a, security_section(security, 10, 0), 0));
+	CHECK_EQUAL(0, RPL_replay_accept(&table, node_a, security, 0));
+	CHECK_EQUAL(1, table.count);
+
+	CHECK_EQUAL(RPL_REPLAY_REPLAYED, RPL_replay_check(&table, node_a, security, 0));
+	CHECK_EQUAL(-1, RPL_replay_accept(&table, node_a, security, 0));
+	CHECK_EQUAL(RPL_REPLAY_REPLAYED, RPL_replay_check(&table, node_a, security_section(security, 9, 0), 0));
+	CHECK_EQUAL(RPL_REPLAY_FRESH, RPL_replay_check(&table, node_a, security_section(security, 11, 0), 0));
+
+	//Counters are per peer
+	CHECK_EQUAL(RPL_REPLAY_FRESH, RPL_replay_check(&table, node_b, security_section(security, 1, 0), 0));
+	CHECK_EQUAL(0, RPL_replay_accept(&table, node_b, security, 0));
+	CHECK_EQUAL(10, RPL_replay_find(&table, node_a)->counter);
+	CHECK_EQUAL(1, RPL_replay_find(&table, node_b)->counter);
+
+	RPL_replay_remove(&table, node_a);
+	POINTERS_EQUAL(NULL, RPL_replay_find(&table, node_a));
+	CHECK_EQUAL(1, table.count);
+}
+
+TEST(replay_tests, timestamp_test) {
+	CHECK_EQUAL(0, RPL_replay_accept(&table, node_a, security_section(security, 1000, 1), 1000));
+	CHECK(RPL_replay_find(&table, node_a)->flags & RPL_REPLAY_FLAG_TIMESTAMP);
+
+	CHECK_EQUAL(RPL_REPLAY_FRESH, RPL_replay_check(&table, node_a, security_section(security, 1010, 1), 1040));
+	CHECK_EQUAL(RPL_REPLAY_STALE, RPL_replay_check(&table, node_a, security_section(security, 1010, 1), 1041));
+	CHECK_EQUAL(RPL_REPLAY_STALE, RPL_replay_check(&table, node_a, security_section(security, 1100, 1), 1000));
+	CHECK_EQUAL(RPL_REPLAY_REPLAYED, RPL_replay_check(&table, node_a, security_section(security, 1000, 1), 1000));
+
+	//Switching to a counter needs a resynchronization
+	table.strict = 1;
+	CHECK_EQUAL(RPL_REPLAY_UNKNOWN, RPL_replay_check(&table, node_a, security_section(security, 2000, 0), 1000));
+}
+
+TEST(replay_tests, strict_test) {
+	table.strict = 1;
+	CHECK_EQUAL(RPL_REPLAY_UNKNOWN, RPL_replay_check(&table, node_a, security_section(security, 10, 0), 0));
+	CHECK_EQUAL(-1, RPL_replay_accept(&table, node_a, security, 0));
+	POINTERS_EQUAL(NULL, RPL_replay_find(&table, node_a));
+}
+
+TEST(replay_tests, consistency_check_test) {
+	struct rpl_replay_table_s peer;
+	struct rpl_replay_entry_s peer_entries[8];
+	struct rpl_cc_s request = {}, response = {}, retransmission = {};
+	struct rpl_cc_view_s request_view, response_view;
+	uint8_t request_buffer[128], response_buffer[128];
+
+	//Node a rebooted: it has no state for b and its own counter restarted, b last heard 500 from a
+	table.strict = 1;
+	CHECK_EQUAL(0, RPL_replay_init(&peer, peer_entries, 8, 30, 0, 2));
+	peer.counter = 70;
+	CHECK_EQUAL(0, RPL_replay_accept(&peer, node_a, security_section(security, 500, 0), 0));
+
+	CHECK_EQUAL(RPL_REPLAY_UNKNOWN, RPL_replay_check(&table, node_b, security_section(security, 71, 0), 0));
+	request.rpl_instance = 1;
+	memcpy(request.dodag_id, dodag_id, 16);
+	CHECK_EQUAL(0, RPL_replay_cc_request(&table, node_b, &request, 0));
+	CHECK_EQUAL(0, request.destination_counter);
+	CHECK_EQUAL(0, RPL_replay_cc_request(&table, node_b, &retransmission, 0));
+	CHECK_EQUAL(request.cc_nonce, retransmission.cc_nonce);
+	cc_message(request_buffer, &request, RPL_replay_next_counter(&table), &request_view);
+
+	//b answers with its estimate of a's counter
+	CHECK_EQUAL(0, RPL_replay_cc_response(&peer, node_a, &request_view, &response));
+	CHECK_EQUAL(RPL_CC_FLAG_R_MASK, response.flags);
+	CHECK_EQUAL(request.cc_nonce, response.cc_nonce);
+	CHECK_EQUAL(500, response.destination_counter);
+	MEMCMP_EQUAL(dodag_id, response.dodag_id, 16);
+	cc_message(response_buffer, &response, RPL_replay_next_counter(&peer), &response_view);
+	CHECK_EQUAL(-1, RPL_replay_cc_response(&peer, node_a, &response_view, &response));
+
+	//A response with another nonce is ignored
+	response_buffer[RPL_ICMPV6_HEADER_LENGTH + RPL_SECURITY_BASE_LENGTH + 1 + 3] ^= 1;
+	CHECK_EQUAL(-1, RPL_replay_cc_receive(&table, node_b, &response_view, security_section(security, 71, 0), 0));
+	response_buffer[RPL_ICMPV6_HEADER_LENGTH + RPL_SECURITY_BASE_LENGTH + 1 + 3] ^= 1;
+	CHECK_EQUAL(-1, RPL_replay_cc_receive(&table, node_a, &response_view, security, 0));
+
+	CHECK_EQUAL(0, RPL_replay_cc_receive(&table, node_b, &response_view, security_section(security, 71, 0), 0));
+	CHECK_EQUAL(RPL_REPLAY_REPLAYED, RPL_replay_check(&table, node_b, security, 0));
+	CHECK_EQUAL(RPL_REPLAY_FRESH, RPL_replay_check(&table, node_b, security_section(security, 72, 0), 0));
+	CHECK_EQUAL(501, RPL_replay_next_counter(&table));
+
+	//The request is answered once only
+	CHECK_EQUAL(-1, RPL_replay_cc_receive(&table, node_b, &response_view, security_section(security, 71, 0), 0));
+}
+
+TEST(replay_tests, eviction_test) {
+	uint8_t address[16];
+	uint32_t i;
+
+	memcpy(address, node_a, 16);
+
+	//Bounded by the table, the least recently heard peers are replaced
+	for (i = 0; i < 1000; i++) {
+		RPL_write_uint32(address + 12, i);
+		CHECK_EQUAL(0, RPL_replay_accept(&table, address, security_section(security, 1, 0), i));
+		CHECK(RPL_replay_find(&table, address) != NULL);
+	}
+	CHECK(table.count <= 64);
+	CHECK(table.count > 48);
+
+	//Every stored peer is still reachable after removals
+	for (i = 950; i < 1000; i += 2) {
+		RPL_write_uint32(address + 12, i);
+		RPL_replay_remove(&table, address);
+	}
+	for (i = 0; i < 64; i++) {
+		if (entries[i].flags & RPL_REPLAY_FLAG_VALID) {
+			POINTERS_EQUAL(&entries[i], RPL_replay_find(&table, entries[i].address));
+		}
+	}
+}
+
+#endif
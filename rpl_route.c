@@ -0,0 +1,511 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+#if RPL_CONF_STORING
+
+//Path compressed binary trie
+//Each node holds a prefix, its children hold longer prefixes branching on the bit that follows it.
+//Nodes without a route only exist where two subtries branch. Nodes do not link to their parent,
+//removal finds it again from the root. Host routes are not in the trie.
+
+static uint64_t RPL_route_read_uint64(const uint8_t *data) {
+	return ((uint64_t)RPL_read_uint32(data) << 32) | RPL_read_uint32(data + 4);
+}
+
+static int RPL_route_clz(uint64_t x) {
+#if defined(__GNUC__)
+	return __builtin_clzll(x);
+#else
+	int n = 0;
+
+	while (!(x & 0x8000000000000000ULL)) {
+		x <<= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+//Upper (half 0) or lower (half 1) 64 bits of an interned prefix
+static uint64_t RPL_route_half(const struct rpl_route_table_s *table, rpl_address_handle_t prefix, int half) {
+	return RPL_route_read_uint64(half ? RPL_address_iid(table->addresses, prefix) : RPL_address_prefix(table->addresses, prefix));
+}
+
+//Number of leading bits (up to limit) shared by key and the prefix of a node
+static int RPL_route_common_length(const struct rpl_route_table_s *table, const uint8_t *key, const struct rpl_route_s *node, int limit) {
+	uint64_t x = RPL_route_read_uint64(key) ^ RPL_route_half(table, node->prefix, 0);
+	int common;
+
+	if (x != 0) {
+		common = RPL_route_clz(x);
+	} else if (limit <= 64) {
+		//The lower half is only loaded for prefixes longer than /64
+		return limit;
+	} else {
+		x = RPL_route_read_uint64(key + 8) ^ RPL_route_half(table, node->prefix, 1);
+		common = (x != 0) ? 64 + RPL_route_clz(x) : 128;
+	}
+	return (common < limit) ? common : limit;
+}
+
+static int RPL_route_bit(const uint8_t *prefix, int position) {
+	return (prefix[position >> 3] >> (7 - (position & 7))) & 1;
+}
+
+static int RPL_route_node_bit(const struct rpl_route_table_s *table, const struct rpl_route_s *node, int position) {
+	return (int)((RPL_route_half(table, node->prefix, position >> 6) >> (63 - (position & 63))) & 1);
+}
+
+//Copies a prefix clearing the bits past prefix_length
+static void RPL_route_normalize(uint8_t key[16], const uint8_t *prefix, uint8_t prefix_length) {
+	int octets = (prefix_length + 7) / 8;
+
+	memset(key, 0, 16);
+	memcpy(key, prefix, (size_t)octets);
+	if (prefix_length & 7) {
+		key[octets - 1] &= (uint8_t)(0xFF << (8 - (prefix_length & 7)));
+	}
+}
+
+static int RPL_route_expired(const struct rpl_route_s *route, uint32_t now) {
+	return !(route->flags & RPL_ROUTE_FLAG_INFINITE) && ((int32_t)(now - route->expires) >= 0);
+}
+
+//Stored in a previous DODAG Version
+static int RPL_route_stale(const struct rpl_route_table_s *table, const struct rpl_route_s *route) {
+	return route->epoch != table->epoch;
+}
+
+//Nodes take a reference on their prefix, branch points share the prefix of the route that created them
+static uint32_t RPL_route_alloc(struct rpl_route_table_s *table, rpl_address_handle_t prefix, uint8_t prefix_length) {
+	struct rpl_route_s *node;
+	uint32_t index;
+
+	index = RPL_pool_alloc(&table->pool);
+	if (index == RPL_POOL_NONE) {
+		return RPL_ROUTE_NONE;
+	}
+
+	node = &table->nodes[index];
+	RPL_address_retain(table->addresses, prefix);
+	node->prefix = prefix;
+	node->prefix_length = prefix_length;
+	node->flags = 0;
+	node->child[0] = RPL_ROUTE_NONE;
+	node->child[1] = RPL_ROUTE_NONE;
+	return index;
+}
+
+static void RPL_route_release(struct rpl_route_table_s *table, uint32_t index) {
+	RPL_address_release(table->addresses, table->nodes[index].prefix);
+	table->nodes[index].flags = RPL_ROUTE_FLAG_FREE;
+	RPL_pool_free(&table->pool, index);
+}
+
+//Points the parent of old (or the root) at replacement
+static void RPL_route_replace(struct rpl_route_table_s *table, uint32_t parent, uint32_t old, uint32_t replacement) {
+	if (parent == RPL_ROUTE_NONE) {
+		table->root = replacement;
+	} else {
+		struct rpl_route_s *node = &table->nodes[parent];
+
+		node->child[(node->child[0] == old) ? 0 : 1] = replacement;
+	}
+}
+
+//Returns the node for key/prefix_length, adding it (and a branch point) when not present
+static uint32_t RPL_route_insert(struct rpl_route_table_s *table, const uint8_t key[16], rpl_address_handle_t handle, uint8_t prefix_length) {
+	uint32_t index = table->root;
+	uint32_t parent = RPL_ROUTE_NONE;
+	uint32_t branch, added;
+	int common, bit;
+
+	if (index == RPL_ROUTE_NONE) {
+		table->root = RPL_route_alloc(table, handle, prefix_length);
+		return table->root;
+	}
+
+	for (;;) {
+		struct rpl_route_s *node = &table->nodes[index];
+
+		common = RPL_route_common_length(table, key, node, (prefix_length < node->prefix_length) ? prefix_length : node->prefix_length);
+		if (common < node->prefix_length) {
+			if (common == prefix_length) {
+				//New prefix covers node
+				added = RPL_route_alloc(table, handle, prefix_length);
+				if (added == RPL_ROUTE_NONE) {
+					return RPL_ROUTE_NONE;
+				}
+				RPL_route_replace(table, parent, index, added);
+				table->nodes[added].child[RPL_route_node_bit(table, node, prefix_length)] = index;
+				return added;
+			}
+
+			//New prefix and node diverge, join them under a branch point
+			branch = RPL_route_alloc(table, handle, (uint8_t)common);
+			if (branch == RPL_ROUTE_NONE) {
+				return RPL_ROUTE_NONE;
+			}
+			added = RPL_route_alloc(table, handle, prefix_length);
+			if (added == RPL_ROUTE_NONE) {
+				RPL_route_release(table, branch);
+				return RPL_ROUTE_NONE;
+			}
+			RPL_route_replace(table, parent, index, branch);
+			bit = RPL_route_bit(key, common);
+			table->nodes[branch].child[bit] = added;
+			table->nodes[branch].child[bit ^ 1] = index;
+			return added;
+		}
+
+		if (prefix_length == node->prefix_length) {
+			return index;
+		}
+
+		bit = RPL_route_bit(key, node->prefix_length);
+		if (node->child[bit] == RPL_ROUTE_NONE) {
+			added = RPL_route_alloc(table, handle, prefix_length);
+			if (added != RPL_ROUTE_NONE) {
+				node->child[bit] = added;
+			}
+			return added;
+		}
+		parent = index;
+		index = node->child[bit];
+	}
+}
+
+static uint32_t RPL_route_find_index(const struct rpl_route_table_s *table, const uint8_t key[16], uint8_t prefix_length) {
+	uint32_t index = table->root;
+
+	while (index != RPL_ROUTE_NONE) {
+		const struct rpl_route_s *node = &table->nodes[index];
+
+		if ((node->prefix_length > prefix_length) || (RPL_route_common_length(table, key, node, node->prefix_length) < node->prefix_length)) {
+			return RPL_ROUTE_NONE;
+		}
+		if (node->prefix_length == prefix_length) {
+			return (node->flags & RPL_ROUTE_FLAG_VALID) ? index : RPL_ROUTE_NONE;
+		}
+		index = node->child[RPL_route_bit(key, node->prefix_length)];
+	}
+	return RPL_ROUTE_NONE;
+}
+
+//Drops the route held by a node, removing nodes that are no longer needed as branch points
+static void RPL_route_remove_index(struct rpl_route_table_s *table, uint32_t index) {
+	struct rpl_route_s *node = &table->nodes[index];
+	uint32_t parent = RPL_ROUTE_NONE;
+	uint32_t grandparent = RPL_ROUTE_NONE;
+	uint32_t at = table->root;
+	uint32_t child;
+	uint8_t key[16];
+
+	RPL_address_release(table->addresses, node->next_hop);
+	node->flags &= (uint8_t)~RPL_ROUTE_FLAG_VALID;
+	table->count--;
+	if ((node->child[0] != RPL_ROUTE_NONE) && (node->child[1] != RPL_ROUTE_NONE)) {
+		return;
+	}
+
+	RPL_address_get(table->addresses, node->prefix, key);
+	while (at != index) {
+		grandparent = parent;
+		parent = at;
+		at = table->nodes[at].child[RPL_route_bit(key, table->nodes[at].prefix_length)];
+	}
+	child = (node->child[0] != RPL_ROUTE_NONE) ? node->child[0] : node->child[1];
+	RPL_route_replace(table, parent, index, child);
+	RPL_route_release(table, index);
+	if ((child != RPL_ROUTE_NONE) || (parent == RPL_ROUTE_NONE)) {
+		return;
+	}
+
+	//The parent lost a child and may now be a redundant branch point
+	node = &table->nodes[parent];
+	if (node->flags & RPL_ROUTE_FLAG_VALID) {
+		return;
+	}
+	child = (node->child[0] != RPL_ROUTE_NONE) ? node->child[0] : node->child[1];
+	RPL_route_replace(table, grandparent, parent, child);
+	RPL_route_release(table, parent);
+}
+
+//Host routes hold a reference on their address, which indexes them
+static struct rpl_route_s *RPL_route_host_find(const struct rpl_route_table_s *table, const uint8_t address[16]) {
+	rpl_address_handle_t handle = RPL_address_find(table->addresses, address);
+
+	if ((handle == RPL_ADDRESS_NONE) || !(table->hosts[handle].flags & RPL_ROUTE_FLAG_VALID)) {
+		return NULL;
+	}
+	return &table->hosts[handle];
+}
+
+static void RPL_route_remove_host(struct rpl_route_table_s *table, struct rpl_route_s *host) {
+	RPL_address_release(table->addresses, host->next_hop);
+	RPL_address_release(table->addresses, host->prefix);
+	host->flags = 0;
+	table->count--;
+}
+
+static struct rpl_route_s *RPL_route_exact(const struct rpl_route_table_s *table, const uint8_t key[16], uint8_t prefix_length) {
+	uint32_t index;
+
+	if (prefix_length == 128) {
+		return RPL_route_host_find(table, key);
+	}
+	index = RPL_route_find_index(table, key, prefix_length);
+	return (index == RPL_ROUTE_NONE) ? NULL : &table->nodes[index];
+}
+
+static void RPL_route_remove(struct rpl_route_table_s *table, struct rpl_route_s *route) {
+	if (route->prefix_length == 128) {
+		RPL_route_remove_host(table, route);
+	} else {
+		RPL_route_remove_index(table, (uint32_t)(route - table->nodes));
+	}
+}
+
+void RPL_route_table_init(struct rpl_route_table_s *table, struct rpl_address_table_s *addresses, struct rpl_route_s *nodes, uint32_t capacity,
+                          struct rpl_route_s *hosts, uint16_t lifetime_unit) {
+	uint32_t i;
+
+	table->addresses = addresses;
+	table->nodes = nodes;
+	table->hosts = hosts;
+	for (i = 0; i < addresses->pool.capacity; i++) {
+		hosts[i].flags = 0;
+	}
+	RPL_pool_init(&table->pool, nodes, sizeof(struct rpl_route_s), offsetof(struct rpl_route_s, child), capacity);
+	table->root = RPL_ROUTE_NONE;
+	table->count = 0;
+	table->lifetime_unit = (lifetime_unit == 0) ? 1 : lifetime_unit;
+	table->epoch = 0;
+}
+
+static int RPL_route_table_store(struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length, const uint8_t next_hop[16],
+                                 uint8_t path_sequence, uint8_t path_lifetime, uint32_t now, uint8_t flags) {
+	struct rpl_route_s *route;
+	rpl_address_handle_t handle, hop;
+	uint8_t key[16];
+	uint32_t index;
+	int result;
+
+	if (prefix_length > 128) {
+		return RPL_ROUTE_INVALID;
+	}
+	RPL_route_normalize(key, prefix, prefix_length);
+
+	//No-Path removes the route when it is newer, or is from the current next hop. As for an update an
+	//incomparable Path Sequence is taken as newer [RFC6550 Section 7.2]
+	if (path_lifetime == RPL_ROUTE_LIFETIME_NO_PATH) {
+		route = RPL_route_exact(table, key, prefix_length);
+		if (route == NULL) {
+			return RPL_ROUTE_REMOVED;
+		}
+		result = RPL_sequence_compare_fast(route->path_sequence, path_sequence);
+		if (!RPL_route_stale(table, route) && (result != RPL_SEQUENCE_COMPARE_B_GREATER) && (result != RPL_SEQUENCE_COMPARE_INCOMPARABLE) &&
+		    ((result != RPL_SEQUENCE_COMPARE_EQUAL) || (route->next_hop != RPL_address_find(table->addresses, next_hop)))) {
+			return RPL_ROUTE_STALE;
+		}
+		RPL_route_remove(table, route);
+		return RPL_ROUTE_REMOVED;
+	}
+
+	if ((handle = RPL_address_intern(table->addresses, key)) == RPL_ADDRESS_NONE) {
+		return RPL_ROUTE_FULL;
+	}
+	if ((hop = RPL_address_intern(table->addresses, next_hop)) == RPL_ADDRESS_NONE) {
+		RPL_address_release(table->addresses, handle);
+		return RPL_ROUTE_FULL;
+	}
+	if (prefix_length == 128) {
+		route = &table->hosts[handle];
+		if (!(route->flags & RPL_ROUTE_FLAG_VALID)) {
+			RPL_address_retain(table->addresses, handle);
+			route->prefix = handle;
+			route->prefix_length = 128;
+			route->flags = 0;
+			route->child[0] = RPL_ROUTE_NONE;
+			route->child[1] = RPL_ROUTE_NONE;
+		}
+	} else {
+		index = RPL_route_insert(table, key, handle, prefix_length);
+		if (index == RPL_ROUTE_NONE) {
+			RPL_address_release(table->addresses, hop);
+			RPL_address_release(table->addresses, handle);
+			return RPL_ROUTE_FULL;
+		}
+		route = &table->nodes[index];
+	}
+	if ((route->flags & RPL_ROUTE_FLAG_VALID) && RPL_route_stale(table, route)) {
+		//Replaces a route of a previous version
+		RPL_address_release(table->addresses, route->next_hop);
+		result = RPL_ROUTE_ADDED;
+	} else if (route->flags & RPL_ROUTE_FLAG_VALID) {
+		//Only an older Path Sequence is stale, an incomparable one is taken as newer
+		if (RPL_sequence_compare_fast(route->path_sequence, path_sequence) == RPL_SEQUENCE_COMPARE_A_GREATER) {
+			RPL_address_release(table->addresses, hop);
+			RPL_address_release(table->addresses, handle);
+			return RPL_ROUTE_STALE;
+		}
+		RPL_address_release(table->addresses, route->next_hop);
+		result = RPL_ROUTE_UPDATED;
+	} else {
+		//A branch point becoming a route may hold the longer prefix that created it
+		if (route->prefix != handle) {
+			RPL_address_release(table->addresses, route->prefix);
+			RPL_address_retain(table->addresses, handle);
+			route->prefix = handle;
+		}
+		table->count++;
+		result = RPL_ROUTE_ADDED;
+	}
+	RPL_address_release(table->addresses, handle);
+
+	route->next_hop = hop;
+	route->path_sequence = path_sequence;
+	route->epoch = table->epoch;
+	route->flags = RPL_ROUTE_FLAG_VALID | flags;
+	if (path_lifetime == RPL_ROUTE_LIFETIME_INFINITE) {
+		route->flags |= RPL_ROUTE_FLAG_INFINITE;
+		route->expires = 0;
+	} else {
+		route->expires = now + (uint32_t)path_lifetime * table->lifetime_unit;
+	}
+	return result;
+}
+
+int RPL_route_table_dao(struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length, const uint8_t next_hop[16], uint8_t path_sequence,
+                        uint8_t path_lifetime, uint32_t now) {
+	return RPL_route_table_store(table, prefix, prefix_length, next_hop, path_sequence, path_lifetime, now, 0);
+}
+
+int RPL_route_table_target(struct rpl_route_table_s *table, const struct rpl_option_view_s *target, const struct rpl_option_view_s *transit,
+                           const uint8_t next_hop[16], uint32_t now) {
+	return RPL_route_table_store(table, RPL_option_target_prefix(target), RPL_option_target_prefix_length(target), next_hop,
+	                             RPL_option_transit_info_path_sequence(transit), RPL_option_transit_info_path_lifetime(transit), now,
+	                             RPL_option_transit_info_external(transit) ? RPL_ROUTE_FLAG_EXTERNAL : 0);
+}
+
+const struct rpl_route_s *RPL_route_table_lookup(const struct rpl_route_table_s *table, const uint8_t address[16], uint32_t now) {
+	const struct rpl_route_s *best = RPL_route_host_find(table, address);
+	uint32_t index = table->root;
+
+	if ((best != NULL) && !RPL_route_expired(best, now) && !RPL_route_stale(table, best)) {
+		return best;
+	}
+	best = NULL;
+
+	while (index != RPL_ROUTE_NONE) {
+		const struct rpl_route_s *node = &table->nodes[index];
+
+		if (RPL_route_common_length(table, address, node, node->prefix_length) < node->prefix_length) {
+			break;
+		}
+		if ((node->flags & RPL_ROUTE_FLAG_VALID) && !RPL_route_expired(node, now) && !RPL_route_stale(table, node)) {
+			best = node;
+		}
+		if (node->prefix_length == 128) {
+			break;
+		}
+		index = node->child[RPL_route_bit(address, node->prefix_length)];
+	}
+	return best;
+}
+
+const struct rpl_route_s *RPL_route_table_find(const struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length) {
+	uint8_t key[16];
+
+	if (prefix_length > 128) {
+		return NULL;
+	}
+	RPL_route_normalize(key, prefix, prefix_length);
+	return RPL_route_exact(table, key, prefix_length);
+}
+
+int RPL_route_table_remove(struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length) {
+	struct rpl_route_s *route;
+	uint8_t key[16];
+
+	if (prefix_length > 128) {
+		return -1;
+	}
+	RPL_route_normalize(key, prefix, prefix_length);
+	route = RPL_route_exact(table, key, prefix_length);
+	if (route == NULL) {
+		return -1;
+	}
+	RPL_route_remove(table, route);
+	return 0;
+}
+
+uint32_t RPL_route_table_remove_next_hop(struct rpl_route_table_s *table, const uint8_t next_hop[16]) {
+	rpl_address_handle_t hop = RPL_address_find(table->addresses, next_hop);
+	uint32_t removed = 0;
+	uint32_t i;
+
+	if (hop == RPL_ADDRESS_NONE) {
+		return 0;
+	}
+	for (i = 0; i < table->pool.used; i++) {
+		if ((table->nodes[i].flags & RPL_ROUTE_FLAG_VALID) && (table->nodes[i].next_hop == hop)) {
+			RPL_route_remove_index(table, i);
+			removed++;
+		}
+	}
+	for (i = 0; i < table->addresses->pool.used; i++) {
+		if ((table->hosts[i].flags & RPL_ROUTE_FLAG_VALID) && (table->hosts[i].next_hop == hop)) {
+			RPL_route_remove_host(table, &table->hosts[i]);
+			removed++;
+		}
+	}
+	return removed;
+}
+
+void RPL_route_table_new_version(struct rpl_route_table_s *table) {
+	//Epochs are only compared for equality, every route is stale so the table is emptied before an epoch comes round again
+	if (++table->epoch == 0) {
+		uint32_t i;
+
+		for (i = 0; i < table->pool.used; i++) {
+			if (!(table->nodes[i].flags & RPL_ROUTE_FLAG_FREE)) {
+				if (table->nodes[i].flags & RPL_ROUTE_FLAG_VALID) {
+					RPL_address_release(table->addresses, table->nodes[i].next_hop);
+				}
+				RPL_address_release(table->addresses, table->nodes[i].prefix);
+			}
+		}
+		for (i = 0; i < table->addresses->pool.used; i++) {
+			if (table->hosts[i].flags & RPL_ROUTE_FLAG_VALID) {
+				RPL_route_remove_host(table, &table->hosts[i]);
+			}
+		}
+		RPL_pool_reset(&table->pool);
+		table->root = RPL_ROUTE_NONE;
+		table->count = 0;
+	}
+}
+
+uint32_t RPL_route_table_purge(struct rpl_route_table_s *table, uint32_t now) {
+	uint32_t removed = 0;
+	uint32_t i;
+
+	for (i = 0; i < table->pool.used; i++) {
+		if ((table->nodes[i].flags & RPL_ROUTE_FLAG_VALID) && (RPL_route_expired(&table->nodes[i], now) || RPL_route_stale(table, &table->nodes[i]))) {
+			RPL_route_remove_index(table, i);
+			removed++;
+		}
+	}
+	for (i = 0; i < table->addresses->pool.used; i++) {
+		if ((table->hosts[i].flags & RPL_ROUTE_FLAG_VALID) && (RPL_route_expired(&table->hosts[i], now) || RPL_route_stale(table, &table->hosts[i]))) {
+			RPL_route_remove_host(table, &table->hosts[i]);
+			removed++;
+		}
+	}
+	return removed;
+}
+
+#endif
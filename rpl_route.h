@@ -0,0 +1,174 @@
+/**
+ * RPL downward routes
+ * Storing mode route table built from DAO Target and Transit Information options [RFC6550 Section 9]
+ *
+ * Routes are held in a path compressed binary trie (a node per stored prefix plus a node per
+ * branch point) over a caller supplied node pool, so the table never allocates. Longest prefix
+ * match walks at most one node per distinct prefix length on the path, comparing 64 bits at a time.
+ * Prefixes and next hops are interned (see rpl_address.h): the many routes through a child share
+ * its next hop entry and a branch point shares the prefix of the route that created it, and the
+ * lower 64 bits of a prefix are only read when it is longer than /64.
+ *
+ * Host (/128) routes, most of the targets of a border router, are kept out of the trie in an
+ * array indexed by the handle of their address, so they take neither a branch point nor a walk:
+ * a lookup first finds the address in the address table. A host route then costs one route and
+ * one address entry, 44 octets with 32 bit handles (100k targets) against 112 for two nodes
+ * holding full addresses.
+ *
+ * Path Sequences are compared as lollipop counters [RFC6550 Section 7.2], stale DAOs are ignored
+ * and an incomparable Path Sequence counts as newer, for a No-Path as for an update.
+ * Path Lifetimes are given in Lifetime Units of the DODAG Configuration and converted to an
+ * expiry time (in seconds of a caller supplied clock) when stored. Expired routes are ignored by
+ * lookups and reclaimed by RPL_route_table_purge.
+ *
+ * Routes are stamped with the epoch of the table when stored. A new DODAG Version bumps the epoch,
+ * routes of previous versions are then ignored like expired routes until a DAO of the new version
+ * replaces them (whatever their Path Sequence) or they are purged, so a global repair costs no
+ * walk of the table.
+ *
+ * The table is compiled out with RPL_CONF_STORING 0, only the results and constants shared with
+ * the source route graph (rpl_source_route.h) are left.
+ */
+
+#ifndef RPL_ROUTE_H
+#define RPL_ROUTE_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_option.h"
+#include "rpl_pool.h"
+#include "rpl_address.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_ROUTE_NONE                  0xFFFFFFFFUL    //!< Null node index
+
+#define RPL_ROUTE_LIFETIME_INFINITE     0xFF            //!< Path Lifetime that never expires
+#define RPL_ROUTE_LIFETIME_NO_PATH      0x00            //!< Path Lifetime of a No-Path DAO
+
+#define RPL_ROUTE_FLAG_VALID            0x01            //!< Node holds a route (otherwise a branch point)
+#define RPL_ROUTE_FLAG_INFINITE         0x02            //!< Route does not expire
+#define RPL_ROUTE_FLAG_EXTERNAL         0x04            //!< Target is external to the DODAG (E flag)
+#define RPL_ROUTE_FLAG_FREE             0x80            //!< Node is on the free list
+
+/**
+ * Results of RPL_route_table_dao
+ */
+enum rpl_route_result_e {
+    RPL_ROUTE_LOOP = -3,            //!< Parent is a descendant of the target (non-storing mode)
+    RPL_ROUTE_INVALID = -2,         //!< Prefix length above 128 (or not a host route in non-storing mode)
+    RPL_ROUTE_FULL = -1,            //!< Node pool or address entries exhausted
+    RPL_ROUTE_ADDED = 0,            //!< New route stored
+    RPL_ROUTE_UPDATED = 1,          //!< Existing route refreshed or moved to a new next hop
+    RPL_ROUTE_REMOVED = 2,          //!< Route removed by a No-Path DAO
+    RPL_ROUTE_STALE = 3             //!< Path Sequence older than the stored route, ignored
+};
+
+#if RPL_CONF_STORING
+
+/**
+ * @brief Route trie node
+ */
+struct rpl_route_s {
+    rpl_address_handle_t prefix;    //!< Interned target prefix, bits past prefix_length are zero (any for a branch point)
+    rpl_address_handle_t next_hop;  //!< Interned link-local address of the child that advertised the target
+    uint32_t child[2];              //!< Subtries on the bit following the prefix, RPL_ROUTE_NONE for a host route
+    uint32_t expires;               //!< Expiry time in seconds (see RPL_ROUTE_FLAG_INFINITE)
+    uint8_t prefix_length;          //!< Prefix length in bits
+    uint8_t flags;                  //!< RPL_ROUTE_FLAG_*
+    uint8_t path_sequence;          //!< Path Sequence of the last accepted Transit Information
+    uint8_t epoch;                  //!< Table epoch when stored, other epochs are previous DODAG Versions
+};
+
+/**
+ * @brief Route table
+ */
+struct rpl_route_table_s {
+    struct rpl_address_table_s *addresses;  //!< Prefixes and next hops
+    struct rpl_route_s *nodes;      //!< Node storage
+    struct rpl_route_s *hosts;      //!< Host routes indexed by the handle of their address
+    struct rpl_pool_s pool;         //!< Nodes in use, n routes shorter than /128 need at most 2n - 1
+    uint32_t root;                  //!< Root node
+    uint32_t count;                 //!< Number of routes, including expired and stale routes not yet purged
+    uint16_t lifetime_unit;         //!< Lifetime Unit in seconds
+    uint8_t epoch;                  //!< Current epoch, bumped for each DODAG Version
+};
+
+/**
+ * @brief Initialise an empty table using the given nodes
+ * @details hosts has an entry per entry of addresses. lifetime_unit of 0 is taken as 1 second.
+ * addresses needs an entry per prefix and next hop and one per distinct /64 among them (see
+ * rpl_address.h), a DAO that does not fit is answered with RPL_ROUTE_FULL like one that finds no
+ * free node.
+ */
+void RPL_route_table_init(struct rpl_route_table_s *table, struct rpl_address_table_s *addresses, struct rpl_route_s *nodes, uint32_t capacity,
+                          struct rpl_route_s *hosts, uint16_t lifetime_unit);
+
+/**
+ * @brief Add, refresh or remove (No-Path) a route from a Target/Transit Information pair
+ *
+ * @param prefix target prefix, at least (prefix_length + 7) / 8 octets
+ * @param next_hop link-local address of the DAO sender
+ * @param now current time in seconds
+ * @return rpl_route_result_e
+ */
+int RPL_route_table_dao(struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length, const uint8_t next_hop[16], uint8_t path_sequence,
+                        uint8_t path_lifetime, uint32_t now);
+
+/**
+ * @brief As RPL_route_table_dao from received (validated) RPL Target and Transit Information options
+ */
+int RPL_route_table_target(struct rpl_route_table_s *table, const struct rpl_option_view_s *target, const struct rpl_option_view_s *transit,
+                           const uint8_t next_hop[16], uint32_t now);
+
+/**
+ * @brief Longest prefix match
+ * @return the route, NULL when no unexpired route covers the address
+ */
+const struct rpl_route_s *RPL_route_table_lookup(const struct rpl_route_table_s *table, const uint8_t address[16], uint32_t now);
+
+/**
+ * @brief Exact match, including expired and stale routes
+ */
+const struct rpl_route_s *RPL_route_table_find(const struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length);
+
+static inline void RPL_route_prefix(const struct rpl_route_table_s *table, const struct rpl_route_s *route, uint8_t prefix[16]) {
+    RPL_address_get(table->addresses, route->prefix, prefix);
+}
+
+static inline void RPL_route_next_hop(const struct rpl_route_table_s *table, const struct rpl_route_s *route, uint8_t next_hop[16]) {
+    RPL_address_get(table->addresses, route->next_hop, next_hop);
+}
+
+/**
+ * @return 0 on success, -1 when there is no such route
+ */
+int RPL_route_table_remove(struct rpl_route_table_s *table, const uint8_t *prefix, uint8_t prefix_length);
+
+/**
+ * @brief Remove all routes through a next hop, eg. an unreachable child
+ * @return number of routes removed
+ */
+uint32_t RPL_route_table_remove_next_hop(struct rpl_route_table_s *table, const uint8_t next_hop[16]);
+
+/**
+ * @brief Move to a new DODAG Version, the routes stored so far become stale
+ */
+void RPL_route_table_new_version(struct rpl_route_table_s *table);
+
+/**
+ * @brief Remove expired and stale routes
+ * @return number of routes removed
+ */
+uint32_t RPL_route_table_purge(struct rpl_route_table_s *table, uint32_t now);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
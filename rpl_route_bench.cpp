@@ -0,0 +1,134 @@
+/**
+ * Route lookup micro-benchmark
+ * Storing mode longest prefix match (rpl_route) and non-storing mode source routing header
+ * construction (rpl_source_route) with 1k, 10k and 100k routes.
+ * Uses Google Benchmark (see rpl_bench.h), 100k routes need 32 bit address handles, build with eg.
+ *   gcc -O3 -DRPL_CONF_ADDRESS_HANDLE_BITS=32 -c rpl_*.c
+ *   g++ -O3 -DRPL_CONF_ADDRESS_HANDLE_BITS=32 rpl_route_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+#define BENCH_LOOKUPS       1024
+
+#if RPL_CONF_STORING || RPL_CONF_NON_STORING
+static void bench_address(uint8_t address[16], uint32_t id) {
+	static const uint8_t prefix[8] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0 };
+
+	memcpy(address, prefix, 8);
+	RPL_write_uint32(address + 8, 0);
+	RPL_write_uint32(address + 12, id * 0x9E3779B1UL);
+}
+#endif
+
+#if RPL_CONF_STORING
+//Routes to random /128 targets through 16 children, looked up in random order
+static void BM_route_lookup(benchmark::State &state) {
+	uint32_t count = (uint32_t)state.range(0);
+	struct rpl_route_s nodes[16];
+	struct rpl_route_s *hosts = (struct rpl_route_s *)malloc((count + 16) * sizeof(struct rpl_route_s));
+	uint8_t (*addresses)[16] = (uint8_t (*)[16])malloc(BENCH_LOOKUPS * 16);
+	struct rpl_address_s *entries = (struct rpl_address_s *)malloc((count + 16) * sizeof(struct rpl_address_s));
+	rpl_address_handle_t *index = (rpl_address_handle_t *)malloc(131072 * sizeof(rpl_address_handle_t));
+	struct rpl_address_table_s interned;
+	struct rpl_route_table_s table;
+	uint8_t address[16], next_hop[16];
+	uint32_t random = 0x6550;
+	uint32_t i;
+
+	if (count + 16 >= RPL_ADDRESS_NONE) {
+		state.SkipWithError("more routes than address handles, build with RPL_CONF_ADDRESS_HANDLE_BITS 32");
+		free(index);
+		free(entries);
+		free(addresses);
+		free(hosts);
+		return;
+	}
+	RPL_address_table_init(&interned, entries, count + 16, index, 131072);
+	RPL_route_table_init(&table, &interned, nodes, 16, hosts, 60);
+	memset(next_hop, 0, 16);
+	next_hop[0] = 0xFE;
+	next_hop[1] = 0x80;
+	for (i = 0; i < count; i++) {
+		bench_address(address, i);
+		next_hop[15] = (uint8_t)(i % 16);
+		RPL_route_table_dao(&table, address, 128, next_hop, 1, RPL_ROUTE_LIFETIME_INFINITE, 0);
+	}
+	for (i = 0; i < BENCH_LOOKUPS; i++) {
+		bench_address(addresses[i], rpl_bench_random(&random) % count);
+	}
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		uint32_t found = 0;
+
+		for (i = 0; i < BENCH_LOOKUPS; i++) {
+			found += (RPL_route_table_lookup(&table, addresses[i], 0) != NULL);
+		}
+		benchmark::DoNotOptimize(found);
+	}
+	rpl_bench_items(state, BENCH_LOOKUPS);
+	free(index);
+	free(entries);
+	free(addresses);
+	free(hosts);
+}
+BENCHMARK(BM_route_lookup)->Arg(1000)->Arg(10000)->Arg(100000);
+#endif
+
+#if RPL_CONF_NON_STORING
+//Source routing headers to random nodes of a random tree
+static void BM_source_route_header(benchmark::State &state) {
+	uint32_t count = (uint32_t)state.range(0);
+	uint32_t index_size = 1;
+	struct rpl_source_route_node_s *nodes;
+	struct rpl_source_route_graph_s graph;
+	uint8_t (*addresses)[16] = (uint8_t (*)[16])malloc(BENCH_LOOKUPS * 16);
+	uint8_t address[16], parent[16], header[1024];
+	uint32_t random = 0x6550;
+	uint32_t *index;
+	uint32_t i;
+
+	while (index_size <= count) {
+		index_size <<= 1;
+	}
+	nodes = (struct rpl_source_route_node_s *)malloc((count + 1) * sizeof(struct rpl_source_route_node_s));
+	index = (uint32_t *)malloc(index_size * 2 * sizeof(uint32_t));
+	bench_address(address, 0);
+	RPL_source_route_init(&graph, nodes, count + 1, index, index_size * 2, address, 60);
+	for (i = 1; i <= count; i++) {
+		bench_address(address, i);
+		//Parents are picked among the nodes within range of the previous ones, giving a depth of about 20
+		bench_address(parent, (i <= 8) ? 0 : i - 1 - rpl_bench_random(&random) % ((i / 8) + 1));
+		RPL_source_route_dao(&graph, address, parent, 1, RPL_ROUTE_LIFETIME_INFINITE, 0);
+	}
+	for (i = 0; i < BENCH_LOOKUPS; i++) {
+		bench_address(addresses[i], 1 + rpl_bench_random(&random) % count);
+	}
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		int length = 0;
+
+		for (i = 0; i < BENCH_LOOKUPS; i++) {
+			const uint8_t *first_hop;
+
+			length += RPL_source_route_header(&graph, addresses[i], 58, header, sizeof(header), &first_hop);
+		}
+		benchmark::DoNotOptimize(length);
+	}
+	rpl_bench_items(state, BENCH_LOOKUPS);
+	free(addresses);
+	free(index);
+	free(nodes);
+}
+BENCHMARK(BM_source_route_header)->Arg(1000)->Arg(10000)->Arg(100000);
+#endif
+
+RPL_BENCH_MAIN()
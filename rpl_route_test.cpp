@@ -0,0 +1,436 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#if RPL_CONF_STORING
+
+#define ROUTE_TEST_CAPACITY     64
+
+static const uint8_t child_a[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0A };
+static const uint8_t child_b[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0B };
+
+static void route_address(uint8_t address[16], uint32_t prefix, uint32_t iid) {
+	memset(address, 0, 16);
+	address[0] = 0x20;
+	address[1] = 0x01;
+	address[2] = 0x0D;
+	address[3] = 0xB8;
+	RPL_write_uint32(address + 4, prefix);
+	RPL_write_uint32(address + 12, iid);
+}
+
+static int route_prefix_match(const uint8_t *address, const uint8_t *prefix, int length) {
+	uint8_t mask = (uint8_t)(0xFF << (8 - (length & 7)));
+
+	if (memcmp(address, prefix, (size_t)(length / 8)) != 0) {
+		return 0;
+	}
+	return !(length & 7) || !((address[length / 8] ^ prefix[length / 8]) & mask);
+}
+
+//Number of nodes in use, each route needs at most one branch point
+static uint32_t route_nodes_used(const struct rpl_route_table_s *table) {
+	uint32_t used = 0;
+	uint32_t i;
+
+	for (i = 0; i < table->pool.used; i++) {
+		used += !(table->nodes[i].flags & RPL_ROUTE_FLAG_FREE);
+	}
+	return used;
+}
+
+TEST_GROUP(route_tests)
+{
+	struct rpl_route_s nodes[ROUTE_TEST_CAPACITY];
+	struct rpl_route_s hosts[ROUTE_TEST_CAPACITY + 2];
+	struct rpl_route_table_s table;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[ROUTE_TEST_CAPACITY + 2];
+	rpl_address_handle_t index[ROUTE_TEST_CAPACITY];
+	uint8_t address[16];
+	uint8_t next_hop[16];
+
+	void setup() {
+		RPL_address_table_init(&addresses, entries, ROUTE_TEST_CAPACITY + 2, index, ROUTE_TEST_CAPACITY);
+		RPL_route_table_init(&table, &addresses, nodes, ROUTE_TEST_CAPACITY, hosts, 60);
+	}
+
+	const uint8_t *route_next_hop(const struct rpl_route_s *route) {
+		RPL_route_next_hop(&table, route, next_hop);
+		return next_hop;
+	}
+
+	void teardown() {
+	}
+};
+
+TEST(route_tests, route_longest_match) {
+	uint8_t prefix[16];
+	const struct rpl_route_s *route;
+
+	route_address(prefix, 1, 0);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, prefix, 64, child_a, 240, 10, 0));
+	route_address(address, 1, 5);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 128, child_b, 240, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, prefix, 32, child_b, 240, 10, 0));
+	CHECK_EQUAL(3, table.count);
+
+	route = RPL_route_table_lookup(&table, address, 0);
+	CHECK(route != NULL);
+	CHECK_EQUAL(128, route->prefix_length);
+	MEMCMP_EQUAL(child_b, route_next_hop(route), 16);
+
+	route_address(address, 1, 6);
+	route = RPL_route_table_lookup(&table, address, 0);
+	CHECK_EQUAL(64, route->prefix_length);
+	MEMCMP_EQUAL(child_a, route_next_hop(route), 16);
+
+	route_address(address, 2, 6);
+	CHECK_EQUAL(32, RPL_route_table_lookup(&table, address, 0)->prefix_length);
+
+	address[0] = 0xFD;
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, address, 0));
+
+	//Default route
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 0, child_a, 240, 10, 0));
+	CHECK_EQUAL(0, RPL_route_table_lookup(&table, address, 0)->prefix_length);
+
+	//Bits past the prefix length are ignored
+	route_address(prefix, 1, 0);
+	prefix[7] |= 0x01;
+	CHECK(RPL_route_table_find(&table, prefix, 63) == NULL);
+	CHECK(RPL_route_table_find(&table, prefix, 32) != NULL);
+	CHECK_EQUAL(RPL_ROUTE_INVALID, RPL_route_table_dao(&table, prefix, 129, child_a, 240, 10, 0));
+}
+
+//Path Sequence is a lollipop counter
+TEST(route_tests, route_path_sequence) {
+	route_address(address, 1, 1);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 128, child_a, 250, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_UPDATED, RPL_route_table_dao(&table, address, 128, child_a, 250, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_UPDATED, RPL_route_table_dao(&table, address, 128, child_b, 2, 10, 0));
+	MEMCMP_EQUAL(child_b, route_next_hop(RPL_route_table_find(&table, address, 128)), 16);
+
+	//Older sequences are ignored
+	CHECK_EQUAL(RPL_ROUTE_STALE, RPL_route_table_dao(&table, address, 128, child_a, 255, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_STALE, RPL_route_table_dao(&table, address, 128, child_a, 1, 10, 0));
+	MEMCMP_EQUAL(child_b, route_next_hop(RPL_route_table_find(&table, address, 128)), 16);
+	CHECK_EQUAL(2, RPL_route_table_find(&table, address, 128)->path_sequence);
+}
+
+TEST(route_tests, route_no_path) {
+	route_address(address, 1, 1);
+	RPL_route_table_dao(&table, address, 128, child_a, 10, 10, 0);
+
+	//A No-Path with the same sequence from another child does not remove the route
+	CHECK_EQUAL(RPL_ROUTE_STALE, RPL_route_table_dao(&table, address, 128, child_b, 10, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(RPL_ROUTE_STALE, RPL_route_table_dao(&table, address, 128, child_a, 9, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(1, table.count);
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_route_table_dao(&table, address, 128, child_a, 10, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(0, table.count);
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, address, 0));
+
+	RPL_route_table_dao(&table, address, 128, child_a, 10, 10, 0);
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_route_table_dao(&table, address, 128, child_b, 11, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_route_table_dao(&table, address, 128, child_b, 11, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(0, route_nodes_used(&table));
+}
+
+//An incomparable Path Sequence is taken as newer, by updates and No-Paths alike
+TEST(route_tests, route_incomparable_sequence) {
+	route_address(address, 1, 1);
+	RPL_route_table_dao(&table, address, 128, child_a, 10, 10, 0);
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_INCOMPARABLE, RPL_sequence_compare_fast(10, 100));
+
+	CHECK_EQUAL(RPL_ROUTE_UPDATED, RPL_route_table_dao(&table, address, 128, child_b, 100, 10, 0));
+	CHECK_EQUAL(100, RPL_route_table_find(&table, address, 128)->path_sequence);
+
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_route_table_dao(&table, address, 128, child_a, 10, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(0, table.count);
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, address, 0));
+}
+
+//Lifetimes are in Lifetime Units (60 s in this table)
+TEST(route_tests, route_lifetime) {
+	uint8_t other[16];
+
+	route_address(address, 1, 1);
+	route_address(other, 1, 2);
+	RPL_route_table_dao(&table, address, 128, child_a, 10, 2, 1000);
+	RPL_route_table_dao(&table, other, 128, child_a, 10, RPL_ROUTE_LIFETIME_INFINITE, 1000);
+	CHECK_EQUAL(1120, RPL_route_table_find(&table, address, 128)->expires);
+
+	CHECK(RPL_route_table_lookup(&table, address, 1119) != NULL);
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, address, 1120));
+	CHECK(RPL_route_table_lookup(&table, other, 1000000) != NULL);
+
+	CHECK_EQUAL(0, RPL_route_table_purge(&table, 1119));
+	CHECK_EQUAL(1, RPL_route_table_purge(&table, 1120));
+	CHECK_EQUAL(1, table.count);
+	CHECK(RPL_route_table_find(&table, address, 128) == NULL);
+}
+
+//Routes of previous DODAG Versions are ignored until replaced or purged
+TEST(route_tests, route_new_version) {
+	uint8_t other[16];
+	int i;
+
+	route_address(address, 1, 1);
+	route_address(other, 1, 2);
+	RPL_route_table_dao(&table, address, 128, child_a, 10, RPL_ROUTE_LIFETIME_INFINITE, 0);
+	RPL_route_table_dao(&table, other, 128, child_a, 10, RPL_ROUTE_LIFETIME_INFINITE, 0);
+	RPL_route_table_new_version(&table);
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, address, 0));
+	CHECK(RPL_route_table_find(&table, address, 128) != NULL);
+
+	//A DAO of the new version replaces the route whatever its Path Sequence
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 128, child_b, 5, RPL_ROUTE_LIFETIME_INFINITE, 0));
+	MEMCMP_EQUAL(child_b, route_next_hop(RPL_route_table_lookup(&table, address, 0)), 16);
+	CHECK_EQUAL(2, table.count);
+	CHECK_EQUAL(1, RPL_route_table_purge(&table, 0));
+	CHECK_EQUAL(1, table.count);
+	POINTERS_EQUAL(NULL, RPL_route_table_find(&table, other, 128));
+
+	//No-Path for a stale route removes it
+	RPL_route_table_new_version(&table);
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_route_table_dao(&table, address, 128, child_a, 1, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(0, table.count);
+
+	//Old routes never come back when the epoch wraps
+	RPL_route_table_dao(&table, other, 128, child_a, 10, RPL_ROUTE_LIFETIME_INFINITE, 0);
+	for (i = 0; i < 256; i++) {
+		RPL_route_table_new_version(&table);
+	}
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, other, 0));
+	CHECK_EQUAL(0, route_nodes_used(&table));
+}
+
+TEST(route_tests, route_remove) {
+	uint32_t i;
+
+	for (i = 0; i < 20; i++) {
+		route_address(address, i / 4, i);
+		RPL_route_table_dao(&table, address, 128, (i & 1) ? child_a : child_b, 10, 10, 0);
+	}
+	CHECK_EQUAL(20, table.count);
+	CHECK_EQUAL(10, RPL_route_table_remove_next_hop(&table, child_a));
+	CHECK_EQUAL(10, table.count);
+	CHECK(route_nodes_used(&table) <= 2 * table.count - 1);
+
+	route_address(address, 0, 0);
+	CHECK_EQUAL(0, RPL_route_table_remove(&table, address, 128));
+	CHECK_EQUAL(-1, RPL_route_table_remove(&table, address, 128));
+	CHECK_EQUAL(9, table.count);
+}
+
+//Pool exhaustion fails cleanly, released nodes are reused
+TEST(route_tests, route_full) {
+	uint32_t i;
+	int result = RPL_ROUTE_ADDED;
+
+	for (i = 0; result == RPL_ROUTE_ADDED; i++) {
+		route_address(address, i % 2, 0);
+		RPL_write_uint32(address + 8, i * 7919);
+		result = RPL_route_table_dao(&table, address, 96, child_a, 10, 10, 0);
+	}
+	CHECK_EQUAL(RPL_ROUTE_FULL, result);
+	CHECK(table.count >= ROUTE_TEST_CAPACITY / 2);
+	CHECK(addresses.pool.count < ROUTE_TEST_CAPACITY + 2);
+
+	route_address(address, 0, 0);
+	CHECK_EQUAL(0, RPL_route_table_remove(&table, address, 96));
+	RPL_write_uint32(address + 8, 1000);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 96, child_a, 10, 10, 0));
+	CHECK_EQUAL(ROUTE_TEST_CAPACITY, table.pool.used);
+}
+
+//Host routes take no node, they are only limited by the address entries
+TEST(route_tests, route_hosts_full) {
+	uint32_t i;
+	int result = RPL_ROUTE_ADDED;
+
+	for (i = 0; result == RPL_ROUTE_ADDED; i++) {
+		route_address(address, 0, i + 1);
+		result = RPL_route_table_dao(&table, address, 128, child_a, 10, 10, 0);
+	}
+	CHECK_EQUAL(RPL_ROUTE_FULL, result);
+	//The next hop and its /64 and the hosts' /64 take three entries
+	CHECK_EQUAL(ROUTE_TEST_CAPACITY - 1, table.count);
+	CHECK_EQUAL(0, table.pool.used);
+
+	route_address(address, 0, 1);
+	CHECK_EQUAL(0, RPL_route_table_remove(&table, address, 128));
+	route_address(address, 0, 1000);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 128, child_a, 10, 10, 0));
+	CHECK(RPL_route_table_find(&table, address, 128) != NULL);
+}
+
+//Distinct /64s are only limited by the address entries, each takes a context entry
+TEST(route_tests, route_prefixes) {
+	//The next hop and its context take two entries, each /48 its prefix and a context
+	const uint32_t fit = ROUTE_TEST_CAPACITY / 2;
+	uint32_t i;
+
+	for (i = 0; i < fit; i++) {
+		route_address(address, i << 16, 0);
+		CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 48, child_a, 240, 30, 0));
+	}
+	CHECK_EQUAL(fit, table.count);
+	CHECK_EQUAL(ROUTE_TEST_CAPACITY + 2, addresses.pool.count);
+
+	//The next one runs out of entries, not of nodes
+	route_address(address, fit << 16, 0);
+	CHECK_EQUAL(RPL_ROUTE_FULL, RPL_route_table_dao(&table, address, 48, child_a, 240, 30, 0));
+	CHECK(table.pool.count < ROUTE_TEST_CAPACITY);
+	CHECK_EQUAL(ROUTE_TEST_CAPACITY + 2, addresses.pool.count);
+}
+
+//Routes from a DAO built and parsed with the message modules
+TEST(route_tests, route_target_options) {
+	struct rpl_dao_s dao = {};
+	struct rpl_option_transit_info_s transit_info = {};
+	struct rpl_message_view_s message;
+	struct rpl_dao_view_s view;
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s target;
+	struct rpl_option_view_s transit;
+	struct rpl_builder_s builder;
+	uint8_t buffer[128];
+	const struct rpl_route_s *route;
+	int length;
+
+	route_address(address, 7, 0);
+	transit_info.flags = RPL_OPTION_TRANSIT_INFO_EXTERNAL_MASK;
+	transit_info.path_sequence = 240;
+	transit_info.path_lifetime = 3;
+	RPL_builder_init(&builder, buffer, sizeof(buffer), NULL, 0);
+	RPL_builder_dao(&builder, &dao, NULL);
+	RPL_builder_target(&builder, 64, address);
+	RPL_builder_transit_info(&builder, &transit_info, NULL);
+	length = RPL_builder_finish(&builder, child_a, child_b);
+	CHECK(length > 0);
+
+	RPL_message_view_init(&message, buffer, (uint16_t)length);
+	CHECK_EQUAL(0, RPL_dao_view_init(&view, &message));
+	RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_dao_view_options(&view), RPL_dao_view_options_length(&view));
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &target));
+	CHECK_EQUAL(1, RPL_option_iter_next(&iter, &transit));
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_target(&table, &target, &transit, child_a, 0));
+
+	route_address(address, 7, 99);
+	route = RPL_route_table_lookup(&table, address, 0);
+	CHECK(route != NULL);
+	CHECK_EQUAL(64, route->prefix_length);
+	CHECK_EQUAL(240, route->path_sequence);
+	CHECK_EQUAL(180, route->expires);
+	CHECK(route->flags & RPL_ROUTE_FLAG_EXTERNAL);
+}
+
+//Random prefixes checked against a linear longest prefix match
+TEST(route_tests, route_random) {
+	static struct rpl_route_s pool[4096];
+	static struct rpl_route_s pool_hosts[2048];
+	static struct rpl_address_s pool_entries[2048];
+	static rpl_address_handle_t pool_index[2048];
+	static uint8_t prefixes[1024][16];
+	static uint8_t lengths[1024];
+	static uint8_t present[1024];
+	uint32_t step, i;
+	int best;
+
+	RPL_address_table_init(&addresses, pool_entries, 2048, pool_index, 2048);
+	RPL_route_table_init(&table, &addresses, pool, 4096, pool_hosts, 1);
+	memset(present, 0, sizeof(present));
+	srand(6550);
+	for (i = 0; i < 1024; i++) {
+		uint32_t j;
+
+		//Distinct prefixes, so that the reference tracks each route separately
+		do {
+			route_address(prefixes[i], (uint32_t)rand() % 8, (uint32_t)rand());
+			prefixes[i][8] = (uint8_t)(rand() % 4);
+			lengths[i] = (uint8_t)(rand() % 4 == 0 ? 128 : 32 + rand() % 97);
+			for (j = 0; j < i; j++) {
+				if ((lengths[j] == lengths[i]) && route_prefix_match(prefixes[i], prefixes[j], lengths[i])) {
+					break;
+				}
+			}
+		} while (j < i);
+	}
+
+	for (step = 0; step < 20000; step++) {
+		i = (uint32_t)rand() % 1024;
+		if (rand() % 3 == 0) {
+			RPL_route_table_remove(&table, prefixes[i], lengths[i]);
+			present[i] = 0;
+		} else {
+			RPL_route_table_dao(&table, prefixes[i], lengths[i], child_a, (uint8_t)i, 10, 0);
+			present[i] = 1;
+		}
+
+		route_address(address, (uint32_t)rand() % 8, (uint32_t)rand());
+		address[8] = (uint8_t)(rand() % 4);
+		if (rand() % 2) {
+			memcpy(address, prefixes[rand() % 1024], 16);
+		}
+		best = -1;
+		for (i = 0; i < 1024; i++) {
+			if (present[i] && ((best < 0) || (lengths[i] > lengths[best])) && route_prefix_match(address, prefixes[i], lengths[i])) {
+				best = (int)i;
+			}
+		}
+
+		if (best < 0) {
+			POINTERS_EQUAL(NULL, RPL_route_table_lookup(&table, address, 0));
+		} else {
+			CHECK(RPL_route_table_lookup(&table, address, 0) != NULL);
+			CHECK_EQUAL(lengths[best], RPL_route_table_lookup(&table, address, 0)->prefix_length);
+		}
+	}
+	CHECK(route_nodes_used(&table) <= 2 * table.count + 1);
+	CHECK(addresses.pool.count <= table.count + 1);
+}
+
+//Border router scale, 16 bit handles hold up to 65534 addresses and 100k targets need 32 bit ones
+TEST(route_tests, route_100k) {
+	//Two next hops, their context and the contexts of 8 target prefixes
+	const uint32_t extra = 11;
+	const uint32_t targets = (RPL_ADDRESS_NONE < 100000UL + extra) ? RPL_ADDRESS_NONE - 1UL - extra : 100000UL;
+	struct rpl_route_s *pool_hosts = (struct rpl_route_s *)malloc((targets + extra) * sizeof(struct rpl_route_s));
+	struct rpl_address_s *pool_entries = (struct rpl_address_s *)malloc((targets + extra) * sizeof(struct rpl_address_s));
+	rpl_address_handle_t *pool_index = (rpl_address_handle_t *)malloc(131072 * sizeof(rpl_address_handle_t));
+	uint32_t i;
+
+	CHECK_EQUAL(0, RPL_address_table_init(&addresses, pool_entries, targets + extra, pool_index, 131072));
+	RPL_route_table_init(&table, &addresses, nodes, ROUTE_TEST_CAPACITY, pool_hosts, 60);
+	for (i = 0; i < targets; i++) {
+		route_address(address, i % 8, i * 2654435761UL);
+		CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_route_table_dao(&table, address, 128, (i & 1) ? child_a : child_b, 240, 30, 0));
+	}
+	CHECK_EQUAL(targets, table.count);
+	//Host routes take no trie node
+	CHECK_EQUAL(0, table.pool.used);
+	for (i = 0; i < targets; i++) {
+		const struct rpl_route_s *route;
+		uint8_t prefix[16];
+
+		route_address(address, i % 8, i * 2654435761UL);
+		route = RPL_route_table_lookup(&table, address, 0);
+		CHECK(route != NULL);
+		RPL_route_prefix(&table, route, prefix);
+		MEMCMP_EQUAL(address, prefix, 16);
+	}
+	CHECK_EQUAL(targets, RPL_route_table_purge(&table, 30 * 60));
+	CHECK_EQUAL(0, route_nodes_used(&table));
+	CHECK_EQUAL(0, addresses.pool.count);
+	free(pool_index);
+	free(pool_entries);
+	free(pool_hosts);
+}
+
+#endif
@@ -0,0 +1,611 @@
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RPL_SECURITY_AESNI
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+#include "rpl.h"
+
+#if RPL_CONF_SECURITY
+
+//AES-128 [FIPS-197], encryption only
+
+#define RPL_SECURITY_LANES      4       //!< Blocks encrypted together, enough to hide the AES-NI round latency
+
+static const uint8_t RPL_aes_sbox[256] = {
+	0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+	0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+	0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+	0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+	0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+	0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+	0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+	0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+	0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+	0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+	0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+	0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+	0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+	0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+	0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+	0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+//Round table, T1..T3 are byte rotations of T0
+static const uint32_t RPL_aes_t0[256] = {
+	0xC66363A5, 0xF87C7C84, 0xEE777799, 0xF67B7B8D, 0xFFF2F20D, 0xD66B6BBD, 0xDE6F6FB1, 0x91C5C554,
+	0x60303050, 0x02010103, 0xCE6767A9, 0x562B2B7D, 0xE7FEFE19, 0xB5D7D762, 0x4DABABE6, 0xEC76769A,
+	0x8FCACA45, 0x1F82829D, 0x89C9C940, 0xFA7D7D87, 0xEFFAFA15, 0xB25959EB, 0x8E4747C9, 0xFBF0F00B,
+	0x41ADADEC, 0xB3D4D467, 0x5FA2A2FD, 0x45AFAFEA, 0x239C9CBF, 0x53A4A4F7, 0xE4727296, 0x9BC0C05B,
+	0x75B7B7C2, 0xE1FDFD1C, 0x3D9393AE, 0x4C26266A, 0x6C36365A, 0x7E3F3F41, 0xF5F7F702, 0x83CCCC4F,
+	0x6834345C, 0x51A5A5F4, 0xD1E5E534, 0xF9F1F108, 0xE2717193, 0xABD8D873, 0x62313153, 0x2A15153F,
+	0x0804040C, 0x95C7C752, 0x46232365, 0x9DC3C35E, 0x30181828, 0x379696A1, 0x0A05050F, 0x2F9A9AB5,
+	0x0E070709, 0x24121236, 0x1B80809B, 0xDFE2E23D, 0xCDEBEB26, 0x4E272769, 0x7FB2B2CD, 0xEA75759F,
+	0x1209091B, 0x1D83839E, 0x582C2C74, 0x341A1A2E, 0x361B1B2D, 0xDC6E6EB2, 0xB45A5AEE, 0x5BA0A0FB,
+	0xA45252F6, 0x763B3B4D, 0xB7D6D661, 0x7DB3B3CE, 0x5229297B, 0xDDE3E33E, 0x5E2F2F71, 0x13848497,
+	0xA65353F5, 0xB9D1D168, 0x00000000, 0xC1EDED2C, 0x40202060, 0xE3FCFC1F, 0x79B1B1C8, 0xB65B5BED,
+	0xD46A6ABE, 0x8DCBCB46, 0x67BEBED9, 0x7239394B, 0x944A4ADE, 0x984C4CD4, 0xB05858E8, 0x85CFCF4A,
+	0xBBD0D06B, 0xC5EFEF2A, 0x4FAAAAE5, 0xEDFBFB16, 0x864343C5, 0x9A4D4DD7, 0x66333355, 0x11858594,
+	0x8A4545CF, 0xE9F9F910, 0x04020206, 0xFE7F7F81, 0xA05050F0, 0x783C3C44, 0x259F9FBA, 0x4BA8A8E3,
+	0xA25151F3, 0x5DA3A3FE, 0x804040C0, 0x058F8F8A, 0x3F9292AD, 0x219D9DBC, 0x70383848, 0xF1F5F504,
+	0x63BCBCDF, 0x77B6B6C1, 0xAFDADA75, 0x42212163, 0x20101030, 0xE5FFFF1A, 0xFDF3F30E, 0xBFD2D26D,
+	0x81CDCD4C, 0x180C0C14, 0x26131335, 0xC3ECEC2F, 0xBE5F5FE1, 0x359797A2, 0x884444CC, 0x2E171739,
+	0x93C4C457, 0x55A7A7F2, 0xFC7E7E82, 0x7A3D3D47, 0xC86464AC, 0xBA5D5DE7, 0x3219192B, 0xE6737395,
+	0xC06060A0, 0x19818198, 0x9E4F4FD1, 0xA3DCDC7F, 0x44222266, 0x542A2A7E, 0x3B9090AB, 0x0B888883,
+	0x8C4646CA, 0xC7EEEE29, 0x6BB8B8D3, 0x2814143C, 0xA7DEDE79, 0xBC5E5EE2, 0x160B0B1D, 0xADDBDB76,
+	0xDBE0E03B, 0x64323256, 0x743A3A4E, 0x140A0A1E, 0x924949DB, 0x0C06060A, 0x4824246C, 0xB85C5CE4,
+	0x9FC2C25D, 0xBDD3D36E, 0x43ACACEF, 0xC46262A6, 0x399191A8, 0x319595A4, 0xD3E4E437, 0xF279798B,
+	0xD5E7E732, 0x8BC8C843, 0x6E373759, 0xDA6D6DB7, 0x018D8D8C, 0xB1D5D564, 0x9C4E4ED2, 0x49A9A9E0,
+	0xD86C6CB4, 0xAC5656FA, 0xF3F4F407, 0xCFEAEA25, 0xCA6565AF, 0xF47A7A8E, 0x47AEAEE9, 0x10080818,
+	0x6FBABAD5, 0xF0787888, 0x4A25256F, 0x5C2E2E72, 0x381C1C24, 0x57A6A6F1, 0x73B4B4C7, 0x97C6C651,
+	0xCBE8E823, 0xA1DDDD7C, 0xE874749C, 0x3E1F1F21, 0x964B4BDD, 0x61BDBDDC, 0x0D8B8B86, 0x0F8A8A85,
+	0xE0707090, 0x7C3E3E42, 0x71B5B5C4, 0xCC6666AA, 0x904848D8, 0x06030305, 0xF7F6F601, 0x1C0E0E12,
+	0xC26161A3, 0x6A35355F, 0xAE5757F9, 0x69B9B9D0, 0x17868691, 0x99C1C158, 0x3A1D1D27, 0x279E9EB9,
+	0xD9E1E138, 0xEBF8F813, 0x2B9898B3, 0x22111133, 0xD26969BB, 0xA9D9D970, 0x078E8E89, 0x339494A7,
+	0x2D9B9BB6, 0x3C1E1E22, 0x15878792, 0xC9E9E920, 0x87CECE49, 0xAA5555FF, 0x50282878, 0xA5DFDF7A,
+	0x038C8C8F, 0x59A1A1F8, 0x09898980, 0x1A0D0D17, 0x65BFBFDA, 0xD7E6E631, 0x844242C6, 0xD06868B8,
+	0x824141C3, 0x299999B0, 0x5A2D2D77, 0x1E0F0F11, 0x7BB0B0CB, 0xA85454FC, 0x6DBBBBD6, 0x2C16163A
+};
+
+static inline uint32_t RPL_aes_ror(uint32_t x, unsigned int n) {
+	return (x >> n) | (x << (32 - n));
+}
+
+void RPL_aes_expand(struct rpl_aes_key_s *aes, const uint8_t key[16]) {
+	static const uint8_t rcon[RPL_AES_ROUNDS] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36 };
+	uint8_t *w = aes->round_keys;
+	uint8_t t[4];
+	unsigned int i;
+
+	memcpy(w, key, 16);
+	for (i = 16; i < sizeof(aes->round_keys); i += 4) {
+		if ((i % 16) == 0) {
+			//RotWord, SubWord and Rcon
+			t[0] = RPL_aes_sbox[w[i - 3]] ^ rcon[i / 16 - 1];
+			t[1] = RPL_aes_sbox[w[i - 2]];
+			t[2] = RPL_aes_sbox[w[i - 1]];
+			t[3] = RPL_aes_sbox[w[i - 4]];
+		} else {
+			memcpy(t, w + i - 4, 4);
+		}
+		w[i] = w[i - 16] ^ t[0];
+		w[i + 1] = w[i - 15] ^ t[1];
+		w[i + 2] = w[i - 14] ^ t[2];
+		w[i + 3] = w[i - 13] ^ t[3];
+	}
+}
+
+void RPL_aes_encrypt(const struct rpl_aes_key_s *aes, const uint8_t in[16], uint8_t out[16]) {
+	const uint8_t *rk = aes->round_keys;
+	uint32_t s0 = RPL_read_uint32(in) ^ RPL_read_uint32(rk);
+	uint32_t s1 = RPL_read_uint32(in + 4) ^ RPL_read_uint32(rk + 4);
+	uint32_t s2 = RPL_read_uint32(in + 8) ^ RPL_read_uint32(rk + 8);
+	uint32_t s3 = RPL_read_uint32(in + 12) ^ RPL_read_uint32(rk + 12);
+	uint32_t t0, t1, t2, t3;
+	unsigned int round;
+
+	for (round = 1; round < RPL_AES_ROUNDS; round++) {
+		rk += RPL_AES_BLOCK_LENGTH;
+		t0 = RPL_aes_t0[s0 >> 24] ^ RPL_aes_ror(RPL_aes_t0[(s1 >> 16) & 0xFF], 8) ^ RPL_aes_ror(RPL_aes_t0[(s2 >> 8) & 0xFF], 16) ^ RPL_aes_ror(RPL_aes_t0[s3 & 0xFF], 24) ^ RPL_read_uint32(rk);
+		t1 = RPL_aes_t0[s1 >> 24] ^ RPL_aes_ror(RPL_aes_t0[(s2 >> 16) & 0xFF], 8) ^ RPL_aes_ror(RPL_aes_t0[(s3 >> 8) & 0xFF], 16) ^ RPL_aes_ror(RPL_aes_t0[s0 & 0xFF], 24) ^ RPL_read_uint32(rk + 4);
+		t2 = RPL_aes_t0[s2 >> 24] ^ RPL_aes_ror(RPL_aes_t0[(s3 >> 16) & 0xFF], 8) ^ RPL_aes_ror(RPL_aes_t0[(s0 >> 8) & 0xFF], 16) ^ RPL_aes_ror(RPL_aes_t0[s1 & 0xFF], 24) ^ RPL_read_uint32(rk + 8);
+		t3 = RPL_aes_t0[s3 >> 24] ^ RPL_aes_ror(RPL_aes_t0[(s0 >> 16) & 0xFF], 8) ^ RPL_aes_ror(RPL_aes_t0[(s1 >> 8) & 0xFF], 16) ^ RPL_aes_ror(RPL_aes_t0[s2 & 0xFF], 24) ^ RPL_read_uint32(rk + 12);
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
+
+	//Final round without MixColumns
+	rk += RPL_AES_BLOCK_LENGTH;
+	t0 = ((uint32_t)RPL_aes_sbox[s0 >> 24] << 24) | ((uint32_t)RPL_aes_sbox[(s1 >> 16) & 0xFF] << 16) | ((uint32_t)RPL_aes_sbox[(s2 >> 8) & 0xFF] << 8) | RPL_aes_sbox[s3 & 0xFF];
+	t1 = ((uint32_t)RPL_aes_sbox[s1 >> 24] << 24) | ((uint32_t)RPL_aes_sbox[(s2 >> 16) & 0xFF] << 16) | ((uint32_t)RPL_aes_sbox[(s3 >> 8) & 0xFF] << 8) | RPL_aes_sbox[s0 & 0xFF];
+	t2 = ((uint32_t)RPL_aes_sbox[s2 >> 24] << 24) | ((uint32_t)RPL_aes_sbox[(s3 >> 16) & 0xFF] << 16) | ((uint32_t)RPL_aes_sbox[(s0 >> 8) & 0xFF] << 8) | RPL_aes_sbox[s1 & 0xFF];
+	t3 = ((uint32_t)RPL_aes_sbox[s3 >> 24] << 24) | ((uint32_t)RPL_aes_sbox[(s0 >> 16) & 0xFF] << 16) | ((uint32_t)RPL_aes_sbox[(s1 >> 8) & 0xFF] << 8) | RPL_aes_sbox[s2 & 0xFF];
+	RPL_write_uint32(out, t0 ^ RPL_read_uint32(rk));
+	RPL_write_uint32(out + 4, t1 ^ RPL_read_uint32(rk + 4));
+	RPL_write_uint32(out + 8, t2 ^ RPL_read_uint32(rk + 8));
+	RPL_write_uint32(out + 12, t3 ^ RPL_read_uint32(rk + 12));
+}
+
+#if defined(RPL_SECURITY_AESNI)
+//Independent blocks are interleaved round by round so each AESENC overlaps the previous ones
+__attribute__((target("aes,sse2")))
+static void RPL_aes_encrypt_lanes_aesni(const struct rpl_aes_key_s *const *aes, uint8_t (*blocks)[16], unsigned int count) {
+	__m128i x[RPL_SECURITY_LANES];
+	unsigned int round, i;
+
+	for (i = 0; i < count; i++) {
+		x[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)blocks[i]), _mm_loadu_si128((const __m128i *)aes[i]->round_keys));
+	}
+	for (round = 1; round < RPL_AES_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			x[i] = _mm_aesenc_si128(x[i], _mm_loadu_si128((const __m128i *)(aes[i]->round_keys + round * RPL_AES_BLOCK_LENGTH)));
+		}
+	}
+	for (i = 0; i < count; i++) {
+		x[i] = _mm_aesenclast_si128(x[i], _mm_loadu_si128((const __m128i *)(aes[i]->round_keys + RPL_AES_ROUNDS * RPL_AES_BLOCK_LENGTH)));
+		_mm_storeu_si128((__m128i *)blocks[i], x[i]);
+	}
+}
+#endif
+
+static int RPL_aes_aesni_supported(void) {
+#if defined(RPL_SECURITY_AESNI)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("aes") != 0;
+#else
+	return 0;
+#endif
+}
+
+//Encrypts up to RPL_SECURITY_LANES blocks in place, each with its own key
+static void RPL_aes_encrypt_lanes(int aesni, const struct rpl_aes_key_s *const *aes, uint8_t (*blocks)[16], unsigned int count) {
+	unsigned int i;
+
+#if defined(RPL_SECURITY_AESNI)
+	if (aesni) {
+		RPL_aes_encrypt_lanes_aesni(aes, blocks, count);
+		return;
+	}
+#else
+	(void)aesni;
+#endif
+	for (i = 0; i < count; i++) {
+		RPL_aes_encrypt(aes[i], blocks[i], blocks[i]);
+	}
+}
+
+/*** CCM* [RFC3610], L = 2 ***/
+
+/**
+ * CBC-MAC input of one message, formatted a block at a time: B0, the length of a followed by
+ * a padded to a block boundary, then m padded to a block boundary
+ */
+struct rpl_ccm_s {
+	const struct rpl_aes_key_s *aes;
+	const uint8_t *nonce;
+	const uint8_t *a;
+	const uint8_t *m;               //!< Plaintext
+	uint16_t a_length;
+	uint16_t m_length;
+	uint16_t a_position;
+	uint16_t m_position;
+	uint8_t stage;
+	uint8_t mac_length;
+	uint8_t x[RPL_AES_BLOCK_LENGTH];    //!< CBC-MAC state, T once all blocks have been added
+};
+
+static void RPL_ccm_init(struct rpl_ccm_s *ccm, const struct rpl_aes_key_s *aes, const uint8_t *nonce, const uint8_t *a, uint16_t a_length,
+                         const uint8_t *m, uint16_t m_length, uint8_t mac_length) {
+	ccm->aes = aes;
+	ccm->nonce = nonce;
+	ccm->a = a;
+	ccm->a_length = a_length;
+	ccm->m = m;
+	ccm->m_length = m_length;
+	ccm->a_position = 0;
+	ccm->m_position = 0;
+	ccm->stage = 0;
+	ccm->mac_length = mac_length;
+	memset(ccm->x, 0, sizeof(ccm->x));
+}
+
+//Returns 1 with the next CBC-MAC input block, 0 once all have been returned
+static int RPL_ccm_next_block(struct rpl_ccm_s *ccm, uint8_t block[16]) {
+	uint16_t n;
+
+	switch (ccm->stage) {
+	case 0:
+		block[0] = (uint8_t)(((ccm->a_length != 0) ? 0x40 : 0) | (((ccm->mac_length - 2) / 2) << 3) | 0x01);
+		memcpy(block + 1, ccm->nonce, RPL_CCM_NONCE_LENGTH);
+		RPL_write_uint16(block + 14, ccm->m_length);
+		ccm->stage = (ccm->a_length != 0) ? 1 : 2;
+		return 1;
+	case 1:
+		memset(block, 0, RPL_AES_BLOCK_LENGTH);
+		if (ccm->a_position == 0) {
+			n = (ccm->a_length < 14) ? ccm->a_length : 14;
+			RPL_write_uint16(block, ccm->a_length);
+			memcpy(block + 2, ccm->a, n);
+		} else {
+			n = (uint16_t)(ccm->a_length - ccm->a_position);
+			n = (n < RPL_AES_BLOCK_LENGTH) ? n : RPL_AES_BLOCK_LENGTH;
+			memcpy(block, ccm->a + ccm->a_position, n);
+		}
+		ccm->a_position = (uint16_t)(ccm->a_position + n);
+		if (ccm->a_position == ccm->a_length) {
+			ccm->stage = 2;
+		}
+		return 1;
+	case 2:
+		if (ccm->m_position < ccm->m_length) {
+			n = (uint16_t)(ccm->m_length - ccm->m_position);
+			n = (n < RPL_AES_BLOCK_LENGTH) ? n : RPL_AES_BLOCK_LENGTH;
+			memset(block, 0, RPL_AES_BLOCK_LENGTH);
+			memcpy(block, ccm->m + ccm->m_position, n);
+			ccm->m_position = (uint16_t)(ccm->m_position + n);
+			return 1;
+		}
+		ccm->stage = 3;
+		return 0;
+	default:
+		return 0;
+	}
+}
+
+//CBC-MAC of several messages at once, a block of each running message per step
+static void RPL_ccm_cbc_mac(int aesni, struct rpl_ccm_s *const *ccm, unsigned int count) {
+	const struct rpl_aes_key_s *aes[RPL_SECURITY_LANES];
+	struct rpl_ccm_s *running[RPL_SECURITY_LANES];
+	uint8_t blocks[RPL_SECURITY_LANES][16];
+	unsigned int n, i, j;
+
+	for (;;) {
+		n = 0;
+		for (i = 0; i < count; i++) {
+			if ((ccm[i]->mac_length != 0) && RPL_ccm_next_block(ccm[i], blocks[n])) {
+				for (j = 0; j < RPL_AES_BLOCK_LENGTH; j++) {
+					blocks[n][j] ^= ccm[i]->x[j];
+				}
+				aes[n] = ccm[i]->aes;
+				running[n++] = ccm[i];
+			}
+		}
+		if (n == 0) {
+			break;
+		}
+		RPL_aes_encrypt_lanes(aesni, aes, blocks, n);
+		for (i = 0; i < n; i++) {
+			memcpy(running[i]->x, blocks[i], RPL_AES_BLOCK_LENGTH);
+		}
+	}
+}
+
+//Counter mode over m from A1, with S0 (the MAC encryption block) returned in s0
+static void RPL_ccm_ctr(int aesni, const struct rpl_aes_key_s *aes, const uint8_t *nonce, uint8_t *m, uint16_t length, uint8_t s0[16]) {
+	const struct rpl_aes_key_s *keys[RPL_SECURITY_LANES] = { aes, aes, aes, aes };
+	uint8_t blocks[RPL_SECURITY_LANES][16];
+	uint32_t total = 1 + ((uint32_t)length + RPL_AES_BLOCK_LENGTH - 1) / RPL_AES_BLOCK_LENGTH;
+	uint32_t counter, n, i, j, offset, end;
+
+	for (counter = 0; counter < total; counter += n) {
+		n = (total - counter < RPL_SECURITY_LANES) ? total - counter : RPL_SECURITY_LANES;
+		for (i = 0; i < n; i++) {
+			blocks[i][0] = 0x01;        //L - 1
+			memcpy(blocks[i] + 1, nonce, RPL_CCM_NONCE_LENGTH);
+			RPL_write_uint16(blocks[i] + 14, (uint16_t)(counter + i));
+		}
+		RPL_aes_encrypt_lanes(aesni, keys, blocks, n);
+		for (i = 0; i < n; i++) {
+			if (counter + i == 0) {
+				memcpy(s0, blocks[0], RPL_AES_BLOCK_LENGTH);
+				continue;
+			}
+			offset = (counter + i - 1) * RPL_AES_BLOCK_LENGTH;
+			end = (offset + RPL_AES_BLOCK_LENGTH < length) ? offset + RPL_AES_BLOCK_LENGTH : length;
+			for (j = offset; j < end; j++) {
+				m[j] ^= blocks[i][j - offset];
+			}
+		}
+	}
+}
+
+static int RPL_ccm_mac_length_valid(uint8_t mac_length) {
+	return (mac_length == 0) || ((mac_length >= 4) && (mac_length <= 16) && ((mac_length & 1) == 0));
+}
+
+//Constant time comparison of U = T xor S0 with the received MAC
+static int RPL_ccm_mac_check(const struct rpl_ccm_s *ccm, const uint8_t s0[16], const uint8_t *mac) {
+	uint8_t difference = 0;
+	uint8_t i;
+
+	for (i = 0; i < ccm->mac_length; i++) {
+		difference |= (uint8_t)(ccm->x[i] ^ s0[i] ^ mac[i]);
+	}
+	return (difference == 0) ? 0 : -1;
+}
+
+static void RPL_ccm_mac_write(const struct rpl_ccm_s *ccm, const uint8_t s0[16], uint8_t *mac) {
+	uint8_t i;
+
+	for (i = 0; i < ccm->mac_length; i++) {
+		mac[i] = ccm->x[i] ^ s0[i];
+	}
+}
+
+int RPL_ccm_encrypt(const struct rpl_aes_key_s *aes, const uint8_t nonce[RPL_CCM_NONCE_LENGTH], const uint8_t *a, uint16_t a_length,
+                    uint8_t *m, uint16_t m_length, int encrypt, uint8_t *mac, uint8_t mac_length) {
+	struct rpl_ccm_s ccm;
+	struct rpl_ccm_s *lanes[1] = { &ccm };
+	uint8_t s0[RPL_AES_BLOCK_LENGTH];
+
+	if (!RPL_ccm_mac_length_valid(mac_length)) {
+		return -1;
+	}
+
+	RPL_ccm_init(&ccm, aes, nonce, a, a_length, m, m_length, mac_length);
+	RPL_ccm_cbc_mac(0, lanes, 1);
+	RPL_ccm_ctr(0, aes, nonce, m, encrypt ? m_length : 0, s0);
+	RPL_ccm_mac_write(&ccm, s0, mac);
+	return 0;
+}
+
+int RPL_ccm_decrypt(const struct rpl_aes_key_s *aes, const uint8_t nonce[RPL_CCM_NONCE_LENGTH], const uint8_t *a, uint16_t a_length,
+                    uint8_t *m, uint16_t m_length, int encrypted, const uint8_t *mac, uint8_t mac_length) {
+	struct rpl_ccm_s ccm;
+	struct rpl_ccm_s *lanes[1] = { &ccm };
+	uint8_t s0[RPL_AES_BLOCK_LENGTH];
+
+	if (!RPL_ccm_mac_length_valid(mac_length)) {
+		return -1;
+	}
+
+	RPL_ccm_ctr(0, aes, nonce, m, encrypted ? m_length : 0, s0);
+	RPL_ccm_init(&ccm, aes, nonce, a, a_length, m, m_length, mac_length);
+	RPL_ccm_cbc_mac(0, lanes, 1);
+	return RPL_ccm_mac_check(&ccm, s0, mac);
+}
+
+/*** Key table ***/
+
+void RPL_security_keys_init(struct rpl_security_keys_s *keys) {
+	memset(keys, 0, sizeof(*keys));
+	keys->aesni = (uint8_t)RPL_aes_aesni_supported();
+}
+
+static int RPL_security_key_match(const struct rpl_security_key_s *key, uint8_t kim, const uint8_t *key_source, uint8_t key_index) {
+	return key->valid && (key->kim == kim) && (key->key_index == key_index) && (memcmp(key->key_source, key_source, RPL_SECURITY_KEY_SOURCE_LENGTH) == 0);
+}
+
+static int RPL_security_key_lookup(struct rpl_security_keys_s *keys, uint8_t kim, const uint8_t *key_source, uint8_t key_index) {
+	int i;
+
+	if (RPL_security_key_match(&keys->keys[keys->last], kim, key_source, key_index)) {
+		return keys->last;
+	}
+	for (i = 0; i < RPL_SECURITY_KEY_TABLE_SIZE; i++) {
+		if (RPL_security_key_match(&keys->keys[i], kim, key_source, key_index)) {
+			keys->last = (uint8_t)i;
+			return i;
+		}
+	}
+	return -1;
+}
+
+//Key Source used in the table for each KIM (zero for group keys without a source)
+static int RPL_security_key_source(uint8_t kim, const uint8_t *key_source, uint8_t *key_index, uint8_t source[RPL_SECURITY_KEY_SOURCE_LENGTH]) {
+	memset(source, 0, RPL_SECURITY_KEY_SOURCE_LENGTH);
+	switch (kim) {
+	case RPL_SEC_KIM_MODE0:
+		return 0;
+	case RPL_SEC_KIM_MODE1:
+		*key_index = 0;
+		//Fall through
+	case RPL_SEC_KIM_MODE2:
+		if (key_source == NULL) {
+			return -1;
+		}
+		memcpy(source, key_source, RPL_SECURITY_KEY_SOURCE_LENGTH);
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+int RPL_security_key_add(struct rpl_security_keys_s *keys, uint8_t kim, const uint8_t *key_source, uint8_t key_index, const uint8_t key[16]) {
+	uint8_t source[RPL_SECURITY_KEY_SOURCE_LENGTH];
+	int i;
+
+	if (RPL_security_key_source(kim, key_source, &key_index, source) < 0) {
+		return -1;
+	}
+	if ((i = RPL_security_key_lookup(keys, kim, source, key_index)) < 0) {
+		for (i = 0; (i < RPL_SECURITY_KEY_TABLE_SIZE) && keys->keys[i].valid; i++) {
+		}
+		if (i == RPL_SECURITY_KEY_TABLE_SIZE) {
+			return -1;
+		}
+	}
+
+	RPL_aes_expand(&keys->keys[i].aes, key);
+	memcpy(keys->keys[i].key_source, source, RPL_SECURITY_KEY_SOURCE_LENGTH);
+	keys->keys[i].key_index = key_index;
+	keys->keys[i].kim = kim;
+	keys->keys[i].valid = 1;
+	return 0;
+}
+
+int RPL_security_key_remove(struct rpl_security_keys_s *keys, uint8_t kim, const uint8_t *key_source, uint8_t key_index) {
+	uint8_t source[RPL_SECURITY_KEY_SOURCE_LENGTH];
+	int i;
+
+	if ((RPL_security_key_source(kim, key_source, &key_index, source) < 0) || ((i = RPL_security_key_lookup(keys, kim, source, key_index)) < 0)) {
+		return -1;
+	}
+	//Clear the schedule as well, it is key material
+	memset(&keys->keys[i], 0, sizeof(keys->keys[i]));
+	return 0;
+}
+
+const struct rpl_security_key_s *RPL_security_key_find(struct rpl_security_keys_s *keys, const uint8_t *security, const uint8_t peer[16]) {
+	uint8_t kim = (security[2] & RPL_SEC_KIM_MASK) >> RPL_SEC_KIM_SHIFT;
+	const uint8_t *key_identifier = security + RPL_SECURITY_BASE_LENGTH;
+	uint8_t source[RPL_SECURITY_KEY_SOURCE_LENGTH];
+	uint8_t key_index = 0;
+	int i;
+
+	switch (kim) {
+	case RPL_SEC_KIM_MODE0:
+		memset(source, 0, sizeof(source));
+		key_index = key_identifier[0];
+		break;
+	case RPL_SEC_KIM_MODE1:
+		memcpy(source, peer + 8, sizeof(source));
+		break;
+	case RPL_SEC_KIM_MODE2:
+		memcpy(source, key_identifier, sizeof(source));
+		key_index = key_identifier[RPL_SECURITY_KEY_SOURCE_LENGTH];
+		break;
+	default:
+		return NULL;
+	}
+
+	i = RPL_security_key_lookup(keys, kim, source, key_index);
+	return (i < 0) ? NULL : &keys->keys[i];
+}
+
+/*** Secured messages ***/
+
+/**
+ * Message being protected or unprotected. The MAC covers the ICMPv6 header (with a zero
+ * checksum), the security section, the base and the options. For the ENC levels the base and
+ * options are the CCM* message m, otherwise everything is authenticated only.
+ */
+struct rpl_security_job_s {
+	struct rpl_ccm_s ccm;
+	uint8_t nonce[RPL_CCM_NONCE_LENGTH];
+	uint8_t *m;                     //!< Encrypted part, NULL for the MAC levels
+	uint16_t m_length;
+	uint8_t *mac;
+};
+
+static int RPL_security_job_init(struct rpl_security_keys_s *keys, struct rpl_security_job_s *job, const struct rpl_security_packet_s *packet, int protect) {
+	struct rpl_message_view_s view;
+	const struct rpl_security_key_s *key;
+	const uint8_t *security;
+	uint8_t kim, lvl;
+
+	if ((RPL_message_view_init(&view, packet->message, packet->length) < 0) || !RPL_message_view_is_secure(&view)) {
+		return -1;
+	}
+	security = RPL_message_view_security(&view);
+	kim = (security[2] & RPL_SEC_KIM_MASK) >> RPL_SEC_KIM_SHIFT;
+	lvl = (security[2] & RPL_SEC_LVL_MASK) >> RPL_SEC_LVL_SHIFT;
+	if ((security[1] != RPL_SECURITY_ALGORITHM_CCM_AES123_RSA_SHA256) || (kim == RPL_SEC_KIM_MODE3) || (lvl > RPL_SEC_LVL_NORM_MODE3)) {
+		return -1;
+	}
+	if ((key = RPL_security_key_find(keys, security, protect ? packet->destination : packet->source)) == NULL) {
+		return -1;
+	}
+
+	//Nonce: Source Identifier, Frame Counter, Security Level [RFC6550 Section 10.5.1]
+	memcpy(job->nonce, packet->source + 8, 8);
+	memcpy(job->nonce + 8, security + 4, 4);
+	job->nonce[12] = lvl;
+
+	packet->message[2] = 0;
+	packet->message[3] = 0;
+	if (lvl & 0x01) {
+		job->m = packet->message + view.base_offset;
+		job->m_length = RPL_message_view_base_length(&view);
+		RPL_ccm_init(&job->ccm, &key->aes, job->nonce, packet->message, view.base_offset, job->m, job->m_length, (uint8_t)RPL_security_mac_length(security[2]));
+	} else {
+		job->m = NULL;
+		job->m_length = 0;
+		RPL_ccm_init(&job->ccm, &key->aes, job->nonce, packet->message, view.base_end, NULL, 0, (uint8_t)RPL_security_mac_length(security[2]));
+	}
+	job->mac = packet->message + view.base_end;
+	return 0;
+}
+
+static unsigned int RPL_security_process(struct rpl_security_keys_s *keys, const struct rpl_security_packet_s *packets, uint8_t *valid, unsigned int count, int protect) {
+	struct rpl_security_job_s jobs[RPL_SECURITY_LANES];
+	struct rpl_security_job_s *active[RPL_SECURITY_LANES];
+	struct rpl_security_job_s *job;
+	struct rpl_ccm_s *lanes[RPL_SECURITY_LANES];
+	const struct rpl_security_packet_s *packet;
+	uint8_t s0[RPL_SECURITY_LANES][RPL_AES_BLOCK_LENGTH];
+	unsigned int start, i, n, passed = 0;
+	uint32_t sum;
+
+	for (start = 0; start < count; start += RPL_SECURITY_LANES) {
+		n = 0;
+		for (i = start; (i < count) && (i < start + RPL_SECURITY_LANES); i++) {
+			valid[i] = (RPL_security_job_init(keys, &jobs[i - start], &packets[i], protect) == 0);
+			if (valid[i]) {
+				active[n] = &jobs[i - start];
+				lanes[n++] = &jobs[i - start].ccm;
+			}
+		}
+
+		//Encrypting follows the MAC, decrypting precedes it
+		if (!protect) {
+			for (i = 0; i < n; i++) {
+				job = active[i];
+				RPL_ccm_ctr(keys->aesni, job->ccm.aes, job->nonce, job->m, job->m_length, s0[i]);
+			}
+		}
+		RPL_ccm_cbc_mac(keys->aesni, lanes, n);
+		if (protect) {
+			for (i = 0; i < n; i++) {
+				job = active[i];
+				RPL_ccm_ctr(keys->aesni, job->ccm.aes, job->nonce, job->m, job->m_length, s0[i]);
+			}
+		}
+
+		for (i = start, n = 0; (i < count) && (i < start + RPL_SECURITY_LANES); i++) {
+			if (!valid[i]) {
+				continue;
+			}
+			job = &jobs[i - start];
+			packet = &packets[i];
+			if (protect) {
+				RPL_ccm_mac_write(&job->ccm, s0[n], job->mac);
+				sum = RPL_checksum_partial(0, packet->message, packet->length) + RPL_checksum_pseudo_header(packet->source, packet->destination, packet->length);
+				RPL_write_uint16(packet->message + 2, RPL_checksum_finish(sum));
+			} else {
+				valid[i] = (RPL_ccm_mac_check(&job->ccm, s0[n], job->mac) == 0);
+			}
+			passed += valid[i];
+			n++;
+		}
+	}
+	return passed;
+}
+
+int RPL_security_protect(struct rpl_security_keys_s *keys, uint8_t *message, uint16_t length, const uint8_t source[16], const uint8_t destination[16]) {
+	struct rpl_security_packet_s packet = { message, source, destination, length };
+	uint8_t valid;
+
+	return (RPL_security_process(keys, &packet, &valid, 1, 1) == 1) ? 0 : -1;
+}
+
+int RPL_security_unprotect(struct rpl_security_keys_s *keys, uint8_t *message, uint16_t length, const uint8_t source[16], const uint8_t destination[16]) {
+	struct rpl_security_packet_s packet = { message, source, destination, length };
+	uint8_t valid;
+
+	return (RPL_security_process(keys, &packet, &valid, 1, 0) == 1) ? 0 : -1;
+}
+
+unsigned int RPL_security_protect_many(struct rpl_security_keys_s *keys, const struct rpl_security_packet_s *packets, uint8_t *valid, unsigned int count) {
+	return RPL_security_process(keys, packets, valid, count, 1);
+}
+
+unsigned int RPL_security_unprotect_many(struct rpl_security_keys_s *keys, const struct rpl_security_packet_s *packets, uint8_t *valid, unsigned int count) {
+	return RPL_security_process(keys, packets, valid, count, 0);
+}
+
+#endif
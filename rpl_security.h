@@ -0,0 +1,146 @@
+/**
+ * RPL security
+ * CCM* with AES-128 protection of secured control messages [RFC6550 Section 10]
+ *
+ * Supports the MAC-32, ENC-MAC-32, MAC-64 and ENC-MAC-64 levels with group keys (KIM 0 and 2)
+ * and per-pair keys (KIM 1). Signatures (KIM 3) are not supported. Keys are expanded once when
+ * they are added to a key table and looked up by (key source, key index) for each message, the
+ * last key used being checked first. AES-NI is used when the CPU supports it, with a portable
+ * table based implementation otherwise.
+ *
+ * Messages are protected in place after they have been built with room for the MAC (see
+ * RPL_builder_raw) and unprotected in place, after the checksum has been verified and before
+ * the message view is initialized. Batches of messages are processed several at a time so the
+ * AES pipeline stays busy while each CBC-MAC waits for its previous block.
+ *
+ * Compiled out with RPL_CONF_SECURITY 0 (see rpl_conf.h), secured messages are then dropped.
+ */
+
+#ifndef RPL_SECURITY_H
+#define RPL_SECURITY_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if RPL_CONF_SECURITY
+
+#ifndef RPL_SECURITY_KEY_TABLE_SIZE
+#define RPL_SECURITY_KEY_TABLE_SIZE     8       //!< Keys held in a key table
+#endif
+
+#define RPL_AES_BLOCK_LENGTH            16
+#define RPL_AES_ROUNDS                  10      //!< AES-128
+#define RPL_CCM_NONCE_LENGTH            13      //!< Source Identifier, Frame Counter and Security Level [RFC6550 Section 10.5.1]
+#define RPL_SECURITY_KEY_SOURCE_LENGTH  8
+
+/**
+ * @brief Expanded AES-128 key
+ */
+struct rpl_aes_key_s {
+    uint8_t round_keys[(RPL_AES_ROUNDS + 1) * RPL_AES_BLOCK_LENGTH];    //!< Key schedule in memory order
+};
+
+/**
+ * @brief Key table entry
+ */
+struct rpl_security_key_s {
+    struct rpl_aes_key_s aes;                               //!< Expanded key
+    uint8_t key_source[RPL_SECURITY_KEY_SOURCE_LENGTH];     //!< Key Source (KIM 2), peer interface identifier (KIM 1), zero otherwise
+    uint8_t key_index;                                      //!< Key Index, 0 for KIM 1
+    uint8_t kim;                                            //!< Key Identifier Mode the key is used with
+    uint8_t valid;
+};
+
+/**
+ * @brief Key table
+ */
+struct rpl_security_keys_s {
+    struct rpl_security_key_s keys[RPL_SECURITY_KEY_TABLE_SIZE];
+    uint8_t last;                   //!< Entry of the last key used, checked first
+    uint8_t aesni;                  //!< Use AES-NI, set by init when the CPU supports it
+};
+
+/**
+ * @brief Secured message for batch processing
+ */
+struct rpl_security_packet_s {
+    uint8_t *message;               //!< ICMPv6 message, protected or unprotected in place
+    const uint8_t *source;          //!< IPv6 source address
+    const uint8_t *destination;     //!< IPv6 destination address
+    uint16_t length;                //!< ICMPv6 message length, including the MAC
+};
+
+/**
+ * AES-128 block cipher (forward direction only, as used by CCM*)
+ */
+void RPL_aes_expand(struct rpl_aes_key_s *aes, const uint8_t key[16]);
+void RPL_aes_encrypt(const struct rpl_aes_key_s *aes, const uint8_t in[16], uint8_t out[16]);
+
+/**
+ * @brief CCM* with a 13 octet nonce (L = 2) [RFC3610]
+ * @details Authenticates a and m, writing the mac_length (0, 4, 8 or 16) octet MAC to mac, then
+ * encrypts m in place when encrypt is set. Decrypting is the reverse: RPL_ccm_decrypt decrypts m
+ * in place and checks the MAC.
+ *
+ * @return 0 on success, -1 on invalid parameters (or when the MAC does not match)
+ */
+int RPL_ccm_encrypt(const struct rpl_aes_key_s *aes, const uint8_t nonce[RPL_CCM_NONCE_LENGTH], const uint8_t *a, uint16_t a_length,
+                    uint8_t *m, uint16_t m_length, int encrypt, uint8_t *mac, uint8_t mac_length);
+int RPL_ccm_decrypt(const struct rpl_aes_key_s *aes, const uint8_t nonce[RPL_CCM_NONCE_LENGTH], const uint8_t *a, uint16_t a_length,
+                    uint8_t *m, uint16_t m_length, int encrypted, const uint8_t *mac, uint8_t mac_length);
+
+void RPL_security_keys_init(struct rpl_security_keys_s *keys);
+
+/**
+ * @brief Add (or replace) a key, expanding its key schedule
+ * @details key_source is the Key Source for KIM 2 and the peer's interface identifier (last 8
+ * octets of its address) for KIM 1, it is ignored for KIM 0.
+ *
+ * @return 0, or -1 when the table is full or the KIM is not supported
+ */
+int RPL_security_key_add(struct rpl_security_keys_s *keys, uint8_t kim, const uint8_t *key_source, uint8_t key_index, const uint8_t key[16]);
+int RPL_security_key_remove(struct rpl_security_keys_s *keys, uint8_t kim, const uint8_t *key_source, uint8_t key_index);
+
+/**
+ * @brief Find the key for a security section
+ * @param peer address of the other end, used to identify per-pair keys
+ */
+const struct rpl_security_key_s *RPL_security_key_find(struct rpl_security_keys_s *keys, const uint8_t *security, const uint8_t peer[16]);
+
+/**
+ * @brief Protect a built secured message in place [RFC6550 Section 10.2]
+ * @details Computes the MAC into the last octets of the message, encrypts the message base and
+ * options for ENC levels and fills in the checksum.
+ *
+ * @return 0, or -1 when the message is malformed, the level is not supported or no key is found
+ */
+int RPL_security_protect(struct rpl_security_keys_s *keys, uint8_t *message, uint16_t length, const uint8_t source[16], const uint8_t destination[16]);
+
+/**
+ * @brief Unprotect a received secured message in place [RFC6550 Section 10.3]
+ * @details The checksum must have been verified, it is cleared. The message contents are
+ * undefined when the MAC does not match.
+ *
+ * @return 0 when the MAC is valid, -1 otherwise
+ */
+int RPL_security_unprotect(struct rpl_security_keys_s *keys, uint8_t *message, uint16_t length, const uint8_t source[16], const uint8_t destination[16]);
+
+/**
+ * @brief Protect or unprotect a batch of messages
+ * @return number of messages processed successfully, with valid[i] set per message
+ */
+unsigned int RPL_security_protect_many(struct rpl_security_keys_s *keys, const struct rpl_security_packet_s *packets, uint8_t *valid, unsigned int count);
+unsigned int RPL_security_unprotect_many(struct rpl_security_keys_s *keys, const struct rpl_security_packet_s *packets, uint8_t *valid, unsigned int count);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
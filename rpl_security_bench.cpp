@@ -0,0 +1,116 @@
+/**
+ * Secured message micro-benchmark
+ * CCM*-AES-128 protect and unprotect of DAOs one at a time and in batches, with AES-NI
+ * (when supported) and the portable implementation.
+ * Uses Google Benchmark (see rpl_bench.h), build with eg.
+ *   gcc -O3 -c rpl_*.c && g++ -O3 rpl_security_bench.cpp rpl_*.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+#if RPL_CONF_SECURITY
+
+#define BENCH_MESSAGES      64
+
+static const uint8_t bench_source[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+static const uint8_t bench_destination[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static const uint8_t bench_key[16] = { 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF };
+
+//ENC-MAC-32 DAO with 4 targets, about 100 octets
+static uint16_t bench_secure_dao(uint8_t *buffer, uint16_t size, uint32_t counter) {
+	struct rpl_builder_s builder;
+	struct rpl_dao_s dao = {};
+	struct rpl_security_s security = {};
+	uint8_t target[16], mac[4] = { 0 };
+	int i;
+
+	security.kim_and_lvl = (RPL_SEC_KIM_MODE0 << RPL_SEC_KIM_SHIFT) | RPL_SEC_LVL_NORM_MODE1;
+	security.counter = counter;
+	dao.rpl_instance = 1;
+	dao.dao_sequence = (uint8_t)counter;
+	memcpy(target, bench_source, 16);
+
+	RPL_builder_init(&builder, buffer, size, NULL, 0);
+	RPL_builder_dao(&builder, &dao, &security);
+	for (i = 0; i < 4; i++) {
+		target[15] = (uint8_t)(i + 2);
+		RPL_builder_target(&builder, 128, target);
+	}
+	RPL_builder_raw(&builder, mac, sizeof(mac));
+	return (uint16_t)RPL_builder_finish(&builder, bench_source, bench_destination);
+}
+
+struct security_bench_data {
+	struct rpl_security_keys_s keys;
+	struct rpl_security_packet_s packets[BENCH_MESSAGES];
+	uint8_t buffers[BENCH_MESSAGES][256];
+	uint8_t valid[BENCH_MESSAGES];
+
+	security_bench_data() {
+		RPL_security_keys_init(&keys);
+		RPL_security_key_add(&keys, RPL_SEC_KIM_MODE0, NULL, 0, bench_key);
+		for (int i = 0; i < BENCH_MESSAGES; i++) {
+			packets[i].message = buffers[i];
+			packets[i].source = bench_source;
+			packets[i].destination = bench_destination;
+			packets[i].length = bench_secure_dao(buffers[i], sizeof(buffers[i]), (uint32_t)i);
+		}
+	}
+};
+
+static security_bench_data data;
+
+//Arg: 1 to use AES-NI when supported
+static void BM_security_protect(benchmark::State &state) {
+	uint8_t aesni = data.keys.aesni;
+
+	data.keys.aesni = (uint8_t)(aesni && state.range(0));
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_MESSAGES; i++) {
+			RPL_security_protect(&data.keys, data.packets[i].message, data.packets[i].length, bench_source, bench_destination);
+		}
+		benchmark::ClobberMemory();
+	}
+	rpl_bench_items(state, BENCH_MESSAGES);
+	data.keys.aesni = aesni;
+}
+BENCHMARK(BM_security_protect)->Arg(0)->Arg(1);
+
+static void BM_security_protect_many(benchmark::State &state) {
+	uint8_t aesni = data.keys.aesni;
+
+	data.keys.aesni = (uint8_t)(aesni && state.range(0));
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(RPL_security_protect_many(&data.keys, data.packets, data.valid, BENCH_MESSAGES));
+		benchmark::ClobberMemory();
+	}
+	rpl_bench_items(state, BENCH_MESSAGES);
+	data.keys.aesni = aesni;
+}
+BENCHMARK(BM_security_protect_many)->Arg(0)->Arg(1);
+
+//Protecting again after unprotecting restores the input, so each iteration covers both
+static void BM_security_unprotect_many(benchmark::State &state) {
+	uint8_t aesni = data.keys.aesni;
+
+	data.keys.aesni = (uint8_t)(aesni && state.range(0));
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		RPL_security_protect_many(&data.keys, data.packets, data.valid, BENCH_MESSAGES);
+		benchmark::DoNotOptimize(RPL_security_unprotect_many(&data.keys, data.packets, data.valid, BENCH_MESSAGES));
+	}
+	rpl_bench_items(state, 2 * BENCH_MESSAGES);
+	data.keys.aesni = aesni;
+}
+BENCHMARK(BM_security_unprotect_many)->Arg(0)->Arg(1);
+
+#endif
+
+RPL_BENCH_MAIN()
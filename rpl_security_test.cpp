@@ -0,0 +1,263 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#if RPL_CONF_SECURITY
+
+static const uint8_t source[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 1 };
+static const uint8_t destination[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x12, 0x4B, 0, 0, 0, 0, 2 };
+static const uint8_t dodag_id[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static const uint8_t group_key[16] = { 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF };
+static const uint8_t key_source[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+static int checksum_valid(const uint8_t *message, uint16_t length) {
+	uint32_t sum = RPL_checksum_pseudo_header(source, destination, length);
+
+	sum = RPL_checksum_partial(sum, message, length);
+	return RPL_checksum_fold(sum) == 0xFFFF;
+}
+
+//Secured DIO with a DODAG Configuration option and room for the MAC
+static uint16_t secure_dio(uint8_t *buffer, uint16_t size, uint8_t kim, uint8_t lvl, uint32_t counter) {
+	struct rpl_builder_s builder;
+	struct rpl_dio_s dio = {};
+	struct rpl_option_dodag_configuration_s config = {};
+	struct rpl_security_s security = {};
+	uint8_t mac[8] = { 0 };
+
+	dio.rpl_instance_id = 1;
+	dio.rpl_version = 240;
+	dio.rank = 256;
+	config.dio_int_double = 20;
+	config.dio_int_min = 3;
+	config.min_hop_rank_increase = 256;
+	config.lifetime_unit = 60;
+	security.kim_and_lvl = (uint8_t)((kim << RPL_SEC_KIM_SHIFT) | (lvl << RPL_SEC_LVL_SHIFT));
+	security.counter = counter;
+	if (kim == RPL_SEC_KIM_MODE0) {
+		security.key_identifier_mode0.key_index = 3;
+	} else if (kim == RPL_SEC_KIM_MODE2) {
+		memcpy(security.key_identifier_mode2.key_source, key_source, sizeof(key_source));
+		security.key_identifier_mode2.key_index = 7;
+	}
+
+	RPL_builder_init(&builder, buffer, size, NULL, 0);
+	RPL_builder_dio(&builder, &dio, dodag_id, &security);
+	RPL_builder_dodag_config(&builder, &config);
+	RPL_builder_raw(&builder, mac, RPL_security_mac_length(security.kim_and_lvl));
+	return (uint16_t)RPL_builder_finish(&builder, source, destination);
+}
+
+TEST_GROUP(security_tests)
+{
+	struct rpl_security_keys_s keys;
+
+	void setup() {
+		RPL_security_keys_init(&keys);
+		CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE0, NULL, 3, group_key));
+	}
+
+	void teardown() {
+
+	}
+};
+
+TEST(security_tests, aes_test) {
+	//FIPS-197 Appendix C.1
+	const uint8_t key[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+	const uint8_t plaintext[16] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF };
+	const uint8_t ciphertext[16] = { 0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A };
+	struct rpl_aes_key_s aes;
+	uint8_t out[16];
+
+	RPL_aes_expand(&aes, key);
+	RPL_aes_encrypt(&aes, plaintext, out);
+	MEMCMP_EQUAL(ciphertext, out, 16);
+}
+
+TEST(security_tests, ccm_test) {
+	//RFC3610 Packet Vector #1
+	const uint8_t nonce[13] = { 0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 };
+	const uint8_t header[8] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+	const uint8_t ciphertext[23] = { 0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2, 0xF0, 0x66, 0xD0, 0xC2,
+	                                 0xC0, 0xF9, 0x89, 0x80, 0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84 };
+	const uint8_t expected_mac[8] = { 0x17, 0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0 };
+	struct rpl_aes_key_s aes;
+	uint8_t m[23], plaintext[23], mac[8];
+	int i;
+
+	for (i = 0; i < 23; i++) {
+		plaintext[i] = (uint8_t)(i + 8);
+	}
+	memcpy(m, plaintext, sizeof(m));
+
+	RPL_aes_expand(&aes, group_key);
+	CHECK_EQUAL(0, RPL_ccm_encrypt(&aes, nonce, header, sizeof(header), m, sizeof(m), 1, mac, sizeof(mac)));
+	MEMCMP_EQUAL(ciphertext, m, sizeof(m));
+	MEMCMP_EQUAL(expected_mac, mac, sizeof(mac));
+
+	CHECK_EQUAL(0, RPL_ccm_decrypt(&aes, nonce, header, sizeof(header), m, sizeof(m), 1, mac, sizeof(mac)));
+	MEMCMP_EQUAL(plaintext, m, sizeof(m));
+
+	//Any change to the header, data or MAC is detected
+	memcpy(m, ciphertext, sizeof(m));
+	mac[7] ^= 1;
+	CHECK_EQUAL(-1, RPL_ccm_decrypt(&aes, nonce, header, sizeof(header), m, sizeof(m), 1, mac, sizeof(mac)));
+	CHECK_EQUAL(-1, RPL_ccm_encrypt(&aes, nonce, header, sizeof(header), m, sizeof(m), 1, mac, 5));
+}
+
+TEST(security_tests, level_test) {
+	uint8_t buffer[128], plain[128];
+	uint16_t length;
+	uint8_t lvl;
+	struct rpl_message_view_s message;
+	struct rpl_dio_view_s dio;
+
+	CHECK_EQUAL(1, RPL_SEC_LVL_NORM_MODE1);
+	CHECK_EQUAL(3, RPL_SEC_LVL_NORM_MODE3);
+
+	for (lvl = RPL_SEC_LVL_NORM_MODE0; lvl <= RPL_SEC_LVL_NORM_MODE3; lvl++) {
+		length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE0, lvl, 100 + lvl);
+		memcpy(plain, buffer, length);
+
+		CHECK_EQUAL(0, RPL_security_protect(&keys, buffer, length, source, destination));
+		CHECK(checksum_valid(buffer, length));
+		CHECK_EQUAL(0, RPL_message_view_init(&message, buffer, length));
+		CHECK_EQUAL((lvl < 2) ? 4 : 8, length - message.base_end);
+		//Only the ENC levels hide the base and options
+		CHECK_EQUAL((lvl & 1) != 0, memcmp(plain + message.base_offset, buffer + message.base_offset, message.base_end - message.base_offset) != 0);
+
+		CHECK_EQUAL(0, RPL_security_unprotect(&keys, buffer, length, source, destination));
+		MEMCMP_EQUAL(plain + 4, buffer + 4, message.base_end - 4);
+		CHECK_EQUAL(0, RPL_dio_view_init(&dio, &message));
+		CHECK_EQUAL(256, RPL_dio_view_rank(&dio));
+	}
+}
+
+TEST(security_tests, tamper_test) {
+	uint8_t buffer[128], protected_buffer[128];
+	uint16_t length, i;
+
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE0, RPL_SEC_LVL_NORM_MODE3, 1);
+	CHECK_EQUAL(0, RPL_security_protect(&keys, buffer, length, source, destination));
+	memcpy(protected_buffer, buffer, length);
+
+	//Every octet except the checksum is covered by the MAC
+	for (i = 0; i < length; i++) {
+		if ((i == 2) || (i == 3)) {
+			continue;
+		}
+		memcpy(buffer, protected_buffer, length);
+		buffer[i] ^= 0x10;
+		CHECK_EQUAL(-1, RPL_security_unprotect(&keys, buffer, length, source, destination));
+	}
+
+	//The nonce includes the source address
+	memcpy(buffer, protected_buffer, length);
+	CHECK_EQUAL(-1, RPL_security_unprotect(&keys, buffer, length, destination, destination));
+
+	memcpy(buffer, protected_buffer, length);
+	CHECK_EQUAL(0, RPL_security_unprotect(&keys, buffer, length, source, destination));
+}
+
+TEST(security_tests, key_test) {
+	uint8_t buffer[128];
+	uint8_t other_key[16] = { 0 };
+	uint16_t length;
+	int i;
+
+	//Per-pair keys are identified by the peer, the receiver looks up the sender's key
+	CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE1, destination + 8, 0, other_key));
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE1, RPL_SEC_LVL_NORM_MODE1, 1);
+	CHECK_EQUAL(0, RPL_security_protect(&keys, buffer, length, source, destination));
+	CHECK_EQUAL(-1, RPL_security_unprotect(&keys, buffer, length, source, destination));
+	CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE1, source + 8, 0, other_key));
+	CHECK_EQUAL(0, RPL_security_unprotect(&keys, buffer, length, source, destination));
+
+	//Key source and index
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE2, RPL_SEC_LVL_NORM_MODE2, 1);
+	CHECK_EQUAL(-1, RPL_security_protect(&keys, buffer, length, source, destination));
+	CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE2, key_source, 7, group_key));
+	CHECK_EQUAL(0, RPL_security_protect(&keys, buffer, length, source, destination));
+
+	//Replacing a key takes effect immediately
+	CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE2, key_source, 7, other_key));
+	CHECK_EQUAL(-1, RPL_security_unprotect(&keys, buffer, length, source, destination));
+
+	CHECK_EQUAL(0, RPL_security_key_remove(&keys, RPL_SEC_KIM_MODE2, key_source, 7));
+	CHECK_EQUAL(-1, RPL_security_key_remove(&keys, RPL_SEC_KIM_MODE2, key_source, 7));
+	CHECK_EQUAL(-1, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE3, key_source, 7, group_key));
+	CHECK_EQUAL(-1, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE2, NULL, 7, group_key));
+
+	//Table full
+	for (i = 0; i < RPL_SECURITY_KEY_TABLE_SIZE - 3; i++) {
+		CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE0, NULL, (uint8_t)(10 + i), group_key));
+	}
+	CHECK_EQUAL(-1, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE0, NULL, 100, group_key));
+	CHECK_EQUAL(0, RPL_security_key_add(&keys, RPL_SEC_KIM_MODE0, NULL, 10, other_key));
+}
+
+TEST(security_tests, unsupported_test) {
+	uint8_t buffer[512];
+	uint16_t length;
+
+	//Not secured
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE0, RPL_SEC_LVL_NORM_MODE0, 1);
+	buffer[1] &= (uint8_t)~RPL_CONTROL_MESSAGE_SECURE_FLAG;
+	CHECK_EQUAL(-1, RPL_security_protect(&keys, buffer, length, source, destination));
+
+	//Unknown level and algorithm
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE0, 4, 1);
+	CHECK_EQUAL(-1, RPL_security_protect(&keys, buffer, length, source, destination));
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE0, RPL_SEC_LVL_NORM_MODE0, 1);
+	buffer[RPL_ICMPV6_HEADER_LENGTH + 1] = 1;
+	CHECK_EQUAL(-1, RPL_security_protect(&keys, buffer, length, source, destination));
+
+	//Truncated
+	length = secure_dio(buffer, sizeof(buffer), RPL_SEC_KIM_MODE0, RPL_SEC_LVL_NORM_MODE0, 1);
+	CHECK_EQUAL(-1, RPL_security_protect(&keys, buffer, RPL_ICMPV6_HEADER_LENGTH + 6, source, destination));
+}
+
+TEST(security_tests, batch_test) {
+	uint8_t buffers[11][128], reference[11][128];
+	struct rpl_security_packet_s packets[11];
+	uint8_t valid[11];
+	uint8_t aesni = keys.aesni;
+	int i;
+
+	for (i = 0; i < 11; i++) {
+		packets[i].message = buffers[i];
+		packets[i].source = source;
+		packets[i].destination = destination;
+		packets[i].length = secure_dio(buffers[i], sizeof(buffers[i]), RPL_SEC_KIM_MODE0, (uint8_t)(i & 3), (uint32_t)i);
+		memcpy(reference[i], buffers[i], packets[i].length);
+	}
+	//No key for the 6th message
+	buffers[5][RPL_ICMPV6_HEADER_LENGTH + RPL_SECURITY_BASE_LENGTH] = 4;
+	reference[5][RPL_ICMPV6_HEADER_LENGTH + RPL_SECURITY_BASE_LENGTH] = 4;
+
+	CHECK_EQUAL(10, RPL_security_protect_many(&keys, packets, valid, 11));
+	CHECK_EQUAL(0, valid[5]);
+
+	//The same result one at a time with the portable implementation
+	keys.aesni = 0;
+	for (i = 0; i < 11; i++) {
+		if (i != 5) {
+			CHECK_EQUAL(0, RPL_security_protect(&keys, reference[i], packets[i].length, source, destination));
+			MEMCMP_EQUAL(reference[i], buffers[i], packets[i].length);
+		}
+	}
+	keys.aesni = aesni;
+
+	buffers[8][40] ^= 1;
+	CHECK_EQUAL(9, RPL_security_unprotect_many(&keys, packets, valid, 11));
+	CHECK_EQUAL(0, valid[5]);
+	CHECK_EQUAL(0, valid[8]);
+	CHECK_EQUAL(1, valid[10]);
+}
+
+#endif
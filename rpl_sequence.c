@@ -1,60 +1,45 @@
 #include "rpl.h"
 
-//TODO: sequence counter stuff, section 7.2
+//Sequence counter stuff, section 7.2
+
+int RPL_sequence_init(void) {
+	return RPL_SEQUENCE_INITIAL;
+}
+
+//Counters in the linear region wrap from 255 to 0, counters in the circular region wrap from 127 to 0
+int RPL_sequence_increment(int a) {
+	int mask = 0x7F | (a & RPL_SEQUENCE_REGION_MASK);
+
+	return (a + 1) & mask;
+}
+
+int RPL_sequence_counter_increment(int a) {
+	return RPL_sequence_increment(a);
+}
 
 int RPL_sequence_is_comparable(int a, int b) {
-	//TODO
-	return 0;
+	return RPL_sequence_compare_fast((uint8_t)a, (uint8_t)b) != RPL_SEQUENCE_COMPARE_INCOMPARABLE;
 }
 
 int RPL_sequence_is_greater(int a, int b) {
-	//TODO
-	return 0;
+	return RPL_sequence_compare_fast((uint8_t)a, (uint8_t)b) == RPL_SEQUENCE_COMPARE_A_GREATER;
 }
 
 int RPL_sequence_is_lesser(int a, int b) {
-	//TODO
-	return 0;
+	return RPL_sequence_compare_fast((uint8_t)a, (uint8_t)b) == RPL_SEQUENCE_COMPARE_B_GREATER;
 }
 
-//This algorithm (description). Wat.
-//Must be (massively) optimizable
+//Returns 1 if B is greater than A, -1 if A is greater than B, 0 if equal
+//and RPL_SEQUENCE_COMPARE_INCOMPARABLE if the counters are too far apart to compare
 int RPL_sequence_counter_compare(int a, int b) {
-	if ((a > 127) && (b <= 127)) {
-		if ((256 + b - a) <= RPL_SEQUENCE_WINDOW) {
-			return 1;   // B is greater than A
-		} else {
-			return -1;  // A is greater than B
-		}
-	} if ((a <= 127) && (b > 127)) {
-		if ((256 + a - b) <= RPL_SEQUENCE_WINDOW) {
-			return 1;   // B is greater than A
-		} else {
-			return -1;  // A is greater than B
-		}
-	}else {
-
-	}
-
-
-	return 0;
+	return RPL_sequence_compare_fast((uint8_t)a, (uint8_t)b);
 }
 
-int RPL_sequence_counter_increment(int a) {
-	if (a >= 128) {
-		if (a == 255) {
-			a = 0;
-		} else {
-			a ++;
-		}
-	} else {
-		if (a == 127) {
-			a = 0;
-		} else {
-			a ++;
-		}
-	}
+//Straight line loop body so the compiler can vectorize it
+void RPL_sequence_compare_many(const uint8_t *restrict a, const uint8_t *restrict b, int8_t *restrict out, unsigned int n) {
+	unsigned int i;
 
-	return a;
+	for (i = 0; i < n; i++) {
+		out[i] = (int8_t)RPL_sequence_compare_fast(a[i], b[i]);
+	}
 }
-
@@ -0,0 +1,88 @@
+/**
+ * RPL sequence counters
+ * Lollipop counters used for DODAG Version, DTSN, DAO and Path sequences [RFC6550 Section 7.2]
+ *
+ * Values in [128..255] form the straight part of the lollipop (counters start at RPL_SEQUENCE_INITIAL),
+ * values in [0..127] form the circular part. Comparison is branch free so that the batch
+ * comparison can be vectorized by the compiler.
+ */
+
+#ifndef RPL_SEQUENCE_H
+#define RPL_SEQUENCE_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Results of sequence counter comparison (see RPL_sequence_counter_compare)
+ */
+enum rpl_sequence_compare_e {
+    RPL_SEQUENCE_COMPARE_A_GREATER = -1,        //!< A is greater than B
+    RPL_SEQUENCE_COMPARE_EQUAL = 0,             //!< A and B are equal
+    RPL_SEQUENCE_COMPARE_B_GREATER = 1,         //!< B is greater than A
+    RPL_SEQUENCE_COMPARE_INCOMPARABLE = 2       //!< Counters have desynchronized and are not comparable [RFC6550 Section 7.2 rule 2.2]
+};
+
+#define RPL_SEQUENCE_REGION_MASK    0x80        //!< Set when a counter is in the linear (lollipop stick) region [128..255]
+
+/**
+ * @brief Branch free lollipop comparison of two sequence counters
+ * @details Implements all of [RFC6550 Section 7.2] using only 8 bit arithmetic and masks so that
+ * loops over it vectorize. With ahead = (B - A) mod 128 when both counters are in the circular
+ * region (serial number arithmetic on 7 bits [RFC1982]) and mod 256 otherwise:
+ *  - counters in the same region compare directly when ahead is within RPL_SEQUENCE_WINDOW
+ *    either way, and are otherwise incomparable.
+ *  - counters in different regions compare across the wrap, B is greater when it is at most
+ *    RPL_SEQUENCE_WINDOW past the end of A's region.
+ *
+ * @param a first sequence counter
+ * @param b second sequence counter
+ * @return rpl_sequence_compare_e result
+ */
+static inline int RPL_sequence_compare_fast(uint8_t a, uint8_t b) {
+    uint8_t mask = (uint8_t)(0x7F | ((a | b) & RPL_SEQUENCE_REGION_MASK));
+    uint8_t ahead = (uint8_t)((b - a) & mask);
+    uint8_t forward = (uint8_t)(ahead - 1) < RPL_SEQUENCE_WINDOW;
+    uint8_t backward = ahead > (uint8_t)(mask - RPL_SEQUENCE_WINDOW);
+    uint8_t a_high = a >> 7;
+    uint8_t cross = (uint8_t)((a ^ b) & RPL_SEQUENCE_REGION_MASK) >> 7;
+    uint8_t outside = (uint8_t)((forward | backward | (ahead == 0)) ^ 1);
+    uint8_t b_greater = (a_high & forward) | ((a_high ^ 1) & (backward ^ 1));
+    int8_t same_result = (int8_t)(forward - backward + (outside << 1));
+    int8_t cross_result = (int8_t)((b_greater << 1) - 1);
+    int8_t cross_mask = (int8_t)-cross;
+
+    return (int8_t)((same_result & ~cross_mask) | (cross_result & cross_mask));
+}
+
+int RPL_sequence_init(void);
+int RPL_sequence_increment(int a);
+int RPL_sequence_counter_increment(int a);
+
+int RPL_sequence_is_comparable(int a, int b);
+int RPL_sequence_is_greater(int a, int b);
+int RPL_sequence_is_lesser(int a, int b);
+int RPL_sequence_counter_compare(int a, int b);
+
+/**
+ * @brief Compare arrays of sequence counters
+ * @details out[i] is the rpl_sequence_compare_e result of comparing a[i] with b[i].
+ * Used to check DODAG Version, DTSN and DAO sequences of many messages at once.
+ *
+ * @param a first sequence counters
+ * @param b second sequence counters
+ * @param out comparison results
+ * @param n number of counters in each array
+ */
+void RPL_sequence_compare_many(const uint8_t *a, const uint8_t *b, int8_t *out, unsigned int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
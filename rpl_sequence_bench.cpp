@@ -0,0 +1,126 @@
+/**
+ * Sequence counter micro-benchmark
+ * Compares the original branch based comparison with the branch free and batch versions.
+ * Uses Google Benchmark (see rpl_bench.h), build with eg.
+ *   gcc -O3 -c rpl_sequence.c && g++ -O3 rpl_sequence_bench.cpp rpl_sequence.o -lbenchmark -lpthread
+ */
+
+#include <stdint.h>
+
+#include "rpl_bench.h"
+
+#include "rpl.h"
+
+#define BENCH_COUNTERS      4096
+
+//Original implementation, kept as a baseline
+static int sequence_counter_compare_branchy(int a, int b) {
+	if ((a > 127) && (b <= 127)) {
+		if ((256 + b - a) <= RPL_SEQUENCE_WINDOW) {
+			return 1;
+		} else {
+			return -1;
+		}
+	} if ((a <= 127) && (b > 127)) {
+		if ((256 + a - b) <= RPL_SEQUENCE_WINDOW) {
+			return 1;
+		} else {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+struct sequence_bench_data {
+	uint8_t a[BENCH_COUNTERS];
+	uint8_t b[BENCH_COUNTERS];
+	int8_t out[BENCH_COUNTERS];
+
+	sequence_bench_data() {
+		uint32_t random = 0x6550;
+
+		for (int i = 0; i < BENCH_COUNTERS; i++) {
+			a[i] = (uint8_t)rpl_bench_random(&random);
+			b[i] = (uint8_t)rpl_bench_random(&random);
+		}
+	}
+};
+
+static sequence_bench_data data;
+
+static void BM_sequence_compare_branchy(benchmark::State &state) {
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_COUNTERS; i++) {
+			data.out[i] = (int8_t)sequence_counter_compare_branchy(data.a[i], data.b[i]);
+		}
+		benchmark::DoNotOptimize(data.out);
+	}
+	rpl_bench_items(state, BENCH_COUNTERS);
+}
+BENCHMARK(BM_sequence_compare_branchy);
+
+static void BM_sequence_counter_compare(benchmark::State &state) {
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_COUNTERS; i++) {
+			data.out[i] = (int8_t)RPL_sequence_counter_compare(data.a[i], data.b[i]);
+		}
+		benchmark::DoNotOptimize(data.out);
+	}
+	rpl_bench_items(state, BENCH_COUNTERS);
+}
+BENCHMARK(BM_sequence_counter_compare);
+
+static void BM_sequence_compare_fast(benchmark::State &state) {
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_COUNTERS; i++) {
+			data.out[i] = (int8_t)RPL_sequence_compare_fast(data.a[i], data.b[i]);
+		}
+		benchmark::DoNotOptimize(data.out);
+	}
+	rpl_bench_items(state, BENCH_COUNTERS);
+}
+BENCHMARK(BM_sequence_compare_fast);
+
+static void BM_sequence_compare_many(benchmark::State &state) {
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		RPL_sequence_compare_many(data.a, data.b, data.out, BENCH_COUNTERS);
+		benchmark::DoNotOptimize(data.out);
+	}
+	rpl_bench_items(state, BENCH_COUNTERS);
+}
+BENCHMARK(BM_sequence_compare_many);
+
+static void BM_sequence_increment(benchmark::State &state) {
+	int counter = RPL_sequence_init();
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_COUNTERS; i++) {
+			counter = RPL_sequence_increment(counter);
+		}
+		benchmark::DoNotOptimize(counter);
+	}
+	rpl_bench_items(state, BENCH_COUNTERS);
+}
+BENCHMARK(BM_sequence_increment);
+
+static void BM_sequence_counter_increment(benchmark::State &state) {
+	int counter = RPL_sequence_init();
+
+	rpl_bench_allocations = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < BENCH_COUNTERS; i++) {
+			counter = RPL_sequence_counter_increment(counter);
+		}
+		benchmark::DoNotOptimize(counter);
+	}
+	rpl_bench_items(state, BENCH_COUNTERS);
+}
+BENCHMARK(BM_sequence_counter_increment);
+
+RPL_BENCH_MAIN()
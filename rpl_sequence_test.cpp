@@ -1,3 +1,5 @@
+#include <stdlib.h>
+
 #include "CppUTest/TestHarness.h"
 #include "CppUTestExt/MockSupport.h"
 
@@ -38,7 +40,7 @@ TEST(sequence_tests, sequence_increment_test) {
 	//Wraparound low
 	a = 255;
 	b = RPL_sequence_increment(a);
-	CHECK_EQUAL(0, b):
+	CHECK_EQUAL(0, b);
 
 	//Linear high increment
 	a = 140;
@@ -48,7 +50,7 @@ TEST(sequence_tests, sequence_increment_test) {
 	//Wraparound high
 	a = 255;
 	b = RPL_sequence_increment(a);
-	CHECK_EQUAL(0, b):
+	CHECK_EQUAL(0, b);
 }
 
 //Sequence requirement 3
@@ -86,5 +88,93 @@ TEST(sequence_tests, sequence_compare_test_3) {
 
 //Sequence requirement 4
 TEST(sequence_tests, sequence_compare_test_4) {
-	//No idea how to test this, see [RFC6550 Page 65] 
-}
\ No newline at end of file
+	int a, b;
+
+	//Same region within the window uses normal comparison [RFC6550 Page 65 Section 2.1]
+	a = 10;
+	b = 20;
+	CHECK_EQUAL(1, RPL_sequence_is_comparable(a, b));
+	CHECK_EQUAL(1, RPL_sequence_is_lesser(a, b));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_B_GREATER, RPL_sequence_counter_compare(a, b));
+
+	a = 250;
+	b = 245;
+	CHECK_EQUAL(1, RPL_sequence_is_greater(a, b));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_EQUAL, RPL_sequence_counter_compare(a, a));
+
+	//Same region outside the window has desynchronized [RFC6550 Page 65 Section 2.2]
+	a = 10;
+	b = 100;
+	CHECK_EQUAL(0, RPL_sequence_is_comparable(a, b));
+	CHECK_EQUAL(0, RPL_sequence_is_greater(a, b));
+	CHECK_EQUAL(0, RPL_sequence_is_lesser(a, b));
+
+	a = 130;
+	b = 200;
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_INCOMPARABLE, RPL_sequence_counter_compare(a, b));
+
+	//The circular region wraps from 127 to 0
+	CHECK_EQUAL(0, RPL_sequence_increment(127));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_B_GREATER, RPL_sequence_counter_compare(127, RPL_sequence_increment(127)));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_A_GREATER, RPL_sequence_counter_compare(0, 127));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_B_GREATER, RPL_sequence_counter_compare(125, 3));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_A_GREATER, RPL_sequence_counter_compare(3, 125));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_INCOMPARABLE, RPL_sequence_counter_compare(100, 3));
+
+	//Low value in A and high value in B is the mirror of Section 1
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_A_GREATER, RPL_sequence_counter_compare(5, 250));
+	CHECK_EQUAL(RPL_SEQUENCE_COMPARE_B_GREATER, RPL_sequence_counter_compare(5, 240));
+}
+
+//Direct transcription of [RFC6550 Section 7.2] to check the branch free comparison against
+static int sequence_compare_reference(int a, int b) {
+	if ((a > 127) && (b <= 127)) {
+		return ((256 + b - a) <= RPL_SEQUENCE_WINDOW) ? 1 : -1;
+	}
+	if ((a <= 127) && (b > 127)) {
+		return ((256 + a - b) <= RPL_SEQUENCE_WINDOW) ? -1 : 1;
+	}
+	if ((a <= 127) && (b <= 127)) {
+		//Circular region, serial number arithmetic on 7 bits [RFC1982]
+		int ahead = (b - a) & 0x7F;
+
+		if (ahead == 0) {
+			return 0;
+		}
+		if (ahead <= RPL_SEQUENCE_WINDOW) {
+			return 1;
+		}
+		return ((128 - ahead) <= RPL_SEQUENCE_WINDOW) ? -1 : RPL_SEQUENCE_COMPARE_INCOMPARABLE;
+	}
+	if (abs(a - b) > RPL_SEQUENCE_WINDOW) {
+		return RPL_SEQUENCE_COMPARE_INCOMPARABLE;
+	}
+	return (a == b) ? 0 : ((a > b) ? -1 : 1);
+}
+
+TEST(sequence_tests, sequence_compare_exhaustive_test) {
+	int a, b;
+
+	for (a = 0; a <= RPL_SEQUENCE_MAX; a++) {
+		for (b = 0; b <= RPL_SEQUENCE_MAX; b++) {
+			CHECK_EQUAL(sequence_compare_reference(a, b), RPL_sequence_counter_compare(a, b));
+		}
+	}
+}
+
+TEST(sequence_tests, sequence_compare_many_test) {
+	uint8_t a[256], b[256];
+	int8_t out[256];
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		a[i] = (uint8_t)i;
+		b[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	RPL_sequence_compare_many(a, b, out, 256);
+
+	for (i = 0; i < 256; i++) {
+		CHECK_EQUAL(RPL_sequence_counter_compare(a[i], b[i]), out[i]);
+	}
+}
@@ -0,0 +1,668 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rpl.h"
+
+#if RPL_CONF_NON_STORING
+
+static const uint8_t RPL_sim_all_rpl_nodes[16] = { 0xFF, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x1A };
+
+static void RPL_sim_deliver(struct rpl_timer_s *timer, void *context);
+static void RPL_sim_dio_transmit(struct rpl_trickle_s *trickle, void *context);
+static void RPL_sim_dao_send(struct rpl_dao_pipeline_s *pipeline, const uint8_t *message, uint16_t length, void *context);
+static void RPL_sim_dao_refresh(struct rpl_timer_s *timer, void *context);
+
+//xorshift32, the state must not be 0
+static uint32_t RPL_sim_random(uint32_t *state) {
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+static uint32_t RPL_sim_seed(uint32_t seed, uint32_t id, uint32_t stream) {
+	uint32_t x = seed ^ (id * 0x9E3779B1UL) ^ (stream * 0x85EBCA77UL);
+
+	x ^= x >> 16;
+	x *= 0x7FEB352DUL;
+	x ^= x >> 15;
+	x *= 0x846CA68BUL;
+	x ^= x >> 16;
+	return (x == 0) ? 0x6550 : x;
+}
+
+int RPL_sim_init(struct rpl_sim_s *sim, struct rpl_sim_node_s *nodes, uint32_t node_count, const struct rpl_sim_link_s *links, const uint32_t *link_offsets,
+                 struct rpl_sim_shard_s *shards, uint32_t shard_count, struct rpl_sim_packet_s *packets, struct rpl_sim_pending_s *pending, uint32_t packet_count,
+                 struct rpl_source_route_graph_s *routes, uint32_t seed) {
+	uint32_t per_shard = (shard_count != 0) ? packet_count / shard_count : 0;
+	uint8_t root[16];
+	uint32_t i, l;
+
+	if ((shard_count == 0) || (shard_count > node_count) || (per_shard == 0)) {
+		return -1;
+	}
+	memset(sim, 0, sizeof(*sim));
+	sim->nodes = nodes;
+	sim->node_count = node_count;
+	sim->links = links;
+	sim->link_offsets = link_offsets;
+	sim->shards = shards;
+	sim->shard_count = shard_count;
+	sim->routes = routes;
+	sim->of = &RPL_of0;
+	sim->instance = 0;
+	sim->version = (rpl_dodag_version_t)RPL_sequence_init();
+	sim->dao_refresh = DEFAULT_SIM_DAO_REFRESH;
+	sim->hold_time = DEFAULT_SIM_HOLD_TIME;
+	sim->mac_retries = DEFAULT_SIM_MAC_RETRIES;
+	sim->config.dio_int_double = DEFAULT_DIO_INTERVAL_DOUBLINGS;
+	sim->config.dio_int_min = DEFAULT_DIO_INTERVAL_MIN;
+	sim->config.dio_redun = DEFAULT_DIO_REDUNDANCY_CONSTANT;
+	sim->config.min_hop_rank_increase = DEFAULT_MIN_HOP_RANK_INCREASE;
+	sim->config.default_lifetime = RPL_ROUTE_LIFETIME_INFINITE;
+	sim->config.lifetime_unit = 60;
+
+	sim->lookahead = 0xFFFFFFFF;
+	for (l = 0; l < link_offsets[node_count]; l++) {
+		if ((links[l].latency == 0) || (links[l].to >= node_count)) {
+			return -1;
+		}
+		if (links[l].latency < sim->lookahead) {
+			sim->lookahead = links[l].latency;
+		}
+	}
+
+	for (i = 0; i < shard_count; i++) {
+		struct rpl_sim_shard_s *shard = &shards[i];
+		uint32_t p;
+
+		memset(shard, 0, offsetof(struct rpl_sim_shard_s, buffer));
+		RPL_timer_wheel_init(&shard->wheel, 0, NULL);
+		shard->sim = sim;
+		shard->first_node = (uint32_t)(((uint64_t)node_count * i) / shard_count);
+		shard->end_node = (uint32_t)(((uint64_t)node_count * (i + 1)) / shard_count);
+		shard->packets = packets + (size_t)per_shard * i;
+		RPL_pool_init(&shard->packet_pool, shard->packets, sizeof(struct rpl_sim_packet_s), offsetof(struct rpl_sim_packet_s, next), per_shard);
+		shard->pending = pending + (size_t)per_shard * i;
+		shard->sent = RPL_ROUTE_NONE;
+		for (p = 0; p < per_shard; p++) {
+			RPL_timer_init(&shard->packets[p].timer, RPL_sim_deliver, &shard->packets[p]);
+			shard->packets[p].shard = shard;
+		}
+	}
+
+	RPL_sim_address(root, 0);
+	for (i = 0; i < node_count; i++) {
+		struct rpl_sim_node_s *node = &nodes[i];
+		struct rpl_sim_shard_s *shard = shards;
+
+		while (i >= shard->end_node) {
+			shard++;
+		}
+		memset(node, 0, sizeof(*node));
+		node->sim = sim;
+		node->shard = shard;
+		node->id = i;
+		node->random = RPL_sim_seed(seed, i, 0);
+		node->joined = RPL_SIM_NEVER;
+		RPL_trickle_engine_init(&node->engine, &shard->wheel, NULL, NULL);
+		node->engine.random_state = RPL_sim_seed(seed, i, 1);
+		RPL_dao_pipeline_init(&node->dao, &shard->wheel, shard->buffer, RPL_SIM_PACKET_SIZE, sim->instance, root, RPL_sim_dao_send, NULL, node);
+		node->dao.ack_requested = 0;
+		RPL_timer_init(&node->refresh, RPL_sim_dao_refresh, node);
+	}
+	return 0;
+}
+
+static void RPL_sim_join(struct rpl_sim_node_s *node) {
+	struct rpl_sim_shard_s *shard = node->shard;
+
+	node->joined = shard->wheel.now;
+	shard->stats.joined++;
+	shard->stats.last_join = shard->wheel.now;
+	RPL_trickle_start(&node->trickle);
+}
+
+void RPL_sim_start(struct rpl_sim_s *sim) {
+	uint32_t i;
+
+	for (i = 0; i < sim->node_count; i++) {
+		struct rpl_sim_node_s *node = &sim->nodes[i];
+
+		RPL_address_table_init(&node->addresses, node->address_entries, RPL_NEIGHBOR_TABLE_SIZE + 2, node->address_index, RPL_SIM_ADDRESS_INDEX_SIZE);
+		RPL_parent_table_init(&node->parents, &node->addresses, sim->config.min_hop_rank_increase, (i == 0));
+		RPL_of_attach(sim->of, &node->parents);
+		RPL_version_init(&node->version, &node->parents, NULL, &node->shard->wheel, sim->hold_time, NULL, NULL);
+		node->version.version = sim->version;
+		RPL_trickle_init_config(&node->trickle, &node->engine, &sim->config, RPL_sim_dio_transmit, node);
+		node->dao.instance = sim->instance;
+	}
+	RPL_sim_join(&sim->nodes[0]);
+}
+
+void RPL_sim_global_repair(struct rpl_sim_s *sim) {
+	struct rpl_sim_node_s *root = &sim->nodes[0];
+
+	RPL_version_increment(&root->version);
+	RPL_trickle_inconsistent(&root->trickle);
+}
+
+//Queue a transmission on each matching link of the node, to is a node id or RPL_SIM_BROADCAST
+//Packets are taken from the sender's shard and handed to the receiver's shard at the end of the window
+static uint32_t RPL_sim_neighbor_id(const struct rpl_sim_node_s *node, const struct rpl_neighbor_s *neighbor) {
+	uint8_t address[16];
+
+	RPL_parent_table_address(&node->parents, neighbor, address);
+	return RPL_sim_node_id(address);
+}
+
+static void RPL_sim_transmit(struct rpl_sim_node_s *node, uint32_t to, uint32_t destination, const uint8_t *data, uint16_t length, uint8_t hops) {
+	struct rpl_sim_s *sim = node->sim;
+	struct rpl_sim_shard_s *shard = node->shard;
+	uint32_t l;
+
+	for (l = sim->link_offsets[node->id]; l < sim->link_offsets[node->id + 1]; l++) {
+		const struct rpl_sim_link_s *link = &sim->links[l];
+		struct rpl_sim_packet_s *packet;
+		uint32_t attempt, index;
+		int received;
+
+		if ((to != RPL_SIM_BROADCAST) && (link->to != to)) {
+			continue;
+		}
+		//Unicasts are retried by the link layer, each attempt adding the link latency
+		for (attempt = 0, received = 0; !received; attempt++) {
+			node->sequence++;
+			shard->stats.transmissions++;
+			shard->stats.bytes += length;
+			received = (link->prr == RPL_SIM_PRR_ALWAYS) || ((RPL_sim_random(&node->random) & 0xFFFF) < link->prr);
+			if (!received) {
+				shard->stats.losses++;
+				if ((to == RPL_SIM_BROADCAST) || (attempt >= sim->mac_retries)) {
+					break;
+				}
+			}
+		}
+		if (!received) {
+			continue;
+		}
+		index = RPL_pool_alloc(&shard->packet_pool);
+		if (index == RPL_POOL_NONE) {
+			shard->stats.drops++;
+			continue;
+		}
+		packet = &shard->packets[index];
+		packet->from = node->id;
+		packet->to = link->to;
+		packet->destination = destination;
+		packet->arrival = shard->wheel.now + attempt * link->latency;
+		packet->sequence = node->sequence;
+		packet->link_metric = (uint16_t)((RPL_MRHOF_ETX_DIVISOR * (uint32_t)RPL_SIM_PRR_ALWAYS) / (link->prr ? link->prr : 1));
+		packet->length = length;
+		packet->hops = hops;
+		memcpy(packet->data, data, length);
+
+		packet->next = RPL_ROUTE_NONE;
+		if (shard->sent == RPL_ROUTE_NONE) {
+			shard->sent = index;
+		} else {
+			shard->packets[shard->sent_tail].next = index;
+		}
+		shard->sent_tail = index;
+	}
+}
+
+static void RPL_sim_dio_transmit(struct rpl_trickle_s *trickle, void *context) {
+	struct rpl_sim_node_s *node = (struct rpl_sim_node_s *)context;
+	struct rpl_sim_s *sim = node->sim;
+	struct rpl_builder_s builder;
+	struct rpl_dio_s dio;
+	uint8_t source[16], dodag_id[16];
+	int length;
+
+	(void)trickle;
+
+	//A node that forgot the DODAG only advertises again once it joins a version
+	if (!RPL_version_is_member(&node->version)) {
+		return;
+	}
+	memset(&dio, 0, sizeof(dio));
+	dio.rpl_instance_id = sim->instance;
+	dio.rpl_version = node->version.version;
+	dio.rank = RPL_parent_table_rank(&node->parents);
+	dio.mode = RPL_DIO_MODE_GROUNDED_FLAG | (RPL_DIO_MODE_MOP1 << RPL_DIO_MODE_MODE_OF_OPERATION_SHIFT);
+	RPL_sim_address(source, node->id);
+	RPL_sim_address(dodag_id, 0);
+	RPL_builder_init(&builder, node->shard->buffer, sizeof(node->shard->buffer), NULL, 0);
+	RPL_builder_dio(&builder, &dio, dodag_id, NULL);
+	RPL_builder_dodag_config(&builder, &sim->config);
+	length = RPL_builder_finish(&builder, source, RPL_sim_all_rpl_nodes);
+	if (length > 0) {
+		node->dio_sent++;
+		node->shard->stats.dio++;
+		RPL_sim_transmit(node, RPL_SIM_BROADCAST, RPL_SIM_BROADCAST, node->shard->buffer, (uint16_t)length, 0);
+	}
+}
+
+//DAOs are sent towards the root through the preferred parent
+static void RPL_sim_dao_send(struct rpl_dao_pipeline_s *pipeline, const uint8_t *message, uint16_t length, void *context) {
+	struct rpl_sim_node_s *node = (struct rpl_sim_node_s *)context;
+	const struct rpl_neighbor_s *parent = RPL_parent_table_preferred(&node->parents);
+
+	(void)pipeline;
+
+	if (parent != NULL) {
+		node->dao_sent++;
+		node->shard->stats.dao++;
+		RPL_sim_transmit(node, RPL_sim_neighbor_id(node, parent), 0, message, length, 0);
+	}
+}
+
+//Advertise the node's own target with its current preferred parent
+static void RPL_sim_dao_advertise(struct rpl_sim_node_s *node) {
+	const struct rpl_neighbor_s *parent = RPL_parent_table_preferred(&node->parents);
+	struct rpl_option_transit_info_s transit;
+	uint8_t address[16], parent_address[16];
+
+	if (parent == NULL) {
+		return;
+	}
+	RPL_parent_table_address(&node->parents, parent, parent_address);
+	node->path_sequence = (uint8_t)RPL_sequence_increment(node->path_sequence);
+	memset(&transit, 0, sizeof(transit));
+	transit.path_sequence = node->path_sequence;
+	transit.path_lifetime = node->sim->config.default_lifetime;
+	RPL_sim_address(address, node->id);
+	RPL_dao_pipeline_add(&node->dao, address, 128, &transit, parent_address);
+	RPL_timer_start(&node->shard->wheel, &node->refresh, node->shard->wheel.now + node->sim->dao_refresh);
+}
+
+static void RPL_sim_dao_refresh(struct rpl_timer_s *timer, void *context) {
+	(void)timer;
+
+	RPL_sim_dao_advertise((struct rpl_sim_node_s *)context);
+}
+
+//OF0 takes a step of rank, scaled from the ETX so that a perfect link gives the default step [RFC6552 Section 4.1]
+static uint16_t RPL_sim_link_metric(const struct rpl_sim_s *sim, uint16_t etx) {
+	uint32_t step;
+
+	if (sim->of->ocp != RPL_OCP_OF0) {
+		return etx;
+	}
+	step = ((uint32_t)etx * RPL_OF0_DEFAULT_STEP_OF_RANK) / RPL_MRHOF_ETX_DIVISOR;
+	return (uint16_t)((step > RPL_OF0_MAXIMUM_STEP_OF_RANK) ? RPL_OF0_MAXIMUM_STEP_OF_RANK : step);
+}
+
+static void RPL_sim_receive_dio(struct rpl_sim_node_s *node, const struct rpl_sim_packet_s *packet, const struct rpl_message_view_s *message) {
+	struct rpl_sim_s *sim = node->sim;
+	struct rpl_dio_view_s dio;
+	const struct rpl_neighbor_s *preferred;
+	rpl_dodag_rank_t rank, previous_rank;
+	uint32_t previous_parent;
+	uint8_t address[16];
+
+	if ((node->id == 0) || (RPL_dio_view_init(&dio, message) != 0) || (RPL_dio_view_instance_id(&dio) != sim->instance)) {
+		return;
+	}
+	switch (RPL_version_receive(&node->version, RPL_dio_view_version(&dio))) {
+	case RPL_VERSION_INCONSISTENT:
+		return;
+	case RPL_VERSION_NEW:
+		//Global repair, the old version's parents no longer count
+		if (node->joined != RPL_SIM_NEVER) {
+			RPL_trickle_inconsistent(&node->trickle);
+		}
+		break;
+	default:
+		break;
+	}
+
+	previous_rank = RPL_parent_table_rank(&node->parents);
+	preferred = RPL_parent_table_preferred(&node->parents);
+	previous_parent = (preferred != NULL) ? RPL_sim_neighbor_id(node, preferred) : RPL_SIM_BROADCAST;
+
+	RPL_sim_address(address, packet->from);
+	rank = RPL_dio_view_rank(&dio);
+	if (rank == RPL_INFINITE_RANK) {
+		RPL_parent_table_remove(&node->parents, address);
+	} else {
+		RPL_of_parent_update(sim->of, &node->parents, address, rank, RPL_sim_link_metric(sim, packet->link_metric));
+	}
+	RPL_version_update(&node->version);
+
+	rank = RPL_parent_table_rank(&node->parents);
+	preferred = RPL_parent_table_preferred(&node->parents);
+	if ((node->joined == RPL_SIM_NEVER) && (preferred != NULL)) {
+		uint8_t root[16];
+
+		RPL_sim_address(address, node->id);
+		RPL_sim_address(root, 0);
+		RPL_dao_pipeline_set_destination(&node->dao, address, root);
+		RPL_sim_join(node);
+	} else if (rank == previous_rank) {
+		RPL_trickle_consistent(&node->trickle);
+	} else if ((rank == RPL_INFINITE_RANK) && (node->joined != RPL_SIM_NEVER)) {
+		//All parents lost, advertise the infinite rank
+		RPL_trickle_inconsistent(&node->trickle);
+	}
+	if ((preferred != NULL) && (RPL_sim_neighbor_id(node, preferred) != previous_parent)) {
+		RPL_sim_dao_advertise(node);
+	}
+}
+
+static void RPL_sim_receive_dao(struct rpl_sim_node_s *node, const struct rpl_sim_packet_s *packet, const struct rpl_message_view_s *message) {
+	struct rpl_sim_s *sim = node->sim;
+	const struct rpl_neighbor_s *parent;
+	struct rpl_dao_view_s dao;
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s option, target;
+	int have_target = 0;
+
+	if (node->id != 0) {
+		//Forwarded towards the root
+		parent = RPL_parent_table_preferred(&node->parents);
+		if ((parent != NULL) && (packet->hops < RPL_SIM_MAX_HOPS)) {
+			node->shard->stats.dao++;
+			RPL_sim_transmit(node, RPL_sim_neighbor_id(node, parent), packet->destination, packet->data, packet->length, (uint8_t)(packet->hops + 1));
+		}
+		return;
+	}
+
+	if ((RPL_dao_view_init(&dao, message) != 0) || (RPL_dao_view_instance_id(&dao) != sim->instance)) {
+		return;
+	}
+	RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, RPL_dao_view_options(&dao), RPL_dao_view_options_length(&dao));
+	while (RPL_option_iter_next(&iter, &option) == 1) {
+		if (option.type == RPL_OPTION_RPL_TARGET) {
+			target = option;
+			have_target = 1;
+		} else if ((option.type == RPL_OPTION_TRANSIT_INFO) && have_target) {
+			RPL_source_route_target(sim->routes, &target, &option, node->shard->wheel.now);
+		}
+	}
+}
+
+static void RPL_sim_deliver(struct rpl_timer_s *timer, void *context) {
+	struct rpl_sim_packet_s *packet = (struct rpl_sim_packet_s *)context;
+	struct rpl_sim_shard_s *shard = packet->shard;
+	struct rpl_sim_node_s *node = &shard->sim->nodes[packet->to];
+	struct rpl_message_view_s message;
+
+	(void)timer;
+
+	shard->stats.deliveries++;
+	if (RPL_message_view_init(&message, packet->data, packet->length) == 0) {
+		switch (RPL_message_view_code(&message)) {
+		case RPL_DODAG_INFORMATION_OBJECT:
+			RPL_sim_receive_dio(node, packet, &message);
+			break;
+		case RPL_DESTINATION_ADVERTISEMENt_OBJECT:
+			RPL_sim_receive_dao(node, packet, &message);
+			break;
+		default:
+			break;
+		}
+	}
+	RPL_pool_free(&shard->packet_pool, (uint32_t)(packet - shard->packets));
+}
+
+static int RPL_sim_pending_compare(const void *a, const void *b) {
+	const struct rpl_sim_pending_s *x = (const struct rpl_sim_pending_s *)a;
+	const struct rpl_sim_pending_s *y = (const struct rpl_sim_pending_s *)b;
+
+	if (x->arrival != y->arrival) {
+		return ((int32_t)(x->arrival - y->arrival) < 0) ? -1 : 1;
+	}
+	if (x->to != y->to) {
+		return (x->to < y->to) ? -1 : 1;
+	}
+	if (x->from != y->from) {
+		return (x->from < y->from) ? -1 : 1;
+	}
+	return (x->sequence < y->sequence) ? -1 : (x->sequence > y->sequence);
+}
+
+//Take the packets sent to the shard's nodes in the last window from every shard and schedule them
+//in an order independent of the order they were sent in
+static void RPL_sim_collect(struct rpl_sim_shard_s *shard, uint32_t until) {
+	struct rpl_sim_s *sim = shard->sim;
+	uint32_t count = 0;
+	uint32_t s, i;
+
+	for (s = 0; s < sim->shard_count; s++) {
+		const struct rpl_sim_shard_s *source = &sim->shards[s];
+
+		for (i = source->sent; i != RPL_ROUTE_NONE; i = source->packets[i].next) {
+			const struct rpl_sim_packet_s *sent = &source->packets[i];
+			struct rpl_sim_packet_s *packet;
+			uint32_t index = i;
+
+			if ((sent->to < shard->first_node) || (sent->to >= shard->end_node)) {
+				continue;
+			}
+			if (source != shard) {
+				index = RPL_pool_alloc(&shard->packet_pool);
+				if (index == RPL_POOL_NONE) {
+					shard->stats.drops++;
+					continue;
+				}
+				packet = &shard->packets[index];
+				memcpy(&packet->from, &sent->from, offsetof(struct rpl_sim_packet_s, data) - offsetof(struct rpl_sim_packet_s, from) + sent->length);
+			}
+			shard->pending[count].arrival = sent->arrival;
+			shard->pending[count].to = sent->to;
+			shard->pending[count].from = sent->from;
+			shard->pending[count].sequence = sent->sequence;
+			shard->pending[count].packet = index;
+			count++;
+		}
+	}
+
+	qsort(shard->pending, count, sizeof(shard->pending[0]), RPL_sim_pending_compare);
+	for (i = 0; i < count; i++) {
+		RPL_timer_start(&shard->wheel, &shard->packets[shard->pending[i].packet].timer, shard->pending[i].arrival);
+	}
+	shard->has_next = (uint8_t)RPL_timer_wheel_next_event(&shard->wheel, until, &shard->next);
+}
+
+//Free the packets the other shards have copied, packets to the shard's own nodes are now in flight
+static void RPL_sim_release_sent(struct rpl_sim_shard_s *shard) {
+	uint32_t i, next;
+
+	for (i = shard->sent; i != RPL_ROUTE_NONE; i = next) {
+		struct rpl_sim_packet_s *packet = &shard->packets[i];
+
+		next = packet->next;
+		if ((packet->to < shard->first_node) || (packet->to >= shard->end_node)) {
+			RPL_pool_free(&shard->packet_pool, i);
+		}
+	}
+	shard->sent = RPL_ROUTE_NONE;
+}
+
+struct rpl_sim_worker_s {
+	struct rpl_sim_shard_s *shard;
+	uint32_t until;
+	pthread_barrier_t *barrier;
+	pthread_mutex_t *lock;
+	pthread_cond_t *start;
+	int *state;                     //!< 0 waiting, 1 run, -1 abort
+};
+
+static void RPL_sim_barrier(const struct rpl_sim_worker_s *worker) {
+	if (worker->barrier != NULL) {
+		pthread_barrier_wait(worker->barrier);
+	}
+}
+
+//Each window: exchange the packets sent, agree on the next event and run the window up to the next lookahead boundary
+static void RPL_sim_shard_run(const struct rpl_sim_worker_s *worker) {
+	struct rpl_sim_shard_s *shard = worker->shard;
+	struct rpl_sim_s *sim = shard->sim;
+
+	for (;;) {
+		uint32_t next = 0, end, s;
+		int found = 0;
+
+		RPL_sim_collect(shard, worker->until);
+		RPL_sim_barrier(worker);
+		RPL_sim_release_sent(shard);
+
+		for (s = 0; s < sim->shard_count; s++) {
+			if (sim->shards[s].has_next && (!found || ((int32_t)(sim->shards[s].next - next) < 0))) {
+				next = sim->shards[s].next;
+				found = 1;
+			}
+		}
+		if (!found) {
+			RPL_timer_wheel_advance(&shard->wheel, worker->until);
+			return;
+		}
+		//Windows are aligned so that they do not depend on how the nodes are sharded,
+		//nothing sent in a window arrives before it ends
+		end = next - (next % sim->lookahead) + sim->lookahead - 1;
+		if ((int32_t)(end - worker->until) > 0) {
+			end = worker->until;
+		}
+		RPL_timer_wheel_advance(&shard->wheel, end);
+		RPL_sim_barrier(worker);
+	}
+}
+
+static void *RPL_sim_thread(void *context) {
+	struct rpl_sim_worker_s *worker = (struct rpl_sim_worker_s *)context;
+	int state;
+
+	pthread_mutex_lock(worker->lock);
+	while ((state = *worker->state) == 0) {
+		pthread_cond_wait(worker->start, worker->lock);
+	}
+	pthread_mutex_unlock(worker->lock);
+	if (state > 0) {
+		RPL_sim_shard_run(worker);
+	}
+	return NULL;
+}
+
+//Set when a shard ran out of packets, the run then depends on the number of shards
+static int RPL_sim_dropped(const struct rpl_sim_s *sim) {
+	uint32_t i;
+
+	for (i = 0; i < sim->shard_count; i++) {
+		if (sim->shards[i].stats.drops != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int RPL_sim_run(struct rpl_sim_s *sim, uint32_t until) {
+	struct rpl_sim_worker_s workers[RPL_SIM_MAX_SHARDS];
+	pthread_t threads[RPL_SIM_MAX_SHARDS];
+	pthread_barrier_t barrier;
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t start = PTHREAD_COND_INITIALIZER;
+	uint32_t count = sim->shard_count;
+	uint32_t i, created;
+	int state = 0;
+
+	if (count > RPL_SIM_MAX_SHARDS) {
+		return -1;
+	}
+	for (i = 0; i < count; i++) {
+		workers[i].shard = &sim->shards[i];
+		workers[i].until = until;
+		workers[i].barrier = (count > 1) ? &barrier : NULL;
+		workers[i].lock = &lock;
+		workers[i].start = &start;
+		workers[i].state = &state;
+	}
+	if (count == 1) {
+		RPL_sim_shard_run(&workers[0]);
+		sim->now = until;
+		return RPL_sim_dropped(sim) ? -1 : 0;
+	}
+
+	if (pthread_barrier_init(&barrier, NULL, count) != 0) {
+		return -1;
+	}
+	//The threads wait until all of them exist, so a failure leaves no thread in the barrier
+	for (created = 1; created < count; created++) {
+		if (pthread_create(&threads[created], NULL, RPL_sim_thread, &workers[created]) != 0) {
+			break;
+		}
+	}
+	pthread_mutex_lock(&lock);
+	state = (created == count) ? 1 : -1;
+	pthread_cond_broadcast(&start);
+	pthread_mutex_unlock(&lock);
+	if (state > 0) {
+		RPL_sim_shard_run(&workers[0]);
+	}
+	for (i = 1; i < created; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	pthread_barrier_destroy(&barrier);
+	if (state < 0) {
+		return -1;
+	}
+	sim->now = until;
+	return RPL_sim_dropped(sim) ? -1 : 0;
+}
+
+void RPL_sim_stats(const struct rpl_sim_s *sim, struct rpl_sim_stats_s *stats) {
+	uint32_t i;
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < sim->shard_count; i++) {
+		const struct rpl_sim_stats_s *shard = &sim->shards[i].stats;
+
+		stats->transmissions += shard->transmissions;
+		stats->losses += shard->losses;
+		stats->drops += shard->drops;
+		stats->deliveries += shard->deliveries;
+		stats->dio += shard->dio;
+		stats->dao += shard->dao;
+		stats->bytes += shard->bytes;
+		stats->joined += shard->joined;
+		if ((shard->joined != 0) && (shard->last_join > stats->last_join)) {
+			stats->last_join = shard->last_join;
+		}
+	}
+}
+
+uint32_t RPL_sim_grid(struct rpl_sim_link_s *links, uint32_t *link_offsets, uint32_t width, uint32_t height, uint16_t prr, uint16_t latency) {
+	static const int dx[4] = { 0, -1, 1, 0 };
+	static const int dy[4] = { -1, 0, 0, 1 };
+	uint32_t count = 0;
+	uint32_t x, y;
+	int d;
+
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++) {
+			link_offsets[y * width + x] = count;
+			for (d = 0; d < 4; d++) {
+				int64_t nx = (int64_t)x + dx[d];
+				int64_t ny = (int64_t)y + dy[d];
+
+				if ((nx < 0) || (ny < 0) || (nx >= width) || (ny >= height)) {
+					continue;
+				}
+				links[count].to = (uint32_t)(ny * width + nx);
+				links[count].prr = prr;
+				links[count].latency = latency;
+				count++;
+			}
+		}
+	}
+	link_offsets[width * height] = count;
+	return count;
+}
+
+#endif
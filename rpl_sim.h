@@ -0,0 +1,265 @@
+/**
+ * RPL network simulator
+ * Discrete-event simulation of a DODAG over a lossy link graph, for multi-node and scaling tests
+ *
+ * Node 0 is the DODAG root, every node runs the library's Trickle, parent selection (with the
+ * chosen Objective Function) and DAO pipeline and exchanges real encoded DIOs and DAOs in
+ * non-storing mode: DAOs are forwarded hop by hop along preferred parents to the root, which
+ * builds its source routes from them. Links are directed with a packet reception ratio and a
+ * latency, node n has the links links[link_offsets[n]..link_offsets[n+1]).
+ *
+ * Time is virtual (ms). Nodes are split into contiguous shards, each with its own timer wheel
+ * and packet pool and run by its own thread. Messages sent within a lookahead window (the
+ * minimum link latency) cannot arrive in the same window, so the shards run each window
+ * independently, then exchange the messages sent and schedule them in (arrival, receiver,
+ * sender, sender sequence) order. Windows are aligned to multiples of the lookahead, so a run
+ * depends only on the seed and not on the number of shards, unless a packet is dropped for lack
+ * of a free packet which RPL_sim_run reports as an error.
+ *
+ * The simulator never allocates, all storage is supplied by the caller. As it runs non-storing
+ * mode it is left out with RPL_CONF_NON_STORING 0.
+ */
+
+#ifndef RPL_SIM_H
+#define RPL_SIM_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_endian.h"
+#include "rpl_timer.h"
+#include "rpl_trickle.h"
+#include "rpl_parent.h"
+#include "rpl_version.h"
+#include "rpl_of.h"
+#include "rpl_dao.h"
+#include "rpl_source_route.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if RPL_CONF_NON_STORING
+
+#ifndef RPL_SIM_PACKET_SIZE
+#define RPL_SIM_PACKET_SIZE         128             //!< Largest simulated message
+#endif
+
+#ifndef RPL_SIM_ADDRESS_INDEX_SIZE
+#define RPL_SIM_ADDRESS_INDEX_SIZE  32              //!< Hash index of the neighbor addresses of a node, a power of 2
+#endif
+
+#ifndef DEFAULT_SIM_DAO_REFRESH
+#define DEFAULT_SIM_DAO_REFRESH     60000           //!< Interval (ms) at which nodes advertise their target again
+#endif
+
+#ifndef DEFAULT_SIM_MAC_RETRIES
+#define DEFAULT_SIM_MAC_RETRIES     3               //!< Link layer retransmissions of unicast frames
+#endif
+
+#ifndef DEFAULT_SIM_HOLD_TIME
+#define DEFAULT_SIM_HOLD_TIME       60000           //!< Time (ms) nodes hold the DODAG after losing all parents
+#endif
+
+#ifndef RPL_SIM_MAX_SHARDS
+#define RPL_SIM_MAX_SHARDS          64              //!< Most threads used by a simulation
+#endif
+
+#define RPL_SIM_BROADCAST           0xFFFFFFFFUL    //!< Destination of link-local multicast messages
+#define RPL_SIM_NEVER               0xFFFFFFFFUL    //!< Join time of nodes not yet joined
+#define RPL_SIM_PRR_ALWAYS          0xFFFF          //!< Reception ratio of a lossless link
+#define RPL_SIM_MAX_HOPS            255             //!< Forwarded DAOs are dropped after this many hops
+
+struct rpl_sim_s;
+struct rpl_sim_shard_s;
+
+/**
+ * @brief Directed link
+ */
+struct rpl_sim_link_s {
+    uint32_t to;                    //!< Receiving node
+    uint16_t prr;                   //!< Packet reception ratio, out of RPL_SIM_PRR_ALWAYS
+    uint16_t latency;               //!< Delivery latency (ms), at least 1
+};
+
+/**
+ * @brief Message being sent or in flight
+ */
+struct rpl_sim_packet_s {
+    struct rpl_timer_s timer;       //!< Expires on delivery
+    struct rpl_sim_shard_s *shard;  //!< Shard owning the packet
+    uint32_t from;                  //!< Transmitting node
+    uint32_t to;                    //!< Receiving node
+    uint32_t destination;           //!< Final destination, RPL_SIM_BROADCAST for link-local multicast
+    uint32_t arrival;               //!< Delivery time
+    uint32_t sequence;              //!< Transmission count of the sender, orders simultaneous arrivals
+    uint32_t next;                  //!< Free or sent list link
+    uint16_t link_metric;           //!< ETX of the link (x128)
+    uint16_t length;
+    uint8_t hops;                   //!< Hops travelled
+    uint8_t data[RPL_SIM_PACKET_SIZE];  //!< ICMPv6 message
+};
+
+/**
+ * @brief Message received in the last window, ordered for scheduling
+ */
+struct rpl_sim_pending_s {
+    uint32_t arrival;
+    uint32_t to;
+    uint32_t from;
+    uint32_t sequence;
+    uint32_t packet;                //!< Index in the shard packet pool
+};
+
+/**
+ * @brief Simulated node
+ */
+struct rpl_sim_node_s {
+    struct rpl_parent_table_s parents;
+    struct rpl_address_table_s addresses;   //!< Neighbor addresses
+    struct rpl_address_s address_entries[RPL_NEIGHBOR_TABLE_SIZE + 2];
+    rpl_address_handle_t address_index[RPL_SIM_ADDRESS_INDEX_SIZE];
+    struct rpl_version_s version;           //!< DODAG Version membership
+    struct rpl_trickle_engine_s engine;     //!< Per node engine, so the random sequence of a node does not depend on others
+    struct rpl_trickle_s trickle;           //!< DIO timer
+    struct rpl_dao_pipeline_s dao;
+    struct rpl_timer_s refresh;             //!< DAO refresh
+    struct rpl_sim_s *sim;
+    struct rpl_sim_shard_s *shard;
+    uint32_t id;
+    uint32_t random;                        //!< Link loss random state
+    uint32_t sequence;                      //!< Link transmissions
+    uint32_t joined;                        //!< Time the node first obtained a rank, RPL_SIM_NEVER before
+    uint32_t dio_sent;
+    uint32_t dao_sent;
+    uint8_t path_sequence;
+};
+
+/**
+ * @brief Simulation counters
+ */
+struct rpl_sim_stats_s {
+    uint32_t transmissions;         //!< Link transmissions (one per receiver of a multicast)
+    uint32_t losses;                //!< Transmissions lost on the link (including retried unicasts)
+    uint32_t drops;                 //!< Transmissions dropped for lack of a free packet
+    uint32_t deliveries;
+    uint32_t dio;                   //!< DIOs sent
+    uint32_t dao;                   //!< DAOs sent, including forwarding
+    uint64_t bytes;                 //!< Octets transmitted
+    uint32_t joined;                //!< Nodes with a rank (including the root)
+    uint32_t last_join;             //!< Time the last node joined
+};
+
+/**
+ * @brief Nodes run by one thread
+ */
+struct rpl_sim_shard_s {
+    struct rpl_timer_wheel_s wheel;                 //!< Virtual clock of the shard
+    struct rpl_sim_s *sim;
+    uint32_t first_node;                            //!< Nodes [first_node, end_node)
+    uint32_t end_node;
+    struct rpl_sim_packet_s *packets;               //!< Packet storage
+    struct rpl_pool_s packet_pool;                  //!< Packets in use (sent, in flight or being delivered)
+    uint32_t sent;                                  //!< Packets sent this window, RPL_ROUTE_NONE when empty
+    uint32_t sent_tail;
+    struct rpl_sim_pending_s *pending;              //!< Received this window, an entry per packet
+    uint32_t next;                                  //!< Next event time
+    uint8_t has_next;                               //!< Set when there is an event before the end of the run
+    struct rpl_sim_stats_s stats;
+    uint8_t buffer[RPL_SIM_PACKET_SIZE];            //!< Encoding buffer
+};
+
+/**
+ * @brief Simulation
+ * @details config, of, version, dao_refresh, hold_time and mac_retries may be changed before RPL_sim_start.
+ */
+struct rpl_sim_s {
+    struct rpl_sim_node_s *nodes;
+    uint32_t node_count;
+    const struct rpl_sim_link_s *links;
+    const uint32_t *link_offsets;                   //!< node_count + 1 entries
+    struct rpl_sim_shard_s *shards;
+    uint32_t shard_count;                           //!< Threads used by RPL_sim_run
+    uint32_t lookahead;                             //!< Minimum link latency
+    uint32_t now;                                   //!< Time the simulation has run to
+    struct rpl_source_route_graph_s *routes;        //!< Source routes at the root
+    const struct rpl_objective_function_s *of;
+    struct rpl_option_dodag_configuration_s config; //!< Advertised by the root
+    rpl_instance_t instance;
+    rpl_dodag_version_t version;                    //!< Initial DODAG Version
+    uint32_t dao_refresh;                           //!< DAO refresh interval (ms)
+    uint32_t hold_time;                             //!< Time (ms) nodes hold the DODAG after losing all parents
+    uint32_t mac_retries;                           //!< Link layer retransmissions of unicasts
+};
+
+/**
+ * Node addresses are 2001:db8::/64 with the node id + 1 as interface identifier
+ */
+static inline void RPL_sim_address(uint8_t address[16], uint32_t id) {
+    static const uint8_t prefix[8] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0 };
+    unsigned int i;
+
+    for (i = 0; i < 8; i++) {
+        address[i] = prefix[i];
+    }
+    RPL_write_uint32(address + 8, 0);
+    RPL_write_uint32(address + 12, id + 1);
+}
+
+static inline uint32_t RPL_sim_node_id(const uint8_t address[16]) {
+    return RPL_read_uint32(address + 12) - 1;
+}
+
+/**
+ * @brief Initialize a simulation
+ *
+ * @param shards shard_count shards, the nodes are split evenly between them
+ * @param packets packet pool, split evenly between the shards
+ * @param pending packet_count entries
+ * @param routes source route graph for the root, initialized with the address of node 0 and
+ * able to hold every node
+ * @param seed random seed
+ * @return 0 on success, -1 if a link has a latency of 0 or an unknown receiver
+ */
+int RPL_sim_init(struct rpl_sim_s *sim, struct rpl_sim_node_s *nodes, uint32_t node_count, const struct rpl_sim_link_s *links, const uint32_t *link_offsets,
+                 struct rpl_sim_shard_s *shards, uint32_t shard_count, struct rpl_sim_packet_s *packets, struct rpl_sim_pending_s *pending, uint32_t packet_count,
+                 struct rpl_source_route_graph_s *routes, uint32_t seed);
+
+/**
+ * @brief Start the root advertising the DODAG
+ */
+void RPL_sim_start(struct rpl_sim_s *sim);
+
+/**
+ * @brief Increment the DODAG Version at the root, between runs
+ */
+void RPL_sim_global_repair(struct rpl_sim_s *sim);
+
+/**
+ * @brief Run the simulation until the given time, with a thread per shard
+ * @details The run continues when a shard runs out of packets, but as packets are split between
+ * shards the result then depends on the shard count.
+ * @return 0 on success, -1 if the threads could not be started or a packet was dropped for lack
+ * of a free packet (in this or an earlier run, see rpl_sim_stats_s)
+ */
+int RPL_sim_run(struct rpl_sim_s *sim, uint32_t until);
+
+/**
+ * @brief Sum of the shard counters
+ */
+void RPL_sim_stats(const struct rpl_sim_s *sim, struct rpl_sim_stats_s *stats);
+
+/**
+ * @brief Fill a grid topology with links to the 4 nearest nodes
+ * @details links needs 4 * width * height entries and link_offsets width * height + 1.
+ * @return number of links
+ */
+uint32_t RPL_sim_grid(struct rpl_sim_link_s *links, uint32_t *link_offsets, uint32_t width, uint32_t height, uint16_t prr, uint16_t latency);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
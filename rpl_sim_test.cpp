@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#if RPL_CONF_NON_STORING
+
+//Node id of the preferred parent, RPL_SIM_BROADCAST when detached
+static uint32_t parent_id(const struct rpl_sim_node_s *node) {
+	const struct rpl_neighbor_s *parent = RPL_parent_table_preferred(&node->parents);
+	uint8_t address[16];
+
+	if (parent == NULL) {
+		return RPL_SIM_BROADCAST;
+	}
+	RPL_parent_table_address(&node->parents, parent, address);
+	return RPL_sim_node_id(address);
+}
+
+TEST_GROUP(sim_tests)
+{
+	struct rpl_sim_s *sim;
+	struct rpl_sim_shard_s *shards;
+	struct rpl_sim_node_s *nodes;
+	struct rpl_sim_link_s *links;
+	uint32_t *link_offsets;
+	struct rpl_sim_packet_s *packets;
+	struct rpl_sim_pending_s *pending;
+	struct rpl_source_route_node_s *route_nodes;
+	uint32_t *route_index;
+	struct rpl_source_route_graph_s routes;
+
+	void setup() {
+		sim = (struct rpl_sim_s *)malloc(sizeof(struct rpl_sim_s));
+		shards = NULL;
+		nodes = NULL;
+		links = NULL;
+		link_offsets = NULL;
+		packets = NULL;
+		pending = NULL;
+		route_nodes = NULL;
+		route_index = NULL;
+	}
+
+	void teardown() {
+		free(sim);
+		free(shards);
+		free(nodes);
+		free(links);
+		free(link_offsets);
+		free(packets);
+		free(pending);
+		free(route_nodes);
+		free(route_index);
+	}
+
+	void grid(uint32_t width, uint32_t height, uint16_t prr, uint16_t latency, uint32_t packet_count, uint32_t seed, uint32_t shard_count = 1) {
+		uint32_t count = width * height;
+		uint32_t index_size = 1;
+		uint8_t root[16];
+
+		while (index_size <= count) {
+			index_size <<= 1;
+		}
+		shards = (struct rpl_sim_shard_s *)malloc(shard_count * sizeof(struct rpl_sim_shard_s));
+		nodes = (struct rpl_sim_node_s *)malloc(count * sizeof(struct rpl_sim_node_s));
+		links = (struct rpl_sim_link_s *)malloc(4 * count * sizeof(struct rpl_sim_link_s));
+		link_offsets = (uint32_t *)malloc((count + 1) * sizeof(uint32_t));
+		packets = (struct rpl_sim_packet_s *)malloc(packet_count * sizeof(struct rpl_sim_packet_s));
+		pending = (struct rpl_sim_pending_s *)malloc(packet_count * sizeof(struct rpl_sim_pending_s));
+		route_nodes = (struct rpl_source_route_node_s *)malloc(count * sizeof(struct rpl_source_route_node_s));
+		route_index = (uint32_t *)malloc(index_size * sizeof(uint32_t));
+
+		RPL_sim_grid(links, link_offsets, width, height, prr, latency);
+		RPL_sim_address(root, 0);
+		CHECK_EQUAL(0, RPL_source_route_init(&routes, route_nodes, count, route_index, index_size, root, 60));
+		CHECK_EQUAL(0, RPL_sim_init(sim, nodes, count, links, link_offsets, shards, shard_count, packets, pending, packet_count, &routes, seed));
+	}
+
+	struct rpl_sim_stats_s stats() {
+		struct rpl_sim_stats_s result;
+
+		RPL_sim_stats(sim, &result);
+		return result;
+	}
+};
+
+TEST(sim_tests, line_test) {
+	rpl_dodag_rank_t rank;
+	uint8_t address[16], header[256];
+	const uint8_t *first_hop = NULL;
+	uint32_t i;
+
+	grid(5, 1, RPL_SIM_PRR_ALWAYS, 5, 256, 1);
+	CHECK_EQUAL(5, sim->lookahead);
+	RPL_sim_start(sim);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 10000));
+
+	CHECK_EQUAL(5, stats().joined);
+	CHECK_EQUAL(0, stats().losses);
+	rank = RPL_ROOT_RANK(DEFAULT_MIN_HOP_RANK_INCREASE);
+	CHECK_EQUAL(rank, RPL_parent_table_rank(&nodes[0].parents));
+	for (i = 1; i < 5; i++) {
+		const struct rpl_neighbor_s *parent = RPL_parent_table_preferred(&nodes[i].parents);
+
+		rank = (rpl_dodag_rank_t)(rank + RPL_of0_rank_increase(rank, RPL_OF0_DEFAULT_STEP_OF_RANK, DEFAULT_MIN_HOP_RANK_INCREASE));
+		CHECK_EQUAL(rank, RPL_parent_table_rank(&nodes[i].parents));
+		CHECK(parent != NULL);
+		CHECK_EQUAL(i - 1, parent_id(&nodes[i]));
+		CHECK(nodes[i].joined > nodes[i - 1].joined);
+	}
+
+	//The root has a source route to the end of the line through the DAOs forwarded to it
+	CHECK_EQUAL(5, routes.pool.count);
+	RPL_sim_address(address, 4);
+	CHECK(RPL_source_route_header(&routes, address, 58, header, sizeof(header), &first_hop) > 0);
+	RPL_sim_address(address, 1);
+	MEMCMP_EQUAL(address, first_hop, 16);
+}
+
+TEST(sim_tests, deterministic_test) {
+	struct rpl_sim_stats_s first;
+	rpl_dodag_rank_t ranks[64];
+	uint32_t i;
+
+	grid(8, 8, 52000, 3, 4096, 1234);
+	RPL_sim_start(sim);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 30000));
+	first = stats();
+	for (i = 0; i < 64; i++) {
+		ranks[i] = RPL_parent_table_rank(&nodes[i].parents);
+	}
+	CHECK_EQUAL(64, first.joined);
+	CHECK(first.losses > 0);
+
+	//Same seed, same run
+	teardown();
+	setup();
+	grid(8, 8, 52000, 3, 4096, 1234);
+	RPL_sim_start(sim);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 10000));
+	CHECK_EQUAL(0, RPL_sim_run(sim, 30000));
+	struct rpl_sim_stats_s second = stats();
+
+	MEMCMP_EQUAL(&first, &second, sizeof(first));
+	for (i = 0; i < 64; i++) {
+		CHECK_EQUAL(ranks[i], RPL_parent_table_rank(&nodes[i].parents));
+	}
+}
+
+TEST(sim_tests, mrhof_test) {
+	uint32_t i;
+
+	//MRHOF prefers fewer lossy hops, ranks still increase away from the root
+	grid(6, 6, 45000, 2, 4096, 7);
+	sim->of = &RPL_mrhof;
+	sim->config.objective_code_point = RPL_OCP_MRHOF;
+	RPL_sim_start(sim);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 60000));
+	CHECK_EQUAL(36, stats().joined);
+	for (i = 1; i < 36; i++) {
+		const struct rpl_neighbor_s *parent = RPL_parent_table_preferred(&nodes[i].parents);
+
+		CHECK(parent != NULL);
+		CHECK(RPL_parent_table_rank(&nodes[parent_id(&nodes[i])].parents) < RPL_parent_table_rank(&nodes[i].parents));
+	}
+}
+
+//Every node follows the root to a new DODAG Version and reattaches in it
+TEST(sim_tests, global_repair_test) {
+	uint32_t i;
+
+	grid(8, 8, 52000, 3, 4096, 5);
+	RPL_sim_start(sim);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 30000));
+	CHECK_EQUAL(64, stats().joined);
+
+	RPL_sim_global_repair(sim);
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, nodes[0].version.version);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 60000));
+	for (i = 1; i < 64; i++) {
+		const struct rpl_neighbor_s *parent = RPL_parent_table_preferred(&nodes[i].parents);
+
+		CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, nodes[i].version.version);
+		CHECK(RPL_version_is_member(&nodes[i].version));
+		CHECK(parent != NULL);
+		CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, nodes[parent_id(&nodes[i])].version.version);
+		CHECK(RPL_parent_table_rank(&nodes[parent_id(&nodes[i])].parents) < RPL_parent_table_rank(&nodes[i].parents));
+	}
+}
+
+TEST(sim_tests, scale_test) {
+	//10k nodes, lossy links, up to 198 hops from the root
+	grid(100, 100, 58000, 4, 65536, 42);
+	sim->config.min_hop_rank_increase = 64;
+	RPL_sim_start(sim);
+	CHECK_EQUAL(0, RPL_sim_run(sim, 120000));
+	CHECK_EQUAL(10000, stats().joined);
+	CHECK_EQUAL(0, stats().drops);
+	CHECK(routes.pool.count > 9900);
+}
+
+//Running out of packets makes the run depend on the shard count, it is reported
+TEST(sim_tests, drop_test) {
+	grid(8, 8, RPL_SIM_PRR_ALWAYS, 3, 16, 7, 2);
+	RPL_sim_start(sim);
+	CHECK_EQUAL(-1, RPL_sim_run(sim, 10000));
+	CHECK(stats().drops > 0);
+	CHECK_EQUAL(10000, sim->now);
+}
+
+TEST(sim_tests, shard_test) {
+	const uint32_t count = 30 * 30;
+	struct rpl_sim_stats_s single;
+	rpl_dodag_rank_t *ranks = (rpl_dodag_rank_t *)malloc(count * sizeof(rpl_dodag_rank_t));
+	uint32_t *parents = (uint32_t *)malloc(count * sizeof(uint32_t));
+	uint32_t *joined = (uint32_t *)malloc(count * sizeof(uint32_t));
+	uint32_t shard_count, route_count = 0, i;
+
+	//The same run whatever the number of threads
+	for (shard_count = 1; shard_count <= 4; shard_count++) {
+		struct rpl_sim_stats_s sharded;
+
+		teardown();
+		setup();
+		grid(30, 30, 50000, 3, 16384, 99, shard_count);
+		RPL_sim_start(sim);
+		CHECK_EQUAL(0, RPL_sim_run(sim, 5000));
+		CHECK_EQUAL(0, RPL_sim_run(sim, 70000));
+		sharded = stats();
+		CHECK_EQUAL(0, sharded.drops);
+		CHECK_EQUAL(count, sharded.joined);
+		if (shard_count == 1) {
+			single = sharded;
+		}
+		MEMCMP_EQUAL(&single, &sharded, sizeof(single));
+		for (i = 0; i < count; i++) {
+			uint32_t parent = parent_id(&nodes[i]);
+
+			if (shard_count == 1) {
+				ranks[i] = RPL_parent_table_rank(&nodes[i].parents);
+				parents[i] = parent;
+				joined[i] = nodes[i].joined;
+			}
+			CHECK_EQUAL(ranks[i], RPL_parent_table_rank(&nodes[i].parents));
+			CHECK_EQUAL(parents[i], parent);
+			CHECK_EQUAL(joined[i], nodes[i].joined);
+		}
+		if (shard_count == 1) {
+			route_count = routes.pool.count;
+		}
+		CHECK_EQUAL(route_count, routes.pool.count);
+	}
+	CHECK(route_count > count - 10);
+	free(ranks);
+	free(parents);
+	free(joined);
+}
+
+#endif
@@ -0,0 +1,377 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "rpl.h"
+
+#if RPL_CONF_NON_STORING
+
+#define RPL_SOURCE_ROUTE_CMPR_MAX       15      //!< CmprI and CmprE are 4 bits
+
+//Slot holding address, or the empty slot where it would be added
+static uint32_t RPL_source_route_slot(const struct rpl_source_route_graph_s *graph, const uint8_t address[16]) {
+	uint32_t slot = RPL_address_hash16(address) & graph->index_mask;
+
+	while ((graph->index[slot] != RPL_ROUTE_NONE) && (memcmp(graph->nodes[graph->index[slot]].address, address, 16) != 0)) {
+		slot = (slot + 1) & graph->index_mask;
+	}
+	return slot;
+}
+
+//Removes the index entry at slot (see RPL_probe_moves_back)
+static void RPL_source_route_unindex(struct rpl_source_route_graph_s *graph, uint32_t slot) {
+	uint32_t next = slot;
+
+	for (;;) {
+		uint32_t home;
+
+		next = (next + 1) & graph->index_mask;
+		if (graph->index[next] == RPL_ROUTE_NONE) {
+			break;
+		}
+		home = RPL_address_hash16(graph->nodes[graph->index[next]].address) & graph->index_mask;
+		if (RPL_probe_moves_back(slot, next, home, graph->index_mask)) {
+			graph->index[slot] = graph->index[next];
+			slot = next;
+		}
+	}
+	graph->index[slot] = RPL_ROUTE_NONE;
+}
+
+static uint32_t RPL_source_route_add(struct rpl_source_route_graph_s *graph, const uint8_t address[16], uint32_t slot) {
+	struct rpl_source_route_node_s *node;
+	uint32_t index;
+
+	index = RPL_pool_alloc(&graph->pool);
+	if (index == RPL_POOL_NONE) {
+		return RPL_ROUTE_NONE;
+	}
+
+	node = &graph->nodes[index];
+	memcpy(node->address, address, 16);
+	node->parent = RPL_ROUTE_NONE;
+	node->first_child = RPL_ROUTE_NONE;
+	node->next_sibling = RPL_ROUTE_NONE;
+	node->prev_sibling = RPL_ROUTE_NONE;
+	node->first_hop = RPL_ROUTE_NONE;
+	node->expires = 0;
+	node->path_sequence = 0;
+	node->flags = 0;
+	node->srh_length = 0;
+	graph->index[slot] = index;
+	return index;
+}
+
+//Nodes that are neither linked to a parent nor a parent themselves are dropped
+static void RPL_source_route_release_unused(struct rpl_source_route_graph_s *graph, uint32_t index) {
+	struct rpl_source_route_node_s *node = &graph->nodes[index];
+
+	if ((index == graph->root) || (node->parent != RPL_ROUTE_NONE) || (node->first_child != RPL_ROUTE_NONE)) {
+		return;
+	}
+	RPL_source_route_unindex(graph, RPL_source_route_slot(graph, node->address));
+	node->flags = RPL_SOURCE_ROUTE_FLAG_FREE;
+	RPL_pool_free(&graph->pool, index);
+}
+
+//Drops the cached headers of a node and its sub-DODAG
+static void RPL_source_route_invalidate(struct rpl_source_route_graph_s *graph, uint32_t top) {
+	uint32_t index = top;
+
+	for (;;) {
+		graph->nodes[index].flags &= (uint8_t)~RPL_SOURCE_ROUTE_FLAG_CACHED;
+		if (graph->nodes[index].first_child != RPL_ROUTE_NONE) {
+			index = graph->nodes[index].first_child;
+			continue;
+		}
+		while ((index != top) && (graph->nodes[index].next_sibling == RPL_ROUTE_NONE)) {
+			index = graph->nodes[index].parent;
+		}
+		if (index == top) {
+			return;
+		}
+		index = graph->nodes[index].next_sibling;
+	}
+}
+
+static void RPL_source_route_unlink(struct rpl_source_route_graph_s *graph, uint32_t index) {
+	struct rpl_source_route_node_s *node = &graph->nodes[index];
+
+	if (node->prev_sibling != RPL_ROUTE_NONE) {
+		graph->nodes[node->prev_sibling].next_sibling = node->next_sibling;
+	} else {
+		graph->nodes[node->parent].first_child = node->next_sibling;
+	}
+	if (node->next_sibling != RPL_ROUTE_NONE) {
+		graph->nodes[node->next_sibling].prev_sibling = node->prev_sibling;
+	}
+	node->parent = RPL_ROUTE_NONE;
+	node->next_sibling = RPL_ROUTE_NONE;
+	node->prev_sibling = RPL_ROUTE_NONE;
+}
+
+static void RPL_source_route_link(struct rpl_source_route_graph_s *graph, uint32_t index, uint32_t parent) {
+	struct rpl_source_route_node_s *node = &graph->nodes[index];
+
+	node->parent = parent;
+	node->prev_sibling = RPL_ROUTE_NONE;
+	node->next_sibling = graph->nodes[parent].first_child;
+	if (node->next_sibling != RPL_ROUTE_NONE) {
+		graph->nodes[node->next_sibling].prev_sibling = index;
+	}
+	graph->nodes[parent].first_child = index;
+}
+
+//Removes the link from a node to its parent
+static void RPL_source_route_detach(struct rpl_source_route_graph_s *graph, uint32_t index) {
+	uint32_t parent = graph->nodes[index].parent;
+
+	RPL_source_route_invalidate(graph, index);
+	RPL_source_route_unlink(graph, index);
+	RPL_source_route_release_unused(graph, parent);
+	RPL_source_route_release_unused(graph, index);
+}
+
+int RPL_source_route_init(struct rpl_source_route_graph_s *graph, struct rpl_source_route_node_s *nodes, uint32_t capacity, uint32_t *index,
+                          uint32_t index_size, const uint8_t root[16], uint16_t lifetime_unit) {
+	uint32_t i;
+
+	if ((capacity == 0) || (index_size <= capacity) || ((index_size & (index_size - 1)) != 0)) {
+		return -1;
+	}
+
+	graph->nodes = nodes;
+	RPL_pool_init(&graph->pool, nodes, sizeof(struct rpl_source_route_node_s), offsetof(struct rpl_source_route_node_s, next_sibling), capacity);
+	graph->index = index;
+	graph->index_mask = index_size - 1;
+	graph->lifetime_unit = (lifetime_unit == 0) ? 1 : lifetime_unit;
+	for (i = 0; i < index_size; i++) {
+		index[i] = RPL_ROUTE_NONE;
+	}
+	graph->root = RPL_source_route_add(graph, root, RPL_source_route_slot(graph, root));
+	return 0;
+}
+
+int RPL_source_route_dao(struct rpl_source_route_graph_s *graph, const uint8_t target[16], const uint8_t parent[16], uint8_t path_sequence,
+                         uint8_t path_lifetime, uint32_t now) {
+	struct rpl_source_route_node_s *node;
+	uint32_t slot = RPL_source_route_slot(graph, target);
+	uint32_t index = graph->index[slot];
+	uint32_t parent_index, ancestor;
+	int result = RPL_ROUTE_UPDATED;
+
+	if (index == graph->root) {
+		return RPL_ROUTE_INVALID;
+	}
+
+	if (index != RPL_ROUTE_NONE) {
+		node = &graph->nodes[index];
+		if (node->parent != RPL_ROUTE_NONE) {
+			int compare = RPL_sequence_compare_fast(node->path_sequence, path_sequence);
+
+			if ((compare == RPL_SEQUENCE_COMPARE_A_GREATER) ||
+			    ((path_lifetime == RPL_ROUTE_LIFETIME_NO_PATH) && (compare == RPL_SEQUENCE_COMPARE_EQUAL) &&
+			     (memcmp(graph->nodes[node->parent].address, parent, 16) != 0))) {
+				return RPL_ROUTE_STALE;
+			}
+		}
+	}
+
+	if (path_lifetime == RPL_ROUTE_LIFETIME_NO_PATH) {
+		if ((index != RPL_ROUTE_NONE) && (graph->nodes[index].parent != RPL_ROUTE_NONE)) {
+			RPL_source_route_detach(graph, index);
+		}
+		return RPL_ROUTE_REMOVED;
+	}
+
+	//Both ends must be in the graph, adding either may fail
+	if (index == RPL_ROUTE_NONE) {
+		index = RPL_source_route_add(graph, target, slot);
+		if (index == RPL_ROUTE_NONE) {
+			return RPL_ROUTE_FULL;
+		}
+	}
+	slot = RPL_source_route_slot(graph, parent);
+	parent_index = graph->index[slot];
+	if (parent_index == RPL_ROUTE_NONE) {
+		parent_index = RPL_source_route_add(graph, parent, slot);
+		if (parent_index == RPL_ROUTE_NONE) {
+			RPL_source_route_release_unused(graph, index);
+			return RPL_ROUTE_FULL;
+		}
+	}
+	node = &graph->nodes[index];
+
+	if (node->parent != parent_index) {
+		//The new parent must not be in the target's sub-DODAG
+		for (ancestor = parent_index; ancestor != RPL_ROUTE_NONE; ancestor = graph->nodes[ancestor].parent) {
+			if (ancestor == index) {
+				RPL_source_route_release_unused(graph, parent_index);
+				RPL_source_route_release_unused(graph, index);
+				return RPL_ROUTE_LOOP;
+			}
+		}
+
+		if (node->parent == RPL_ROUTE_NONE) {
+			result = RPL_ROUTE_ADDED;
+		} else {
+			uint32_t old_parent = node->parent;
+
+			RPL_source_route_unlink(graph, index);
+			RPL_source_route_release_unused(graph, old_parent);
+		}
+		RPL_source_route_invalidate(graph, index);
+		RPL_source_route_link(graph, index, parent_index);
+	}
+
+	node->path_sequence = path_sequence;
+	if (path_lifetime == RPL_ROUTE_LIFETIME_INFINITE) {
+		node->flags |= RPL_SOURCE_ROUTE_FLAG_INFINITE;
+	} else {
+		node->flags &= (uint8_t)~RPL_SOURCE_ROUTE_FLAG_INFINITE;
+		node->expires = now + (uint32_t)path_lifetime * graph->lifetime_unit;
+	}
+	return result;
+}
+
+int RPL_source_route_target(struct rpl_source_route_graph_s *graph, const struct rpl_option_view_s *target, const struct rpl_option_view_s *transit,
+                            uint32_t now) {
+	const uint8_t *parent = RPL_option_transit_info_parent_address(transit);
+
+	if ((RPL_option_target_prefix_length(target) != 128) || (parent == NULL)) {
+		return RPL_ROUTE_INVALID;
+	}
+	return RPL_source_route_dao(graph, RPL_option_target_prefix(target), parent, RPL_option_transit_info_path_sequence(transit),
+	                            RPL_option_transit_info_path_lifetime(transit), now);
+}
+
+//Leading octets shared by two addresses, limited to what CmprI/CmprE can express
+static int RPL_source_route_common(const uint8_t *a, const uint8_t *b) {
+	int i;
+
+	for (i = 0; (i < RPL_SOURCE_ROUTE_CMPR_MAX) && (a[i] == b[i]); i++) {
+	}
+	return i;
+}
+
+//Encodes the header for path[0] (destination) .. path[hops - 1] (first hop)
+//Each address is expanded by the node before it on the path, so elision is limited by neighbouring hops
+static int RPL_source_route_encode(const struct rpl_source_route_graph_s *graph, const uint32_t *path, int hops, uint8_t *buffer, uint16_t capacity) {
+	const struct rpl_source_route_node_s *nodes = graph->nodes;
+	int segments = hops - 1;
+	int cmpr_i = RPL_SOURCE_ROUTE_CMPR_MAX;
+	int cmpr_e = RPL_source_route_common(nodes[path[0]].address, nodes[path[1]].address);
+	int length, pad, position, i;
+
+	for (i = 1; i < segments; i++) {
+		int common = RPL_source_route_common(nodes[path[i]].address, nodes[path[i + 1]].address);
+
+		cmpr_i = (common < cmpr_i) ? common : cmpr_i;
+	}
+	if (segments == 1) {
+		cmpr_i = 0;
+	}
+
+	length = (segments - 1) * (16 - cmpr_i) + (16 - cmpr_e);
+	pad = (8 - (length & 7)) & 7;
+	length += RPL_SOURCE_ROUTE_HEADER_LENGTH + pad;
+	if (length > capacity) {
+		return -1;
+	}
+
+	buffer[0] = 0;
+	buffer[1] = (uint8_t)(length / 8 - 1);
+	buffer[2] = RPL_SOURCE_ROUTE_ROUTING_TYPE;
+	buffer[3] = (uint8_t)segments;
+	buffer[4] = (uint8_t)((cmpr_i << 4) | cmpr_e);
+	buffer[5] = (uint8_t)(pad << 4);
+	buffer[6] = 0;
+	buffer[7] = 0;
+
+	//Addresses in path order from the second hop to the destination
+	position = RPL_SOURCE_ROUTE_HEADER_LENGTH;
+	for (i = segments - 1; i > 0; i--) {
+		memcpy(buffer + position, nodes[path[i]].address + cmpr_i, (size_t)(16 - cmpr_i));
+		position += 16 - cmpr_i;
+	}
+	memcpy(buffer + position, nodes[path[0]].address + cmpr_e, (size_t)(16 - cmpr_e));
+	memset(buffer + position + 16 - cmpr_e, 0, (size_t)pad);
+	return length;
+}
+
+int RPL_source_route_header(struct rpl_source_route_graph_s *graph, const uint8_t destination[16], uint8_t next_header, uint8_t *buffer, uint16_t capacity,
+                            const uint8_t **first_hop) {
+	uint32_t path[RPL_SOURCE_ROUTE_MAX_HOPS + 1];
+	struct rpl_source_route_node_s *node;
+	uint32_t index = graph->index[RPL_source_route_slot(graph, destination)];
+	int hops = 0;
+	int length;
+
+	if ((index == RPL_ROUTE_NONE) || (index == graph->root)) {
+		return -1;
+	}
+	node = &graph->nodes[index];
+
+	if (!(node->flags & RPL_SOURCE_ROUTE_FLAG_CACHED)) {
+		//Walk up to the root, path[hops - 1] is the first hop
+		while (index != graph->root) {
+			if ((index == RPL_ROUTE_NONE) || (hops > RPL_SOURCE_ROUTE_MAX_HOPS)) {
+				return -1;
+			}
+			path[hops++] = index;
+			index = graph->nodes[index].parent;
+		}
+
+		node->first_hop = path[hops - 1];
+		if (hops == 1) {
+			node->srh_length = 0;
+			node->flags |= RPL_SOURCE_ROUTE_FLAG_CACHED;
+		} else {
+			length = RPL_source_route_encode(graph, path, hops, buffer, capacity);
+			if (length < 0) {
+				return -1;
+			}
+			if (length <= RPL_SOURCE_ROUTE_CACHE_SIZE) {
+				memcpy(node->srh, buffer, (size_t)length);
+				node->srh_length = (uint8_t)length;
+				node->flags |= RPL_SOURCE_ROUTE_FLAG_CACHED;
+			}
+			buffer[0] = next_header;
+			*first_hop = graph->nodes[node->first_hop].address;
+			return length;
+		}
+	}
+
+	if (node->srh_length > capacity) {
+		return -1;
+	}
+	memcpy(buffer, node->srh, node->srh_length);
+	if (node->srh_length != 0) {
+		buffer[0] = next_header;
+	}
+	*first_hop = graph->nodes[node->first_hop].address;
+	return node->srh_length;
+}
+
+uint32_t RPL_source_route_purge(struct rpl_source_route_graph_s *graph, uint32_t now) {
+	uint32_t removed = 0;
+	uint32_t i;
+
+	for (i = 0; i < graph->pool.used; i++) {
+		struct rpl_source_route_node_s *node = &graph->nodes[i];
+
+		if (!(node->flags & (RPL_SOURCE_ROUTE_FLAG_FREE | RPL_SOURCE_ROUTE_FLAG_INFINITE)) && (node->parent != RPL_ROUTE_NONE) &&
+		    ((int32_t)(now - node->expires) >= 0)) {
+			RPL_source_route_detach(graph, i);
+			removed++;
+		}
+	}
+	return removed;
+}
+
+const struct rpl_source_route_node_s *RPL_source_route_find(const struct rpl_source_route_graph_s *graph, const uint8_t address[16]) {
+	uint32_t index = graph->index[RPL_source_route_slot(graph, address)];
+
+	return (index == RPL_ROUTE_NONE) ? NULL : &graph->nodes[index];
+}
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * RPL non-storing mode source routes
+ * DAO parent graph held by the DODAG root and Source Routing Header generation [RFC6550 Section 9.7, RFC6554]
+ *
+ * In non-storing mode (MOP 1) each node reports its parents to the root in the Parent Address of
+ * the Transit Information option. The root keeps one node per address with a link to its most
+ * recently advertised parent, and builds the route to a destination by walking up the graph.
+ *
+ * The compressed Source Routing Header for each destination is cached in its node. Changing the
+ * parent of a node only invalidates the cached headers of that node and its descendants (its
+ * sub-DODAG), the rest of the graph keeps its cached headers.
+ *
+ * Nodes are found through an open addressing hash index, storage for nodes and the index is
+ * supplied by the caller. Not built when RPL_CONF_NON_STORING is 0.
+ */
+
+#ifndef RPL_SOURCE_ROUTE_H
+#define RPL_SOURCE_ROUTE_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_option.h"
+#include "rpl_route.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if RPL_CONF_NON_STORING
+
+#ifndef RPL_SOURCE_ROUTE_CACHE_SIZE
+#define RPL_SOURCE_ROUTE_CACHE_SIZE     136     //!< Octets of cached header per destination, longer headers are built on every request
+#endif
+
+#define RPL_SOURCE_ROUTE_HEADER_LENGTH  8       //!< Fixed part of the Source Routing Header [RFC6554 Section 3]
+#define RPL_SOURCE_ROUTE_ROUTING_TYPE   3       //!< Routing Type of the RPL Source Route Header
+#define RPL_SOURCE_ROUTE_MAX_HOPS       255     //!< Segments Left is 8 bits
+
+#define RPL_SOURCE_ROUTE_FLAG_INFINITE  0x01    //!< Link to the parent does not expire
+#define RPL_SOURCE_ROUTE_FLAG_CACHED    0x02    //!< srh holds the header for this destination
+#define RPL_SOURCE_ROUTE_FLAG_FREE      0x80    //!< Node is on the free list
+
+/**
+ * @brief Graph node
+ */
+struct rpl_source_route_node_s {
+    uint8_t address[16];            //!< Global address of the node
+    uint32_t parent;                //!< Parent advertised in the last DAO, RPL_ROUTE_NONE when unknown
+    uint32_t first_child;           //!< First child
+    uint32_t next_sibling;          //!< Next child of the parent
+    uint32_t prev_sibling;          //!< Previous child of the parent
+    uint32_t first_hop;             //!< First hop of the cached route
+    uint32_t expires;               //!< Expiry time of the link to the parent in seconds
+    uint8_t path_sequence;          //!< Path Sequence of the last accepted DAO
+    uint8_t flags;                  //!< RPL_SOURCE_ROUTE_FLAG_*
+    uint8_t srh_length;             //!< Length of the cached header, 0 for a child of the root
+    uint8_t srh[RPL_SOURCE_ROUTE_CACHE_SIZE];   //!< Cached header (Next Header is filled in on use)
+};
+
+/**
+ * @brief DAO parent graph
+ */
+struct rpl_source_route_graph_s {
+    struct rpl_source_route_node_s *nodes;  //!< Node storage
+    struct rpl_pool_s pool;                 //!< Nodes in the graph (count), including the root
+    uint32_t *index;                        //!< Hash index of node numbers
+    uint32_t index_mask;                    //!< Size of index - 1
+    uint32_t root;                          //!< The root node
+    uint16_t lifetime_unit;                 //!< Lifetime Unit in seconds
+};
+
+/**
+ * @brief Initialise a graph holding only the root
+ * @details index_size must be a power of 2 larger than capacity.
+ * @return 0 on success, -1 on invalid sizes
+ */
+int RPL_source_route_init(struct rpl_source_route_graph_s *graph, struct rpl_source_route_node_s *nodes, uint32_t capacity, uint32_t *index,
+                          uint32_t index_size, const uint8_t root[16], uint16_t lifetime_unit);
+
+/**
+ * @brief Record the parent of a target from a DAO
+ * @details A Path Lifetime of 0 (No-Path) removes the link to the parent.
+ * @return rpl_route_result_e
+ */
+int RPL_source_route_dao(struct rpl_source_route_graph_s *graph, const uint8_t target[16], const uint8_t parent[16], uint8_t path_sequence,
+                         uint8_t path_lifetime, uint32_t now);
+
+/**
+ * @brief As RPL_source_route_dao from received (validated) RPL Target and Transit Information options
+ * @details Only host (/128) targets with a Parent Address are accepted.
+ */
+int RPL_source_route_target(struct rpl_source_route_graph_s *graph, const struct rpl_option_view_s *target, const struct rpl_option_view_s *transit,
+                            uint32_t now);
+
+/**
+ * @brief Build the Source Routing Header for a packet from the root to destination
+ *
+ * @param next_header Next Header of the routing header
+ * @param buffer filled with the header
+ * @param first_hop set to the address to use as IPv6 Destination Address
+ * @return header length, 0 when destination is a child of the root (no header), -1 when unreachable
+ * or buffer is too small
+ */
+int RPL_source_route_header(struct rpl_source_route_graph_s *graph, const uint8_t destination[16], uint8_t next_header, uint8_t *buffer, uint16_t capacity,
+                            const uint8_t **first_hop);
+
+/**
+ * @brief Remove links to parents that have expired
+ * @return number of links removed
+ */
+uint32_t RPL_source_route_purge(struct rpl_source_route_graph_s *graph, uint32_t now);
+
+/**
+ * @brief Find a node by address
+ * @return node, NULL when not in the graph
+ */
+const struct rpl_source_route_node_s *RPL_source_route_find(const struct rpl_source_route_graph_s *graph, const uint8_t address[16]);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#if RPL_CONF_NON_STORING
+
+#define SOURCE_ROUTE_TEST_NODES     5000
+#define SOURCE_ROUTE_TEST_INDEX     8192
+
+static const uint8_t root_address[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 };
+
+static void node_address(uint8_t address[16], uint32_t id) {
+	memcpy(address, root_address, 16);
+	RPL_write_uint32(address + 12, id);
+}
+
+//Expands a Source Routing Header as each hop would [RFC6554 Section 4.2], returns the number of addresses
+static int source_route_expand(const uint8_t *header, const uint8_t first_hop[16], uint8_t addresses[][16]) {
+	int segments = header[3];
+	int cmpr_i = header[4] >> 4;
+	int cmpr_e = header[4] & 0x0F;
+	const uint8_t *previous = first_hop;
+	const uint8_t *position = header + RPL_SOURCE_ROUTE_HEADER_LENGTH;
+	int i;
+
+	for (i = 0; i < segments; i++) {
+		int elided = (i == segments - 1) ? cmpr_e : cmpr_i;
+
+		memcpy(addresses[i], previous, (size_t)elided);
+		memcpy(addresses[i] + elided, position, (size_t)(16 - elided));
+		position += 16 - elided;
+		previous = addresses[i];
+	}
+	return segments;
+}
+
+TEST_GROUP(source_route_tests)
+{
+	struct rpl_source_route_node_s *nodes;
+	uint32_t *index;
+	struct rpl_source_route_graph_s graph;
+	uint8_t a[16], b[16], c[16], d[16];
+	uint8_t header[512];
+	const uint8_t *first_hop;
+
+	void setup() {
+		nodes = (struct rpl_source_route_node_s *)malloc(SOURCE_ROUTE_TEST_NODES * sizeof(struct rpl_source_route_node_s));
+		index = (uint32_t *)malloc(SOURCE_ROUTE_TEST_INDEX * sizeof(uint32_t));
+		CHECK_EQUAL(0, RPL_source_route_init(&graph, nodes, SOURCE_ROUTE_TEST_NODES, index, SOURCE_ROUTE_TEST_INDEX, root_address, 60));
+		node_address(a, 0xA);
+		node_address(b, 0xB);
+		node_address(c, 0xC);
+		node_address(d, 0xD);
+		first_hop = NULL;
+	}
+
+	void teardown() {
+		free(nodes);
+		free(index);
+	}
+};
+
+TEST(source_route_tests, source_route_init) {
+	CHECK_EQUAL(-1, RPL_source_route_init(&graph, nodes, 16, index, 16, root_address, 60));
+	CHECK_EQUAL(-1, RPL_source_route_init(&graph, nodes, 16, index, 24, root_address, 60));
+	CHECK_EQUAL(0, RPL_source_route_init(&graph, nodes, 16, index, 32, root_address, 60));
+	CHECK_EQUAL(1, graph.pool.count);
+	CHECK(RPL_source_route_find(&graph, root_address) != NULL);
+}
+
+TEST(source_route_tests, source_route_chain) {
+	static const uint8_t expected[] = { 41, 1, RPL_SOURCE_ROUTE_ROUTING_TYPE, 2, 0xFF, 0x60, 0, 0, 0x0B, 0x0C, 0, 0, 0, 0, 0, 0 };
+
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_dao(&graph, a, root_address, 240, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_dao(&graph, b, a, 240, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_dao(&graph, c, b, 240, 10, 0));
+	CHECK_EQUAL(4, graph.pool.count);
+
+	//Children of the root need no header
+	CHECK_EQUAL(0, RPL_source_route_header(&graph, a, 41, header, sizeof(header), &first_hop));
+	MEMCMP_EQUAL(a, first_hop, 16);
+
+	//Addresses sharing all but the last octet compress to one octet each
+	CHECK_EQUAL(sizeof(expected), RPL_source_route_header(&graph, c, 41, header, sizeof(header), &first_hop));
+	MEMCMP_EQUAL(expected, header, sizeof(expected));
+	MEMCMP_EQUAL(a, first_hop, 16);
+
+	//Cached header, with the Next Header of the request
+	CHECK(RPL_source_route_find(&graph, c)->flags & RPL_SOURCE_ROUTE_FLAG_CACHED);
+	memset(header, 0xAA, sizeof(header));
+	CHECK_EQUAL(sizeof(expected), RPL_source_route_header(&graph, c, 17, header, sizeof(header), &first_hop));
+	CHECK_EQUAL(17, header[0]);
+	MEMCMP_EQUAL(expected + 1, header + 1, sizeof(expected) - 1);
+
+	CHECK_EQUAL(-1, RPL_source_route_header(&graph, d, 41, header, sizeof(header), &first_hop));
+	CHECK_EQUAL(-1, RPL_source_route_header(&graph, root_address, 41, header, sizeof(header), &first_hop));
+	CHECK_EQUAL(-1, RPL_source_route_header(&graph, c, 41, header, 8, &first_hop));
+}
+
+//Elision is limited by the addresses of neighbouring hops
+TEST(source_route_tests, source_route_compression) {
+	uint8_t addresses[4][16];
+
+	b[4] = 0x77;
+	RPL_source_route_dao(&graph, a, root_address, 240, 10, 0);
+	RPL_source_route_dao(&graph, b, a, 240, 10, 0);
+	RPL_source_route_dao(&graph, c, b, 240, 10, 0);
+	RPL_source_route_dao(&graph, d, c, 240, 10, 0);
+
+	CHECK_EQUAL(8 + 12 + 12 + 1 + 7, RPL_source_route_header(&graph, d, 41, header, sizeof(header), &first_hop));
+	CHECK_EQUAL(0x4F, header[4]);
+	CHECK_EQUAL(0x70, header[5]);
+	CHECK_EQUAL(3, source_route_expand(header, first_hop, addresses));
+	MEMCMP_EQUAL(b, addresses[0], 16);
+	MEMCMP_EQUAL(c, addresses[1], 16);
+	MEMCMP_EQUAL(d, addresses[2], 16);
+}
+
+//Changing a parent only drops the cached headers of the sub-DODAG
+TEST(source_route_tests, source_route_invalidate) {
+	RPL_source_route_dao(&graph, a, root_address, 240, 10, 0);
+	RPL_source_route_dao(&graph, b, a, 240, 10, 0);
+	RPL_source_route_dao(&graph, c, b, 240, 10, 0);
+	RPL_source_route_dao(&graph, d, a, 240, 10, 0);
+	RPL_source_route_header(&graph, c, 41, header, sizeof(header), &first_hop);
+	RPL_source_route_header(&graph, d, 41, header, sizeof(header), &first_hop);
+	RPL_source_route_header(&graph, b, 41, header, sizeof(header), &first_hop);
+
+	//Refresh with the same parent keeps the cache
+	CHECK_EQUAL(RPL_ROUTE_UPDATED, RPL_source_route_dao(&graph, b, a, 241, 10, 0));
+	CHECK(RPL_source_route_find(&graph, c)->flags & RPL_SOURCE_ROUTE_FLAG_CACHED);
+
+	CHECK_EQUAL(RPL_ROUTE_UPDATED, RPL_source_route_dao(&graph, b, d, 242, 10, 0));
+	CHECK(!(RPL_source_route_find(&graph, b)->flags & RPL_SOURCE_ROUTE_FLAG_CACHED));
+	CHECK(!(RPL_source_route_find(&graph, c)->flags & RPL_SOURCE_ROUTE_FLAG_CACHED));
+	CHECK(RPL_source_route_find(&graph, d)->flags & RPL_SOURCE_ROUTE_FLAG_CACHED);
+
+	CHECK_EQUAL(8 + 3 + 5, RPL_source_route_header(&graph, c, 41, header, sizeof(header), &first_hop));
+	CHECK_EQUAL(3, header[3]);
+	MEMCMP_EQUAL(a, first_hop, 16);
+}
+
+TEST(source_route_tests, source_route_loop) {
+	RPL_source_route_dao(&graph, a, root_address, 240, 10, 0);
+	RPL_source_route_dao(&graph, b, a, 240, 10, 0);
+	RPL_source_route_dao(&graph, c, b, 240, 10, 0);
+	CHECK_EQUAL(RPL_ROUTE_LOOP, RPL_source_route_dao(&graph, a, c, 241, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_LOOP, RPL_source_route_dao(&graph, a, a, 241, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_INVALID, RPL_source_route_dao(&graph, root_address, a, 241, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_LOOP, RPL_source_route_dao(&graph, d, d, 241, 10, 0));
+	POINTERS_EQUAL(NULL, RPL_source_route_find(&graph, d));
+	CHECK(RPL_source_route_header(&graph, c, 41, header, sizeof(header), &first_hop) > 0);
+}
+
+TEST(source_route_tests, source_route_no_path) {
+	RPL_source_route_dao(&graph, a, root_address, 240, 10, 0);
+	RPL_source_route_dao(&graph, b, a, 240, 10, 0);
+	RPL_source_route_dao(&graph, c, b, 240, 10, 0);
+	RPL_source_route_header(&graph, c, 41, header, sizeof(header), &first_hop);
+
+	CHECK_EQUAL(RPL_ROUTE_STALE, RPL_source_route_dao(&graph, b, a, 239, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(RPL_ROUTE_STALE, RPL_source_route_dao(&graph, b, c, 240, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_source_route_dao(&graph, b, a, 240, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+
+	//b stays as c's parent, but the sub-DODAG is unreachable
+	CHECK(RPL_source_route_find(&graph, b) != NULL);
+	CHECK_EQUAL(-1, RPL_source_route_header(&graph, c, 41, header, sizeof(header), &first_hop));
+
+	//Nodes with no links are dropped
+	CHECK_EQUAL(RPL_ROUTE_REMOVED, RPL_source_route_dao(&graph, c, b, 241, RPL_ROUTE_LIFETIME_NO_PATH, 0));
+	POINTERS_EQUAL(NULL, RPL_source_route_find(&graph, b));
+	POINTERS_EQUAL(NULL, RPL_source_route_find(&graph, c));
+	CHECK_EQUAL(2, graph.pool.count);
+}
+
+TEST(source_route_tests, source_route_purge) {
+	RPL_source_route_dao(&graph, a, root_address, 240, 10, 0);
+	RPL_source_route_dao(&graph, b, a, 240, RPL_ROUTE_LIFETIME_INFINITE, 0);
+	RPL_source_route_dao(&graph, c, a, 240, 1, 0);
+	CHECK_EQUAL(0, RPL_source_route_purge(&graph, 59));
+	CHECK_EQUAL(1, RPL_source_route_purge(&graph, 60));
+	POINTERS_EQUAL(NULL, RPL_source_route_find(&graph, c));
+	CHECK_EQUAL(1, RPL_source_route_purge(&graph, 600));
+	CHECK_EQUAL(-1, RPL_source_route_header(&graph, b, 41, header, sizeof(header), &first_hop));
+	CHECK_EQUAL(0, RPL_source_route_purge(&graph, 100000));
+}
+
+TEST(source_route_tests, source_route_target_options) {
+	struct rpl_option_transit_info_s transit_info = {};
+	struct rpl_option_iter_s iter;
+	struct rpl_option_view_s target;
+	struct rpl_option_view_s transit;
+	struct rpl_builder_s builder;
+	uint8_t block[128];
+	int length;
+
+	transit_info.path_sequence = 240;
+	transit_info.path_lifetime = 10;
+	RPL_builder_init(&builder, block, sizeof(block), NULL, 0);
+	RPL_builder_block_begin(&builder, RPL_DESTINATION_ADVERTISEMENt_OBJECT);
+	RPL_builder_target(&builder, 128, a);
+	RPL_builder_transit_info(&builder, &transit_info, root_address);
+	RPL_builder_target(&builder, 64, b);
+	RPL_builder_transit_info(&builder, &transit_info, NULL);
+	length = RPL_builder_finish(&builder, NULL, NULL);
+	CHECK(length > 0);
+
+	RPL_option_iter_init(&iter, RPL_DESTINATION_ADVERTISEMENt_OBJECT, block, (uint16_t)length);
+	RPL_option_iter_next(&iter, &target);
+	RPL_option_iter_next(&iter, &transit);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_target(&graph, &target, &transit, 0));
+	RPL_option_iter_next(&iter, &target);
+	RPL_option_iter_next(&iter, &transit);
+	CHECK_EQUAL(RPL_ROUTE_INVALID, RPL_source_route_target(&graph, &target, &transit, 0));
+	CHECK_EQUAL(0, RPL_source_route_header(&graph, a, 41, header, sizeof(header), &first_hop));
+}
+
+TEST(source_route_tests, source_route_full) {
+	struct rpl_source_route_node_s small[3];
+	uint32_t small_index[4];
+
+	CHECK_EQUAL(0, RPL_source_route_init(&graph, small, 3, small_index, 4, root_address, 60));
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_dao(&graph, a, root_address, 240, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_FULL, RPL_source_route_dao(&graph, c, b, 240, 10, 0));
+	CHECK_EQUAL(2, graph.pool.count);
+	CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_dao(&graph, b, a, 240, 10, 0));
+	CHECK_EQUAL(RPL_ROUTE_FULL, RPL_source_route_dao(&graph, c, b, 240, 10, 0));
+}
+
+//A 5000 node mesh with parent changes, every header expands to the path in the graph
+TEST(source_route_tests, source_route_mesh) {
+	static uint32_t parents[SOURCE_ROUTE_TEST_NODES];
+	static uint8_t addresses[RPL_SOURCE_ROUTE_MAX_HOPS][16];
+	uint8_t address[16], parent[16];
+	uint32_t i, id, step, hop;
+	int segments, length;
+
+	srand(6554);
+	parents[1] = 0;
+	for (id = 1; id < SOURCE_ROUTE_TEST_NODES - 1; id++) {
+		parents[id] = (id < 8) ? 0 : 1 + (uint32_t)rand() % (id - 1);
+		node_address(address, id + 1);
+		node_address(parent, parents[id] + 1);
+		CHECK_EQUAL(RPL_ROUTE_ADDED, RPL_source_route_dao(&graph, address, parent, 240, RPL_ROUTE_LIFETIME_INFINITE, 0));
+	}
+
+	for (step = 0; step < 3; step++) {
+		for (i = 0; i < 200; i++) {
+			//Move a node under one with a lower id, which can not be a descendant
+			id = 100 + (uint32_t)rand() % (SOURCE_ROUTE_TEST_NODES - 101);
+			parents[id] = 1 + (uint32_t)rand() % (id - 1);
+			node_address(address, id + 1);
+			node_address(parent, parents[id] + 1);
+			CHECK(RPL_source_route_dao(&graph, address, parent, (uint8_t)(241 + step), RPL_ROUTE_LIFETIME_INFINITE, 0) >= 0);
+		}
+
+		for (id = 1; id < SOURCE_ROUTE_TEST_NODES - 1; id++) {
+			node_address(address, id + 1);
+			length = RPL_source_route_header(&graph, address, 41, header, sizeof(header), &first_hop);
+			CHECK(length >= 0);
+			segments = (length == 0) ? 0 : source_route_expand(header, first_hop, addresses);
+
+			//Walk the expected path back from the destination
+			hop = id;
+			for (i = (uint32_t)segments; i > 0; i--) {
+				node_address(address, hop + 1);
+				MEMCMP_EQUAL(address, addresses[i - 1], 16);
+				hop = parents[hop];
+			}
+			node_address(address, hop + 1);
+			MEMCMP_EQUAL(address, first_hop, 16);
+			CHECK_EQUAL(0, parents[hop]);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include <stddef.h>
+
+#include "rpl.h"
+
+//Hierarchical timer wheel
+//Level l slot s holds timers due when the wheel reaches the time with bits [6l, 6l+6) equal to s,
+//they are re-inserted into the lower levels (cascaded) when that time is reached
+
+#define RPL_TIMER_WHEEL_MASK        (RPL_TIMER_WHEEL_SLOTS - 1)
+#define RPL_TIMER_WHEEL_RANGE       (1UL << (RPL_TIMER_WHEEL_BITS * RPL_TIMER_WHEEL_LEVELS))
+
+static void RPL_timer_list_init(struct rpl_timer_s *head) {
+	head->next = head;
+	head->prev = head;
+}
+
+void RPL_timer_wheel_init(struct rpl_timer_wheel_s *wheel, uint32_t now, const struct rpl_clock_s *clock) {
+	int level, slot;
+
+	wheel->now = now;
+	wheel->pending = 0;
+	wheel->clock = clock;
+	for (level = 0; level < RPL_TIMER_WHEEL_LEVELS; level++) {
+		wheel->occupied[level] = 0;
+		for (slot = 0; slot < RPL_TIMER_WHEEL_SLOTS; slot++) {
+			RPL_timer_list_init(&wheel->slots[level][slot]);
+		}
+	}
+}
+
+void RPL_timer_init(struct rpl_timer_s *timer, rpl_timer_callback_t callback, void *context) {
+	timer->next = NULL;
+	timer->prev = NULL;
+	timer->expires = 0;
+	timer->callback = callback;
+	timer->context = context;
+}
+
+//Links a timer into the slot for its expiry, expires must not be before the wheel time
+static void RPL_timer_insert(struct rpl_timer_wheel_s *wheel, struct rpl_timer_s *timer) {
+	uint32_t delta = timer->expires - wheel->now;
+	uint32_t when = timer->expires;
+	struct rpl_timer_s *head;
+	int level, slot;
+
+	for (level = 0; level < RPL_TIMER_WHEEL_LEVELS - 1; level++) {
+		if (delta < (1UL << (RPL_TIMER_WHEEL_BITS * (level + 1)))) {
+			break;
+		}
+	}
+	if (delta >= RPL_TIMER_WHEEL_RANGE) {
+		when = wheel->now + RPL_TIMER_WHEEL_RANGE - 1;
+	}
+
+	slot = (when >> (RPL_TIMER_WHEEL_BITS * level)) & RPL_TIMER_WHEEL_MASK;
+	head = &wheel->slots[level][slot];
+	timer->next = head;
+	timer->prev = head->prev;
+	head->prev->next = timer;
+	head->prev = timer;
+	wheel->occupied[level] |= 1ULL << slot;
+}
+
+static void RPL_timer_unlink(struct rpl_timer_s *timer) {
+	timer->prev->next = timer->next;
+	timer->next->prev = timer->prev;
+	timer->next = NULL;
+	timer->prev = NULL;
+}
+
+void RPL_timer_start(struct rpl_timer_wheel_s *wheel, struct rpl_timer_s *timer, uint32_t expires) {
+	if (RPL_timer_running(timer)) {
+		RPL_timer_unlink(timer);
+		wheel->pending--;
+	}
+	if ((int32_t)(expires - wheel->now) <= 0) {
+		expires = wheel->now + 1;
+	}
+
+	timer->expires = expires;
+	RPL_timer_insert(wheel, timer);
+	wheel->pending++;
+}
+
+void RPL_timer_stop(struct rpl_timer_wheel_s *wheel, struct rpl_timer_s *timer) {
+	if (RPL_timer_running(timer)) {
+		RPL_timer_unlink(timer);
+		wheel->pending--;
+	}
+}
+
+//Slots are visited in order, the occupancy bits may be stale (set for an emptied slot) which only costs an empty visit
+int RPL_timer_wheel_next_event(const struct rpl_timer_wheel_s *wheel, uint32_t limit, uint32_t *next) {
+	uint32_t best = 0;
+	uint32_t best_delta = 0xFFFFFFFF;
+	int level;
+
+	for (level = 0; level < RPL_TIMER_WHEEL_LEVELS; level++) {
+		int shift = RPL_TIMER_WHEEL_BITS * level;
+		uint64_t bits = wheel->occupied[level];
+		unsigned int index, distance;
+		uint32_t when;
+
+		if (bits == 0) {
+			continue;
+		}
+
+		//Distance to the next occupied slot after the current one, the current slot itself is a full rotation away
+		index = ((wheel->now >> shift) + 1) & RPL_TIMER_WHEEL_MASK;
+		bits = (bits >> index) | (index ? (bits << (RPL_TIMER_WHEEL_SLOTS - index)) : 0);
+		distance = (unsigned int)__builtin_ctzll(bits) + 1;
+
+		when = ((wheel->now >> shift) + distance) << shift;
+		if (when - wheel->now < best_delta) {
+			best_delta = when - wheel->now;
+			best = when;
+		}
+	}
+
+	if (best_delta > limit - wheel->now) {
+		return 0;
+	}
+
+	*next = best;
+	return 1;
+}
+
+//Moves the timers of a higher level slot down to the lower levels
+static void RPL_timer_cascade(struct rpl_timer_wheel_s *wheel, int level, int slot) {
+	struct rpl_timer_s *head = &wheel->slots[level][slot];
+	struct rpl_timer_s pending;
+	struct rpl_timer_s *timer;
+
+	wheel->occupied[level] &= ~(1ULL << slot);
+	if (head->next == head) {
+		return;
+	}
+
+	pending.next = head->next;
+	pending.prev = head->prev;
+	pending.next->prev = &pending;
+	pending.prev->next = &pending;
+	RPL_timer_list_init(head);
+
+	while ((timer = pending.next) != &pending) {
+		RPL_timer_unlink(timer);
+		RPL_timer_insert(wheel, timer);
+	}
+}
+
+static void RPL_timer_expire(struct rpl_timer_wheel_s *wheel, int slot) {
+	struct rpl_timer_s *head = &wheel->slots[0][slot];
+	struct rpl_timer_s *timer;
+
+	wheel->occupied[0] &= ~(1ULL << slot);
+
+	//Callbacks may start or stop other timers, restarted timers always land in a later slot
+	while ((timer = head->next) != head) {
+		RPL_timer_unlink(timer);
+		wheel->pending--;
+		timer->callback(timer, timer->context);
+	}
+}
+
+void RPL_timer_wheel_advance(struct rpl_timer_wheel_s *wheel, uint32_t now) {
+	uint32_t next;
+	int level;
+
+	while (RPL_timer_wheel_next_event(wheel, now, &next)) {
+		wheel->now = next;
+
+		for (level = RPL_TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+			int shift = RPL_TIMER_WHEEL_BITS * level;
+
+			if ((next & ((1UL << shift) - 1)) == 0) {
+				RPL_timer_cascade(wheel, level, (next >> shift) & RPL_TIMER_WHEEL_MASK);
+			}
+		}
+		RPL_timer_expire(wheel, next & RPL_TIMER_WHEEL_MASK);
+	}
+
+	wheel->now = now;
+}
+
+void RPL_timer_wheel_run(struct rpl_timer_wheel_s *wheel) {
+	if (wheel->clock != NULL) {
+		RPL_timer_wheel_advance(wheel, wheel->clock->now(wheel->clock->context));
+	}
+}
@@ -0,0 +1,95 @@
+/**
+ * RPL timers
+ * Hierarchical timer wheel with O(1) start and stop
+ *
+ * Time is measured in ticks (milliseconds for the RPL timers) of a clock supplied by the user,
+ * the wheel is only advanced by RPL_timer_wheel_advance so simulations and tests can run on a
+ * virtual clock. Each level has RPL_TIMER_WHEEL_SLOTS slots, timers move down a level when the
+ * level below wraps, and idle periods are skipped using per level occupancy bitmaps.
+ *
+ * Timers are intrusive, the wheel never allocates.
+ */
+
+#ifndef RPL_TIMER_H
+#define RPL_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_TIMER_WHEEL_BITS        6                               //!< Slots per level as a power of 2
+#define RPL_TIMER_WHEEL_SLOTS       (1 << RPL_TIMER_WHEEL_BITS)
+#define RPL_TIMER_WHEEL_LEVELS      5                               //!< Range of 2^30 ticks, later timers are held at the top level
+
+struct rpl_timer_s;
+
+typedef void (*rpl_timer_callback_t)(struct rpl_timer_s *timer, void *context);
+
+/**
+ * @brief Timer
+ */
+struct rpl_timer_s {
+    struct rpl_timer_s *next;       //!< Next timer in the slot
+    struct rpl_timer_s *prev;       //!< Previous timer in the slot, NULL when not running
+    uint32_t expires;               //!< Expiry time in ticks
+    rpl_timer_callback_t callback;  //!< Called on expiry, may restart the timer
+    void *context;                  //!< Passed to callback
+};
+
+/**
+ * @brief Clock used to drive a timer wheel
+ */
+struct rpl_clock_s {
+    uint32_t (*now)(void *context); //!< Current time in ticks
+    void *context;                  //!< Passed to now
+};
+
+/**
+ * @brief Timer wheel
+ */
+struct rpl_timer_wheel_s {
+    uint32_t now;                                                       //!< Time of the last processed tick
+    uint32_t pending;                                                   //!< Number of running timers
+    uint64_t occupied[RPL_TIMER_WHEEL_LEVELS];                          //!< Bit per non empty slot
+    struct rpl_timer_s slots[RPL_TIMER_WHEEL_LEVELS][RPL_TIMER_WHEEL_SLOTS];  //!< Slot list heads
+    const struct rpl_clock_s *clock;                                    //!< Clock for RPL_timer_wheel_run, may be NULL
+};
+
+void RPL_timer_wheel_init(struct rpl_timer_wheel_s *wheel, uint32_t now, const struct rpl_clock_s *clock);
+
+/**
+ * @brief Process all timers expiring up to and including now
+ */
+void RPL_timer_wheel_advance(struct rpl_timer_wheel_s *wheel, uint32_t now);
+
+/**
+ * @brief Advance to the time given by the wheel clock
+ */
+void RPL_timer_wheel_run(struct rpl_timer_wheel_s *wheel);
+
+/**
+ * @brief Time of the next tick that may expire a timer, for sleeping or advancing a simulation
+ * @return 0 when there is no event before limit, 1 with *next set otherwise
+ */
+int RPL_timer_wheel_next_event(const struct rpl_timer_wheel_s *wheel, uint32_t limit, uint32_t *next);
+
+void RPL_timer_init(struct rpl_timer_s *timer, rpl_timer_callback_t callback, void *context);
+
+/**
+ * @brief Start (or restart) a timer to expire at the given time
+ * @details Times that have already passed expire on the next tick.
+ */
+void RPL_timer_start(struct rpl_timer_wheel_s *wheel, struct rpl_timer_s *timer, uint32_t expires);
+void RPL_timer_stop(struct rpl_timer_wheel_s *wheel, struct rpl_timer_s *timer);
+
+static inline int RPL_timer_running(const struct rpl_timer_s *timer) {
+    return timer->prev != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#define TIMER_TEST_COUNT    64
+
+static uint32_t fired_at[TIMER_TEST_COUNT];
+static int fired_order[TIMER_TEST_COUNT];
+static int fired_count;
+static struct rpl_timer_wheel_s *fired_wheel;
+
+static void timer_fired(struct rpl_timer_s *timer, void *context) {
+	int index = (int)(intptr_t)context;
+
+	(void)timer;
+	fired_at[index] = fired_wheel->now;
+	fired_order[fired_count++] = index;
+}
+
+//Restarts itself every 100 ticks
+static void timer_periodic(struct rpl_timer_s *timer, void *context) {
+	(void)context;
+	fired_at[fired_count++] = fired_wheel->now;
+	RPL_timer_start(fired_wheel, timer, fired_wheel->now + 100);
+}
+
+static uint32_t virtual_now;
+
+static uint32_t virtual_clock(void *context) {
+	(void)context;
+	return virtual_now;
+}
+
+TEST_GROUP(timer_tests)
+{
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_timer_s timers[TIMER_TEST_COUNT];
+
+	void setup() {
+		int i;
+
+		RPL_timer_wheel_init(&wheel, 1000, NULL);
+		fired_wheel = &wheel;
+		fired_count = 0;
+		for (i = 0; i < TIMER_TEST_COUNT; i++) {
+			fired_at[i] = 0;
+			RPL_timer_init(&timers[i], timer_fired, (void *)(intptr_t)i);
+		}
+	}
+
+	void teardown() {
+	}
+};
+
+//Timers fire at their expiry time, in expiry order
+TEST(timer_tests, timer_order) {
+	RPL_timer_start(&wheel, &timers[0], 1030);
+	RPL_timer_start(&wheel, &timers[1], 1010);
+	RPL_timer_start(&wheel, &timers[2], 1020);
+	CHECK_EQUAL(3, wheel.pending);
+	CHECK(RPL_timer_running(&timers[0]));
+
+	RPL_timer_wheel_advance(&wheel, 1015);
+	CHECK_EQUAL(1, fired_count);
+	CHECK_EQUAL(1010, fired_at[1]);
+
+	RPL_timer_wheel_advance(&wheel, 2000);
+	CHECK_EQUAL(3, fired_count);
+	CHECK_EQUAL(1, fired_order[0]);
+	CHECK_EQUAL(2, fired_order[1]);
+	CHECK_EQUAL(0, fired_order[2]);
+	CHECK_EQUAL(1020, fired_at[2]);
+	CHECK_EQUAL(1030, fired_at[0]);
+	CHECK_EQUAL(0, wheel.pending);
+	CHECK(!RPL_timer_running(&timers[0]));
+}
+
+//Timers on the upper levels cascade down and fire at the exact tick
+TEST(timer_tests, timer_far) {
+	static const uint32_t delays[] = { 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 1000000, 16777216, 100000000 };
+	unsigned i;
+
+	for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+		RPL_timer_start(&wheel, &timers[i], 1000 + delays[i]);
+	}
+	RPL_timer_wheel_advance(&wheel, 1000 + 100000000);
+	CHECK_EQUAL(sizeof(delays) / sizeof(delays[0]), fired_count);
+	for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+		CHECK_EQUAL(1000 + delays[i], fired_at[i]);
+		CHECK_EQUAL((int)i, fired_order[i]);
+	}
+}
+
+//Advancing in small steps gives the same result as one large step
+TEST(timer_tests, timer_small_steps) {
+	uint32_t now;
+	int i;
+
+	srand(6206);
+	for (i = 0; i < TIMER_TEST_COUNT; i++) {
+		RPL_timer_start(&wheel, &timers[i], 1000 + 1 + (uint32_t)rand() % 300000);
+	}
+	for (now = 1000; now < 1000 + 300001; now += 7) {
+		RPL_timer_wheel_advance(&wheel, now);
+	}
+	RPL_timer_wheel_advance(&wheel, now);
+	CHECK_EQUAL(TIMER_TEST_COUNT, fired_count);
+	for (i = 0; i < TIMER_TEST_COUNT; i++) {
+		CHECK_EQUAL(timers[i].expires, fired_at[i]);
+	}
+	for (i = 1; i < TIMER_TEST_COUNT; i++) {
+		CHECK(fired_at[fired_order[i - 1]] <= fired_at[fired_order[i]]);
+	}
+}
+
+TEST(timer_tests, timer_stop_restart) {
+	RPL_timer_start(&wheel, &timers[0], 1010);
+	RPL_timer_start(&wheel, &timers[1], 5000);
+	RPL_timer_stop(&wheel, &timers[0]);
+	RPL_timer_stop(&wheel, &timers[0]);
+	CHECK_EQUAL(1, wheel.pending);
+
+	//Restarting moves the timer
+	RPL_timer_start(&wheel, &timers[1], 1020);
+	CHECK_EQUAL(1, wheel.pending);
+	RPL_timer_wheel_advance(&wheel, 1100);
+	CHECK_EQUAL(1, fired_count);
+	CHECK_EQUAL(1, fired_order[0]);
+	CHECK_EQUAL(1020, fired_at[1]);
+
+	//Times in the past fire on the next tick
+	RPL_timer_start(&wheel, &timers[2], 900);
+	CHECK_EQUAL(1101, timers[2].expires);
+}
+
+TEST(timer_tests, timer_periodic) {
+	RPL_timer_init(&timers[0], timer_periodic, NULL);
+	RPL_timer_start(&wheel, &timers[0], 1100);
+	RPL_timer_wheel_advance(&wheel, 1550);
+	CHECK_EQUAL(5, fired_count);
+	CHECK_EQUAL(1500, fired_at[4]);
+	CHECK_EQUAL(1600, timers[0].expires);
+	CHECK_EQUAL(1, wheel.pending);
+}
+
+TEST(timer_tests, timer_next_event) {
+	uint32_t next = 0;
+
+	CHECK_EQUAL(0, RPL_timer_wheel_next_event(&wheel, 1000000, &next));
+
+	RPL_timer_start(&wheel, &timers[0], 1000 + 70000);
+	RPL_timer_start(&wheel, &timers[1], 1000 + 5000000);
+	CHECK_EQUAL(1, RPL_timer_wheel_next_event(&wheel, 2000000, &next));
+	CHECK(next <= 1000 + 70000);
+	CHECK(next > 1000);
+
+	//Jumping between events only ever fires timers at their expiry
+	while (RPL_timer_wheel_next_event(&wheel, 10000000, &next)) {
+		RPL_timer_wheel_advance(&wheel, next);
+	}
+	CHECK_EQUAL(2, fired_count);
+	CHECK_EQUAL(1000 + 70000, fired_at[0]);
+	CHECK_EQUAL(1000 + 5000000, fired_at[1]);
+}
+
+TEST(timer_tests, timer_clock) {
+	struct rpl_clock_s clock = { virtual_clock, NULL };
+
+	RPL_timer_wheel_init(&wheel, 0, &clock);
+	RPL_timer_start(&wheel, &timers[0], 250);
+	virtual_now = 249;
+	RPL_timer_wheel_run(&wheel);
+	CHECK_EQUAL(0, fired_count);
+	virtual_now = 250;
+	RPL_timer_wheel_run(&wheel);
+	CHECK_EQUAL(1, fired_count);
+	CHECK_EQUAL(250, wheel.now);
+}
@@ -0,0 +1,111 @@
+#include <stddef.h>
+
+#include "rpl.h"
+
+//Trickle timer, RFC6206 section 4.2 with the RPL parameters of RFC6550 section 8.3.1
+
+#define RPL_TRICKLE_MAX_EXPONENT    30      //!< Longest interval the timer wheel can hold without clamping
+
+static uint32_t RPL_trickle_random(struct rpl_trickle_engine_s *engine) {
+	uint32_t x;
+
+	if (engine->random != NULL) {
+		return engine->random(engine->random_context);
+	}
+
+	//xorshift32
+	x = engine->random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	engine->random_state = x;
+	return x;
+}
+
+void RPL_trickle_engine_init(struct rpl_trickle_engine_s *engine, struct rpl_timer_wheel_s *wheel, uint32_t (*random)(void *context), void *random_context) {
+	engine->wheel = wheel;
+	engine->random = random;
+	engine->random_context = random_context;
+	engine->random_state = 0x6550;
+}
+
+//Rule 1 and 2: start an interval with c = 0 and t chosen in [I/2, I)
+static void RPL_trickle_begin_interval(struct rpl_trickle_s *trickle) {
+	struct rpl_timer_wheel_s *wheel = trickle->engine->wheel;
+	uint32_t half = trickle->interval / 2;
+	uint32_t t = half + RPL_trickle_random(trickle->engine) % (trickle->interval - half);
+
+	trickle->counter = 0;
+	trickle->transmitted = 0;
+	trickle->interval_start = wheel->now;
+	RPL_timer_start(wheel, &trickle->timer, wheel->now + t);
+}
+
+static void RPL_trickle_expired(struct rpl_timer_s *timer, void *context) {
+	struct rpl_trickle_s *trickle = (struct rpl_trickle_s *)context;
+
+	(void)timer;
+
+	//Rule 4: transmit at t unless enough consistent messages have been heard
+	if (!trickle->transmitted) {
+		trickle->transmitted = 1;
+		if ((trickle->redundancy == RPL_TRICKLE_INFINITE_REDUNDANCY) || (trickle->counter < trickle->redundancy)) {
+			trickle->transmit(trickle, trickle->context);
+		}
+		RPL_timer_start(trickle->engine->wheel, &trickle->timer, trickle->interval_start + trickle->interval);
+		return;
+	}
+
+	//Rule 5: double the interval at its end
+	trickle->interval = (trickle->interval >= trickle->imax / 2) ? trickle->imax : trickle->interval * 2;
+	RPL_trickle_begin_interval(trickle);
+}
+
+void RPL_trickle_init(struct rpl_trickle_s *trickle, struct rpl_trickle_engine_s *engine, uint8_t dio_int_min, uint8_t dio_int_double, uint8_t dio_redun,
+                      rpl_trickle_transmit_t transmit, void *context) {
+	uint8_t min_exponent = (dio_int_min > RPL_TRICKLE_MAX_EXPONENT) ? RPL_TRICKLE_MAX_EXPONENT : dio_int_min;
+	uint8_t max_exponent = (min_exponent + dio_int_double > RPL_TRICKLE_MAX_EXPONENT) ? RPL_TRICKLE_MAX_EXPONENT : (uint8_t)(min_exponent + dio_int_double);
+
+	RPL_timer_init(&trickle->timer, RPL_trickle_expired, trickle);
+	trickle->engine = engine;
+	trickle->imin = 1UL << min_exponent;
+	trickle->imax = 1UL << max_exponent;
+	trickle->interval = trickle->imin;
+	trickle->interval_start = 0;
+	trickle->redundancy = dio_redun;
+	trickle->counter = 0;
+	trickle->transmitted = 0;
+	trickle->transmit = transmit;
+	trickle->context = context;
+}
+
+void RPL_trickle_init_config(struct rpl_trickle_s *trickle, struct rpl_trickle_engine_s *engine, const struct rpl_option_dodag_configuration_s *config,
+                             rpl_trickle_transmit_t transmit, void *context) {
+	if (config == NULL) {
+		RPL_trickle_init(trickle, engine, DEFAULT_DIO_INTERVAL_MIN, DEFAULT_DIO_INTERVAL_DOUBLINGS, DEFAULT_DIO_REDUNDANCY_CONSTANT, transmit, context);
+	} else {
+		RPL_trickle_init(trickle, engine, config->dio_int_min, config->dio_int_double, config->dio_redun, transmit, context);
+	}
+}
+
+void RPL_trickle_start(struct rpl_trickle_s *trickle) {
+	trickle->interval = trickle->imin;
+	RPL_trickle_begin_interval(trickle);
+}
+
+void RPL_trickle_stop(struct rpl_trickle_s *trickle) {
+	RPL_timer_stop(trickle->engine->wheel, &trickle->timer);
+}
+
+void RPL_trickle_consistent(struct rpl_trickle_s *trickle) {
+	if (trickle->counter < 0xFF) {
+		trickle->counter++;
+	}
+}
+
+void RPL_trickle_inconsistent(struct rpl_trickle_s *trickle) {
+	if (trickle->interval != trickle->imin) {
+		trickle->interval = trickle->imin;
+		RPL_trickle_begin_interval(trickle);
+	}
+}
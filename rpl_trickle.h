@@ -0,0 +1,88 @@
+/**
+ * RPL Trickle timers
+ * Trickle algorithm [RFC6206] as used to schedule DIO transmissions [RFC6550 Section 8.3]
+ *
+ * Each Trickle timer runs on a shared timer wheel and engine, so thousands of instances or
+ * simulated nodes can be driven from one (possibly virtual) clock. Intervals are in
+ * milliseconds: Imin = 2^DIOIntervalMin, Imax = Imin * 2^DIOIntervalDoublings, k = DIORedundancyConstant.
+ */
+
+#ifndef RPL_TRICKLE_H
+#define RPL_TRICKLE_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RPL_TRICKLE_INFINITE_REDUNDANCY     0       //!< A redundancy constant of 0 disables suppression [RFC6550 Section 8.3.1]
+
+struct rpl_trickle_s;
+
+typedef void (*rpl_trickle_transmit_t)(struct rpl_trickle_s *trickle, void *context);
+
+/**
+ * @brief State shared by a set of Trickle timers
+ */
+struct rpl_trickle_engine_s {
+    struct rpl_timer_wheel_s *wheel;    //!< Wheel the timers run on
+    uint32_t (*random)(void *context);  //!< Random number source, injectable for reproducible tests
+    void *random_context;               //!< Passed to random
+    uint32_t random_state;              //!< State of the built in generator used when random is NULL
+};
+
+/**
+ * @brief Trickle timer
+ */
+struct rpl_trickle_s {
+    struct rpl_timer_s timer;           //!< Fires at t, then at the end of the interval
+    struct rpl_trickle_engine_s *engine;
+    uint32_t imin;                      //!< Minimum interval (ms)
+    uint32_t imax;                      //!< Maximum interval (ms)
+    uint32_t interval;                  //!< Current interval I
+    uint32_t interval_start;            //!< Start time of the current interval
+    uint8_t redundancy;                 //!< Redundancy constant k
+    uint8_t counter;                    //!< Consistent messages heard this interval c
+    uint8_t transmitted;                //!< Set once t has passed in the current interval
+    rpl_trickle_transmit_t transmit;    //!< Called at t unless suppressed
+    void *context;                      //!< Passed to transmit
+};
+
+void RPL_trickle_engine_init(struct rpl_trickle_engine_s *engine, struct rpl_timer_wheel_s *wheel, uint32_t (*random)(void *context), void *random_context);
+
+/**
+ * @brief Configure a Trickle timer from the DIO Trickle parameters
+ * @details Use DEFAULT_DIO_INTERVAL_MIN, DEFAULT_DIO_INTERVAL_DOUBLINGS and DEFAULT_DIO_REDUNDANCY_CONSTANT
+ * when no DODAG Configuration option has been received.
+ */
+void RPL_trickle_init(struct rpl_trickle_s *trickle, struct rpl_trickle_engine_s *engine, uint8_t dio_int_min, uint8_t dio_int_double, uint8_t dio_redun,
+                      rpl_trickle_transmit_t transmit, void *context);
+
+void RPL_trickle_init_config(struct rpl_trickle_s *trickle, struct rpl_trickle_engine_s *engine, const struct rpl_option_dodag_configuration_s *config,
+                             rpl_trickle_transmit_t transmit, void *context);
+
+/**
+ * @brief Start the timer with I = Imin
+ */
+void RPL_trickle_start(struct rpl_trickle_s *trickle);
+void RPL_trickle_stop(struct rpl_trickle_s *trickle);
+
+/**
+ * @brief A consistent transmission was heard [RFC6206 Section 4.2 rule 3]
+ */
+void RPL_trickle_consistent(struct rpl_trickle_s *trickle);
+
+/**
+ * @brief An inconsistency was detected, reset to Imin [RFC6206 Section 4.2 rule 6]
+ */
+void RPL_trickle_inconsistent(struct rpl_trickle_s *trickle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
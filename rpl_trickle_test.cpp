@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+#define TRICKLE_TEST_MAX_SENT   64
+
+static struct rpl_timer_wheel_s *trickle_wheel;
+static uint32_t sent_at[TRICKLE_TEST_MAX_SENT];
+static int sent_count;
+
+static void trickle_transmit(struct rpl_trickle_s *trickle, void *context) {
+	(void)trickle;
+	(void)context;
+	if (sent_count < TRICKLE_TEST_MAX_SENT) {
+		sent_at[sent_count] = trickle_wheel->now;
+	}
+	sent_count++;
+}
+
+static void trickle_count(struct rpl_trickle_s *trickle, void *context) {
+	(void)trickle;
+	(*(int *)context)++;
+}
+
+static uint32_t trickle_random(void *context) {
+	return *(uint32_t *)context;
+}
+
+TEST_GROUP(trickle_tests)
+{
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_trickle_engine_s engine;
+	struct rpl_trickle_s trickle;
+	uint32_t random_value;
+
+	void setup() {
+		RPL_timer_wheel_init(&wheel, 0, NULL);
+		RPL_trickle_engine_init(&engine, &wheel, trickle_random, &random_value);
+		trickle_wheel = &wheel;
+		sent_count = 0;
+		random_value = 0;
+	}
+
+	void teardown() {
+	}
+};
+
+//RFC6550 section 8.3.1 defaults
+TEST(trickle_tests, trickle_defaults) {
+	RPL_trickle_init_config(&trickle, &engine, NULL, trickle_transmit, NULL);
+	CHECK_EQUAL(8, trickle.imin);
+	CHECK_EQUAL(8UL << 20, trickle.imax);
+	CHECK_EQUAL(10, trickle.redundancy);
+}
+
+TEST(trickle_tests, trickle_config) {
+	struct rpl_option_dodag_configuration_s config;
+
+	memset(&config, 0, sizeof(config));
+	config.dio_int_min = 12;
+	config.dio_int_double = 8;
+	config.dio_redun = 0;
+	RPL_trickle_init_config(&trickle, &engine, &config, trickle_transmit, NULL);
+	CHECK_EQUAL(4096, trickle.imin);
+	CHECK_EQUAL(4096UL << 8, trickle.imax);
+	CHECK_EQUAL(RPL_TRICKLE_INFINITE_REDUNDANCY, trickle.redundancy);
+}
+
+//With t = I/2 transmissions happen half way through intervals that double up to Imax
+TEST(trickle_tests, trickle_doubling) {
+	RPL_trickle_init(&trickle, &engine, 3, 2, 10, trickle_transmit, NULL);
+	RPL_trickle_start(&trickle);
+	RPL_timer_wheel_advance(&wheel, 8 + 16 + 32 + 32 + 16);
+
+	//Intervals [0,8) [8,24) [24,56) [56,88) [88,120)
+	CHECK_EQUAL(5, sent_count);
+	CHECK_EQUAL(4, sent_at[0]);
+	CHECK_EQUAL(8 + 8, sent_at[1]);
+	CHECK_EQUAL(24 + 16, sent_at[2]);
+	CHECK_EQUAL(56 + 16, sent_at[3]);
+	CHECK_EQUAL(88 + 16, sent_at[4]);
+	CHECK_EQUAL(32, trickle.interval);
+}
+
+//t is picked from [I/2, I)
+TEST(trickle_tests, trickle_random_range) {
+	random_value = 7;
+	RPL_trickle_init(&trickle, &engine, 3, 0, 10, trickle_transmit, NULL);
+	RPL_trickle_start(&trickle);
+	RPL_timer_wheel_advance(&wheel, 100);
+	CHECK(sent_count > 0);
+	CHECK_EQUAL(7, sent_at[0]);
+	CHECK_EQUAL(8 + 7, sent_at[1]);
+}
+
+//Transmission is suppressed once k consistent messages have been heard
+TEST(trickle_tests, trickle_suppression) {
+	int i;
+
+	RPL_trickle_init(&trickle, &engine, 4, 4, 2, trickle_transmit, NULL);
+	RPL_trickle_start(&trickle);
+	RPL_trickle_consistent(&trickle);
+	RPL_trickle_consistent(&trickle);
+	RPL_timer_wheel_advance(&wheel, 15);
+	CHECK_EQUAL(0, sent_count);
+
+	//The counter is reset with the next interval
+	RPL_trickle_consistent(&trickle);
+	RPL_timer_wheel_advance(&wheel, 16 + 32);
+	CHECK_EQUAL(1, sent_count);
+
+	//k = 0 never suppresses
+	RPL_trickle_init(&trickle, &engine, 4, 4, RPL_TRICKLE_INFINITE_REDUNDANCY, trickle_transmit, NULL);
+	RPL_trickle_start(&trickle);
+	for (i = 0; i < 300; i++) {
+		RPL_trickle_consistent(&trickle);
+	}
+	RPL_timer_wheel_advance(&wheel, wheel.now + 16);
+	CHECK_EQUAL(2, sent_count);
+}
+
+//An inconsistency resets the interval to Imin unless it is already Imin
+TEST(trickle_tests, trickle_inconsistent) {
+	RPL_trickle_init(&trickle, &engine, 3, 4, 10, trickle_transmit, NULL);
+	RPL_trickle_start(&trickle);
+	RPL_timer_wheel_advance(&wheel, 2);
+	RPL_trickle_inconsistent(&trickle);
+	RPL_timer_wheel_advance(&wheel, 8);
+	CHECK_EQUAL(1, sent_count);
+	CHECK_EQUAL(4, sent_at[0]);
+
+	RPL_timer_wheel_advance(&wheel, 100);
+	CHECK(trickle.interval > trickle.imin);
+	RPL_trickle_inconsistent(&trickle);
+	CHECK_EQUAL(trickle.imin, trickle.interval);
+	CHECK_EQUAL(100, trickle.interval_start);
+	sent_count = 0;
+	RPL_timer_wheel_advance(&wheel, 104);
+	CHECK_EQUAL(1, sent_count);
+	CHECK_EQUAL(104, sent_at[0]);
+
+	RPL_trickle_stop(&trickle);
+	RPL_timer_wheel_advance(&wheel, 100000);
+	CHECK_EQUAL(1, sent_count);
+	CHECK_EQUAL(0, wheel.pending);
+}
+
+//Many timers on one wheel, driven across a virtual day
+TEST(trickle_tests, trickle_many) {
+	static struct rpl_trickle_s trickles[2000];
+	static int counts[2000];
+	uint32_t next;
+	int i;
+
+	RPL_trickle_engine_init(&engine, &wheel, NULL, NULL);
+	for (i = 0; i < 2000; i++) {
+		counts[i] = 0;
+		RPL_trickle_init_config(&trickles[i], &engine, NULL, trickle_count, &counts[i]);
+		RPL_trickle_start(&trickles[i]);
+	}
+	while (RPL_timer_wheel_next_event(&wheel, 86400000UL, &next)) {
+		RPL_timer_wheel_advance(&wheel, next);
+	}
+	RPL_timer_wheel_advance(&wheel, 86400000UL);
+
+	//Imax is about 8388 s, so a day is roughly 20 doublings plus 10 intervals at Imax
+	for (i = 0; i < 2000; i++) {
+		CHECK(counts[i] >= 25);
+		CHECK(counts[i] <= 35);
+		CHECK_EQUAL(trickles[i].imax, trickles[i].interval);
+	}
+	CHECK_EQUAL(2000, wheel.pending);
+}
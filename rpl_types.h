@@ -27,8 +27,13 @@
  * Add packed attribute to all message structures (and structures that should be packed)
  */
 
+#ifndef RPL_TYPES_H
+#define RPL_TYPES_H
+
 #include <stdint.h>
 
+#include "rpl_conf.h"
+
 #define RPL_MAX_INSTANCE_ID                 127     //!< Maximum instance id in a LLN
 #define RPL_INSTANCE_FLAG_GLOBAL            0x00    //!< Indicates the RPL instance is global
 #define RPL_INSTANCE_FLAG_LOCAL             0x80    //!< Indicates the RPL instance is local only
@@ -38,26 +43,33 @@
 
 #define MAX_OPTION_DATA                     64      //!< Maximum size of control message option data fields
 
+#define RPL_ICMPV6_HEADER_LENGTH            4       //!< ICMPv6 type, code and checksum preceding each control message
+#define RPL_DODAG_ID_LENGTH                 16      //!< Length of a DODAGID (IPv6 address)
+
 #ifndef DEFAULT_PATH_CONTROL_SIZE
-//TODO: Default here
+#define DEFAULT_PATH_CONTROL_SIZE           0       //!< Default Path Control Size [RFC6550 Section 17]
 #endif
 
 #ifndef DEFAULT_DIO_INTERVAL_DOUBLINGS
-//TODO: Default here
+#define DEFAULT_DIO_INTERVAL_DOUBLINGS      20      //!< Default DIOIntervalDoublings, Imax = Imin * 2^20 [RFC6550 Section 17]
 #endif
 
 #ifndef DEFAULT_DIO_INTERVAL_MIN
-//TODO: Default here
+#define DEFAULT_DIO_INTERVAL_MIN            3       //!< Default DIOIntervalMin, Imin = 2^3 ms [RFC6550 Section 17]
 #endif
 
 #ifndef DEFAULT_DIO_REDUNDANCY_CONSTANT
-//TODO: Default here
+#define DEFAULT_DIO_REDUNDANCY_CONSTANT     10      //!< Default DIORedundancyConstant k [RFC6550 Section 17]
 #endif
 
 #ifndef DEFAULT_MIN_HOP_RANK_INCREASE
-//TODO: Default here
+#define DEFAULT_MIN_HOP_RANK_INCREASE       256     //!< Default MinHopRankIncrease [RFC6550 Section 17]
 #endif
 
+#define RPL_INFINITE_RANK                   0xFFFF  //!< Rank of a node that is not attached to a DODAG [RFC6550 Section 17]
+#define RPL_ROOT_RANK(min_hop_rank_increase)            (min_hop_rank_increase)     //!< Rank of a DODAG root [RFC6550 Section 17]
+#define RPL_DAG_RANK(rank, min_hop_rank_increase)       ((rank) / (min_hop_rank_increase))  //!< Integer part of a rank used for comparison [RFC6550 Section 3.5.1]
+
 enum rpl_control_message_e {
     RPL_DODAG_INFORMATION_SOLICITATION = 0x00,
     RPL_DODAG_INFORMATION_OBJECT = 0x01,
@@ -70,9 +82,16 @@ enum rpl_control_message_e {
     RPL_CONSISTENCY_CHECK = 0x8A
 };
 
+#define RPL_CONTROL_MESSAGE_SECURE_FLAG     0x80    //!< Set in the ICMPv6 code of secured control messages
+
 #ifndef RPL_OVERRIDE_TYPES
 typedef uint8_t rpl_instance_t;
-typedef uint8_t rpl_dodag_id_t;
+#if RPL_CONF_ADDRESS_HANDLE_BITS == 32
+typedef uint32_t rpl_address_handle_t;          //!< Interned IPv6 address or prefix (see rpl_address.h)
+#else
+typedef uint16_t rpl_address_handle_t;          //!< Interned IPv6 address or prefix (see rpl_address.h)
+#endif
+typedef rpl_address_handle_t rpl_dodag_id_t;    //!< Interned DODAGID
 typedef uint8_t rpl_dodag_version_t;
 typedef uint16_t rpl_dodag_rank_t;
 #endif
@@ -88,7 +107,7 @@ struct rpl_instance_s {
     rpl_dodag_id_t dodag_id;                //!< Identified of the DODAG root, unique within an RPL instance.
     rpl_dodag_version_t dodag_version;      //!< Specific iteration of a DODAG with a given DODAG ID, sequential counter incremented by the root
     rpl_dodag_rank_t dodag_rank;            //!< Rank in the DODAG (scope is current DODAG version). Defines position wrt. DODAG root.
-} rpl_instance_s;
+};
 
 /**
  * @brief DODAG Information Object (DIO)
@@ -104,7 +123,9 @@ struct rpl_dio_s {
     uint8_t flags;                          //!< Reserved for flags. Must be initialized to zero and ignored by receiver.
     uint8_t reserved;                       //!< Unused field. Must be initialized to zero and ignored by receiver.
     uint8_t options;
-} rpl_dio_s;
+};
+
+#define RPL_DIO_BASE_LENGTH                     24          //!< Length of the DIO base on the wire, including the DODAGID
 
 #define RPL_DIO_MODE_GROUNDED_FLAG              0x80        //!< Indicates whether the DODAG advertised can satisfy the application defined goal.
 
@@ -152,7 +173,9 @@ struct rpl_dao_s {
     uint8_t dao_sequence;                   //!< Incremented at each unique DAO message from a node and echoed in the DAO-ACK message.
     uint8_t dodag_id[16];                   //!< (Optional) set by DODAG root to uniquely identify a DODAG, present only when 'D' flag is set.
     uint8_t options;
-} rpl_dao_s;
+};
+
+#define RPL_DAO_BASE_LENGTH                 4       //!< Length of the DAO base on the wire, without the optional DODAGID
 
 #define RPL_DAO_FLAGS_MASK                  0x3F    //!< Mask for unused flags in the dao flags field
 #define RPL_DAO_FLAG_K_MASK                 0x80    //!< Indicates the recipient must respond with a DAO-ACK
@@ -178,7 +201,9 @@ struct rpl_dis_s {
     uint8_t flags;      //!< Unused field reserved for flags.
     uint8_t reserved;   //!< Unused field. Must be initialized to zero and ignored by the receiver.
     uint8_t options;      //!< Options placeholder
-} rpl_dis_s;
+};
+
+#define RPL_DIS_BASE_LENGTH                 2       //!< Length of the DIS base on the wire
 
 enum rpl_dis_option_e {
     RPL_DIS_OPTION_PAD1 = 0x00,
@@ -192,10 +217,13 @@ struct rpl_dao_ack_s {
     uint8_t dao_sequence;                   //!< Incremented at each unique DAO message from a node and echoed in the DAO-ACK message by the recipient.
     uint8_t status;                         //!< Indicates the completion. Status 0 is unqualified acceptance, 1-127 tentative acceptance, 128-255 rejection.
     uint8_t dodag_id[16];                   //!< (Optional) set by DODAG root to uniquely identify a DODAG, present only when 'D' flag is set.
-} rpl_dao_ack_s;
+};
+
+#define RPL_DAO_ACK_BASE_LENGTH             4       //!< Length of the DAO-ACK base on the wire, without the optional DODAGID
 
 #define RPL_DAO_ACK_FLAGS_MASK              0x7F    //!< Mask for unused flags in the dao ack flags field
 #define RPL_DAO_ACK_FLAG_K_MASK             0x80    //!< Indicates the DODAGID field is present, this MUST be set when a local RPL instance ID is used
+#define RPL_DAO_ACK_FLAG_D_MASK             RPL_DAO_ACK_FLAG_K_MASK     //!< 'D' flag as named in [RFC6550 Section 6.5]
 
 enum rpl_dao_ack_status_e {
     rpl_dao_ack_status_accepted = 0x00      //!< Indicates the DAO message has been accepted without qualification.
@@ -218,9 +246,12 @@ struct rpl_cc_s {
     uint8_t dodag_id[16];                   //!< Set by DODAG root to uniquely identify a DODAG, present only when 'D' flag is set.
     uint32_t destination_counter;           //!< Indicates the senders estimate of the destinations current security counter value. 0 for no estimate.
     uint8_t opions;
-} rpl_cc_s;
+};
+
+#define RPL_CC_BASE_LENGTH                  24      //!< Length of the CC base on the wire, including the DODAGID
 
 #define RPL_CC_FLAGS_MASK                   0x7F    //!< Mask for unused flags in the CC flags field
+#define RPL_CC_FLAG_R_MASK                  0x80    //!< Indicates the CC message is a response
 
 enum rpl_cc_option_e {
     RPL_CC_OPTION_PAD1 = 0x00,
@@ -255,7 +286,7 @@ enum rpl_option_type_e {
  * Option Type: 0x00
  */
 struct rpl_option_pad1_s {
-} rpl_option_pad1_s;
+};
 
 /**
  * @brief PadN Option
@@ -274,8 +305,8 @@ struct rpl_option_pad1_s {
         consists of N-2 zero-valued octets.
  */
 struct rpl_option_padN_s {
-    uint8_t padding[];
-} rpl_option_padN_s;
+    uint8_t padding[0];
+};
 
 /**
  * @brief DAG Metric Container
@@ -291,8 +322,8 @@ struct rpl_option_padN_s {
  *
  */
 struct rpl_option_dag_metric_s {
-    uint8_t metric_data[];
-} rpl_option_dag_metric_s;
+    uint8_t metric_data[0];
+};
 
 /**
  * @brief Route Information Option (RIO)
@@ -310,7 +341,7 @@ struct rpl_option_route_info_s {
     uint8_t flags;             //!< Route info flags, contains Route Preference (PRF)
     uint32_t route_lifetime;   //!< ROute lifetime, length of time in seconds that the prefix is valid for route determination
     uint8_t prefix[];          //!< Variable length field containing an IP address or IPv6 prefix
-} rpl_option_route_info_s;
+};
 
 #define RPL_OPTION_ROUTE_INFO_PRF_MASK      0x1f        //!< Route preference mask (in flags variable)
 #define RPL_OPTION_ROUTE_INGO_PRF_SHIFT     3           //!< Route preference shift (in flags variable)
@@ -337,7 +368,7 @@ struct rpl_option_dodag_configuration_s {
     uint8_t reserved;               //!< Reserved field, must be initialized to zero by sender and ignored by receiver
     uint8_t default_lifetime;       //!< Lifetime to be used as default for all RPL routes, lifetime = default * unit
     uint16_t lifetime_unit;         //!< Lifetime unit, provides the unit in seconds used to express route lifetimes in RPL
-} rpl_option_dodag_configuration_s;
+};
 
 #define RPL_OPTION_DODAG_CONFIG_AUTHENTICATION_MASK         0x08        //!< Authentication enabled mask (see flags field)
 #define RPL_OPTION_DODAG_CONFIG_AUTHENTICATION_SHIFT        3           //!< Authentication enabled shift
@@ -359,7 +390,7 @@ struct rpl_option_rpl_target_s {
     uint8_t flags;             //!< Flags, reserved for future use
     uint8_t prefix_length;     //!< Number of leading bits in the IPv6 prefix that are valid (0 to 128)
     uint8_t prefix[];          //!< Variable length field containing an IPv6 destination address, prefix, or multicast group
-} rpl_option_rpl_target_s;
+};
 
 
 /**
@@ -380,7 +411,7 @@ struct rpl_option_transit_info_s {
     uint8_t path_sequence;              //!< Path sequence, issued by nod owning a target prefix when issuing new RPL target options
     uint8_t path_lifetime;              //!< Path lifetime, length of time in lifetime units that the prefix is valid for route determination (0xFF is infinite, 0x00 is unreachable)
     uint8_t parent_address[];           //!< Parent Address (optional), IPv6 address of DODAG parent of issuing node
-} rpl_option_transit_info_s;
+};
 
 #define RPL_OPTION_TRANSIT_INFO_EXTERNAL_MASK           0x80    //!< External flag mask (see flags)
 #define RPL_OPTION_TRANSIT_INFO_EXTERNAL_SHIFT          7       //!< External flag shift (see flags)
@@ -406,12 +437,12 @@ struct rpl_option_solicited_info_s {
     uint8_t flags;                      //!< Flags, contains Version Predicate (V), Instance Predicate (I) and DODAG ID Predicate (D)
     uint8_t dodag_id[16];               //!< DODAG identifier (when valid)
     uint8_t version_number;             //!< Value of DODAG version (when valid)
-} rpl_option_solicited_info_s;
+};
 
 #define RPL_OPTION_SOLICITED_INFO_VERSION_MASK         0x80        //!< Version predicate mask (see flags field)
 #define RPL_OPTION_SOLICITED_INFO_VERSION_SHIFT        7           //!< Version predicate shift
-#define RPL_OPTION_SOLICITED_INFO_VERSION_VALID        (1<<RPL_OPTION_DODAG_CONFIG_AUTHENTICATION_SHIFT)
-#define RPL_OPTION_SOLICITED_INFO_VERSION_INVALID      (0<<RPL_OPTION_DODAG_CONFIG_AUTHENTICATION_SHIFT)
+#define RPL_OPTION_SOLICITED_INFO_VERSION_VALID        (1<<RPL_OPTION_SOLICITED_INFO_VERSION_SHIFT)
+#define RPL_OPTION_SOLICITED_INFO_VERSION_INVALID      (0<<RPL_OPTION_SOLICITED_INFO_VERSION_SHIFT)
 #define RPL_OPTION_SOLICITED_INFO_INSTANCE_MASK        0x40        //!< Instance predicate mask (see flags field)
 #define RPL_OPTION_SOLICITED_INFO_INSTANCE_SHIFT       6           //!< Instance predicate shift
 #define RPL_OPTION_SOLICITED_INFO_INSTANCE_VALID       (1<<RPL_OPTION_SOLICITED_INFO_INSTANCE_SHIFT)
@@ -438,7 +469,7 @@ struct rpl_option_prefix_info_s {
     uint32_t preferred_lifetime;        //!< Length of time in s that the addresses generated by stateless autoconfig remain preferred. 0xFFFFFFFF indicated infinity
     uint32_t reserved2;                 //!< Unused field, MUST be initialized to zero and ignored by receiver
     uint8_t prefix[];                   //!< IPv6 Address or Prefix
-} rpl_option_prefix_info_s;
+};
 
 #define RPL_OPTION_PREFIX_INFO_ON_LINK_MASK                 0x80        //!< On-Link Flag mask, indicates prefix can be used for on link determination
 #define RPL_OPTION_PREFIX_INFO_ON_LINK_SHIFT                7           //!< On-Link Flag shift
@@ -467,7 +498,7 @@ struct rpl_option_prefix_info_s {
  */
 struct rpl_option_target_descriptor_s {
     uint32_t descriptor;                //!< RPL target descriptor
-} rpl_option_target_descriptor_s;
+};
 
 /**
  * @brief RPL generic option structure
@@ -487,7 +518,7 @@ struct rpl_option_s {
         struct rpl_option_prefix_info_s prefix_info;
         struct rpl_option_target_descriptor_s target_descriptor;
     };
-} rpl_option_s;
+};
 
 /***            RPL Security structures, flags and enumerations             ***/
 
@@ -509,15 +540,15 @@ struct rpl_security_s {
         struct {
         } key_identifier_mode1;     //!< Indicates which key was used to protect the packet in Key Identifier Mode 1
         struct {
-            uint8_t key_source;     //!< Indicates the logical identifier of the originator of a group key (optional field)
+            uint8_t key_source[8];  //!< Indicates the logical identifier of the originator of a group key (optional field)
             uint8_t key_index;      //!< Index used to identify different keys from the same originator (optional field)
         } key_identifier_mode2;     //!< Indicates which key was used to protect the packet in Key Identifier Mode 2
         struct {
-            uint8_t key_source;     //!< Indicates the logical identifier of the originator of a group key (optional field)
+            uint8_t key_source[8];  //!< Indicates the logical identifier of the originator of a group key (optional field)
             uint8_t key_index;      //!< Index used to identify different keys from the same originator (optional field)
         } key_identifier_mode3;     //!< Indicates which key was used to protect the packet in Key Identifier Mode 3
     };
-} rpl_security_s;
+};
 
 
 #define RPL_SECURITY_COUNTER_IS_TIME_FLAG   0x80        //!< Indicates the counter field is a time stamp
@@ -526,8 +557,10 @@ enum rpl_security_algorithm_e {
     RPL_SECURITY_ALGORITHM_CCM_AES123_RSA_SHA256 = 0    //!< CCM with AES-129 for encryption, RSA with SHA-256 for signatures
 };
 
-#define RPL_SEC_KIM_MASK                        0xE0
-#define RPL_SEC_KIM_SHIFT                       5
+#define RPL_SECURITY_BASE_LENGTH                8           //!< Length of the security section without the Key Identifier field
+
+#define RPL_SEC_KIM_MASK                        0xC0
+#define RPL_SEC_KIM_SHIFT                       6
 
 enum rpl_security_kim_mode_e {
     RPL_SEC_KIM_MODE0 = 0x00,   //!< Group key used. Key field determined by Key Index field. Key source not present, key index present.
@@ -545,9 +578,9 @@ enum rpl_security_kim_mode_e {
  */
 enum rpl_security_lvl_normal_e {
     RPL_SEC_LVL_NORM_MODE0 = 0x00,  //!< MAC-32 with length 4
-    RPL_SEC_LVL_NORM_MODE1 = 0x00,  //!< ENC-MAC-32 with length 4
-    RPL_SEC_LVL_NORM_MODE2 = 0x00,  //!< MAC-64 with length 8
-    RPL_SEC_LVL_NORM_MODE3 = 0x00,  //!< ENC-MAC-64 with length 8
+    RPL_SEC_LVL_NORM_MODE1 = 0x01,  //!< ENC-MAC-32 with length 4
+    RPL_SEC_LVL_NORM_MODE2 = 0x02,  //!< MAC-64 with length 8
+    RPL_SEC_LVL_NORM_MODE3 = 0x03,  //!< ENC-MAC-64 with length 8
 };
 
 /**
@@ -556,9 +589,9 @@ enum rpl_security_lvl_normal_e {
  */
 enum rpl_security_lvl_mode_three_e {
     RPL_SEC_LVL_KIM3_MODE0 = 0x00,  //!< Sign-3072 with signature length 384
-    RPL_SEC_LVL_KIM3_MODE1 = 0x00,  //!< ENC-Sign-3072 with signature length 384
-    RPL_SEC_LVL_KIM3_MODE2 = 0x00,  //!< SIGN-2048 with signature length 256
-    RPL_SEC_LVL_KIM3_MODE3 = 0x00,  //!< ENC-SIGN-2013 with signature length 2256
+    RPL_SEC_LVL_KIM3_MODE1 = 0x01,  //!< ENC-Sign-3072 with signature length 384
+    RPL_SEC_LVL_KIM3_MODE2 = 0x02,  //!< SIGN-2048 with signature length 256
+    RPL_SEC_LVL_KIM3_MODE3 = 0x03,  //!< ENC-SIGN-2013 with signature length 2256
 };
 
 /**
@@ -581,7 +614,7 @@ struct rpl_control_message_s {
     uint8_t type;
     uint8_t code;
     uint16_t checksum;
-    rpl_control_message_base_u base;
+    union rpl_control_message_base_u base;
     void *options;
 };
 
@@ -595,7 +628,7 @@ struct rpl_secure_control_message_s {
     uint8_t code;
     uint16_t checksum;
     struct rpl_security_s security;
-    rpl_control_message_base_u base;
+    union rpl_control_message_base_u base;
     uint8_t option_type;
     uint8_t option_length;
     uint8_t option_data[MAX_OPTION_DATA];
@@ -607,3 +640,4 @@ struct rpl_secure_control_message_s {
 #define RPL_SEQUENCE_INITIAL        240     //!< Initial RPL sequence counter value [RFC6550 Page 64]
 #define RPL_SEQUENCE_MAX            255     //!< Maximum sequence counter value
 
+#endif
@@ -0,0 +1,82 @@
+#include <stddef.h>
+
+#include "rpl.h"
+
+//The state of the previous version is left in place, the tables only ignore it
+static void RPL_version_invalidate(struct rpl_version_s *version) {
+	RPL_parent_table_new_version(version->parents);
+#if RPL_CONF_STORING
+	if (version->routes != NULL) {
+		RPL_route_table_new_version(version->routes);
+	}
+#endif
+}
+
+static void RPL_version_hold_expired(struct rpl_timer_s *timer, void *context) {
+	struct rpl_version_s *version = (struct rpl_version_s *)context;
+
+	(void)timer;
+
+	version->member = 0;
+	RPL_version_invalidate(version);
+	if (version->lost != NULL) {
+		version->lost(version, version->context);
+	}
+}
+
+void RPL_version_init(struct rpl_version_s *version, struct rpl_parent_table_s *parents, struct rpl_route_table_s *routes, struct rpl_timer_wheel_s *wheel,
+                      uint32_t hold_time, rpl_version_callback_t lost, void *context) {
+	version->parents = parents;
+#if RPL_CONF_STORING
+	version->routes = routes;
+#else
+	(void)routes;
+#endif
+	version->wheel = wheel;
+	version->hold_time = hold_time;
+	version->lost = lost;
+	version->context = context;
+	version->version = (rpl_dodag_version_t)RPL_sequence_init();
+	version->member = parents->is_root;
+	RPL_timer_init(&version->hold, RPL_version_hold_expired, version);
+}
+
+int RPL_version_increment(struct rpl_version_s *version) {
+	if (!version->parents->is_root) {
+		return -1;
+	}
+	version->version = (rpl_dodag_version_t)RPL_sequence_increment(version->version);
+	RPL_version_invalidate(version);
+	return 0;
+}
+
+int RPL_version_receive(struct rpl_version_s *version, rpl_dodag_version_t dio_version) {
+	int result;
+
+	if (version->member) {
+		result = RPL_sequence_compare_fast(version->version, dio_version);
+		if (result == RPL_SEQUENCE_COMPARE_EQUAL) {
+			return RPL_VERSION_CURRENT;
+		}
+		//Only the root increments the version, and nobody goes back to an older one
+		if (version->parents->is_root || (result == RPL_SEQUENCE_COMPARE_A_GREATER)) {
+			return RPL_VERSION_INCONSISTENT;
+		}
+	}
+
+	version->version = dio_version;
+	version->member = 1;
+	RPL_version_invalidate(version);
+	RPL_timer_stop(version->wheel, &version->hold);
+	return RPL_VERSION_NEW;
+}
+
+void RPL_version_update(struct rpl_version_s *version) {
+	int attached = (RPL_parent_table_preferred(version->parents) != NULL);
+
+	if (version->parents->is_root || !version->member || attached) {
+		RPL_timer_stop(version->wheel, &version->hold);
+	} else if (!RPL_timer_running(&version->hold)) {
+		RPL_timer_start(version->wheel, &version->hold, version->wheel->now + version->hold_time);
+	}
+}
@@ -0,0 +1,104 @@
+/**
+ * RPL DODAG Version
+ * DODAG Version membership and global repair [RFC6550 Sections 3.2.2, 8.2.2.1]
+ *
+ * A node is a member of at most one DODAG Version and all its parents belong to that version.
+ * Only the root increments the version, other nodes move to a newer version when they hear it and
+ * never go back to an older one. Moving to a new version bumps the epoch of the parent and route
+ * tables, the state of the previous version is then ignored and reused as it is met instead of
+ * being torn down, so a global repair takes the same time whatever the size of the tables.
+ *
+ * After losing all parents a node holds the DODAG information for hold_time ticks, so it can
+ * reattach within the version it advertised (with an infinite rank meanwhile). When the time runs
+ * out without a parent the node forgets the DODAG and joins the next version it hears.
+ */
+
+#ifndef RPL_VERSION_H
+#define RPL_VERSION_H
+
+#include <stdint.h>
+
+#include "rpl_types.h"
+#include "rpl_parent.h"
+#include "rpl_route.h"
+#include "rpl_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rpl_route_table_s;
+
+/**
+ * Results of RPL_version_receive
+ */
+enum rpl_version_result_e {
+    RPL_VERSION_INCONSISTENT = -1,  //!< DIO of another version that is not followed (older, or newer at the root), the sender is not a parent
+    RPL_VERSION_CURRENT = 0,        //!< DIO of the version this node is a member of
+    RPL_VERSION_NEW = 1             //!< Node moved to (or joined) the DIO's version
+};
+
+struct rpl_version_s;
+
+typedef void (*rpl_version_callback_t)(struct rpl_version_s *version, void *context);
+
+/**
+ * @brief DODAG Version state of a node
+ */
+struct rpl_version_s {
+    struct rpl_parent_table_s *parents;
+#if RPL_CONF_STORING
+    struct rpl_route_table_s *routes;       //!< Downward routes, may be NULL
+#endif
+    struct rpl_timer_wheel_s *wheel;
+    struct rpl_timer_s hold;                //!< Runs while the DODAG is held after losing all parents
+    uint32_t hold_time;                     //!< Ticks the DODAG information is held
+    rpl_version_callback_t lost;            //!< Called when the DODAG is forgotten, may be NULL
+    void *context;                          //!< Passed to lost
+    rpl_dodag_version_t version;            //!< DODAGVersionNumber of the version this node is a member of
+    uint8_t member;                         //!< Set while the node is a member of version
+};
+
+/**
+ * @brief Initialise the version state of a node
+ * @details A root (see the parent table) is a member of the initial version, other nodes join the
+ * version of the first DIO they hear. routes is ignored when RPL_CONF_STORING is 0.
+ */
+void RPL_version_init(struct rpl_version_s *version, struct rpl_parent_table_s *parents, struct rpl_route_table_s *routes, struct rpl_timer_wheel_s *wheel,
+                      uint32_t hold_time, rpl_version_callback_t lost, void *context);
+
+/**
+ * @brief Start a global repair by incrementing the version [RFC6550 Section 7.2]
+ * @return 0, or -1 when this node is not the root
+ */
+int RPL_version_increment(struct rpl_version_s *version);
+
+/**
+ * @brief Check the DODAGVersionNumber of a received DIO before its rank is used
+ * @details Moves the node to a newer version, or one that is no longer comparable (eg. after a
+ * long partition). The rank of the DIO should only update the parent table when the result is not
+ * RPL_VERSION_INCONSISTENT, and the Trickle timer be reset when it is not RPL_VERSION_CURRENT.
+ *
+ * @return rpl_version_result_e
+ */
+int RPL_version_receive(struct rpl_version_s *version, rpl_dodag_version_t dio_version);
+
+/**
+ * @brief Start or stop holding the DODAG, to be called after the parent set changed
+ */
+void RPL_version_update(struct rpl_version_s *version);
+
+//A node only sends DIOs for the version it is a member of
+static inline int RPL_version_is_member(const struct rpl_version_s *version) {
+    return version->member;
+}
+
+static inline int RPL_version_is_holding(const struct rpl_version_s *version) {
+    return RPL_timer_running(&version->hold);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include "rpl.h"
+
+
+static const uint8_t parent_a[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0A };
+static const uint8_t parent_b[16] = { 0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0B };
+static const uint8_t target[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+static int lost_count;
+static void *lost_context;
+
+static void version_lost(struct rpl_version_s *version, void *context) {
+	(void)version;
+
+	lost_count++;
+	lost_context = context;
+}
+
+TEST_GROUP(version_tests)
+{
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_parent_table_s parents;
+#if RPL_CONF_STORING
+	struct rpl_route_table_s routes;
+	struct rpl_route_s nodes[8];
+	struct rpl_route_s hosts[16];
+#endif
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[16];
+	rpl_address_handle_t index[16];
+	struct rpl_version_s version;
+
+	void setup() {
+		lost_count = 0;
+		lost_context = NULL;
+		RPL_timer_wheel_init(&wheel, 0, NULL);
+		RPL_address_table_init(&addresses, entries, 16, index, 16);
+		RPL_parent_table_init(&parents, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+#if RPL_CONF_STORING
+		RPL_route_table_init(&routes, &addresses, nodes, 8, hosts, 60);
+		RPL_version_init(&version, &parents, &routes, &wheel, 1000, version_lost, this);
+#else
+		RPL_version_init(&version, &parents, NULL, &wheel, 1000, version_lost, this);
+#endif
+	}
+
+	void teardown() {
+
+	}
+};
+
+TEST(version_tests, root_test) {
+	struct rpl_version_s root;
+	struct rpl_parent_table_s root_parents;
+
+	//Only the root increments the version
+	CHECK_EQUAL(-1, RPL_version_increment(&version));
+	CHECK(!RPL_version_is_member(&version));
+
+	RPL_parent_table_init(&root_parents, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 1);
+	RPL_version_init(&root, &root_parents, NULL, &wheel, 1000, NULL, NULL);
+	CHECK(RPL_version_is_member(&root));
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL, root.version);
+	CHECK_EQUAL(0, RPL_version_increment(&root));
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, root.version);
+
+	//and never follows another one
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&root, RPL_SEQUENCE_INITIAL + 5));
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&root, RPL_SEQUENCE_INITIAL));
+	CHECK_EQUAL(RPL_VERSION_CURRENT, RPL_version_receive(&root, RPL_SEQUENCE_INITIAL + 1));
+	RPL_version_update(&root);
+	CHECK(!RPL_version_is_holding(&root));
+}
+
+TEST(version_tests, receive_test) {
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&version, 240));
+	CHECK(RPL_version_is_member(&version));
+	RPL_parent_table_update(&parents, parent_a, 256, 0);
+#if RPL_CONF_STORING
+	RPL_route_table_dao(&routes, target, 128, parent_b, 1, RPL_ROUTE_LIFETIME_INFINITE, 0);
+#endif
+	CHECK_EQUAL(RPL_VERSION_CURRENT, RPL_version_receive(&version, 240));
+	CHECK_EQUAL(512, RPL_parent_table_rank(&parents));
+
+	//A newer version drops the parents and routes of the old one
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&version, 241));
+	CHECK_EQUAL(241, version.version);
+	CHECK_EQUAL(RPL_INFINITE_RANK, RPL_parent_table_rank(&parents));
+#if RPL_CONF_STORING
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&routes, target, 0));
+#endif
+
+	//Older versions are never followed again
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&version, 240));
+	CHECK_EQUAL(241, version.version);
+
+	//Across the lollipop wrap
+	version.version = 255;
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&version, 0));
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&version, 255));
+
+	//Counters that can no longer be compared are followed
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&version, 100));
+	CHECK_EQUAL(100, version.version);
+}
+
+TEST(version_tests, hold_test) {
+	RPL_version_receive(&version, 240);
+	RPL_parent_table_update(&parents, parent_a, 256, 0);
+	RPL_version_update(&version);
+	CHECK(!RPL_version_is_holding(&version));
+
+	//Losing all parents holds the DODAG, reattaching in the version stops the hold
+	RPL_parent_table_remove(&parents, parent_a);
+	RPL_version_update(&version);
+	CHECK(RPL_version_is_holding(&version));
+	RPL_timer_wheel_advance(&wheel, 500);
+	RPL_parent_table_update(&parents, parent_b, 512, 0);
+	RPL_version_update(&version);
+	CHECK(!RPL_version_is_holding(&version));
+	CHECK(RPL_version_is_member(&version));
+
+	//Moving to a new version stops the hold too
+	RPL_parent_table_remove(&parents, parent_b);
+	RPL_version_update(&version);
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&version, 241));
+	CHECK(!RPL_version_is_holding(&version));
+
+	//When the hold time runs out the DODAG is forgotten, any version can then be joined
+	RPL_parent_table_update(&parents, parent_a, 256, 0);
+	RPL_version_update(&version);
+	RPL_parent_table_remove(&parents, parent_a);
+	RPL_version_update(&version);
+	RPL_timer_wheel_advance(&wheel, 1499);
+	CHECK(RPL_version_is_member(&version));
+	CHECK_EQUAL(0, lost_count);
+	RPL_timer_wheel_advance(&wheel, 1500);
+	CHECK_EQUAL(1, lost_count);
+	POINTERS_EQUAL(this, lost_context);
+	CHECK(!RPL_version_is_member(&version));
+	CHECK(!RPL_version_is_holding(&version));
+	RPL_version_update(&version);
+	CHECK(!RPL_version_is_holding(&version));
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&version, 240));
+}
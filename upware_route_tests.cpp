@@ -1,3 +1,5 @@
+#include <string.h>
+
 
 
 #include "CppUTest/TestHarness.h"
@@ -29,43 +31,176 @@ TEST(upward_route_tests, dio_base_rules_8_1) {
 
 //8.2.1.  Neighbors and Parents within a DODAG Version
 TEST(upward_route_tests, neighbors_parents_8_2_1) {
+	struct rpl_parent_table_s root;
+	struct rpl_parent_table_s node;
+#if RPL_CONF_STORING
+	struct rpl_route_table_s routes;
+	struct rpl_route_s route_nodes[8];
+	struct rpl_route_s route_hosts[16];
+	uint8_t target[16] = { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+#endif
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[16];
+	rpl_address_handle_t index[16];
+	uint8_t neighbors[4][16], address[16];
+	int parents;
+	int i;
+
+	memset(neighbors, 0, sizeof(neighbors));
+	for (i = 0; i < 4; i++) {
+		neighbors[i][0] = 0xFE;
+		neighbors[i][1] = 0x80;
+		neighbors[i][15] = (uint8_t)(i + 1);
+	}
+	RPL_address_table_init(&addresses, entries, 16, index, 16);
+	RPL_parent_table_init(&root, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 1);
+	RPL_parent_table_init(&node, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	RPL_parent_table_update(&root, neighbors[0], 512, 0);
+	RPL_parent_table_update(&node, neighbors[0], 256, 0);
+	RPL_parent_table_update(&node, neighbors[1], 512, 0);
+	RPL_parent_table_update(&node, neighbors[2], 768, 0);
+	RPL_parent_table_update(&node, neighbors[3], 640, 300);
+
 	//Check parent set must be a subset of neighbor set
+	//(parents are drawn from the table entries, count the parents found in the neighbor table)
+	parents = 0;
+	for (i = 0; i < node.count; i++) {
+		if (RPL_parent_table_is_parent(&node, i)) {
+			RPL_parent_table_address(&node, &node.neighbors[i], address);
+			CHECK(RPL_parent_table_find(&node, address) >= 0);
+			parents++;
+		}
+	}
+	CHECK_EQUAL(RPL_parent_table_parent_count(&node), parents);
+	CHECK(parents <= node.count);
 
 	//Check root has parent set size of zero
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&root));
+	POINTERS_EQUAL(NULL, RPL_parent_table_preferred(&root));
 
 	//Check non-root parent set >= 1 (how does this work with undiscovered?)
+	//An attached node (rank below INFINITE_RANK) has at least its preferred parent, a node that has
+	//not yet discovered the DODAG is detached with an empty parent set
+	CHECK(RPL_parent_table_rank(&node) != RPL_INFINITE_RANK);
+	CHECK(RPL_parent_table_parent_count(&node) >= 1);
 
 	//Check preferred parent must be a member of parent set
+	CHECK(RPL_parent_table_preferred(&node) != NULL);
+	CHECK(RPL_parent_table_is_parent(&node, node.preferred));
 
 	//Check rank is greater than all elements in parent set
+	for (i = 0; i < node.count; i++) {
+		if (RPL_parent_table_is_parent(&node, i)) {
+			CHECK(RPL_DAG_RANK(RPL_parent_table_rank(&node), node.min_hop_rank_increase) > RPL_DAG_RANK(node.neighbors[i].rank, node.min_hop_rank_increase));
+		}
+	}
 
 	//Check unreachable nodes are not considered in candidate neighbor set (see [RFC4861] for Neighbor Unreachability Detection)
-
+	CHECK_EQUAL(0, RPL_parent_table_remove(&node, neighbors[0]));
+	CHECK_EQUAL(-1, RPL_parent_table_find(&node, neighbors[0]));
+	CHECK(RPL_parent_table_preferred(&node) != NULL);
+	RPL_parent_table_address(&node, RPL_parent_table_preferred(&node), address);
+	CHECK(memcmp(address, neighbors[0], 16) != 0);
+	CHECK_EQUAL(768, RPL_parent_table_rank(&node));
+
+#if RPL_CONF_STORING
 	//Check unreachable nodes are removed from the routing table
+	RPL_route_table_init(&routes, &addresses, route_nodes, 8, route_hosts, 60);
+	RPL_route_table_dao(&routes, target, 128, neighbors[1], 240, 10, 0);
+	RPL_route_table_dao(&routes, neighbors[2], 128, neighbors[2], 240, 10, 0);
+	CHECK_EQUAL(0, RPL_parent_table_remove(&node, neighbors[1]));
+	CHECK_EQUAL(1, RPL_route_table_remove_next_hop(&routes, neighbors[1]));
+	POINTERS_EQUAL(NULL, RPL_route_table_lookup(&routes, target, 0));
+	CHECK(RPL_route_table_lookup(&routes, neighbors[2], 0) != NULL);
+#endif
 }
 
 //8.2.2.1.  DODAG Version
 TEST(upward_route_tests, dodag_version_8_2_2_1) {
+	struct rpl_timer_wheel_s wheel;
+	struct rpl_parent_table_s root_parents, parents;
+	struct rpl_version_s root, node;
+	struct rpl_address_table_s addresses;
+	struct rpl_address_s entries[8];
+	rpl_address_handle_t index[8];
+	uint8_t neighbors[3][16];
+	int i;
+
+	memset(neighbors, 0, sizeof(neighbors));
+	for (i = 0; i < 3; i++) {
+		neighbors[i][0] = 0xFE;
+		neighbors[i][1] = 0x80;
+		neighbors[i][15] = (uint8_t)(i + 1);
+	}
+	RPL_timer_wheel_init(&wheel, 0, NULL);
+	RPL_address_table_init(&addresses, entries, 8, index, 8);
+	RPL_parent_table_init(&root_parents, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 1);
+	RPL_parent_table_init(&parents, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	RPL_version_init(&root, &root_parents, NULL, &wheel, 1000, NULL, NULL);
+	RPL_version_init(&node, &parents, NULL, &wheel, 1000, NULL, NULL);
+
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&node, root.version));
+	RPL_parent_table_update(&parents, neighbors[0], 256, 0);
+	RPL_parent_table_update(&parents, neighbors[1], 256, 0);
+	RPL_version_update(&node);
+	CHECK_EQUAL(2, RPL_parent_table_parent_count(&parents));
+
 	//1. Check all elements of a parent set MUST belong to the same DODAG version
+	//   (a new version leaves the parents of the old one out of the parent set)
+	CHECK_EQUAL(0, RPL_version_increment(&root));
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&node, root.version));
+	RPL_parent_table_update(&parents, neighbors[0], 256, 0);
+	CHECK_EQUAL(1, RPL_parent_table_parent_count(&parents));
+	CHECK(!RPL_parent_table_is_parent(&parents, RPL_parent_table_find(&parents, neighbors[1])));
 
 	//2. Check node is a member of a DODAG version only if all parents are members of that DODAG version
 	//   (or if the node is the root)
+	CHECK(RPL_version_is_member(&root));
+	CHECK(RPL_version_is_member(&node));
+	CHECK_EQUAL(root.version, node.version);
 
 	//3. Check node can only send DIOs for DODAG versions of which it is a member
+	//   (the version advertised is the one the node is a member of, a node that forgot the DODAG advertises none)
+	struct rpl_version_s detached;
+	struct rpl_parent_table_s detached_parents;
+
+	RPL_parent_table_init(&detached_parents, &addresses, DEFAULT_MIN_HOP_RANK_INCREASE, 0);
+	RPL_version_init(&detached, &detached_parents, NULL, &wheel, 1000, NULL, NULL);
+	CHECK(!RPL_version_is_member(&detached));
 
 	//4. Check DODAG root can increment DODAG version, follows Section 7
 	//   Check non DODAG root cannot increment DODAG version
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, root.version);
+	CHECK_EQUAL(-1, RPL_version_increment(&node));
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, node.version);
 
 	//5. Check non-root node can not advertise a DODAGVersionNumber less than (<) that it is aware of
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&node, RPL_SEQUENCE_INITIAL));
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, node.version);
 
 	//6. Check non-root node can not be a member of a previous version after advertising a higher (>) version
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&node, RPL_SEQUENCE_INITIAL));
+	CHECK(RPL_version_is_member(&node));
+	CHECK_EQUAL(RPL_SEQUENCE_INITIAL + 1, node.version);
 
 	//Check node holds DODAG information for implementation defined time following loss of all parents
+	RPL_version_update(&node);
+	RPL_parent_table_remove(&parents, neighbors[0]);
+	RPL_version_update(&node);
+	CHECK(RPL_version_is_holding(&node));
+	RPL_timer_wheel_advance(&wheel, 999);
+	CHECK(RPL_version_is_member(&node));
+	RPL_timer_wheel_advance(&wheel, 1000);
+	CHECK(!RPL_version_is_member(&node));
 
 	//Check parent advertising a new DODAGVersionNumber cannot belong to the sub-DODAG of a node advertising an older DODAGVersionNumber
-
+	//(a node of the new version does not take DIOs of the older version into its parent set)
+	CHECK_EQUAL(RPL_VERSION_NEW, RPL_version_receive(&node, RPL_SEQUENCE_INITIAL + 2));
+	CHECK_EQUAL(RPL_VERSION_INCONSISTENT, RPL_version_receive(&node, RPL_SEQUENCE_INITIAL + 1));
+	CHECK_EQUAL(0, RPL_parent_table_parent_count(&parents));
 }
 
+
 //8.2.2.2.  DODAG Roots
 TEST(upward_route_tests, dodag_roots_8_2_2_2) {
 	//TODO: